@@ -0,0 +1,63 @@
+#include "alloc-counter.hpp"
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+thread_local uint64_t t_allocations = 0;
+thread_local uint64_t t_bytes = 0;
+
+void *Allocate(std::size_t size)
+{
+	++t_allocations;
+	t_bytes += size;
+	if (void *ptr = std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+} // namespace
+
+void *operator new(std::size_t size)
+{
+	return Allocate(size);
+}
+
+void *operator new[](std::size_t size)
+{
+	return Allocate(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+AllocationCount ThreadAllocations()
+{
+	return {t_allocations, t_bytes};
+}
+
+void ReportAllocations(benchmark::State &state, const AllocationCount &start)
+{
+	AllocationCount now = ThreadAllocations();
+	state.counters["allocs/iter"] = benchmark::Counter(static_cast<double>(now.allocations - start.allocations),
+							   benchmark::Counter::kAvgIterations);
+	state.counters["alloc_bytes/iter"] =
+		benchmark::Counter(static_cast<double>(now.bytes - start.bytes), benchmark::Counter::kAvgIterations);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+
+// The bench binary replaces global operator new to count what the calling thread allocates, so
+// benchmarks can report allocations per iteration next to their throughput.
+struct AllocationCount {
+	uint64_t allocations = 0;
+	uint64_t bytes = 0;
+};
+
+AllocationCount ThreadAllocations();
+
+// Adds allocs/iter and alloc_bytes/iter counters for everything allocated on this thread since start
+void ReportAllocations(benchmark::State &state, const AllocationCount &start);
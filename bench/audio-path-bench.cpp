@@ -0,0 +1,135 @@
+#include "obs-audio-to-websocket/audio-format.hpp"
+#include "obs-audio-to-websocket/audio-levels.hpp"
+#include "obs-audio-to-websocket/audio-packet.hpp"
+#include "alloc-counter.hpp"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace obs_audio_to_websocket;
+
+namespace {
+
+// Planar float block as OBS hands it to the capture callback
+struct PlanarBlock {
+	std::vector<float> samples;
+	AudioFrame frame;
+
+	PlanarBlock(uint32_t channels, uint32_t frames)
+	{
+		samples.resize(static_cast<size_t>(channels) * frames);
+		for (size_t i = 0; i < samples.size(); ++i) {
+			// Slightly over full scale now and then, so the clamp is exercised
+			samples[i] = 1.1f * std::sin(0.01f * static_cast<float>(i));
+		}
+		frame.channels = channels;
+		frame.frames = frames;
+		frame.sampleRate = 48000;
+		for (uint32_t ch = 0; ch < channels; ++ch) {
+			frame.planes[ch] = samples.data() + static_cast<size_t>(ch) * frames;
+		}
+	}
+};
+
+// Channel counts 1-8 (mono to 7.1) against OBS-sized to large blocks
+void BlockShapes(benchmark::internal::Benchmark *bench)
+{
+	bench->ArgNames({"channels", "frames"});
+	bench->ArgsProduct({{1, 2, 6, 8}, {128, 480, 1024, 4096}});
+}
+
+void ReportSamples(benchmark::State &state, const AudioFrame &frame, size_t bytesPerIteration)
+{
+	int64_t samples = static_cast<int64_t>(frame.frames) * frame.channels;
+	state.SetItemsProcessed(state.iterations() * samples);
+	state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytesPerIteration));
+}
+
+void ConvertBench(benchmark::State &state, bool toFloat)
+{
+	PlanarBlock block(static_cast<uint32_t>(state.range(0)), static_cast<uint32_t>(state.range(1)));
+	size_t outBytes = block.samples.size() * (toFloat ? 4 : 2);
+	std::vector<uint8_t> out(outBytes);
+
+	AllocationCount start = ThreadAllocations();
+	for (auto _ : state) {
+		ConvertPlanar(block.frame, toFloat, out.data());
+		benchmark::DoNotOptimize(out.data());
+		benchmark::ClobberMemory();
+	}
+	ReportAllocations(state, start);
+	ReportSamples(state, block.frame, outBytes);
+}
+
+} // namespace
+
+// Planar float -> interleaved little-endian int16, the default wire format. items_per_second is samples/s.
+static void BM_ConvertPlanarS16(benchmark::State &state)
+{
+	ConvertBench(state, false);
+}
+BENCHMARK(BM_ConvertPlanarS16)->Apply(BlockShapes);
+
+static void BM_ConvertPlanarF32(benchmark::State &state)
+{
+	ConvertBench(state, true);
+}
+BENCHMARK(BM_ConvertPlanarF32)->Apply(BlockShapes);
+
+// Peak, RMS and 4x true peak, once per block on the encoding thread
+static void BM_LevelMeter(benchmark::State &state)
+{
+	PlanarBlock block(static_cast<uint32_t>(state.range(0)), static_cast<uint32_t>(state.range(1)));
+	LevelMeter meter;
+	bool completed = false;
+	meter.Measure(block.frame, completed); // Size the scratch buffer outside the timed loop
+
+	AllocationCount start = ThreadAllocations();
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(meter.Measure(block.frame, completed));
+	}
+	ReportAllocations(state, start);
+	ReportSamples(state, block.frame, block.samples.size() * sizeof(float));
+}
+BENCHMARK(BM_LevelMeter)->Apply(BlockShapes);
+
+// Packet allocation and header serialization, without filling the payload
+static void BM_CreateAudioPacket(benchmark::State &state)
+{
+	PlanarBlock block(static_cast<uint32_t>(state.range(0)), static_cast<uint32_t>(state.range(1)));
+	size_t payloadBytes = block.samples.size() * 2;
+	const std::string sourceId = "Main";
+	const std::string sourceName = "Mic/Aux";
+
+	AllocationCount start = ThreadAllocations();
+	for (auto _ : state) {
+		auto packet = CreateAudioPacket(0, AudioFormat(48000, block.frame.channels, 16), sourceId, sourceName,
+						payloadBytes);
+		benchmark::DoNotOptimize(packet->data.data());
+	}
+	ReportAllocations(state, start);
+	ReportSamples(state, block.frame, AUDIO_PACKET_HEADER_SIZE + payloadBytes);
+}
+BENCHMARK(BM_CreateAudioPacket)->Apply(BlockShapes);
+
+// What the encoder does per block before the sinks see it: new packet, header, int16 payload
+static void BM_EncodeBlock(benchmark::State &state)
+{
+	PlanarBlock block(static_cast<uint32_t>(state.range(0)), static_cast<uint32_t>(state.range(1)));
+	size_t payloadBytes = block.samples.size() * 2;
+	const std::string sourceId = "Main";
+	const std::string sourceName = "Mic/Aux";
+
+	AllocationCount start = ThreadAllocations();
+	for (auto _ : state) {
+		auto packet = CreateAudioPacket(0, AudioFormat(48000, block.frame.channels, 16), sourceId, sourceName,
+						payloadBytes);
+		ConvertPlanar(block.frame, false, packet->payload());
+		benchmark::DoNotOptimize(packet->data.data());
+	}
+	ReportAllocations(state, start);
+	ReportSamples(state, block.frame, AUDIO_PACKET_HEADER_SIZE + payloadBytes);
+}
+BENCHMARK(BM_EncodeBlock)->Apply(BlockShapes);
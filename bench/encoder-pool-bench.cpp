@@ -0,0 +1,110 @@
+#include "obs-audio-to-websocket/encoder-pool.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace obs_audio_to_websocket;
+
+namespace {
+
+constexpr size_t FRAMES = 1024;
+constexpr size_t CHANNELS = 2;
+// Blocks posted per stream per iteration, about a second of 48 kHz audio
+constexpr size_t BLOCKS_PER_ITERATION = 48;
+// Conversion passes per block, standing in for a codec that costs tens of microseconds per block
+constexpr int CODEC_PASSES = 16;
+
+// Synthetic feed: a planar stereo sine block, the same one every time
+std::vector<float> MakeBlock()
+{
+	std::vector<float> block(FRAMES * CHANNELS);
+	for (size_t ch = 0; ch < CHANNELS; ++ch) {
+		for (size_t i = 0; i < FRAMES; ++i) {
+			block[ch * FRAMES + i] = 0.5f * std::sin(static_cast<float>(i + ch * 7) * 0.05f);
+		}
+	}
+	return block;
+}
+
+// The pipeline's float -> 16-bit conversion, repeated to stand in for heavier codec work
+void EncodeBlock(const std::vector<float> &block, std::vector<int16_t> &out)
+{
+	for (int pass = 0; pass < CODEC_PASSES; ++pass) {
+		for (size_t i = 0; i < FRAMES; ++i) {
+			for (size_t ch = 0; ch < CHANNELS; ++ch) {
+				float sample = std::clamp(block[ch * FRAMES + i], -1.0f, 1.0f);
+				out[i * CHANNELS + ch] = static_cast<int16_t>(std::round(sample * 32767.0f));
+			}
+		}
+		benchmark::DoNotOptimize(out.data());
+	}
+}
+
+} // namespace
+
+// Blocks/s across range(0) streams, each on its own lane of a pool with one thread per core. Scaling
+// is near linear up to the core count when lanes really encode in parallel.
+static void BM_EncoderPoolStreams(benchmark::State &state)
+{
+	size_t streams = static_cast<size_t>(state.range(0));
+	EncoderPool pool(std::max(1u, std::thread::hardware_concurrency()));
+
+	const std::vector<float> block = MakeBlock();
+	std::atomic<size_t> remaining{0};
+	std::vector<std::vector<int16_t>> outputs(streams, std::vector<int16_t>(FRAMES * CHANNELS));
+	std::vector<std::shared_ptr<EncoderStream>> lanes;
+	for (size_t i = 0; i < streams; ++i) {
+		std::vector<int16_t> *out = &outputs[i];
+		lanes.push_back(pool.CreateStream([&block, out, &remaining]() {
+			EncodeBlock(block, *out);
+			remaining.fetch_sub(1, std::memory_order_release);
+		}));
+	}
+
+	for (auto _ : state) {
+		remaining = streams * BLOCKS_PER_ITERATION;
+		for (size_t n = 0; n < BLOCKS_PER_ITERATION; ++n) {
+			for (auto &lane : lanes) {
+				lane->Post();
+			}
+		}
+		while (remaining.load(std::memory_order_acquire) > 0) {
+			std::this_thread::yield();
+		}
+	}
+
+	uint64_t cpuNs = 0;
+	uint64_t jobs = 0;
+	for (auto &lane : lanes) {
+		cpuNs += lane->GetCpuTimeNs();
+		jobs += lane->GetJobCount();
+		lane->Close();
+	}
+	pool.Stop();
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * streams * BLOCKS_PER_ITERATION));
+	state.counters["cpu_us_per_block"] = jobs ? cpuNs / 1000.0 / jobs : 0.0;
+}
+BENCHMARK(BM_EncoderPoolStreams)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// Baseline: the same streams encoded one after another on a single thread, as the audio callback did
+static void BM_EncoderInlineStreams(benchmark::State &state)
+{
+	size_t streams = static_cast<size_t>(state.range(0));
+	std::vector<int16_t> output(FRAMES * CHANNELS);
+	const std::vector<float> block = MakeBlock();
+
+	for (auto _ : state) {
+		for (size_t n = 0; n < BLOCKS_PER_ITERATION * streams; ++n) {
+			EncodeBlock(block, output);
+		}
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * streams * BLOCKS_PER_ITERATION));
+}
+BENCHMARK(BM_EncoderInlineStreams)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,222 @@
+#include "obs-audio-to-websocket/audio-packet.hpp"
+#include "obs-audio-to-websocket/pipeline-stats.hpp"
+#include "obs-audio-to-websocket/websocketpp-client.hpp"
+#include "impairment-proxy.hpp"
+#include <websocketpp/server.hpp>
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace obs_audio_to_websocket;
+
+// A websocketpp client streaming at the audio rate through ImpairmentProxy. Each iteration is a fixed
+// stretch of real time, so the counters rather than the timings are the numbers to compare: what the
+// client drops under backpressure, what is lost on resets, delivery latency and how long the link needs
+// to catch up once sending stops.
+
+namespace {
+
+// The heaviest common format, 8 channels of float at 48 kHz (about 1.5 MB/s), so stalls reach the
+// client's send buffer limit within a second or so
+constexpr uint32_t SAMPLE_RATE = 48000;
+constexpr uint32_t CHANNELS = 8;
+constexpr uint32_t FRAMES = 1024;
+constexpr int STREAM_SECONDS = 4;
+
+// Records the send-to-receive latency carried in each packet's timestamp
+class LatencyReceiver {
+public:
+	LatencyReceiver()
+	{
+		m_server.clear_access_channels(websocketpp::log::alevel::all);
+		m_server.clear_error_channels(websocketpp::log::elevel::all);
+		m_server.init_asio();
+		m_server.set_reuse_addr(true);
+		m_server.set_message_handler([this](websocketpp::connection_hdl, server_type::message_ptr msg) {
+			const std::string &payload = msg->get_payload();
+			if (msg->get_opcode() != websocketpp::frame::opcode::binary ||
+			    payload.size() < AUDIO_PACKET_HEADER_SIZE)
+				return;
+			uint64_t timestamp = 0;
+			for (int i = 7; i >= 0; --i) {
+				timestamp = (timestamp << 8) | static_cast<uint8_t>(payload[i]);
+			}
+			uint64_t now = SteadyNowNs();
+			latencyNs.Record(now > timestamp ? now - timestamp : 0);
+			packets.fetch_add(1, std::memory_order_relaxed);
+		});
+		m_server.listen(asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+		m_server.start_accept();
+		asio::error_code ec;
+		port = m_server.get_local_endpoint(ec).port();
+		m_thread = std::thread([this]() { m_server.run(); });
+	}
+
+	~LatencyReceiver()
+	{
+		m_server.stop();
+		m_thread.join();
+	}
+
+	std::atomic<uint64_t> packets{0};
+	Histogram latencyNs;
+	uint16_t port = 0;
+
+private:
+	using server_type = websocketpp::server<websocketpp::config::asio>;
+	server_type m_server;
+	std::thread m_thread;
+};
+
+bool WaitFor(const std::function<bool()> &condition, int timeoutMs)
+{
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+	while (!condition()) {
+		if (std::chrono::steady_clock::now() > deadline)
+			return false;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return true;
+}
+
+void RunImpaired(benchmark::State &state, const ImpairmentSettings &settings)
+{
+	const size_t payloadBytes = size_t(FRAMES) * CHANNELS * sizeof(float);
+	const auto blockDuration = std::chrono::nanoseconds(uint64_t(FRAMES) * 1000000000ULL / SAMPLE_RATE);
+	uint64_t sent = 0, dropped = 0, skipped = 0, received = 0, stalls = 0, resets = 0;
+	double catchUpMs = 0;
+	HistogramSnapshot latency;
+
+	for (auto _ : state) {
+		LatencyReceiver receiver;
+		ImpairmentProxy proxy(asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), receiver.port),
+				      settings);
+		auto client = std::make_shared<WebSocketPPClient>();
+		client->Connect("ws://127.0.0.1:" + std::to_string(proxy.GetPort()) + "/");
+		if (!WaitFor([&client]() { return client->IsConnected(); }, 5000)) {
+			state.SkipWithError("client did not connect");
+			client->Disconnect();
+			break;
+		}
+
+		uint64_t iterationSent = 0;
+		auto next = std::chrono::steady_clock::now();
+		auto end = next + std::chrono::seconds(STREAM_SECONDS);
+		while (next < end) {
+			std::this_thread::sleep_until(next);
+			next += blockDuration;
+			auto packet = CreateAudioPacket(SteadyNowNs(), AudioFormat(SAMPLE_RATE, CHANNELS, 32), "bench",
+							"bench", payloadBytes);
+			memset(packet->payload(), 0, payloadBytes);
+			if (client->IsConnected()) {
+				client->SendAudioPacket(packet);
+				++iterationSent;
+			} else {
+				++skipped;
+			}
+		}
+
+		// Caught up once everything the client accepted has arrived, or nothing more has for 200 ms
+		// (the rest went down with a reset connection)
+		uint64_t expected = iterationSent - client->GetDroppedPackets();
+		auto stopped = std::chrono::steady_clock::now();
+		auto lastArrival = stopped;
+		uint64_t seen = receiver.packets.load();
+		WaitFor(
+			[&]() {
+				uint64_t now = receiver.packets.load();
+				if (now != seen) {
+					seen = now;
+					lastArrival = std::chrono::steady_clock::now();
+				}
+				return now >= expected ||
+				       std::chrono::steady_clock::now() - lastArrival > std::chrono::milliseconds(200);
+			},
+			10000);
+		catchUpMs += std::chrono::duration<double, std::milli>(lastArrival - stopped).count();
+
+		sent += iterationSent;
+		dropped += client->GetDroppedPackets();
+		received += receiver.packets.load();
+		stalls += proxy.GetStats().stalls.load();
+		resets += proxy.GetStats().resets.load();
+		latency.Add(receiver.latencyNs);
+		client->Disconnect();
+	}
+
+	auto perIteration = benchmark::Counter::kAvgIterations;
+	state.counters["sent"] = benchmark::Counter(static_cast<double>(sent), perIteration);
+	state.counters["dropped"] = benchmark::Counter(static_cast<double>(dropped), perIteration);
+	state.counters["lost"] =
+		benchmark::Counter(sent > dropped + received ? double(sent - dropped - received) : 0.0, perIteration);
+	state.counters["skipped"] = benchmark::Counter(static_cast<double>(skipped), perIteration);
+	state.counters["stalls"] = benchmark::Counter(static_cast<double>(stalls), perIteration);
+	state.counters["resets"] = benchmark::Counter(static_cast<double>(resets), perIteration);
+	state.counters["catch_up_ms"] = benchmark::Counter(catchUpMs, perIteration);
+	state.counters["p50_ms"] = latency.Percentile(0.5) / 1e6;
+	state.counters["p99_ms"] = latency.Percentile(0.99) / 1e6;
+	state.counters["max_ms"] = latency.GetMax() / 1e6;
+}
+
+} // namespace
+
+// Periodic stalls of the given length (mean one per second, same seed every run)
+static void BM_ImpairedStall(benchmark::State &state)
+{
+	ImpairmentSettings settings;
+	settings.stallEveryMs = 1000;
+	settings.stallMs = static_cast<uint32_t>(state.range(0));
+	RunImpaired(state, settings);
+}
+BENCHMARK(BM_ImpairedStall)
+	->Arg(100)
+	->Arg(500)
+	->Arg(2000)
+	->Iterations(1)
+	->Unit(benchmark::kMillisecond)
+	->UseRealTime();
+
+// Link capacity in KB/s, from above the stream's rate to well below it
+static void BM_ImpairedBandwidth(benchmark::State &state)
+{
+	ImpairmentSettings settings;
+	settings.bandwidthBps = static_cast<uint64_t>(state.range(0)) * 1000;
+	RunImpaired(state, settings);
+}
+BENCHMARK(BM_ImpairedBandwidth)
+	->Arg(4000)
+	->Arg(1600)
+	->Arg(1000)
+	->Iterations(1)
+	->Unit(benchmark::kMillisecond)
+	->UseRealTime();
+
+// 50 ms one-way delay plus the given jitter
+static void BM_ImpairedJitter(benchmark::State &state)
+{
+	ImpairmentSettings settings;
+	settings.delayMs = 50;
+	settings.jitterMs = static_cast<uint32_t>(state.range(0));
+	RunImpaired(state, settings);
+}
+BENCHMARK(BM_ImpairedJitter)
+	->Arg(0)
+	->Arg(20)
+	->Arg(100)
+	->Iterations(1)
+	->Unit(benchmark::kMillisecond)
+	->UseRealTime();
+
+// Abrupt resets, mean one per second of connection: in-flight loss and time spent reconnecting
+static void BM_ImpairedReset(benchmark::State &state)
+{
+	ImpairmentSettings settings;
+	settings.closeEveryMs = 1000;
+	RunImpaired(state, settings);
+}
+BENCHMARK(BM_ImpairedReset)->Iterations(1)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,87 @@
+#include "obs-audio-to-websocket/shm-ring.hpp"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace obs_audio_to_websocket;
+
+namespace {
+
+std::string RingName(const char *suffix)
+{
+	return "oaws-bench-" + std::string(suffix);
+}
+
+// Typical packet sizes: 1024 frames of 16-bit stereo up to 1024 frames of 8-channel float
+void PacketSizes(benchmark::internal::Benchmark *b)
+{
+	for (int bytes : {4 * 1024, 8 * 1024, 32 * 1024}) {
+		b->Arg(bytes);
+	}
+}
+
+} // namespace
+
+// Writer cost alone: what the audio thread pays per packet
+static void BM_ShmRingWrite(benchmark::State &state)
+{
+	ShmRingWriter writer;
+	if (!writer.Create(RingName("write"), SHM_RING_DEFAULT_CAPACITY)) {
+		state.SkipWithError(writer.GetError().c_str());
+		return;
+	}
+
+	std::vector<uint8_t> packet(static_cast<size_t>(state.range(0)), 0x5a);
+	for (auto _ : state) {
+		writer.Write(ShmRecordType::AudioPacket, packet.data(), packet.size());
+	}
+
+	state.SetItemsProcessed(state.iterations());
+	state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(packet.size()));
+}
+BENCHMARK(BM_ShmRingWrite)->Apply(PacketSizes);
+
+// End-to-end: a reader thread on the other side of the ring (futex wakeups on Linux)
+static void BM_ShmRingWriteRead(benchmark::State &state)
+{
+	ShmRingWriter writer;
+	if (!writer.Create(RingName("roundtrip"), SHM_RING_DEFAULT_CAPACITY)) {
+		state.SkipWithError(writer.GetError().c_str());
+		return;
+	}
+
+	ShmRingReader reader;
+	if (!reader.Open(RingName("roundtrip"))) {
+		state.SkipWithError(reader.GetError().c_str());
+		return;
+	}
+
+	std::atomic<bool> done{false};
+	std::atomic<int64_t> received{0};
+	std::thread readerThread([&]() {
+		std::vector<uint8_t> payload;
+		ShmRecordType type;
+		while (!done.load(std::memory_order_relaxed)) {
+			if (reader.Read(payload, type, 10) == ShmRingReader::Result::Ok) {
+				received.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+	});
+
+	std::vector<uint8_t> packet(static_cast<size_t>(state.range(0)), 0x5a);
+	for (auto _ : state) {
+		writer.Write(ShmRecordType::AudioPacket, packet.data(), packet.size());
+	}
+
+	done = true;
+	readerThread.join();
+
+	state.SetItemsProcessed(state.iterations());
+	state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(packet.size()));
+	state.counters["delivered"] = benchmark::Counter(static_cast<double>(received.load()) /
+							 static_cast<double>(state.iterations()));
+	state.counters["overruns"] = static_cast<double>(reader.GetOverruns());
+}
+BENCHMARK(BM_ShmRingWriteRead)->Apply(PacketSizes)->UseRealTime();
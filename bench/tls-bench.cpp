@@ -0,0 +1,190 @@
+#include "obs-audio-to-websocket/websocketpp-client.hpp"
+#include <websocketpp/config/asio.hpp>
+#include <websocketpp/server.hpp>
+#include <benchmark/benchmark.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using namespace obs_audio_to_websocket;
+
+namespace {
+
+bool WaitFor(const std::function<bool()> &condition, int timeoutMs = 5000)
+{
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+	while (!condition()) {
+		if (std::chrono::steady_clock::now() > deadline)
+			return false;
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+	return true;
+}
+
+// Self-signed P-256 certificate for localhost/127.0.0.1, generated per run
+struct TestCertificate {
+	TestCertificate()
+	{
+		EVP_PKEY_CTX *kctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+		EVP_PKEY_keygen_init(kctx);
+		EVP_PKEY_CTX_set_ec_paramgen_curve_nid(kctx, NID_X9_62_prime256v1);
+		EVP_PKEY_keygen(kctx, &key);
+		EVP_PKEY_CTX_free(kctx);
+
+		cert = X509_new();
+		X509_set_version(cert, 2);
+		ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+		X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+		X509_gmtime_adj(X509_getm_notAfter(cert), 24 * 3600);
+		X509_set_pubkey(cert, key);
+
+		X509_NAME *name = X509_get_subject_name(cert);
+		X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char *>("localhost"),
+					   -1, -1, 0);
+		X509_set_issuer_name(cert, name);
+
+		X509V3_CTX v3;
+		X509V3_set_ctx_nodb(&v3);
+		X509V3_set_ctx(&v3, cert, cert, nullptr, nullptr, 0);
+		X509_EXTENSION *san = X509V3_EXT_conf_nid(nullptr, &v3, NID_subject_alt_name,
+							  const_cast<char *>("DNS:localhost,IP:127.0.0.1"));
+		X509_add_ext(cert, san, -1);
+		X509_EXTENSION_free(san);
+		X509_sign(cert, key, EVP_sha256());
+
+		// The client loads its trust anchors from a file, like a private CA in production
+#ifdef _WIN32
+		caFile = "oaws-bench-ca.pem";
+#else
+		caFile = "/tmp/oaws-bench-ca-" + std::to_string(getpid()) + ".pem";
+#endif
+		FILE *f = fopen(caFile.c_str(), "w");
+		if (f) {
+			PEM_write_X509(f, cert);
+			fclose(f);
+		}
+	}
+
+	~TestCertificate()
+	{
+		std::remove(caFile.c_str());
+		X509_free(cert);
+		EVP_PKEY_free(key);
+	}
+
+	EVP_PKEY *key = nullptr;
+	X509 *cert = nullptr;
+	std::string caFile;
+};
+
+// wss:// server that accepts connections and ignores their traffic
+class TlsServer {
+public:
+	explicit TlsServer(const TestCertificate &certificate)
+	{
+		m_context = std::make_shared<asio::ssl::context>(asio::ssl::context::sslv23_server);
+		m_context->set_options(asio::ssl::context::default_workarounds | asio::ssl::context::no_sslv2 |
+				       asio::ssl::context::no_sslv3);
+		SSL_CTX_use_certificate(m_context->native_handle(), certificate.cert);
+		SSL_CTX_use_PrivateKey(m_context->native_handle(), certificate.key);
+
+		m_server.clear_access_channels(websocketpp::log::alevel::all);
+		m_server.clear_error_channels(websocketpp::log::elevel::all);
+		m_server.init_asio();
+		m_server.set_reuse_addr(true);
+		m_server.set_tls_init_handler([this](websocketpp::connection_hdl) { return m_context; });
+		m_server.listen(asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+		m_server.start_accept();
+		asio::error_code ec;
+		port = m_server.get_local_endpoint(ec).port();
+		m_thread = std::thread([this]() { m_server.run(); });
+	}
+
+	~TlsServer()
+	{
+		m_server.stop();
+		m_thread.join();
+	}
+
+	uint16_t port = 0;
+
+private:
+	using server_type = websocketpp::server<websocketpp::config::asio_tls>;
+	std::shared_ptr<asio::ssl::context> m_context;
+	server_type m_server;
+	std::thread m_thread;
+};
+
+// Connects once and reports the client's own connect-to-open latency as the iteration time
+bool TimeConnect(benchmark::State &state, WebSocketPPTlsClient &client, const std::string &uri)
+{
+	client.Connect(uri);
+	if (!WaitFor([&client]() { return client.IsConnected(); })) {
+		state.SkipWithError("client did not connect");
+		return false;
+	}
+	state.SetIterationTime(client.GetLastConnectMs() / 1000.0);
+
+	// Give TLS 1.3 session tickets, sent after the handshake, time to arrive
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	client.Disconnect();
+	return true;
+}
+
+} // namespace
+
+// Fresh client per connection: full TLS handshake every time
+static void BM_TlsConnectFull(benchmark::State &state)
+{
+	TestCertificate certificate;
+	TlsServer server(certificate);
+	std::string uri = "wss://127.0.0.1:" + std::to_string(server.port) + "/";
+
+	int resumed = 0;
+	for (auto _ : state) {
+		auto client = std::make_shared<WebSocketPPTlsClient>();
+		client->SetTlsCaFile(certificate.caFile);
+		if (!TimeConnect(state, *client, uri))
+			return;
+		resumed += client->WasTlsSessionResumed() ? 1 : 0;
+	}
+	state.counters["resumed"] = benchmark::Counter(resumed, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_TlsConnectFull)->UseManualTime()->Unit(benchmark::kMillisecond);
+
+// Same client reconnecting, as after a network blip: the cached session is offered
+static void BM_TlsConnectResumed(benchmark::State &state)
+{
+	TestCertificate certificate;
+	TlsServer server(certificate);
+	std::string uri = "wss://127.0.0.1:" + std::to_string(server.port) + "/";
+
+	auto client = std::make_shared<WebSocketPPTlsClient>();
+	client->SetTlsCaFile(certificate.caFile);
+	client->Connect(uri);
+	if (!WaitFor([&client]() { return client->IsConnected(); })) {
+		state.SkipWithError("client did not connect");
+		return;
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	client->Disconnect();
+
+	int resumed = 0;
+	for (auto _ : state) {
+		if (!TimeConnect(state, *client, uri))
+			return;
+		resumed += client->WasTlsSessionResumed() ? 1 : 0;
+	}
+	state.counters["resumed"] = benchmark::Counter(resumed, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_TlsConnectResumed)->UseManualTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,213 @@
+#include "obs-audio-to-websocket/audio-packet.hpp"
+#include "obs-audio-to-websocket/native-websocket-client.hpp"
+#include "obs-audio-to-websocket/stream-socket-sink.hpp"
+#include "obs-audio-to-websocket/websocketpp-client.hpp"
+#include <websocketpp/server.hpp>
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using namespace obs_audio_to_websocket;
+
+namespace {
+
+// Packets are sent in bursts small enough to stay under the sinks' drop threshold,
+// then we wait for the receiver so every iteration measures delivered bytes.
+constexpr size_t BURST_BYTES = 256 * 1024;
+
+AudioPacketPtr MakePacket(size_t payloadBytes)
+{
+	auto packet = CreateAudioPacket(0, AudioFormat(48000, 2, 16), "bench", "bench", payloadBytes);
+	memset(packet->payload(), 0x5a, payloadBytes);
+	return packet;
+}
+
+bool WaitFor(const std::function<bool()> &condition, int timeoutMs = 5000)
+{
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+	while (!condition()) {
+		if (std::chrono::steady_clock::now() > deadline)
+			return false;
+		std::this_thread::yield();
+	}
+	return true;
+}
+
+// Accepts one connection and counts the bytes it receives
+template<typename Protocol> class RawReceiver {
+public:
+	explicit RawReceiver(const typename Protocol::endpoint &endpoint)
+		: m_acceptor(m_io, endpoint),
+		  m_socket(m_io)
+	{
+		m_acceptor.async_accept(m_socket, [this](const asio::error_code &ec) {
+			if (!ec)
+				Read();
+		});
+		m_thread = std::thread([this]() { m_io.run(); });
+	}
+
+	~RawReceiver()
+	{
+		m_io.stop();
+		m_thread.join();
+	}
+
+	typename Protocol::endpoint Endpoint() const { return m_acceptor.local_endpoint(); }
+	std::atomic<uint64_t> bytes{0};
+
+private:
+	void Read()
+	{
+		m_socket.async_read_some(asio::buffer(m_buffer), [this](const asio::error_code &ec, size_t n) {
+			if (ec)
+				return;
+			bytes.fetch_add(n, std::memory_order_relaxed);
+			Read();
+		});
+	}
+
+	asio::io_context m_io;
+	typename Protocol::acceptor m_acceptor;
+	typename Protocol::socket m_socket;
+	std::array<uint8_t, 256 * 1024> m_buffer;
+	std::thread m_thread;
+};
+
+// websocketpp server counting received payload bytes (client frames arrive masked)
+class WsReceiver {
+public:
+	WsReceiver()
+	{
+		m_server.clear_access_channels(websocketpp::log::alevel::all);
+		m_server.clear_error_channels(websocketpp::log::elevel::all);
+		m_server.init_asio();
+		m_server.set_reuse_addr(true);
+		m_server.set_message_handler([this](websocketpp::connection_hdl, server_type::message_ptr msg) {
+			bytes.fetch_add(msg->get_payload().size(), std::memory_order_relaxed);
+		});
+		m_server.listen(asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+		m_server.start_accept();
+		asio::error_code ec;
+		port = m_server.get_local_endpoint(ec).port();
+		m_thread = std::thread([this]() { m_server.run(); });
+	}
+
+	~WsReceiver()
+	{
+		m_server.stop();
+		m_thread.join();
+	}
+
+	std::atomic<uint64_t> bytes{0};
+	uint16_t port = 0;
+
+private:
+	using server_type = websocketpp::server<websocketpp::config::asio>;
+	server_type m_server;
+	std::thread m_thread;
+};
+
+template<typename Sink>
+void RunSinkBenchmark(benchmark::State &state, Sink &sink, const std::atomic<uint64_t> &received,
+		      size_t wireOverhead)
+{
+	if (!WaitFor([&sink]() { return sink.IsConnected(); })) {
+		state.SkipWithError("sink did not connect");
+		return;
+	}
+
+	size_t payloadBytes = static_cast<size_t>(state.range(0));
+	AudioPacketPtr packet = MakePacket(payloadBytes);
+	size_t perPacket = packet->data.size() + wireOverhead;
+	size_t burst = std::max<size_t>(1, BURST_BYTES / perPacket);
+
+	// Let the "start" control message and handshake traffic settle
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	uint64_t expected = received.load();
+
+	for (auto _ : state) {
+		for (size_t i = 0; i < burst; ++i) {
+			sink.SendAudioPacket(packet);
+		}
+		expected += burst * perPacket;
+		if (!WaitFor([&]() { return received.load(std::memory_order_relaxed) >= expected; })) {
+			state.SkipWithError("receiver did not get all packets");
+			break;
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(burst));
+	state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(burst * packet->data.size()));
+	state.counters["dropped"] = static_cast<double>(sink.GetDroppedPackets());
+}
+
+void PacketSizes(benchmark::internal::Benchmark *b)
+{
+	// 1024 frames: 16-bit stereo, 16-bit 8ch, float 8ch
+	for (int bytes : {4 * 1024, 16 * 1024, 32 * 1024}) {
+		b->Arg(bytes);
+	}
+}
+
+} // namespace
+
+// Baseline: websocketpp client, which masks (XORs) every payload byte
+static void BM_TransportWebSocketPP(benchmark::State &state)
+{
+	WsReceiver receiver;
+	auto sink = std::make_shared<WebSocketPPClient>();
+	sink->Connect("ws://127.0.0.1:" + std::to_string(receiver.port) + "/");
+	RunSinkBenchmark(state, *sink, receiver.bytes, 0);
+	sink->Disconnect();
+}
+BENCHMARK(BM_TransportWebSocketPP)->Apply(PacketSizes)->UseRealTime();
+
+// Same wire protocol and receiver; masking into pooled frames and coalesced vectored writes
+static void BM_TransportNativeWebSocket(benchmark::State &state)
+{
+	WsReceiver receiver;
+	auto sink = std::make_shared<NativeWebSocketClient>();
+	sink->Connect("ws://127.0.0.1:" + std::to_string(receiver.port) + "/");
+	RunSinkBenchmark(state, *sink, receiver.bytes, 0);
+	sink->Disconnect();
+}
+BENCHMARK(BM_TransportNativeWebSocket)->Apply(PacketSizes)->UseRealTime();
+
+static void BM_TransportTcp(benchmark::State &state)
+{
+	RawReceiver<asio::ip::tcp> receiver(asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+	auto sink = std::make_shared<TcpSink>();
+	sink->Connect("tcp://127.0.0.1:" + std::to_string(receiver.Endpoint().port()));
+	RunSinkBenchmark(state, *sink, receiver.bytes, STREAM_FRAME_HEADER_SIZE);
+	sink->Disconnect();
+}
+BENCHMARK(BM_TransportTcp)->Apply(PacketSizes)->UseRealTime();
+
+#if defined(ASIO_HAS_LOCAL_SOCKETS) && !defined(_WIN32)
+static void BM_TransportUnixSocket(benchmark::State &state)
+{
+	std::string path = "/tmp/oaws-bench-" + std::to_string(getpid()) + ".sock";
+	unlink(path.c_str());
+	{
+		RawReceiver<asio::local::stream_protocol> receiver{asio::local::stream_protocol::endpoint(path)};
+		auto sink = std::make_shared<UnixSocketSink>();
+		sink->Connect("unix://" + path);
+		RunSinkBenchmark(state, *sink, receiver.bytes, STREAM_FRAME_HEADER_SIZE);
+		sink->Disconnect();
+	}
+	unlink(path.c_str());
+}
+BENCHMARK(BM_TransportUnixSocket)->Apply(PacketSizes)->UseRealTime();
+#endif
@@ -46,43 +46,46 @@ set(CPACK_ARCHIVE_THREADS 0)
 
 include(CPack)
 
-find_package(libobs QUIET)
-
-if(NOT TARGET OBS::libobs)
-  find_package(LibObs REQUIRED)
-  add_library(OBS::libobs ALIAS libobs)
-
-  if(ENABLE_FRONTEND_API)
-    find_path(
-      obs-frontend-api_INCLUDE_DIR
-      NAMES obs-frontend-api.h
-      PATHS /usr/include /usr/local/include
-      PATH_SUFFIXES obs
-    )
-
-    find_library(obs-frontend-api_LIBRARY NAMES obs-frontend-api PATHS /usr/lib /usr/local/lib)
-
-    if(obs-frontend-api_LIBRARY)
-      if(NOT TARGET OBS::obs-frontend-api)
-        if(IS_ABSOLUTE "${obs-frontend-api_LIBRARY}")
-          add_library(OBS::obs-frontend-api UNKNOWN IMPORTED)
-          set_property(TARGET OBS::obs-frontend-api PROPERTY IMPORTED_LOCATION "${obs-frontend-api_LIBRARY}")
-        else()
-          add_library(OBS::obs-frontend-api INTERFACE IMPORTED)
-          set_property(TARGET OBS::obs-frontend-api PROPERTY IMPORTED_LIBNAME "${obs-frontend-api_LIBRARY}")
+# A core-only build (ENABLE_PLUGIN=OFF) for the tools and benchmarks does not need libobs
+if(ENABLE_PLUGIN)
+  find_package(libobs QUIET)
+
+  if(NOT TARGET OBS::libobs)
+    find_package(LibObs REQUIRED)
+    add_library(OBS::libobs ALIAS libobs)
+
+    if(ENABLE_FRONTEND_API)
+      find_path(
+        obs-frontend-api_INCLUDE_DIR
+        NAMES obs-frontend-api.h
+        PATHS /usr/include /usr/local/include
+        PATH_SUFFIXES obs
+      )
+
+      find_library(obs-frontend-api_LIBRARY NAMES obs-frontend-api PATHS /usr/lib /usr/local/lib)
+
+      if(obs-frontend-api_LIBRARY)
+        if(NOT TARGET OBS::obs-frontend-api)
+          if(IS_ABSOLUTE "${obs-frontend-api_LIBRARY}")
+            add_library(OBS::obs-frontend-api UNKNOWN IMPORTED)
+            set_property(TARGET OBS::obs-frontend-api PROPERTY IMPORTED_LOCATION "${obs-frontend-api_LIBRARY}")
+          else()
+            add_library(OBS::obs-frontend-api INTERFACE IMPORTED)
+            set_property(TARGET OBS::obs-frontend-api PROPERTY IMPORTED_LIBNAME "${obs-frontend-api_LIBRARY}")
+          endif()
+
+          set_target_properties(
+            OBS::obs-frontend-api
+            PROPERTIES INTERFACE_INCLUDE_DIRECTORIES "${obs-frontend-api_INCLUDE_DIR}"
+          )
         endif()
-
-        set_target_properties(
-          OBS::obs-frontend-api
-          PROPERTIES INTERFACE_INCLUDE_DIRECTORIES "${obs-frontend-api_INCLUDE_DIR}"
-        )
       endif()
     endif()
-  endif()
 
-  macro(find_package)
-    if(NOT "${ARGV0}" STREQUAL libobs AND NOT "${ARGV0}" STREQUAL obs-frontend-api)
-      _find_package(${ARGV})
-    endif()
-  endmacro()
+    macro(find_package)
+      if(NOT "${ARGV0}" STREQUAL libobs AND NOT "${ARGV0}" STREQUAL obs-frontend-api)
+        _find_package(${ARGV})
+      endif()
+    endmacro()
+  endif()
 endif()
@@ -0,0 +1,9 @@
+#pragma once
+
+namespace obs_audio_to_websocket {
+
+// Registers the "Audio to WebSocket" audio filter. Every instance runs its own StreamPipeline fed from its
+// position in the source's filter chain, independent of the profiles in the Tools dialog.
+void RegisterAudioFilter();
+
+} // namespace obs_audio_to_websocket
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -16,6 +17,30 @@ struct AudioFormat {
 	bool isValid() const;
 };
 
+constexpr size_t MAX_FRAME_CHANNELS = 8; // OBS's maximum (7.1)
+
+// A block of audio handed to a pipeline, independent of where it was tapped: planar float, or already
+// interleaved 16-bit or float samples when OBS did the conversion
+struct AudioFrame {
+	std::array<const float *, MAX_FRAME_CHANNELS> planes{};
+	const uint8_t *interleaved = nullptr; // Used instead of planes when set
+	uint32_t bitDepth = 32;               // Of the interleaved samples: 16 (signed) or 32 (float)
+	uint32_t frames = 0;
+	uint32_t channels = 0;
+	uint32_t sampleRate = 0;
+	uint64_t timestamp = 0; // OBS audio timestamp (ns)
+	uint64_t receivedNs = 0; // SteadyNowNs() when the block reached the pipeline
+};
+
+// Interleaves planar float samples into out_ptr as little-endian 16-bit PCM (clamped and rounded) or
+// 32-bit float
+void ConvertPlanar(const AudioFrame &frame, bool to_float, uint8_t *out_ptr);
+// Averages the frame's channels, planar or interleaved, into mono
+void DownmixMono(const AudioFrame &frame, std::vector<float> &mono);
+// Splits an interleaved frame into planar float stored in samples; planar becomes a copy of frame whose
+// planes point there
+void DeinterleaveFrame(const AudioFrame &frame, std::vector<float> &samples, AudioFrame &planar);
+
 struct AudioChunk {
 	std::vector<uint8_t> data;
 	uint64_t timestamp;
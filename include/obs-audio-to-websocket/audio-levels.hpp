@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "audio-format.hpp"
+
+namespace obs_audio_to_websocket {
+
+// Per-channel levels over one metering interval, as linear amplitude (1.0 = full scale)
+struct AudioLevels {
+	uint32_t channels = 0; // 0 when nothing has been measured
+	std::array<float, MAX_FRAME_CHANNELS> peak{};
+	std::array<float, MAX_FRAME_CHANNELS> rms{};
+	std::array<float, MAX_FRAME_CHANNELS> truePeak{}; // 4x oversampled, never below peak
+	uint64_t timestamp = 0;                           // Start of the interval (OBS audio ns)
+	uint32_t frames = 0;                              // Sample frames covered
+	uint32_t sampleRate = 0;
+
+	float MaxPeak() const;
+};
+
+// dBFS, floored at -100 so silence stays a finite number
+float AmplitudeToDb(float amplitude);
+
+// Measures peak, RMS and true peak block by block and closes an interval every intervalMs of audio.
+// Single-threaded: lives on whichever thread encodes the stream.
+class LevelMeter {
+public:
+	static constexpr uint32_t DEFAULT_INTERVAL_MS = 100;
+
+	explicit LevelMeter(uint32_t intervalMs = DEFAULT_INTERVAL_MS);
+
+	// Measures one block and returns its sample peak across all channels. Returns true in completed
+	// when the block closed an interval, which GetLevels() then holds.
+	float Measure(const AudioFrame &frame, bool &completed);
+	const AudioLevels &GetLevels() const { return m_levels; }
+
+	void Reset();
+
+private:
+	// Taps per phase of the 4x polyphase true-peak interpolator
+	static constexpr size_t TRUE_PEAK_TAPS = 12;
+
+	// Copies one channel of the block into m_scratch after that channel's history
+	void LoadChannel(const AudioFrame &frame, uint32_t channel);
+	// Accumulates the channel's interval state from m_scratch; returns the block's sample peak
+	float MeasureChannel(uint32_t channel, size_t frames);
+
+	uint32_t m_intervalMs;
+	AudioLevels m_levels; // Last completed interval
+
+	// Interval in progress
+	uint32_t m_channels = 0;
+	uint32_t m_sampleRate = 0;
+	uint64_t m_intervalStart = 0;
+	uint32_t m_intervalFrames = 0;
+	std::array<float, MAX_FRAME_CHANNELS> m_peak{};
+	std::array<double, MAX_FRAME_CHANNELS> m_sumSquares{};
+	std::array<float, MAX_FRAME_CHANNELS> m_truePeak{};
+
+	// Last TRUE_PEAK_TAPS - 1 samples of each channel, so the interpolator runs across block boundaries
+	std::array<std::array<float, TRUE_PEAK_TAPS - 1>, MAX_FRAME_CHANNELS> m_history{};
+	std::vector<float> m_scratch;
+};
+
+// Latest levels, written by one thread and read by any number of others without locks: a sequence
+// counter around relaxed atomic fields, retried by readers that overlap a write.
+class LevelSnapshot {
+public:
+	void Publish(const AudioLevels &levels);
+	AudioLevels Read() const;
+
+private:
+	std::atomic<uint32_t> m_sequence{0};
+	std::atomic<uint32_t> m_channels{0};
+	std::atomic<uint32_t> m_frames{0};
+	std::atomic<uint32_t> m_sampleRate{0};
+	std::atomic<uint64_t> m_timestamp{0};
+	std::array<std::atomic<float>, MAX_FRAME_CHANNELS> m_peak{};
+	std::array<std::atomic<float>, MAX_FRAME_CHANNELS> m_rms{};
+	std::array<std::atomic<float>, MAX_FRAME_CHANNELS> m_truePeak{};
+};
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "audio-format.hpp"
+
+namespace obs_audio_to_websocket {
+
+// Header: timestamp(8) + sampleRate(4) + channels(4) + bitDepth(4) + sourceIdLen(4) + sourceNameLen(4)
+constexpr size_t AUDIO_PACKET_HEADER_SIZE = 8 + 4 + 4 + 4 + 4 + 4;
+
+// A fully serialized binary audio message. Packets are encoded once per audio
+// callback and then shared read-only between every sink in the fan-out.
+struct AudioPacket {
+	std::vector<uint8_t> data; // Header + strings + payload, exactly as sent on the wire
+	size_t payloadOffset = 0;
+	uint64_t timestamp = 0;
+	uint64_t captureNs = 0; // SteadyNowNs() when its audio reached the pipeline; 0 if unknown
+	AudioFormat format;
+	std::string sourceName;
+
+	uint8_t *payload() { return data.data() + payloadOffset; }
+	const uint8_t *payload() const { return data.data() + payloadOffset; }
+	size_t payloadSize() const { return data.size() - payloadOffset; }
+};
+
+using AudioPacketPtr = std::shared_ptr<const AudioPacket>;
+
+// Allocates a packet and writes its header; the caller fills payload() in place.
+std::shared_ptr<AudioPacket> CreateAudioPacket(uint64_t timestamp, const AudioFormat &format,
+					       const std::string &sourceId, const std::string &sourceName,
+					       size_t payloadSize);
+
+// Serializes a complete chunk (header + copied payload).
+AudioPacketPtr EncodeAudioPacket(const AudioChunk &chunk);
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "audio-packet.hpp"
+#include "clock-sync.hpp"
+
+namespace obs_audio_to_websocket {
+
+struct PipelineStats;
+
+// JSON control message ({"type": ..., "timestamp": <system clock, microseconds>, ...fields}) shared by all transports
+std::string MakeControlMessage(const std::string &type, const nlohmann::json &fields = nlohmann::json::object());
+
+// A destination for encoded audio packets. Every sink in the fan-out owns its
+// own connection state, reconnect schedule and backpressure policy.
+class AudioSink {
+public:
+	using OnConnectedCallback = std::function<void()>;
+	using OnDisconnectedCallback = std::function<void()>;
+	using OnMessageCallback = std::function<void(const std::string &)>;
+	using OnErrorCallback = std::function<void(const std::string &)>;
+
+	virtual ~AudioSink() = default;
+
+	virtual bool Connect(const std::string &uri) = 0;
+	virtual void Disconnect() = 0;
+	virtual bool IsConnected() const = 0;
+
+	// Must never block the audio thread; drop instead
+	virtual void SendAudioPacket(const AudioPacketPtr &packet) = 0;
+	// Sends an already serialized JSON control message
+	virtual void SendControlText(const std::string &payload) = 0;
+	void SendControlMessage(const std::string &type) { SendControlText(MakeControlMessage(type)); }
+
+	virtual bool IsReconnecting() const { return false; }
+	virtual int GetReconnectAttempts() const { return 0; }
+	virtual uint64_t GetDroppedPackets() const { return 0; }
+	// DSCP code point (0-63) for outgoing traffic; 0 leaves the OS default. Ignored by sinks without IP sockets.
+	virtual void SetDscp(int dscp) { (void)dscp; }
+
+	const std::string &GetUri() const { return m_uri; }
+	// Bytes that were already buffered when the last packet was queued (0 for sinks that don't queue)
+	size_t GetQueuedBytes() const { return m_queuedBytes.load(std::memory_order_relaxed); }
+	// Offset to the consumer's clock, from clock_sync exchanges over this sink's control channel
+	ClockSync &GetClockSync() { return m_clockSync; }
+	const ClockSync &GetClockSync() const { return m_clockSync; }
+
+	// Per-stream counters the sink reports sends, drops and queueing into. Set before Connect; optional.
+	void SetStats(std::shared_ptr<PipelineStats> stats) { m_stats = std::move(stats); }
+
+	void SetOnConnected(OnConnectedCallback cb) { m_onConnected = cb; }
+	void SetOnDisconnected(OnDisconnectedCallback cb) { m_onDisconnected = cb; }
+	void SetOnMessage(OnMessageCallback cb) { m_onMessage = cb; }
+	void SetOnError(OnErrorCallback cb) { m_onError = cb; }
+
+protected:
+	// A packet went out to the OS (or a library that owns the write from here); captureNs is its
+	// AudioPacket::captureNs
+	void RecordSent(uint64_t captureNs, size_t bytes);
+	void RecordDropped();
+	// Bytes already buffered when a packet is queued
+	void RecordQueuedBytes(size_t bytes);
+	// For the reconnecting transports: losing an established connection is a disconnect, a failed attempt an
+	// error. Failed retries are only logged, so a flapping endpoint doesn't flood the error callback.
+	void ReportConnectionLost(bool wasConnected, bool retrying, const std::string &what, const std::string &reason);
+
+	std::string m_uri;
+	std::shared_ptr<PipelineStats> m_stats;
+	ClockSync m_clockSync;
+	std::atomic<size_t> m_queuedBytes{0};
+
+	OnConnectedCallback m_onConnected;
+	OnDisconnectedCallback m_onDisconnected;
+	OnMessageCallback m_onMessage;
+	OnErrorCallback m_onError;
+};
+
+// Transport choices the URI alone doesn't express
+struct SinkOptions {
+	bool nativeWebSocket = false; // ws:// through NativeWebSocketClient instead of websocketpp
+};
+
+// Creates the sink matching the URI scheme (ws://, wss://, shm://, tcp://, unix://, rtp://). Returns nullptr for unknown schemes.
+std::shared_ptr<AudioSink> CreateAudioSink(const std::string &uri, const SinkOptions &options = SinkOptions());
+
+// True if CreateAudioSink understands the URI's scheme
+bool IsSupportedSinkUri(const std::string &uri);
+
+} // namespace obs_audio_to_websocket
@@ -4,13 +4,19 @@
 #include <memory>
 #include <atomic>
 #include <mutex>
-#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
 #include <obs.h>
 #include <obs-module.h>
 #include <obs-frontend-api.h>
-#include "websocketpp-client.hpp"
+#include "audio-sink.hpp"
+#include "websocketpp-server.hpp"
+#include "metrics-server.hpp"
+#include "constants.hpp"
 #include "audio-format.hpp"
-#include "obs-source-wrapper.hpp"
+#include "stream-pipeline.hpp"
+#include "stream-profile.hpp"
 
 namespace obs_audio_to_websocket {
 
@@ -20,44 +26,63 @@ class AudioStreamer : public QObject {
 	Q_OBJECT
 
 public:
+	using PipelineList = std::vector<std::shared_ptr<StreamPipeline>>;
+
 	static AudioStreamer &Instance();
 
+	// Starts every enabled stream profile, plus the embedded server when enabled
 	void Start();
 	void Stop();
 	bool IsStreaming() const { return m_streaming.load(); }
 
-	void SetWebSocketUrl(const std::string &url)
-	{
-		std::lock_guard<std::mutex> lock(m_urlMutex);
-		m_wsUrl = url;
-	}
-	std::string GetWebSocketUrl() const
-	{
-		std::lock_guard<std::mutex> lock(m_urlMutex);
-		return m_wsUrl;
-	}
-
-	void SetAudioSource(const std::string &sourceName);
-	std::string GetAudioSource() const { return m_audioSourceName; }
+	// Edits take effect the next time streaming starts
+	std::vector<StreamProfile> GetProfiles() const;
+	void SetProfiles(std::vector<StreamProfile> profiles);
 
 	void SetAutoConnectEnabled(bool enabled) { m_autoConnectEnabled.store(enabled); }
 	bool IsAutoConnectEnabled() const { return m_autoConnectEnabled.load(); }
 
+	// Embedded server mode: consumers connect to OBS and pull audio from every profile
+	void SetServerEnabled(bool enabled) { m_serverEnabled.store(enabled); }
+	bool IsServerEnabled() const { return m_serverEnabled.load(); }
+	void SetServerPort(int port) { m_serverPort.store(port); }
+	int GetServerPort() const { return m_serverPort.load(); }
+	// Called from the metrics thread too
+	size_t GetSubscriberCount() const;
+
+	// DSCP code point for outgoing traffic, also used by filter pipelines
+	int GetDscp() const { return m_dscp.load(); }
+	// Share of each block's duration a pipeline may spend on it before shedding optional work (0 = no
+	// watchdog), also used by filter pipelines
+	double GetCpuBudget() const { return m_cpuBudget.load(); }
+	// Whether endpoints may drive tracing with control messages, also used by filter pipelines
+	bool GetRemoteTraceControl() const { return m_remoteTraceControl.load(); }
+
 	void ShowSettings();
 	void LoadSettings();
 
-	double GetDataRate() const { return m_dataRate.load(); }
-	bool IsConnected() const { return m_wsClient && m_wsClient->IsConnected(); }
-	std::shared_ptr<WebSocketPPClient> GetWebSocketClient() const { return m_wsClient; }
+	// Sum over all running pipelines
+	double GetDataRate() const;
+	bool IsConnected() const;
+	std::shared_ptr<const PipelineList> GetPipelines() const { return std::atomic_load(&m_pipelines); }
 
-	void ConnectToWebSocket();
-	void DisconnectFromWebSocket();
+	// Filter pipelines are scraped alongside the dialog's, labeled "<source>/<filter>"
+	void AddFilterPipeline(const std::string &label, std::shared_ptr<StreamPipeline> pipeline);
+	void RemoveFilterPipeline(const std::shared_ptr<StreamPipeline> &pipeline);
+
+	// Prometheus scrape of every running pipeline, served by the metrics endpoint
+	std::string RenderMetrics() const;
+	// Stops streaming and releases everything bound to the network pool: the embedded server, the metrics
+	// endpoint and leftover filter pipelines. Must happen before the pool is stopped at unload.
+	void Shutdown();
 
 signals:
 	void connectionStatusChanged(bool connected);
 	void streamingStatusChanged(bool streaming);
 	void dataRateChanged(double kbps);
 	void errorOccurred(const QString &error);
+	// A stream's CPU watchdog shed another stage of optional work, or restored one
+	void cpuLoadChanged(const QString &stream, const QString &stage, bool degraded);
 
 private:
 	AudioStreamer();
@@ -65,39 +90,31 @@ private:
 	AudioStreamer(const AudioStreamer &) = delete;
 	AudioStreamer &operator=(const AudioStreamer &) = delete;
 
-	static void AudioCaptureCallback(void *param, obs_source_t *source, const struct audio_data *audio_data,
-					 bool muted);
-
-	void ProcessAudioData(obs_source_t *source, const struct audio_data *audio_data, bool muted);
-	void AttachAudioSource();
-	void DetachAudioSource();
-
-	void OnWebSocketConnected();
-	void OnWebSocketDisconnected();
-	void OnWebSocketMessage(const std::string &message);
-	void OnWebSocketError(const std::string &error);
-
-	void UpdateDataRate(size_t bytes);
-
-	std::shared_ptr<WebSocketPPClient> m_wsClient;
+	void StartPipelines();
+	void StopPipelines();
+	void StartServer();
+	void StopServer();
+	void OnPipelineFailed(const std::weak_ptr<StreamPipeline> &pipeline);
+
+	// Replaced wholesale on start/stop; readers only ever see a snapshot
+	std::shared_ptr<const PipelineList> m_pipelines;
+	// Created and replaced on the UI thread only; other threads read a snapshot with atomic_load
+	std::shared_ptr<WebSocketPPServer> m_server;
+	std::shared_ptr<MetricsServer> m_metrics;
+	std::vector<std::pair<std::string, std::shared_ptr<StreamPipeline>>> m_filterPipelines;
+	mutable std::mutex m_filterPipelinesMutex;
 	std::unique_ptr<SettingsDialog> m_settingsDialog;
 
-	OBSSourceWrapper m_audioSource;
-	std::string m_audioSourceName;
-	std::string m_wsUrl = "ws://localhost:8889/audio";
+	std::vector<StreamProfile> m_profiles;
+	mutable std::mutex m_profilesMutex;
 
 	std::atomic<bool> m_streaming{false};
-	std::atomic<bool> m_shuttingDown{false};
 	std::atomic<bool> m_autoConnectEnabled{false};
-	std::atomic<double> m_dataRate{0.0};
-
-	std::recursive_mutex m_sourceMutex;
-	mutable std::mutex m_urlMutex;
-
-	// Data rate calculation
-	std::chrono::steady_clock::time_point m_lastRateUpdate;
-	size_t m_bytesSinceLastUpdate = 0;
-	std::mutex m_rateMutex;
+	std::atomic<bool> m_serverEnabled{false};
+	std::atomic<int> m_serverPort{constants::DEFAULT_SERVER_PORT};
+	std::atomic<int> m_dscp{0};
+	std::atomic<double> m_cpuBudget{constants::DEFAULT_CPU_BUDGET_PERCENT / 100.0};
+	std::atomic<bool> m_remoteTraceControl{false};
 };
 
 } // namespace obs_audio_to_websocket
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace obs_audio_to_websocket {
+
+// What the controller sees of the link at each evaluation
+struct LinkSignals {
+	uint64_t queuedBytes = 0;    // Largest backlog buffered in any connected sink
+	uint64_t bytesPerSecond = 0; // The current rung's encoded rate, to turn the backlog into time
+	uint64_t newDrops = 0;       // Packets dropped since the previous evaluation
+	int64_t rttGrowthNs = 0;     // Latest clock sync round trip minus the shortest one (largest over sinks)
+};
+
+struct BitrateControllerSettings {
+	uint32_t congestedBacklogMs = 250; // A backlog this deep is congestion
+	uint32_t clearBacklogMs = 40;      // Below this (and nothing else wrong) the link is keeping up
+	uint32_t growthEvaluations = 3;    // A backlog growing this many evaluations in a row is congestion too
+	uint32_t rttGrowthMs = 150;        // Queueing delay on top of the base round trip that counts as congestion
+	uint32_t stepDownHoldMs = 2000;    // After a switch, give the backlog time to drain before stepping again
+	uint32_t stepUpAfterMs = 10000;    // Clear time before probing the next better rung
+	uint32_t maxStepUpAfterMs = 120000;
+};
+
+// Picks a rung of a format ladder (0 = best) from link congestion signals, with hysteresis: any sign of
+// congestion steps down at once (then holds while the backlog drains), but stepping up takes a long clear
+// stretch. A step up that congests again soon doubles the clear time needed for the next probe, so a link
+// that sits just below a rung's rate doesn't flap.
+//
+// Not thread-safe; the pipeline updates it from the thread that encodes.
+class BitrateController {
+public:
+	enum class Reason {
+		None,
+		Drops,     // Sinks dropped packets
+		Backlog,   // Sink buffers deep or growing
+		Latency,   // Round trip grew
+		Recovered, // Link clear long enough to try a better rung
+	};
+
+	explicit BitrateController(size_t rungs, BitrateControllerSettings settings = BitrateControllerSettings());
+
+	// Evaluates one interval; nowNs is any monotonic clock. Returns true if the rung changed.
+	bool Update(const LinkSignals &signals, uint64_t nowNs);
+	// Back to the best rung, forgetting history
+	void Reset();
+
+	size_t GetRung() const { return m_rung; }
+	size_t GetRungCount() const { return m_rungs; }
+	// Why the last switch happened
+	Reason GetReason() const { return m_reason; }
+
+private:
+	Reason Diagnose(const LinkSignals &signals);
+
+	const size_t m_rungs;
+	const BitrateControllerSettings m_settings;
+
+	size_t m_rung = 0;
+	Reason m_reason = Reason::None;
+	bool m_switched = false; // m_lastSwitchNs is valid
+	bool m_lastSwitchUp = false;
+	uint64_t m_lastSwitchNs = 0;
+	uint64_t m_clearSinceNs = 0; // 0 while not clear
+	uint64_t m_stepUpAfterNs = 0;
+	uint64_t m_previousQueuedBytes = 0;
+	uint32_t m_growingEvaluations = 0;
+};
+
+const char *BitrateReasonName(BitrateController::Reason reason);
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace obs_audio_to_websocket {
+
+// Stream clock: the timebase of AudioFrame::timestamp and of packet timestamps. OBS stamps audio with
+// os_gettime_ns(), which reads the same monotonic clock as std::chrono::steady_clock on the platforms OBS
+// runs on, so SteadyNowNs() is "now" on the stream clock.
+
+// NTP-style estimate of one consumer's clock relative to the stream clock. Each exchange gives four
+// timestamps: t1 request sent and t4 reply received (stream clock), t2 request received and t3 reply sent
+// (consumer clock). Of the last few samples, the one with the shortest round trip wins, since queueing
+// delay is what skews an offset and the fastest exchange has the least of it.
+//
+// Samples are added from the sink's network thread; the estimate can be read from any thread.
+class ClockSync {
+public:
+	static constexpr size_t FILTER_SIZE = 8;
+
+	// Returns false for an impossible sample (negative round trip), which is ignored
+	bool AddSample(int64_t t1, int64_t t2, int64_t t3, int64_t t4);
+	// Forgets all samples, e.g. when the sink reconnects and may have reached a different consumer
+	void Reset();
+
+	bool HasEstimate() const { return m_valid.load(std::memory_order_acquire); }
+	// Consumer clock minus stream clock
+	int64_t GetOffsetNs() const { return m_offsetNs.load(std::memory_order_relaxed); }
+	// Round trip of the sample the offset came from
+	int64_t GetRttNs() const { return m_rttNs.load(std::memory_order_relaxed); }
+	// Round trip of the latest sample, and the shortest since Reset: how far the link's queues have
+	// grown beyond its base delay (0 before the first sample)
+	int64_t GetLastRttNs() const { return m_lastRttNs.load(std::memory_order_relaxed); }
+	int64_t GetMinRttNs() const { return m_minRttNs.load(std::memory_order_relaxed); }
+
+	int64_t ToStreamClock(int64_t consumerNs) const { return consumerNs - GetOffsetNs(); }
+
+private:
+	struct Sample {
+		int64_t offsetNs = 0;
+		int64_t rttNs = 0;
+	};
+
+	// Network thread only
+	std::array<Sample, FILTER_SIZE> m_samples{};
+	size_t m_count = 0;
+	size_t m_next = 0;
+
+	std::atomic<int64_t> m_offsetNs{0};
+	std::atomic<int64_t> m_rttNs{0};
+	std::atomic<int64_t> m_lastRttNs{0};
+	std::atomic<int64_t> m_minRttNs{0};
+	std::atomic<bool> m_valid{false};
+};
+
+} // namespace obs_audio_to_websocket
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 namespace obs_audio_to_websocket {
 namespace constants {
 
@@ -8,5 +10,36 @@ constexpr int MAX_RECONNECT_ATTEMPTS = 10;
 constexpr int INITIAL_RECONNECT_DELAY_MS = 1000; // 1 second
 constexpr int MAX_RECONNECT_DELAY_MS = 30000;    // 30 seconds
 
+// Per-sink send buffer limit before audio packets are dropped (~2.7 s of 48 kHz stereo 16-bit)
+constexpr size_t MAX_SEND_BUFFERED_BYTES = 512 * 1024;
+
+// Clock sync exchange with each connected consumer (NTP-style, over the control channel)
+constexpr int CLOCK_SYNC_INTERVAL_MS = 5000;
+// Adaptive profiles sync more often, since the round trip is one of the congestion signals
+constexpr int ADAPTIVE_CLOCK_SYNC_INTERVAL_MS = 1000;
+// How often an adaptive profile re-evaluates its link
+constexpr int ADAPTIVE_EVALUATE_INTERVAL_MS = 500;
+
+// Share of a block's duration (in percent) its processing may take before the pipeline sheds optional work
+constexpr int DEFAULT_CPU_BUDGET_PERCENT = 10;
+
+// Blocks a pipeline can have waiting for its encoder lane (~680 ms of 1024-frame blocks at 48 kHz) before
+// it drops new ones, and the samples each slot holds before it first has to grow (a stereo OBS block)
+constexpr size_t ENCODER_RING_BLOCKS = 32;
+constexpr size_t ENCODER_RING_SLOT_SAMPLES = 1024 * 2;
+
+// Kernel send buffer for WebSocket client sockets
+constexpr int SOCKET_SEND_BUFFER_BYTES = 256 * 1024;
+
+// Embedded server mode
+constexpr int DEFAULT_SERVER_PORT = 8890;
+constexpr size_t SERVER_MAX_SUBSCRIBER_BUFFERED_BYTES = 256 * 1024;
+constexpr int SERVER_SLOW_CONSUMER_EVICT_MS = 5000; // Evict subscribers that stay backed up this long
+constexpr int SERVER_CLOSE_TIMEOUT_MS = 2000;       // Stop() waits this long for close handshakes
+
+// Traces requested by endpoints ("get_trace"): newest events per thread, and the size of each reply part
+constexpr size_t REMOTE_TRACE_EVENTS_PER_THREAD = 4096;
+constexpr size_t REMOTE_TRACE_PART_BYTES = 256 * 1024;
+
 } // namespace constants
 } // namespace obs_audio_to_websocket
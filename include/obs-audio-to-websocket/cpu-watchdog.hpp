@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace obs_audio_to_websocket {
+
+// Optional work a pipeline gives up when its blocks overrun their CPU budget, cheapest loss first. Each
+// stage keeps the ones before it shed.
+enum class ShedStage {
+	None,
+	Metering,   // Level meter: the dialog's level bar, "levels" messages and the silence warning stop
+	Features,   // Log-mel streams extract alternate 100 ms stretches only
+	Resampling, // Lower-rate ladder rungs use linear interpolation instead of the windowed-sinc filter
+	Packets,    // Every other block is dropped unencoded
+};
+
+const char *ShedStageName(ShedStage stage);
+
+struct CpuBudgetSettings {
+	double budgetFraction = 0.10;        // Share of a block's duration its processing may take
+	uint32_t windowBlocks = 50;          // Overruns are counted per window (about 1 s of OBS's blocks)
+	uint32_t overrunsToShed = 5;         // Overruns in one window that count as sustained
+	double headroomFraction = 0.5;       // A window is clear when blocks average under this share of the budget
+	uint32_t restoreAfterMs = 10000;     // Clear time before the last shed stage is restored
+	uint32_t maxRestoreAfterMs = 120000; // Restores that overrun again soon double the wait, up to this
+};
+
+// Times each block against a budget derived from its duration and steps through the pipeline's shed stages:
+// one further per window with sustained overruns, one back after a long clear stretch.
+//
+// Not thread-safe; the pipeline records from the thread that encodes.
+class CpuWatchdog {
+public:
+	// stages: the ones that apply to the pipeline, in ShedStage order
+	explicit CpuWatchdog(std::vector<ShedStage> stages, CpuBudgetSettings settings = CpuBudgetSettings());
+
+	// One processed block: costNs of wall time for blockNs of audio. Returns true if the stage changed.
+	bool Record(uint64_t costNs, uint64_t blockNs, uint64_t nowNs);
+	void Reset();
+
+	ShedStage GetStage() const { return m_level ? m_stages[m_level - 1] : ShedStage::None; }
+	bool Sheds(ShedStage stage) const { return stage != ShedStage::None && stage <= GetStage(); }
+	const CpuBudgetSettings &GetSettings() const { return m_settings; }
+
+private:
+	void EndWindow(uint64_t nowNs);
+
+	const std::vector<ShedStage> m_stages;
+	const CpuBudgetSettings m_settings;
+
+	size_t m_level = 0; // Stages shed, from the front of m_stages
+	bool m_changed = false;
+
+	// Current window
+	uint32_t m_blocks = 0;
+	uint32_t m_overruns = 0;
+	uint64_t m_costNs = 0;
+	uint64_t m_budgetNs = 0;
+
+	uint64_t m_clearSinceNs = 0; // 0 while not clear
+	uint64_t m_restoredNs = 0;   // When the last stage was restored, 0 if it has held since
+	uint64_t m_restoreAfterNs = 0;
+};
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace obs_audio_to_websocket {
+
+class EncoderPool;
+
+// A serial lane on the encoder pool, one per stream. The lane runs its job once per Post, one run at a
+// time and never concurrently with itself, while different lanes run in parallel. The job finds its input
+// wherever the poster left it, e.g. a ring of preallocated blocks, so posting neither allocates nor locks.
+class EncoderStream {
+public:
+	~EncoderStream();
+
+	// Runs the job once more. Lock- and allocation-free, for the audio thread; a single poster at a time.
+	void Post();
+
+	// Drops pending runs and waits for a running one to finish. Posting must have stopped; must not be
+	// called from the lane's own job.
+	void Close();
+
+	// Thread CPU time spent in this lane's job, and how many runs have finished
+	uint64_t GetCpuTimeNs() const { return m_cpuNs.load(std::memory_order_relaxed); }
+	uint64_t GetJobCount() const { return m_jobs.load(std::memory_order_relaxed); }
+	size_t GetQueuedJobs() const { return m_pending.load(std::memory_order_relaxed); }
+
+private:
+	friend class EncoderPool;
+	EncoderStream(EncoderPool *pool, std::function<void()> job) : m_pool(pool), m_job(std::move(job)) {}
+
+	// Runs the job up to a handful of times; returns true if runs are still pending and the lane must be
+	// rescheduled
+	bool RunSome();
+	// The pool stopped, or was stopping, with the lane unscheduled or still queued: its pending runs will
+	// never happen, so drop them and let the next Post schedule the lane afresh
+	void Unschedule();
+
+	EncoderPool *m_pool;
+	const std::function<void()> m_job;
+
+	// Posts not run yet. Non-zero exactly while the lane sits in a worker queue or runs, so the poster
+	// that takes it from zero is the one that schedules it.
+	std::atomic<size_t> m_pending{0};
+	std::atomic<bool> m_closed{false};
+
+	// Close waits here; only the workers and Close take the mutex
+	std::mutex m_mutex;
+	std::condition_variable m_idle;
+	bool m_running = false;
+
+	std::atomic<uint64_t> m_cpuNs{0};
+	std::atomic<uint64_t> m_jobs{0};
+};
+
+// Plugin-wide encoder threads, shared by every pipeline so encoding leaves OBS's audio thread and
+// several streams can encode at once.
+//
+// Each worker has its own lock-free queue of runnable lanes. A lane posted from a worker goes to that
+// worker's queue, one posted from elsewhere (the audio thread) is spread round-robin; a worker whose queue
+// runs dry steals the oldest lane from another worker.
+class EncoderPool {
+public:
+	static EncoderPool &Instance();
+
+	// Standalone pool, e.g. for benchmarks; threads == 0 picks a size from the CPU count
+	explicit EncoderPool(size_t threads);
+	~EncoderPool();
+	EncoderPool(const EncoderPool &) = delete;
+	EncoderPool &operator=(const EncoderPool &) = delete;
+
+	// Thread count takes effect the next time the pool starts; disabling makes new pipelines encode on
+	// their capture thread
+	void Configure(size_t threads, bool enabled = true);
+	bool IsEnabled() const { return m_enabled.load(); }
+
+	// New lane running job once per Post. Starts the pool on first use. Null while the pool is stopping
+	// or already serves its maximum number of lanes; the caller then runs its work inline.
+	std::shared_ptr<EncoderStream> CreateStream(std::function<void()> job);
+
+	// Joins all threads; every lane must have been closed first
+	void Stop();
+
+	size_t GetThreadCount() const;
+
+private:
+	EncoderPool() = default;
+
+	friend class EncoderStream;
+	void Schedule(EncoderStream *lane);
+	void Enqueue(size_t index, EncoderStream *lane);
+
+	void StartLocked();
+	void WorkerLoop(size_t index);
+	EncoderStream *TakeWork(size_t index);
+
+	// Bounded multi-producer, multi-consumer queue of lanes (Vyukov's). A lane is in at most one queue
+	// at a time, so room for every lane the pool hands out means a push never fails.
+	class LaneQueue {
+	public:
+		LaneQueue();
+		bool Push(EncoderStream *lane);
+		EncoderStream *Pop();
+
+	private:
+		struct Cell {
+			std::atomic<size_t> sequence;
+			EncoderStream *lane;
+		};
+		std::unique_ptr<Cell[]> m_cells;
+		alignas(64) std::atomic<size_t> m_enqueue{0};
+		alignas(64) std::atomic<size_t> m_dequeue{0};
+	};
+
+	struct Worker {
+		LaneQueue lanes;
+		std::thread thread;
+	};
+
+	mutable std::mutex m_mutex; // Guards starting and stopping; never held while joining
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	size_t m_configuredThreads = 0;
+	std::atomic<bool> m_enabled{true};
+
+	// Read by Schedule instead of m_workers.size(), which it can't lock; zero while stopped
+	std::atomic<size_t> m_workerCount{0};
+	// Schedule calls from outside the pool in progress; Stop waits them out before tearing workers down
+	std::atomic<size_t> m_scheduling{0};
+	std::atomic<size_t> m_lanes{0};
+
+	// Idle workers wait here for m_pending to become non-zero. Posters notify without the mutex, and only
+	// when someone sleeps.
+	std::mutex m_wakeMutex;
+	std::condition_variable m_wake;
+	std::atomic<size_t> m_sleeping{0};
+	std::atomic<size_t> m_pending{0};
+	std::atomic<size_t> m_next{0};
+	std::atomic<bool> m_stopping{false};
+};
+
+// CPU time consumed by the calling thread so far
+uint64_t ThreadCpuTimeNs();
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,74 @@
+#pragma once
+
+// These macros are defined in CMakeLists.txt, don't redefine them here
+
+#include <asio.hpp>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace obs_audio_to_websocket {
+
+// Plugin-wide event loops shared by every network sink, the embedded server and the settings
+// dialog's connection test, instead of one thread (plus a reconnect thread) per client.
+//
+// Each io_context is run by exactly one thread. A client is assigned one context for its whole
+// life, so all of its handlers run on the same thread in order and need no strands or locks
+// among themselves. Threads can optionally be pinned to CPUs.
+class IoContextPool {
+public:
+	static IoContextPool &Instance();
+
+	// Takes effect the next time the pool starts. threads == 0 picks a size from the CPU count.
+	void Configure(size_t threads, bool pinThreads);
+
+	// Context for a new client, round-robin across threads. Starts the pool on first use.
+	asio::io_context &Acquire();
+
+	// Joins all threads; every client must have been disconnected and released first
+	void Stop();
+
+	size_t GetThreadCount() const;
+
+private:
+	IoContextPool() = default;
+	~IoContextPool();
+	IoContextPool(const IoContextPool &) = delete;
+	IoContextPool &operator=(const IoContextPool &) = delete;
+
+	void StartLocked();
+
+	struct Worker {
+		asio::io_context io;
+		std::unique_ptr<asio::executor_work_guard<asio::io_context::executor_type>> work;
+		std::thread thread;
+	};
+
+	mutable std::mutex m_mutex;
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	size_t m_next = 0;
+	size_t m_configuredThreads = 0;
+	bool m_pinThreads = false;
+};
+
+// Wraps an asio completion handler so it is skipped once owner has been destroyed. Clients on
+// the pool are owned by shared_ptr and their pending handlers can outlive them; a handler only
+// runs while it holds a strong reference, so the owner can't be destroyed underneath it either.
+template<typename Owner, typename Handler> auto WeakHandler(Owner *owner, Handler handler)
+{
+	return [weak = owner->weak_from_this(), handler = std::move(handler)](auto &&...args) {
+		if (auto self = weak.lock()) {
+			handler(std::forward<decltype(args)>(args)...);
+		}
+	};
+}
+
+// Runs fn on io's thread and waits for it to finish; runs it inline when already on that thread.
+// Used to tear down a client's socket state without racing its handlers. Rethrows what fn throws;
+// returns without running fn if the pool stops first.
+void RunOnContext(asio::io_context &io, const std::function<void()> &fn);
+
+} // namespace obs_audio_to_websocket
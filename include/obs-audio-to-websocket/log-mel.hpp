@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace obs_audio_to_websocket {
+
+// Log-mel feature frames, as consumed by speech models, instead of the waveform
+struct FeatureSettings {
+	uint32_t melBins = 80;
+	float windowMs = 25.0f;
+	float hopMs = 10.0f;
+	bool float16 = true; // IEEE 754 half precision on the wire; float32 otherwise
+};
+
+// Turns a mono sample stream into log-mel frames: periodic Hann window, power spectrum from a
+// power-of-two real FFT, triangular HTK mel filters from 0 Hz to Nyquist, natural log floored at 1e-10.
+// Samples are buffered across calls, so frames don't depend on how the audio was blocked.
+class LogMelExtractor {
+public:
+	LogMelExtractor(uint32_t sampleRate, const FeatureSettings &settings);
+
+	// Appends count samples and writes every frame they complete to frames (melBins floats each).
+	// Returns the number of frames; firstFrameOffset receives where the first one's window starts,
+	// in samples relative to samples[0] (negative when it began in an earlier call).
+	size_t Process(const float *samples, size_t count, std::vector<float> &frames, int64_t &firstFrameOffset);
+
+	void Reset();
+
+	uint32_t GetSampleRate() const { return m_sampleRate; }
+	uint32_t GetMelBins() const { return m_melBins; }
+	size_t GetWindowSize() const { return m_windowSize; }
+	size_t GetHopSize() const { return m_hopSize; }
+	size_t GetFftSize() const { return m_fftSize; }
+
+private:
+	void ComputeFrame(const float *window, float *out);
+	void Fft(); // In place on m_re/m_im, size m_fftSize / 2
+
+	uint32_t m_sampleRate;
+	uint32_t m_melBins;
+	size_t m_windowSize;
+	size_t m_hopSize;
+	size_t m_fftSize;
+
+	std::vector<float> m_window;  // Hann coefficients
+	std::vector<float> m_pending; // Samples not yet consumed by a full hop
+
+	// Half-size complex FFT in split (structure-of-arrays) form so the butterflies vectorize
+	std::vector<float> m_re;
+	std::vector<float> m_im;
+	std::vector<uint32_t> m_bitReverse;
+	std::vector<float> m_twiddleRe; // Per stage, concatenated
+	std::vector<float> m_twiddleIm;
+	std::vector<float> m_splitRe; // e^{-2 pi i k / N} for the real-FFT post-processing
+	std::vector<float> m_splitIm;
+	std::vector<float> m_power;
+
+	// Sparse filterbank: filter m covers bins [m_filterStart[m], m_filterStart[m] + m_filterWeights[m].size())
+	std::vector<size_t> m_filterStart;
+	std::vector<std::vector<float>> m_filterWeights;
+};
+
+// Round-to-nearest-even float -> IEEE 754 binary16
+uint16_t FloatToHalf(float value);
+
+} // namespace obs_audio_to_websocket
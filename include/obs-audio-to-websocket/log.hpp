@@ -0,0 +1,21 @@
+#pragma once
+
+// Logging for the OBS-independent core. In the plugin, blog comes from libobs. Core-only builds (the
+// command-line tools and benchmarks) define AUDIO_TO_WEBSOCKET_NO_OBS and link their own blog, with the
+// same C signature and levels as libobs's util/base.h.
+#ifdef AUDIO_TO_WEBSOCKET_NO_OBS
+extern "C" void blog(int log_level, const char *format, ...);
+
+enum {
+	LOG_ERROR = 100,
+	LOG_WARNING = 200,
+	LOG_INFO = 300,
+	LOG_DEBUG = 400,
+};
+
+// The headless blog (src/headless-log.cpp) prints messages at or below this level to stderr; default
+// LOG_WARNING
+void SetHeadlessLogLevel(int level);
+#else
+#include <util/base.h>
+#endif
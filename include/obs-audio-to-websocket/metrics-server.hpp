@@ -0,0 +1,82 @@
+#pragma once
+
+// These macros are defined in CMakeLists.txt, don't redefine them here
+
+#include <asio.hpp>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include "pipeline-stats.hpp"
+
+namespace obs_audio_to_websocket {
+
+// Builds one scrape in the Prometheus text exposition format (version 0.0.4). Samples of a family must
+// follow its Family() header without other families in between.
+class PrometheusWriter {
+public:
+	void Family(const char *name, const char *type, const char *help);
+	// labels is the inside of the braces, e.g. Label("stream", name); may be empty
+	void Sample(const char *name, const std::string &labels, double value);
+	void Sample(const char *name, const std::string &labels, uint64_t value);
+	// Cumulative buckets at the given upper bounds (ascending, in recorded units) plus +Inf, _sum and
+	// _count, all divided by scale. Costs one pass over the histogram's buckets.
+	void Histogram(const char *name, const std::string &labels, const HistogramSnapshot &histogram,
+		       const std::vector<uint64_t> &bounds, double scale);
+
+	// key="value" with the value escaped
+	static std::string Label(const char *key, const std::string &value);
+
+	const std::string &Text() const { return m_text; }
+
+private:
+	void Line(const char *name, const char *suffix, const std::string &labels, const std::string &value);
+
+	std::string m_text;
+};
+
+// Minimal HTTP/1.1 listener on the loopback interface serving GET /metrics. Scrapes are rendered on a
+// network thread from the render callback; the audio path is never involved.
+//
+// Owned by shared_ptr: the shared network thread outlives the server, and completions queued by Stop()
+// run after it may already have been released.
+class MetricsServer : public std::enable_shared_from_this<MetricsServer> {
+public:
+	using RenderCallback = std::function<std::string()>;
+
+	explicit MetricsServer(RenderCallback render);
+	~MetricsServer();
+
+	bool Start(uint16_t port);
+	void Stop();
+	bool IsRunning() const { return m_running.load(); }
+
+private:
+	struct Session {
+		explicit Session(asio::io_context &io) : socket(io), deadline(io) {}
+
+		asio::ip::tcp::socket socket;
+		asio::steady_timer deadline;
+		asio::streambuf request{8192};
+		std::string response;
+	};
+
+	void StartAccept();
+	void StartSession(const std::shared_ptr<Session> &session);
+	void OnRequest(const std::shared_ptr<Session> &session);
+	void EndSession(const std::shared_ptr<Session> &session);
+
+	asio::io_context &m_io;
+	asio::ip::tcp::acceptor m_acceptor;
+	RenderCallback m_render;
+	uint16_t m_port = 0;
+	std::atomic<bool> m_running{false};
+
+	// Touched on m_io's thread only
+	std::set<std::shared_ptr<Session>> m_sessions;
+};
+
+} // namespace obs_audio_to_websocket
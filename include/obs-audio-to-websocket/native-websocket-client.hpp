@@ -0,0 +1,124 @@
+#pragma once
+
+// These macros are defined in CMakeLists.txt, don't redefine them here
+
+#include <asio.hpp>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "audio-sink.hpp"
+#include "io-context-pool.hpp"
+#include "reconnector.hpp"
+
+namespace obs_audio_to_websocket {
+
+// Minimal RFC 6455 client for ws:// written directly on asio. Compared to websocketpp it masks
+// each payload straight into a pooled frame buffer while copying it (one pass, no intermediate
+// message), and flushes every queued frame with a single vectored async_write, so a backlog
+// drains in one syscall instead of one write per message. Only what an audio sender needs is
+// implemented: no TLS, extensions or subprotocols; incoming text messages, ping and close are handled.
+// Runs on the shared IoContextPool, so instances must be owned by a shared_ptr.
+class NativeWebSocketClient : public AudioSink, public std::enable_shared_from_this<NativeWebSocketClient> {
+public:
+	NativeWebSocketClient();
+	~NativeWebSocketClient() override;
+
+	bool Connect(const std::string &uri) override;
+	void Disconnect() override;
+	bool IsConnected() const override { return m_connected.load(); }
+
+	void SendAudioPacket(const AudioPacketPtr &packet) override;
+	void SendControlText(const std::string &payload) override;
+
+	bool IsReconnecting() const override { return m_reconnect.IsReconnecting(); }
+	int GetReconnectAttempts() const override { return m_reconnect.GetAttempts(); }
+	uint64_t GetDroppedPackets() const override { return m_droppedPackets.load(); }
+	void SetDscp(int dscp) override { m_dscp = dscp; }
+
+private:
+	enum Opcode : uint8_t {
+		Continuation = 0x0,
+		Text = 0x1,
+		Binary = 0x2,
+		Close = 0x8,
+		Ping = 0x9,
+		Pong = 0xA,
+	};
+
+	bool ParseUri(const std::string &uri);
+	void StartConnect();
+	void OnConnect(const asio::error_code &ec);
+	void StartHandshake();
+	bool ValidateHandshake(const std::string &response);
+	void StartRead();
+	bool ProcessIncoming();
+	void HandleFrame(uint8_t opcode, bool fin, std::string &&payload);
+
+	// Writes header, fresh masking key and masked payload into frame (call with m_queueMutex held)
+	void BuildFrame(std::vector<uint8_t> &frame, uint8_t opcode, const uint8_t *data, size_t length);
+	// Builds a masked frame into a pooled buffer and queues it; false if dropped for backpressure.
+	// packet is set for audio frames, whose completion is counted in the stream stats.
+	bool QueueFrame(uint8_t opcode, const uint8_t *data, size_t length, bool droppable,
+			const AudioPacket *packet = nullptr);
+	void StartWrite();
+	void HandleError(const std::string &what, const asio::error_code &ec);
+	void ScheduleReconnect();
+	// Drops queued frames; an in-flight batch stays with its handler (call with m_queueMutex held)
+	void DropQueueLocked();
+
+	asio::io_context &m_io;
+	asio::ip::tcp::socket m_socket;
+	Reconnector m_reconnect;
+	asio::steady_timer m_handshakeTimer;
+
+	std::string m_host;
+	std::string m_port;
+	std::string m_resource;
+	std::string m_hostHeader;
+	std::string m_handshakeKey;
+	std::string m_handshakeRequest;
+	asio::streambuf m_handshakeResponse;
+
+	// Frames handed to one vectored async_write. The completion handler owns the batch, so the buffers
+	// outlive a cleared queue or a destroyed client until the write completes (IOCP reads them until then).
+	struct WriteBatch {
+		std::vector<std::vector<uint8_t>> frames;
+		std::vector<std::pair<uint64_t, size_t>> sends; // See m_queueSends
+		std::vector<asio::const_buffer> buffers;
+		size_t bytes = 0;
+		uint64_t generation = 0;
+	};
+
+	// Outgoing frames; buffers cycle between m_queue, the write batch and m_freeBuffers so steady-state
+	// sends don't allocate
+	std::mutex m_queueMutex;
+	std::deque<std::vector<uint8_t>> m_queue;
+	// Parallel to m_queue: the audio packet's captureNs and size, or zero size for other frames
+	std::deque<std::pair<uint64_t, size_t>> m_queueSends;
+	std::vector<std::vector<uint8_t>> m_freeBuffers;
+	size_t m_queuedBytes = 0; // Queued and in flight
+	bool m_writing = false;
+	std::shared_ptr<WriteBatch> m_spareBatch; // Reused once the last write's handler is done with it
+	// Bumped whenever the queue is dropped; a completion from an older batch no longer owns m_writing
+	uint64_t m_writeGeneration = 0;
+	uint64_t m_maskState = 0;
+
+	// Incoming frames
+	std::vector<uint8_t> m_readBuffer;
+	std::vector<uint8_t> m_incoming;
+	std::string m_fragment;
+	uint8_t m_fragmentOpcode = 0;
+
+	std::atomic<bool> m_connected{false};
+	std::atomic<bool> m_closing{false}; // Server sent a close frame
+	std::atomic<bool> m_backpressured{false};
+	std::atomic<bool> m_running{false};
+	std::atomic<uint64_t> m_droppedPackets{0};
+	std::atomic<int> m_dscp{0};
+};
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <obs.h>
+#include "obs-source-wrapper.hpp"
+#include "stream-pipeline.hpp"
+#include "stream-profile.hpp"
+
+namespace obs_audio_to_websocket {
+
+// A profile's own OBS tap: its source's audio capture callback, or its output mix track with libobs doing
+// the resampling, remixing and sample format conversion. A mix track profile must select exactly one
+// track (see ExpandMixTracks).
+class ObsAudioInput : public AudioInput {
+public:
+	explicit ObsAudioInput(StreamProfile profile);
+	~ObsAudioInput() override;
+
+	bool Attach(StreamPipeline &pipeline, std::string &error) override;
+	void Detach() override;
+
+private:
+	static void AudioCaptureCallback(void *param, obs_source_t *source, const struct audio_data *audio_data,
+					 bool muted);
+	static void RawAudioCallback(void *param, size_t mix_idx, struct audio_data *data);
+
+	bool AttachAudioSource(std::string &error);
+	bool AttachMixTrack(std::string &error);
+
+	const StreamProfile m_profile;
+	StreamPipeline *m_pipeline = nullptr;
+
+	OBSSourceWrapper m_audioSource;
+	// Output mix being tapped and the layout OBS converts it to; m_mixIndex is -1 when not attached
+	int m_mixIndex = -1;
+	uint32_t m_mixSampleRate = 0;
+	uint32_t m_mixChannels = 0;
+	uint32_t m_mixBitDepth = 16;
+
+	bool m_formatErrorLogged = false; // Audio thread only
+};
+
+} // namespace obs_audio_to_websocket
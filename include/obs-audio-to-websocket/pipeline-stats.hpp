@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace obs_audio_to_websocket {
+
+// Log-linear histogram in the spirit of HdrHistogram: values below 32 are counted exactly, larger ones in
+// 16 linear sub-buckets per power of two, so a reported value is within 1/16 of the true one. Recording is
+// a few relaxed atomic adds and never blocks; readers take a HistogramSnapshot while writers carry on.
+class Histogram {
+public:
+	static constexpr size_t SUB_BUCKETS = 16;
+	static constexpr size_t BUCKET_COUNT = (64 - 4) * SUB_BUCKETS + SUB_BUCKETS;
+
+	void Record(uint64_t value);
+
+	static size_t BucketIndex(uint64_t value);
+	// Largest value that lands in bucket index
+	static uint64_t BucketUpperBound(size_t index);
+
+private:
+	friend class HistogramSnapshot;
+
+	std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_counts{};
+	std::atomic<uint64_t> m_count{0};
+	std::atomic<uint64_t> m_sum{0};
+	std::atomic<uint64_t> m_max{0};
+};
+
+// Plain copy of one or more histograms. Percentiles cost one pass over the buckets, however many values
+// were recorded.
+class HistogramSnapshot {
+public:
+	void Add(const Histogram &histogram);
+
+	uint64_t GetCount() const { return m_count; }
+	uint64_t GetSum() const { return m_sum; }
+	uint64_t GetMax() const { return m_max; }
+	// Upper bound of the bucket holding the given quantile (0..1), capped at the maximum; 0 when empty
+	uint64_t Percentile(double quantile) const;
+	const std::array<uint64_t, Histogram::BUCKET_COUNT> &GetCounts() const { return m_counts; }
+
+private:
+	std::array<uint64_t, Histogram::BUCKET_COUNT> m_counts{};
+	uint64_t m_count = 0;
+	uint64_t m_sum = 0;
+	uint64_t m_max = 0;
+};
+
+// One stream's health counters. Each is written from wherever the work happens (capture thread, encoder
+// lane, network threads) without locks, and read by the dialog at any time.
+struct PipelineStats {
+	Histogram callbackNs;        // PushAudio on the capture thread
+	Histogram queueWaitNs;       // Block posted -> its encode started on the encoder lane
+	Histogram encodeNs;          // Convert, serialize and hand to every sink
+	Histogram captureToSendNs;   // Block reached PushAudio -> a sink wrote its packet out, per sink
+	Histogram encoderQueueDepth; // Blocks already waiting on the lane when one is posted
+	Histogram sinkQueueBytes;    // Bytes already buffered in a sink when a packet is queued
+	// Packet timestamp -> the consumer received it, from consumer acks mapped through the clock sync
+	Histogram captureToConsumerNs;
+	Histogram clockSyncRttNs; // Round trip of each clock_sync exchange
+
+	// Summed over endpoints: a block fanned out to two sinks counts twice
+	std::atomic<uint64_t> packetsSent{0};
+	std::atomic<uint64_t> bytesSent{0};
+	std::atomic<uint64_t> packetsDropped{0};
+	// Adaptive profiles: current rung of the format ladder (0 = best) and how often it changed
+	std::atomic<uint32_t> formatRung{0};
+	std::atomic<uint64_t> formatSwitches{0};
+	// CPU budget watchdog: blocks that took longer than their budget, the ShedStage in effect and blocks
+	// dropped unprocessed, by the last stage or because the encoder lane was a full ring behind
+	std::atomic<uint64_t> budgetOverruns{0};
+	std::atomic<uint32_t> shedStage{0};
+	std::atomic<uint64_t> blocksShed{0};
+};
+
+// Steady clock, in nanoseconds, for the latency histograms
+uint64_t SteadyNowNs();
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,68 @@
+#pragma once
+
+// These macros are defined in CMakeLists.txt, don't redefine them here
+
+#include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include "io-context-pool.hpp"
+
+namespace obs_audio_to_websocket {
+
+// Reconnect schedule shared by the client transports: exponential backoff from INITIAL_RECONNECT_DELAY_MS up to
+// MAX_RECONNECT_DELAY_MS, giving up after MAX_RECONNECT_ATTEMPTS failed attempts in a row.
+//
+// Schedule, Cancel and the retry run on the owner's network thread. IsReconnecting and GetAttempts can be read
+// from any thread.
+class Reconnector {
+public:
+	static constexpr const char *GAVE_UP_ERROR = "Connection lost: Max reconnection attempts exceeded";
+
+	explicit Reconnector(asio::io_context &io) : m_timer(io) {}
+
+	// Full budget again: on Connect() and once an attempt succeeds
+	void Reset();
+
+	// Arms the timer for the next attempt, which calls retry while owner is alive. A retry already pending
+	// absorbs the call, since a read and a write (or a timeout) can report the same broken connection.
+	// Returns false once the attempts are used up; the owner then reports GAVE_UP_ERROR.
+	template<typename Owner, typename Retry> bool Schedule(Owner *owner, const std::string &uri, Retry retry)
+	{
+		int delayMs = 0;
+		if (!Next(uri, delayMs))
+			return false;
+		if (delayMs < 0)
+			return true;
+
+		m_timer.expires_after(std::chrono::milliseconds(delayMs));
+		m_timer.async_wait(WeakHandler(owner, [this, retry = std::move(retry)](const asio::error_code &ec) {
+			// Cancelled by Cancel(), which cleared the flag itself
+			if (ec)
+				return;
+			m_pending = false;
+			retry();
+		}));
+		return true;
+	}
+
+	// Drops a pending retry (Disconnect)
+	void Cancel();
+
+	bool IsReconnecting() const { return m_reconnecting.load(); }
+	int GetAttempts() const { return m_attempts.load(); }
+
+	// Backoff before the given attempt (1-based)
+	static int DelayMs(int attempt);
+
+private:
+	// Counts the attempt and logs it; delayMs < 0 when one is already pending
+	bool Next(const std::string &uri, int &delayMs);
+
+	asio::steady_timer m_timer;
+	bool m_pending = false; // Network thread only; the timer's expiry can't tell, since cancel() keeps it
+	std::atomic<bool> m_reconnecting{false};
+	std::atomic<int> m_attempts{0};
+};
+
+} // namespace obs_audio_to_websocket
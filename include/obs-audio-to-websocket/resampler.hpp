@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "audio-format.hpp"
+
+namespace obs_audio_to_websocket {
+
+// Sample rate conversion of planar float audio, for formats below the rate OBS captures at. Each channel's
+// tail is kept across calls, so output doesn't depend on how the input was blocked.
+class Resampler {
+public:
+	enum class Quality {
+		High,   // Windowed-sinc low-pass interpolation; anti-aliased, ~8 zero crossings per side
+		Linear, // Two-tap interpolation; aliases, but costs a fraction of High
+	};
+
+	Resampler(uint32_t inputRate, uint32_t outputRate, uint32_t channels, Quality quality = Quality::High);
+
+	// Converts one planar block of GetChannels() channels at the input rate into out (one vector per
+	// channel). Returns the number of output frames; firstFrameOffsetNs receives the time of the first
+	// one relative to the block's first sample (negative when it falls in an earlier block). The output
+	// trails the input by the filter's half length, so it has a matching delay.
+	size_t Process(const AudioFrame &frame, std::vector<std::vector<float>> &out, int64_t &firstFrameOffsetNs);
+
+	void Reset();
+
+	uint32_t GetInputRate() const { return m_inputRate; }
+	uint32_t GetOutputRate() const { return m_outputRate; }
+	uint32_t GetChannels() const { return m_channels; }
+	Quality GetQuality() const { return m_quality; }
+
+private:
+	static constexpr size_t PHASES = 256;
+
+	uint32_t m_inputRate;
+	uint32_t m_outputRate;
+	uint32_t m_channels;
+	Quality m_quality;
+
+	size_t m_halfTaps;           // Input samples each side of an output's position
+	std::vector<float> m_kernel; // (PHASES + 1) rows of 2 * m_halfTaps coefficients
+
+	std::vector<std::vector<float>> m_pending; // Per channel: unconsumed input, starting with filter history
+	// Position of the next output in m_pending: whole samples plus a fraction m_fraction / m_outputRate
+	size_t m_position = 0;
+	uint64_t m_fraction = 0;
+};
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,100 @@
+#pragma once
+
+// These macros are defined in CMakeLists.txt, don't redefine them here
+
+#include <asio.hpp>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "audio-sink.hpp"
+
+namespace obs_audio_to_websocket {
+
+// rtp://host:port[?pt=96&fec=5&mtu=1200] - RTP over UDP (RFC 3550) with an L16
+// payload (RFC 3551, big-endian PCM). Packets are sent straight from the audio
+// thread on a non-blocking socket: late or lost audio is dropped, never queued.
+// The host is resolved on a shared network thread, so Connect() doesn't block.
+//
+// With fec=N, every N media packets are followed by one parity packet on a
+// separate SSRC with payload type pt+1 (see README for the layout).
+class RtpSink : public AudioSink, public std::enable_shared_from_this<RtpSink> {
+public:
+	using OnDescriptionCallback = std::function<void(const std::string &sdp)>;
+
+	RtpSink();
+	~RtpSink() override;
+
+	bool Connect(const std::string &uri) override;
+	void Disconnect() override;
+	bool IsConnected() const override { return m_connected.load(); }
+
+	void SendAudioPacket(const AudioPacketPtr &packet) override;
+	// RTP has no in-band control channel; the SDP travels over the other sinks instead
+	void SendControlText(const std::string &payload) override { (void)payload; }
+
+	uint64_t GetDroppedPackets() const override { return m_droppedPackets.load(); }
+
+	// SDP for the current stream format; empty until the first packet has been sent
+	std::string GetSdp() const;
+	// Called whenever the SDP changes (first packet, format change)
+	void SetOnDescription(OnDescriptionCallback cb) { m_onDescription = cb; }
+
+private:
+	bool ParseUri(const std::string &uri);
+	void OnResolved(const asio::error_code &ec, const asio::ip::udp::resolver::results_type &results);
+	void UpdateDescription(uint32_t sampleRate, uint32_t channels, size_t framesPerPacket);
+	void SendRtp(uint8_t payloadType, uint16_t seq, uint32_t timestamp, uint32_t ssrc, bool marker,
+		     const uint8_t *payload, size_t length);
+	void AddToFec(uint16_t seq, uint32_t timestamp, bool marker, const uint8_t *payload, size_t length);
+
+	asio::io_context &m_io;
+	// Held while the socket is opened, used or closed: sends run on the audio thread, the rest on the
+	// caller's and the network thread
+	std::mutex m_socketMutex;
+	asio::ip::udp::socket m_socket;
+
+	std::string m_host;
+	std::string m_port;
+	uint8_t m_payloadType = 96;
+	int m_fecGroup = 0;
+	size_t m_mtu = 1200;
+
+	// Send state, touched by the audio thread (and reset on connect) under m_socketMutex
+	uint16_t m_seq = 0;
+	uint32_t m_ssrc = 0;
+	uint32_t m_nextTimestamp = 0; // RTP timestamp of the next frame; advances by frame count
+	uint64_t m_nextPacketNs = 0;  // OBS timestamp the next packet should carry if no audio went missing
+	bool m_haveNextPacketNs = false;
+	bool m_marker = true;
+	uint32_t m_sampleRate = 0;
+	uint32_t m_channels = 0;
+	size_t m_framesPerPacket = 0;
+	std::vector<uint8_t> m_payload;
+	std::vector<uint8_t> m_datagram;
+
+	// XOR parity over the current FEC group, and the parity packet built from it
+	std::vector<uint8_t> m_fecPayload;
+	std::vector<uint8_t> m_fecPacket;
+	uint16_t m_fecBaseSeq = 0;
+	uint8_t m_fecCount = 0;
+	uint8_t m_fecHeaderXor = 0;
+	uint32_t m_fecTimestampXor = 0;
+	uint16_t m_fecLengthXor = 0;
+	uint16_t m_fecSeq = 0;
+	uint32_t m_fecSsrc = 0;
+
+	mutable std::mutex m_sdpMutex;
+	std::string m_sdp;
+	OnDescriptionCallback m_onDescription;
+
+	std::atomic<bool> m_running{false}; // Between Connect() and Disconnect()
+	std::atomic<bool> m_connected{false};
+	std::atomic<uint64_t> m_droppedPackets{0};
+	bool m_formatErrorLogged = false;
+};
+
+} // namespace obs_audio_to_websocket
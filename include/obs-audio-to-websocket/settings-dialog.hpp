@@ -2,9 +2,12 @@
 
 #include <QDialog>
 #include <QTimer>
+#include <array>
 #include <memory>
 #include <chrono>
+#include <vector>
 #include <obs.h>
+#include "stream-profile.hpp"
 
 QT_BEGIN_NAMESPACE
 class QLineEdit;
@@ -13,11 +16,13 @@ class QComboBox;
 class QLabel;
 class QProgressBar;
 class QCheckBox;
+class QSpinBox;
 QT_END_NAMESPACE
 
 namespace obs_audio_to_websocket {
 
 class AudioStreamer;
+class StreamPipeline;
 
 class SettingsDialog : public QDialog {
 	Q_OBJECT
@@ -27,11 +32,27 @@ public:
 	~SettingsDialog();
 
 private slots:
+	void onProfileSelected(int index);
+	void onAddProfile();
+	void onRemoveProfile();
+	void onProfileEnabledToggled(bool enabled);
+	void onFormatChanged(int index);
+	void onCaptureModeChanged(int index);
+	void onTrackToggled();
+	void onSampleRateChanged(int index);
+	void onChannelsChanged(int index);
 	void onStartStopToggled();
 	void onTestConnection();
 	void onAudioSourceChanged(const QString &source);
 	void onUrlChanged(const QString &url);
 	void onAutoConnectToggled(bool enabled);
+	void onServerModeToggled(bool enabled);
+	void onServerPortChanged(int port);
+	void onNativeWebSocketToggled(bool enabled);
+	void onSendLevelsToggled(bool enabled);
+	void onAdaptiveToggled(bool enabled);
+	void onRecordTraceToggled(bool enabled);
+	void onSaveTrace();
 
 	void updateConnectionStatus(bool connected);
 	void updateStreamingStatus(bool streaming);
@@ -50,34 +71,63 @@ private:
 	void connectSignals();
 	void loadSettings();
 	bool saveSettings();
+	// Shows profile index in the per-profile widgets without feeding the edits back
+	void showProfile(int index);
+	// Pushes m_profiles to the streamer and saves them
+	void applyProfiles();
+	bool hasStreamableProfile() const;
+	// Enables the source or track widgets to match the current profile's capture mode
+	void updateCaptureControls();
 	void selectDefaultMicrophoneSource();
 
-	static void volumeCallback(void *data, const float magnitude[MAX_AUDIO_CHANNELS],
-				   const float peak[MAX_AUDIO_CHANNELS], const float inputPeak[MAX_AUDIO_CHANNELS]);
-
-	void cleanupVolumeMeter();
+	// Running pipelines of the current profile: one, or one per output track
+	std::vector<std::shared_ptr<StreamPipeline>> currentPipelines() const;
+	// Level bar and its per-channel tooltip, from the current profile's running pipelines
+	void updateLevels();
+	// Latency percentiles and counters for the stats section
+	void updateStats();
 
 	// UI Elements
+	QComboBox *m_profileCombo;
+	QPushButton *m_addProfileButton;
+	QPushButton *m_removeProfileButton;
+	QCheckBox *m_profileEnabledCheckBox;
 	QLineEdit *m_urlEdit;
 	QPushButton *m_testButton;
 	QCheckBox *m_autoConnectCheckBox;
+	QCheckBox *m_serverCheckBox;
+	QSpinBox *m_serverPortSpin;
+	QCheckBox *m_nativeWebSocketCheckBox;
+	QCheckBox *m_sendLevelsCheckBox;
+	QCheckBox *m_adaptiveCheckBox;
+	QComboBox *m_captureCombo;
 	QComboBox *m_audioSourceCombo;
 	QPushButton *m_refreshButton;
+	std::array<QCheckBox *, MAX_MIX_TRACKS> m_trackCheckBoxes;
+	QComboBox *m_formatCombo;
+	QComboBox *m_sampleRateCombo;
+	QComboBox *m_channelsCombo;
 	QPushButton *m_startStopButton;
 	QProgressBar *m_audioLevelBar;
 	QLabel *m_statusLabel;
 	QLabel *m_dataRateLabel;
 	QLabel *m_muteStatusLabel;
+	QLabel *m_subscribersLabel;
+	QLabel *m_statsLabel;
+	QCheckBox *m_recordTraceCheckBox;
+	QPushButton *m_saveTraceButton;
 
 	// Update timer
 	std::unique_ptr<QTimer> m_updateTimer;
+	unsigned int m_statusTicks = 0;
 
 	// Reference to audio streamer
 	AudioStreamer *m_streamer;
 
-	// Volume meter
-	obs_volmeter_t *m_volmeter = nullptr;
-	float m_currentPeak = -60.0f;
+	// Working copy of the stream profiles; the widgets above edit m_profiles[m_currentProfile]
+	std::vector<StreamProfile> m_profiles;
+	int m_currentProfile = 0;
+	bool m_loadingProfile = false;
 
 	// Error dialog rate limiting
 	std::chrono::steady_clock::time_point m_lastErrorTime;
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include "audio-sink.hpp"
+#include "shm-ring.hpp"
+
+namespace obs_audio_to_websocket {
+
+// shm://<name>[?size=<bytes>] - publishes packets into a POSIX shared-memory ring
+// for readers on the same host. No sockets, no framing, one memcpy per packet.
+class ShmRingSink : public AudioSink {
+public:
+	ShmRingSink() = default;
+	~ShmRingSink() override;
+
+	bool Connect(const std::string &uri) override;
+	void Disconnect() override;
+	bool IsConnected() const override { return m_open.load(); }
+
+	void SendAudioPacket(const AudioPacketPtr &packet) override;
+	void SendControlText(const std::string &payload) override;
+
+	uint64_t GetDroppedPackets() const override { return m_droppedPackets.load(); }
+	uint32_t GetReaderCount() const;
+
+private:
+	ShmRingWriter m_writer;
+	mutable std::mutex m_writeMutex; // Audio thread and control messages share the single writer
+	std::atomic<bool> m_open{false};
+	std::atomic<uint64_t> m_droppedPackets{0};
+};
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,164 @@
+#pragma once
+
+// Shared-memory ring buffer used by the shm:// transport. This header and
+// src/shm-ring.cpp have no OBS/Qt dependencies so that same-host consumers can
+// build the reader side on its own.
+//
+// Segment layout (all integers little-endian / native, offsets in bytes):
+//
+//   0    ShmRingHeader (256 bytes, see below)
+//   256  data area, `capacity` bytes, capacity is a power of two
+//
+// The data area is a byte ring addressed by monotonically increasing 64-bit
+// positions (offset = position & (capacity - 1)). Every record starts on an
+// 8-byte boundary with a 16-byte ShmRecordHeader followed by the payload,
+// padded to 8 bytes. A record never wraps: if it does not fit before the end
+// of the ring the writer emits a PADDING record (or, if fewer than 16 bytes
+// remain, simply skips them) and continues at offset 0.
+//
+// There is a single writer (the plugin) and any number of readers. A writer
+// never takes over a name another live writer holds: creation fails unless the
+// existing segment is closed or its writer process is gone. Readers
+// never block the writer; a reader that falls more than `capacity` bytes
+// behind is overrun and resynchronizes at the current write position.
+//
+// Publication protocol:
+//   writer: writeClaim = end of the new record  (release fence)
+//           copy record bytes
+//           writePos = end of the new record     (release)
+//           sequence += 1; notify += 1; futex-wake if readersWaiting > 0
+//   reader: pos < writePos (acquire) -> copy record -> acquire fence ->
+//           if writeClaim - pos > capacity the copy may be torn: overrun.
+//
+// On Linux readers sleep on the `notify` word with a shared futex; elsewhere
+// they poll with a short sleep.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace obs_audio_to_websocket {
+
+constexpr uint32_t SHM_RING_MAGIC = 0x53574141; // "AAWS"
+constexpr uint32_t SHM_RING_VERSION = 1;
+constexpr size_t SHM_RING_HEADER_SIZE = 256;
+constexpr size_t SHM_RING_DEFAULT_CAPACITY = 4 * 1024 * 1024;
+constexpr size_t SHM_RING_MIN_CAPACITY = 4096;
+constexpr size_t SHM_RING_MAX_CAPACITY = 256 * 1024 * 1024;
+
+enum class ShmRecordType : uint32_t {
+	AudioPacket = 0, // Binary audio message, same format as the WebSocket binary message
+	Control = 1,     // UTF-8 JSON control message
+	Padding = 2,     // Filler up to the end of the ring, skip to offset 0
+};
+
+struct ShmRecordHeader {
+	uint32_t length;   // Payload length in bytes (excluding this header and padding)
+	uint32_t type;     // ShmRecordType
+	uint64_t sequence; // Record sequence number, starts at 1
+};
+static_assert(sizeof(ShmRecordHeader) == 16, "record header must stay 16 bytes");
+
+struct ShmRingHeader {
+	// Cache line 0: immutable after creation
+	uint32_t magic;
+	uint32_t version;
+	uint32_t headerSize; // Offset of the data area
+	uint32_t flags;      // Bit 0: writer closed
+	uint64_t capacity;   // Data area size, power of two
+	uint64_t createdNs;  // Writer creation time (steady clock), lets readers detect a recreated segment
+	uint32_t writerPid;  // Process that created the segment; 0 from writers that predate the field
+	uint8_t reserved0[28];
+
+	// Cache line 1: writer-owned
+	alignas(64) std::atomic<uint64_t> writePos;   // End of the last published record
+	std::atomic<uint64_t> writeClaim;             // End of the record currently being written
+	std::atomic<uint64_t> sequence;               // Number of records published
+	uint8_t reserved1[40];
+
+	// Cache line 2: wakeup
+	alignas(64) std::atomic<uint32_t> notify;     // Incremented on every publish (futex word)
+	std::atomic<uint32_t> readersWaiting;         // Readers currently sleeping on `notify`
+	std::atomic<uint32_t> readers;                // Attached readers (advisory)
+	uint8_t reserved2[52];
+
+	uint8_t reserved3[64];
+};
+static_assert(sizeof(ShmRingHeader) == SHM_RING_HEADER_SIZE, "header layout is part of the reader ABI");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared-memory atomics must be lock-free");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared-memory atomics must be lock-free");
+
+class ShmRingWriter {
+public:
+	ShmRingWriter() = default;
+	~ShmRingWriter();
+
+	ShmRingWriter(const ShmRingWriter &) = delete;
+	ShmRingWriter &operator=(const ShmRingWriter &) = delete;
+
+	// Creates the named segment. `name` is a POSIX shm name without the leading '/'. Fails if a live
+	// writer holds the name; a segment whose writer closed it or exited is replaced.
+	bool Create(const std::string &name, size_t capacity = SHM_RING_DEFAULT_CAPACITY);
+	// Removes the name only while it still refers to this writer's segment
+	void Close();
+	bool IsOpen() const { return m_header != nullptr; }
+
+	// Publishes one record. Never blocks; returns false if the record can never fit.
+	bool Write(ShmRecordType type, const void *data, size_t length);
+
+	uint32_t GetReaderCount() const;
+	const std::string &GetError() const { return m_error; }
+
+private:
+	std::string m_name;
+	std::string m_error;
+	ShmRingHeader *m_header = nullptr;
+	uint8_t *m_data = nullptr;
+	size_t m_mappedSize = 0;
+	// Identity of the created segment, so Close() never unlinks a successor's
+	uint64_t m_device = 0;
+	uint64_t m_inode = 0;
+};
+
+class ShmRingReader {
+public:
+	enum class Result {
+		Ok,
+		Timeout,
+		Overrun, // Reader fell behind; `GetLostBytes` grew and reading resumed at the newest data
+		Closed,  // Writer closed the segment
+	};
+
+	ShmRingReader() = default;
+	~ShmRingReader();
+
+	ShmRingReader(const ShmRingReader &) = delete;
+	ShmRingReader &operator=(const ShmRingReader &) = delete;
+
+	// Attaches to an existing segment and starts reading at the newest record.
+	bool Open(const std::string &name);
+	void Close();
+	bool IsOpen() const { return m_header != nullptr; }
+
+	// Copies the next record into `payload`. Waits up to `timeoutMs` (0 = don't wait).
+	Result Read(std::vector<uint8_t> &payload, ShmRecordType &type, int timeoutMs);
+
+	uint64_t GetLostBytes() const { return m_lostBytes; }
+	uint64_t GetOverruns() const { return m_overruns; }
+	const std::string &GetError() const { return m_error; }
+
+private:
+	bool Wait(uint32_t observedNotify, int timeoutMs);
+
+	std::string m_error;
+	ShmRingHeader *m_header = nullptr;
+	const uint8_t *m_data = nullptr;
+	size_t m_mappedSize = 0;
+	uint64_t m_readPos = 0;
+	uint64_t m_lostBytes = 0;
+	uint64_t m_overruns = 0;
+};
+
+} // namespace obs_audio_to_websocket
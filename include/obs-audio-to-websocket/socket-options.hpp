@@ -0,0 +1,46 @@
+#pragma once
+
+// These macros are defined in CMakeLists.txt, don't redefine them here
+
+#include <asio.hpp>
+#include "constants.hpp"
+
+namespace obs_audio_to_websocket {
+
+using ip_tos = asio::detail::socket_option::integer<IPPROTO_IP, IP_TOS>;
+#ifdef IPV6_TCLASS
+using ipv6_tclass = asio::detail::socket_option::integer<IPPROTO_IPV6, IPV6_TCLASS>;
+#endif
+
+// Low-latency options for a connected TCP socket carrying audio: TCP_NODELAY, a fixed send
+// buffer and, when dscp > 0, the DSCP code point. Failures are not fatal - the socket just
+// keeps the OS defaults - so the error of the last failing option is returned for logging.
+template<typename Socket> asio::error_code TuneAudioSocket(Socket &socket, int dscp)
+{
+	asio::error_code result;
+	asio::error_code ec;
+
+	socket.set_option(asio::ip::tcp::no_delay(true), ec); // Audio frames are small; don't wait for Nagle
+	if (ec)
+		result = ec;
+	socket.set_option(asio::socket_base::send_buffer_size(constants::SOCKET_SEND_BUFFER_BYTES), ec);
+	if (ec)
+		result = ec;
+
+	if (dscp > 0) {
+		// DSCP occupies the upper six bits of the TOS / traffic class byte
+		int tos = (dscp & 0x3f) << 2;
+		if (socket.local_endpoint(ec).address().is_v6()) {
+#ifdef IPV6_TCLASS
+			socket.set_option(ipv6_tclass(tos), ec);
+#endif
+		} else {
+			socket.set_option(ip_tos(tos), ec);
+		}
+		if (ec)
+			result = ec;
+	}
+	return result;
+}
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "audio-format.hpp"
+#include "audio-levels.hpp"
+#include "audio-sink.hpp"
+#include "bitrate-controller.hpp"
+#include "cpu-watchdog.hpp"
+#include "log-mel.hpp"
+#include "pipeline-stats.hpp"
+#include "resampler.hpp"
+#include "stream-profile.hpp"
+
+namespace obs_audio_to_websocket {
+
+class WebSocketPPServer;
+class EncoderStream;
+class StreamPipeline;
+
+// Feeds a pipeline from wherever its audio comes from: an OBS source or output mix track in the plugin
+// (ObsAudioInput), a file in the offline driver
+class AudioInput {
+public:
+	virtual ~AudioInput() = default;
+
+	// Starts calling pipeline.PushAudio from a single thread. On failure returns false with a user-facing
+	// reason in error.
+	virtual bool Attach(StreamPipeline &pipeline, std::string &error) = 0;
+	// Stops calling it; returns once no call is in progress
+	virtual void Detach() = 0;
+};
+
+// One stream profile's convert -> fan-out path, independent of OBS. A pipeline owns all of its mutable state
+// (sinks, rate counters, log-once flags), so any number of them can stream side by side.
+// Owned by shared_ptr; callbacks are invoked from the audio and network threads.
+class StreamPipeline : public std::enable_shared_from_this<StreamPipeline> {
+public:
+	using SinkList = std::vector<std::shared_ptr<AudioSink>>;
+	using OnConnectionChangedCallback = std::function<void()>;
+	using OnErrorCallback = std::function<void(const std::string &)>;
+	using OnFailedCallback = std::function<void()>;
+	using OnDataRateCallback = std::function<void()>;
+	using OnCpuLoadCallback = std::function<void(ShedStage stage, bool degraded)>;
+
+	explicit StreamPipeline(StreamProfile profile);
+	~StreamPipeline();
+
+	// Attaches input, if any, and connects the sinks; server (may be null) also gets every packet. Without
+	// an input the owner calls PushAudio itself, e.g. from a filter somewhere in the source's chain.
+	// Returns false, after reporting through the error callback, if the input can't be attached.
+	bool Start(WebSocketPPServer *server, int dscp, std::unique_ptr<AudioInput> input = nullptr);
+	void Stop();
+	bool IsRunning() const { return m_running.load(); }
+
+	// Converts one block into a packet and hands it to every sink. Expects a single producer thread.
+	// With the encoder pool enabled the block is copied and encoded there, in push order.
+	void PushAudio(const AudioFrame &frame);
+
+	const StreamProfile &GetProfile() const { return m_profile; }
+	std::shared_ptr<const SinkList> GetSinks() const { return std::atomic_load(&m_sinks); }
+	bool IsConnected() const;
+	double GetDataRate() const { return m_dataRate.load(); }
+	// Per-channel levels of the last metering interval; channels == 0 when stopped. Lock-free, any thread.
+	AudioLevels GetLevels() const { return m_levels.Read(); }
+	// Latency histograms and send/drop counters for this pipeline's lifetime; lock-free, any thread
+	const PipelineStats &GetStats() const { return *m_stats; }
+	// Thread CPU time spent encoding, and blocks encoded, since the last Start
+	uint64_t GetEncodeCpuTimeNs() const;
+	uint64_t GetEncodedBlocks() const;
+
+	void SetOnConnectionChanged(OnConnectionChangedCallback cb) { m_onConnectionChanged = cb; }
+	void SetOnError(OnErrorCallback cb) { m_onError = cb; }
+	// Every sink gave up reconnecting. Called on a network thread, so the owner must Stop() from elsewhere.
+	void SetOnFailed(OnFailedCallback cb) { m_onFailed = cb; }
+	void SetOnDataRate(OnDataRateCallback cb) { m_onDataRate = cb; }
+	// The CPU watchdog shed another stage (degraded) or restored one. Called on the encoding thread, which
+	// may be OBS's audio thread, so it must return quickly.
+	void SetOnCpuLoad(OnCpuLoadCallback cb) { m_onCpuLoad = cb; }
+	// Share of each block's duration its processing may take before optional work is shed; 0 turns the
+	// watchdog off. Set before Start.
+	void SetCpuBudget(double fraction);
+	// Whether endpoints may start, stop and fetch traces with control messages. Tracing is process-wide,
+	// so this is off unless the owner allows it.
+	void SetRemoteTraceControl(bool allowed) { m_remoteTraceControl = allowed; }
+
+private:
+	void ResetCaptureState();
+	void DetachInput();
+	// A PushAudio block that owns its samples, for encoding after the callback has returned. Slots are
+	// reused round the ring and only grow, so the capture thread stops allocating after the first pass.
+	struct FrameSlot {
+		AudioFrame frame;
+		std::vector<float> samples;
+		std::vector<uint8_t> bytes;
+	};
+	// The encoder lane's job: encodes the oldest block in the ring
+	void EncodeQueued();
+
+	// Converts, serializes and sends one block; runs on the capture thread or the stream's encoder lane
+	void Encode(const AudioFrame &frame);
+	// The two codecs
+	void EncodePcm(const AudioFrame &frame, const SinkList &sinks, WebSocketPPServer *server);
+	void EncodeFeatures(const AudioFrame &frame, const SinkList &sinks, WebSocketPPServer *server);
+	void SendPacket(AudioPacketPtr packet, size_t bytes, const SinkList &sinks, WebSocketPPServer *server);
+	// "levels" control message for consumers that would otherwise meter the audio themselves
+	void SendLevels(const AudioLevels &levels, const SinkList &sinks, WebSocketPPServer *server);
+	// Starts a clock sync exchange with every connected sink once per interval
+	void SyncClocks(const SinkList &sinks, WebSocketPPServer *server);
+	// Hands one block's processing time to the CPU watchdog and acts on a stage change
+	void CheckBudget(const AudioFrame &frame, uint64_t started);
+	// Adaptive profiles: feeds the link's congestion signals to the controller once per interval and, on a
+	// switch, announces the new format in-band ahead of the first packet in it
+	void AdaptFormat(const AudioFrame &frame, const SinkList &sinks, WebSocketPPServer *server);
+	// The block as the current rung encodes it: frame itself, or a planar copy that is downmixed,
+	// resampled or taken out of OBS's interleaved format. Valid until the next call.
+	const AudioFrame &ApplyRung(const AudioFrame &frame, const FormatRung &rung, uint32_t bitDepth);
+
+	void CopyInterleaved(const AudioFrame &frame, uint8_t *out_ptr, size_t size) const;
+
+	// "format" control message describing the stream's payload, sent to each sink as it connects and,
+	// with the reason, whenever an adaptive profile switches rungs
+	std::string DescribeFormat(const char *reason = nullptr) const;
+
+	void ConnectSinks(int dscp);
+	void DisconnectSinks();
+
+	void OnSinkConnected(const std::weak_ptr<AudioSink> &sink);
+	void OnSinkMessage(const std::weak_ptr<AudioSink> &sink, const std::string &message);
+	void OnClockSyncReply(AudioSink &sink, const nlohmann::json &msg, uint64_t receivedNs);
+	void OnAck(const AudioSink &sink, const nlohmann::json &msg);
+	void OnSinkError(const std::string &url, const std::string &error);
+	// start_trace, stop_trace and get_trace from an endpoint
+	void OnTraceRequest(const std::weak_ptr<AudioSink> &sink, const std::string &type);
+	void JoinTraceDump();
+
+	// RTP session descriptions travel over the control channel of the other sinks
+	void BroadcastDescription(const std::string &url, const std::string &sdp);
+	void SendDescriptions(const std::shared_ptr<AudioSink> &target);
+
+	void ReportError(const std::string &error);
+	void UpdateDataRate(size_t bytes);
+
+	const StreamProfile m_profile;
+	const std::string m_inputName; // Packet source name
+	const std::string m_sourceId;
+	const std::vector<FormatRung> m_ladder; // A single rung unless the profile is adaptive
+	// Shared with the sinks, which record sends and drops from network threads
+	const std::shared_ptr<PipelineStats> m_stats;
+
+	// Replaced wholesale on start/stop; the audio thread only ever reads a snapshot
+	std::shared_ptr<const SinkList> m_sinks;
+	std::atomic<WebSocketPPServer *> m_server{nullptr};
+
+	std::mutex m_inputMutex;
+	std::unique_ptr<AudioInput> m_input;
+
+	std::atomic<bool> m_running{false};
+
+	std::atomic<bool> m_remoteTraceControl{false};
+	std::atomic<bool> m_traceRefusalLogged{false};
+	// get_trace replies are built and sent on this thread, one at a time, so a multi-megabyte dump never
+	// holds up the network thread the request came in on
+	std::mutex m_traceDumpMutex;
+	std::thread m_traceDump;
+	std::atomic<bool> m_traceDumping{false};
+
+	// Serial encoder lane, or null to encode on the capture thread
+	std::shared_ptr<EncoderStream> m_encoder;
+	// Single-producer (PushAudio), single-consumer (the lane) ring of blocks waiting to be encoded
+	std::vector<FrameSlot> m_ring;
+	std::atomic<size_t> m_ringHead{0}; // Next slot PushAudio fills
+	std::atomic<size_t> m_ringTail{0}; // Next slot the lane encodes
+	bool m_ringFullLogged = false;
+	std::atomic<uint64_t> m_inlineCpuNs{0};
+	std::atomic<uint64_t> m_inlineBlocks{0};
+
+	// Encoding state, only touched by one thread at a time (the capture thread or the encoder lane)
+	bool m_formatLogged = false;
+	bool m_formatErrorLogged = false;
+	int m_silenceCounter = 0;
+	std::unique_ptr<LogMelExtractor> m_extractor; // Feature streams; rebuilt when the sample rate changes
+	std::vector<float> m_mono;
+	std::vector<float> m_features;
+	LevelMeter m_levelMeter;
+	LevelSnapshot m_levels; // Written by the encoding thread, read by anyone
+	uint64_t m_lastClockSyncNs = 0;
+	std::unique_ptr<BitrateController> m_bitrate; // Adaptive profiles only
+	std::atomic<size_t> m_rung{0};                // Index into m_ladder; read by DescribeFormat anywhere
+	uint64_t m_lastAdaptNs = 0;
+	uint64_t m_lastDropCount = 0;
+	std::unique_ptr<Resampler> m_resampler; // Rungs below the input's rate
+	AudioFrame m_converted;
+	std::vector<float> m_planar;
+	std::vector<std::vector<float>> m_resampled;
+	std::unique_ptr<CpuWatchdog> m_watchdog; // Null when the budget is off
+	uint64_t m_shedParity = 0;
+	std::chrono::steady_clock::time_point m_lastRateUpdate;
+	size_t m_bytesSinceLastUpdate = 0;
+	std::atomic<double> m_dataRate{0.0};
+
+	OnConnectionChangedCallback m_onConnectionChanged;
+	OnErrorCallback m_onError;
+	OnFailedCallback m_onFailed;
+	OnDataRateCallback m_onDataRate;
+	OnCpuLoadCallback m_onCpuLoad;
+};
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "audio-sink.hpp"
+#include "log-mel.hpp"
+
+namespace obs_audio_to_websocket {
+
+// Sample encoding of the PCM payload; the packet header's bit depth tells consumers which one it is
+enum class SampleEncoding {
+	Int16,   // 16-bit signed, little-endian
+	Float32, // 32-bit IEEE 754 float, little-endian
+};
+
+// What a profile taps
+enum class CaptureMode {
+	Source,    // One source's audio, after its filters, at OBS's rate and layout
+	MixTracks, // OBS output mix tracks; OBS converts to the profile's rate, layout and sample format
+};
+
+constexpr size_t MAX_MIX_TRACKS = 6; // MAX_AUDIO_MIXES
+
+// One step of an adaptive profile's format ladder: how PCM is encoded while the link sustains it.
+// Written "<encoding>[@<rate>][/mono]", e.g. "f32", "s16@16000" or "s16@8000/mono".
+struct FormatRung {
+	SampleEncoding encoding = SampleEncoding::Int16;
+	uint32_t sampleRate = 0; // Resample down to this rate; 0 (or above the input's) keeps the input's
+	bool mono = false;       // Downmix to one channel
+
+	bool operator==(const FormatRung &other) const
+	{
+		return encoding == other.encoding && sampleRate == other.sampleRate && mono == other.mono;
+	}
+};
+
+// One independently streamed pipeline: where its audio comes from, where it goes and how it is encoded.
+// Stored as a JSON array under "Profiles" in the AudioStreamer config section.
+struct StreamProfile {
+	std::string name = "Default";
+	bool enabled = true;
+	CaptureMode capture = CaptureMode::Source;
+	std::string audioSource;
+	uint32_t mixTracks = 1; // Bit i selects output track i + 1; each selected track streams on its own
+	std::string urls = "ws://localhost:8889/audio"; // See ParseUrlList
+	SampleEncoding encoding = SampleEncoding::Int16;
+	std::string codec = "pcm"; // "pcm", or "logmel" for feature frames instead of the waveform
+	FeatureSettings features;  // "logmel" only
+	bool sendLevels = false;   // Also send a "levels" control message per metering interval
+	// Step down (and back up) the format ladder as the link congests and recovers; PCM only
+	bool adaptive = false;
+	std::vector<FormatRung> ladder; // Best first; empty for the default ladder below the profile's encoding
+	bool nativeWebSocket = false;
+	// Migrated from pre-profile settings: packets keep carrying the source name as sourceId
+	bool legacySourceId = false;
+	// Mix track capture only (0 = same as OBS): OBS resamples and remixes before handing audio over
+	uint32_t sampleRate = 0;
+	uint32_t channels = 0;
+
+	bool IsFeatureStream() const { return codec == "logmel"; }
+	// Bits per value on the wire: PCM samples, or feature values (float16/float32)
+	uint32_t BitDepth() const;
+	SinkOptions GetSinkOptions() const;
+	// Whether Start has something to tap
+	bool HasInput() const;
+	// Source name, or "Track N" for a single-track profile; goes out as the packet's source name
+	std::string InputName() const;
+	// The sourceId on the wire: the profile name, or the input name for a migrated profile
+	std::string SourceId() const { return legacySourceId ? InputName() : name; }
+	// The ladder an adaptive profile steps through; a single rung for a fixed format
+	std::vector<FormatRung> FormatLadder() const;
+};
+
+const char *SampleEncodingName(SampleEncoding encoding);
+bool ParseSampleEncoding(const std::string &name, SampleEncoding &encoding);
+
+std::string FormatRungName(const FormatRung &rung);
+bool ParseFormatRung(const std::string &name, FormatRung &rung);
+
+// One profile per stream: a mix track profile becomes one copy per selected track, named "<name> (Track N)"
+std::vector<StreamProfile> ExpandMixTracks(const StreamProfile &profile);
+
+// The dialog's and filter's single "format" choice, covering sample encoding and codec:
+// "s16", "f32", "logmel-f16" or "logmel-f32"
+std::string OutputFormatName(const StreamProfile &profile);
+bool ApplyOutputFormat(const std::string &name, StreamProfile &profile);
+
+std::string SerializeProfiles(const std::vector<StreamProfile> &profiles);
+// Skips malformed entries with a warning and renames duplicates, so every profile name is unique
+std::vector<StreamProfile> ParseProfiles(const std::string &json);
+
+// The URL field may hold several endpoints separated by commas or whitespace;
+// each one becomes an independent sink fed from the same encoded packets.
+std::vector<std::string> ParseUrlList(const std::string &urls);
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,112 @@
+#pragma once
+
+// These macros are defined in CMakeLists.txt, don't redefine them here
+
+#include <asio.hpp>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "audio-sink.hpp"
+#include "io-context-pool.hpp"
+#include "reconnector.hpp"
+
+namespace obs_audio_to_websocket {
+
+// Frame types on the raw stream transports
+enum class StreamFrameType : uint32_t {
+	AudioPacket = 0, // Binary audio message, same format as the WebSocket binary message
+	Control = 1,     // UTF-8 JSON control message
+};
+
+// Every frame is an 8-byte header - uint32 payload length, uint32 StreamFrameType (both
+// little-endian) - followed by the payload. No handshake, masking or per-frame flags.
+constexpr size_t STREAM_FRAME_HEADER_SIZE = 8;
+
+// tcp://host:port and unix:///path/to/socket sinks for consumers that don't need a browser-compatible protocol.
+// Runs on the shared IoContextPool, so instances must be owned by a shared_ptr.
+template<typename Protocol>
+class StreamSocketSink : public AudioSink, public std::enable_shared_from_this<StreamSocketSink<Protocol>> {
+public:
+	StreamSocketSink();
+	~StreamSocketSink() override;
+
+	bool Connect(const std::string &uri) override;
+	void Disconnect() override;
+	bool IsConnected() const override { return m_connected.load(); }
+
+	void SendAudioPacket(const AudioPacketPtr &packet) override;
+	void SendControlText(const std::string &payload) override;
+
+	bool IsReconnecting() const override { return m_reconnect.IsReconnecting(); }
+	int GetReconnectAttempts() const override { return m_reconnect.GetAttempts(); }
+	uint64_t GetDroppedPackets() const override { return m_droppedPackets.load(); }
+	void SetDscp(int dscp) override { m_dscp = dscp; } // tcp:// only; unix sockets have no IP header
+
+private:
+	struct Frame {
+		std::array<uint8_t, STREAM_FRAME_HEADER_SIZE> header;
+		AudioPacketPtr packet; // Shared with the other sinks, never copied
+		std::string text;
+
+		size_t size() const { return header.size() + (packet ? packet->data.size() : text.size()); }
+	};
+
+	// Frames handed to one vectored async_write, owned by its completion handler so the referenced
+	// bytes stay alive until the write completes even if the queue is dropped meanwhile
+	struct WriteBatch {
+		std::vector<Frame> frames;
+		std::vector<asio::const_buffer> buffers;
+		size_t bytes = 0;
+		uint64_t generation = 0;
+	};
+
+	bool ParseUri(const std::string &uri);
+	void StartConnect();
+	void OnConnect(const asio::error_code &ec);
+	void StartReadHeader();
+	void StartReadPayload(size_t length, uint32_t type);
+	bool QueueFrame(Frame &&frame, bool droppable);
+	void StartWrite();
+	void HandleError(const std::string &what, const asio::error_code &ec);
+	void ScheduleReconnect();
+	// Drops queued frames; an in-flight batch stays with its handler (call with m_queueMutex held)
+	void DropQueueLocked();
+
+	static void WriteHeader(Frame &frame, size_t length, StreamFrameType type);
+
+	asio::io_context &m_io;
+	typename Protocol::socket m_socket;
+	Reconnector m_reconnect;
+
+	// tcp://host:port or unix://path
+	std::string m_host;
+	std::string m_port;
+	std::string m_path;
+
+	std::mutex m_queueMutex;
+	std::deque<Frame> m_queue;
+	size_t m_queuedBytes = 0; // Queued and in flight
+	bool m_writing = false;
+	std::shared_ptr<WriteBatch> m_spareBatch; // Reused once the last write's handler is done with it
+	// Bumped whenever the queue is dropped; a completion from an older batch no longer owns m_writing
+	uint64_t m_writeGeneration = 0;
+
+	std::array<uint8_t, STREAM_FRAME_HEADER_SIZE> m_readHeader;
+	std::vector<uint8_t> m_readPayload;
+
+	std::atomic<bool> m_connected{false};
+	std::atomic<bool> m_running{false};
+	std::atomic<uint64_t> m_droppedPackets{0};
+	std::atomic<int> m_dscp{0};
+};
+
+using TcpSink = StreamSocketSink<asio::ip::tcp>;
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+using UnixSocketSink = StreamSocketSink<asio::local::stream_protocol>;
+#endif
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "pipeline-stats.hpp"
+
+namespace obs_audio_to_websocket {
+
+// Per-thread trace-event recorder for jitter hunting. Off by default: while disabled, every hook is one
+// relaxed load. Building with AUDIO_TO_WEBSOCKET_NO_TRACING (ENABLE_TRACING=OFF) compiles the hooks out.
+//
+// Each thread records into its own fixed ring, so recording never waits on another thread; the oldest
+// events are overwritten. A dump copies whatever the rings still hold as Chrome/Perfetto trace events.
+class Tracer {
+public:
+	// Events kept per thread
+	static constexpr size_t RING_SIZE = 16384;
+
+	static Tracer &Instance();
+
+	static bool IsEnabled()
+	{
+#ifdef AUDIO_TO_WEBSOCKET_NO_TRACING
+		return false;
+#else
+		return s_enabled.load(std::memory_order_relaxed);
+#endif
+	}
+	void SetEnabled(bool enabled);
+
+	// name must be a string literal; id ties one audio block's events together across threads
+	static void Complete(const char *name, uint64_t startNs, uint64_t endNs, uint64_t id)
+	{
+		if (IsEnabled())
+			Instance().Record(name, startNs, endNs - startNs, id);
+	}
+	static void Instant(const char *name, uint64_t id)
+	{
+		if (IsEnabled())
+			Instance().Record(name, SteadyNowNs(), INSTANT, id);
+	}
+	// Label for the calling thread in dumps; a string literal, cheap enough to call at thread start
+	static void SetThreadName(const char *name);
+
+	// {"traceEvents": [...]}: load in chrome://tracing or ui.perfetto.dev. Keeps the newest
+	// maxEventsPerThread of each thread's events.
+	nlohmann::json Collect(size_t maxEventsPerThread = RING_SIZE) const;
+	void Clear();
+
+private:
+	static constexpr uint64_t INSTANT = ~uint64_t(0);
+
+	struct Slot {
+		std::atomic<uint64_t> sequence{0}; // 2 * index + 2 once written, odd while being written
+		std::atomic<const char *> name{nullptr};
+		std::atomic<uint64_t> start{0};
+		std::atomic<uint64_t> duration{0};
+		std::atomic<uint64_t> id{0};
+	};
+
+	struct Ring {
+		uint32_t thread = 0;
+		std::atomic<const char *> threadName{nullptr};
+		std::atomic<uint64_t> head{0};    // Events ever written; only the owning thread advances it
+		std::atomic<uint64_t> cleared{0}; // Events before this index were discarded by Clear()
+		std::array<Slot, RING_SIZE> slots;
+	};
+
+	Tracer() = default;
+	void Record(const char *name, uint64_t startNs, uint64_t duration, uint64_t id);
+	Ring &ThreadRing();
+
+	inline static std::atomic<bool> s_enabled{false};
+
+	// Rings outlive their threads so a dump still shows them; the lock is only taken by a thread's first
+	// event and by dumps
+	mutable std::mutex m_mutex;
+	std::vector<std::shared_ptr<Ring>> m_rings;
+};
+
+// Records a complete event from construction to destruction when tracing is on
+class TraceSpan {
+public:
+	TraceSpan(const char *name, uint64_t id) : m_name(name), m_id(id), m_start(Tracer::IsEnabled() ? SteadyNowNs() : 0)
+	{
+	}
+	~TraceSpan()
+	{
+		if (m_start)
+			Tracer::Complete(m_name, m_start, SteadyNowNs(), m_id);
+	}
+	TraceSpan(const TraceSpan &) = delete;
+	TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+	const char *m_name;
+	uint64_t m_id;
+	uint64_t m_start;
+};
+
+} // namespace obs_audio_to_websocket
@@ -2,83 +2,114 @@
 
 // These macros are defined in CMakeLists.txt, don't redefine them here
 
-#include <websocketpp/config/asio_no_tls.hpp>
 #include <websocketpp/client.hpp>
 #include <websocketpp/connection.hpp>
 #include <websocketpp/logger/levels.hpp>
 #include <websocketpp/common/thread.hpp>
 #include <websocketpp/common/memory.hpp>
-#include <thread>
 #include <mutex>
 #include <functional>
 #include <atomic>
+#include <chrono>
 #include <memory>
 #include <string>
-#include "audio-format.hpp"
+#include "audio-sink.hpp"
+#include "io-context-pool.hpp"
+#include "reconnector.hpp"
+#include "websocketpp-config.hpp"
 
 namespace obs_audio_to_websocket {
 
-// Using non-TLS client for simplicity (ws:// only) - matching obs-websocket
-using client = websocketpp::client<websocketpp::config::asio>;
-using message_ptr = websocketpp::config::asio::message_type::ptr;
-
-class WebSocketPPClient : public std::enable_shared_from_this<WebSocketPPClient> {
+// ws:// uses the plain asio transport (matching obs-websocket), wss:// the TLS client one,
+// both with the tuned socket options and pooled message buffers from websocketpp-config.hpp.
+// The TLS client keeps the last session (ID or ticket) so reconnects after a network blip
+// resume with an abbreviated handshake instead of a full one. Building with
+// AUDIO_TO_WEBSOCKET_NO_TLS (ENABLE_TLS=OFF) leaves the TLS client and OpenSSL out.
+// Runs on the shared IoContextPool, so instances must be owned by a shared_ptr.
+template<typename Config>
+class BasicWebSocketPPClient : public AudioSink, public std::enable_shared_from_this<BasicWebSocketPPClient<Config>> {
 public:
-	using OnConnectedCallback = std::function<void()>;
-	using OnDisconnectedCallback = std::function<void()>;
-	using OnMessageCallback = std::function<void(const std::string &)>;
-	using OnErrorCallback = std::function<void(const std::string &)>;
-
-	WebSocketPPClient();
-	virtual ~WebSocketPPClient();
+	using client = websocketpp::client<Config>;
+	using message_ptr = typename Config::message_type::ptr;
 
-	bool Connect(const std::string &uri);
-	void Disconnect();
-	bool IsConnected() const { return m_connected.load(); }
+	BasicWebSocketPPClient();
+	virtual ~BasicWebSocketPPClient();
 
-	void SendAudioData(const AudioChunk &chunk);
-	void SendControlMessage(const std::string &type);
+	bool Connect(const std::string &uri) override;
+	void Disconnect() override;
+	bool IsConnected() const override { return m_connected.load(); }
 
-	void SetOnConnected(OnConnectedCallback cb) { m_onConnected = cb; }
-	void SetOnDisconnected(OnDisconnectedCallback cb) { m_onDisconnected = cb; }
-	void SetOnMessage(OnMessageCallback cb) { m_onMessage = cb; }
-	void SetOnError(OnErrorCallback cb) { m_onError = cb; }
+	// Queues a shared, pre-encoded packet. Drops it instead of blocking when this
+	// connection's send buffer is backed up, so a slow sink never stalls the others.
+	void SendAudioPacket(const AudioPacketPtr &packet) override;
+	void SendControlText(const std::string &payload) override;
 
 	void SetAutoReconnect(bool enable) { m_shouldReconnect = enable; }
 	bool IsAutoReconnectEnabled() const { return m_shouldReconnect; }
-	bool IsReconnecting() const { return m_reconnecting.load(); }
-	int GetReconnectAttempts() const { return m_reconnectAttempts.load(); }
+	bool IsReconnecting() const override { return m_reconnect.IsReconnecting(); }
+	int GetReconnectAttempts() const override { return m_reconnect.GetAttempts(); }
+	uint64_t GetDroppedPackets() const override { return m_droppedPackets.load(); }
+	void SetDscp(int dscp) override { m_dscp = dscp; }
+
+#ifndef AUDIO_TO_WEBSOCKET_NO_TLS
+	// PEM file with trusted CAs for wss://; the system trust store is used when empty
+	void SetTlsCaFile(const std::string &path) { m_tlsCaFile = path; }
+	bool WasTlsSessionResumed() const { return m_tlsSessionResumed.load(); }
+#endif
+	// Time from starting the connection to the WebSocket handshake completing
+	double GetLastConnectMs() const { return m_lastConnectMs.load(); }
 
 private:
-	void Run();
+	void InstallHandlers();
+	void StartConnection(typename client::connection_ptr con);
+	bool IsCurrentConnection(websocketpp::connection_hdl hdl) const;
 	void OnOpen(websocketpp::connection_hdl hdl);
 	void OnClose(websocketpp::connection_hdl hdl);
 	void OnMessage(websocketpp::connection_hdl hdl, message_ptr msg);
 	void OnFail(websocketpp::connection_hdl hdl);
 	void ScheduleReconnect();
 	void DoReconnect();
+	void TuneSocket(websocketpp::connection_hdl hdl);
+#ifndef AUDIO_TO_WEBSOCKET_NO_TLS
+	void InitTls();
+	void StoreTlsSession(SSL_SESSION *session);
+#endif
 
+	asio::io_context &m_io;
 	client m_client;
 	websocketpp::connection_hdl m_hdl;
 	mutable std::mutex m_hdlMutex; // Protect m_hdl access
-	std::thread m_thread;
-	bool m_threadRunning{false};
+	bool m_handlersInstalled = false;
 
 	std::atomic<bool> m_connected{false};
 	std::atomic<bool> m_running{false};
 	std::atomic<bool> m_shouldReconnect{true};
 
-	// Reconnection state
-	std::thread m_reconnectThread;
-	std::atomic<int> m_reconnectAttempts{0};
-	std::atomic<bool> m_reconnecting{false};
+	Reconnector m_reconnect;
+
+	// Backpressure state
+	std::atomic<uint64_t> m_droppedPackets{0};
+	std::atomic<bool> m_backpressured{false};
 
-	std::string m_uri;
+	std::atomic<int> m_dscp{0};
 
-	OnConnectedCallback m_onConnected;
-	OnDisconnectedCallback m_onDisconnected;
-	OnMessageCallback m_onMessage;
-	OnErrorCallback m_onError;
+	// Connect timing
+	std::chrono::steady_clock::time_point m_connectStart;
+	std::atomic<double> m_lastConnectMs{0.0};
+
+#ifndef AUDIO_TO_WEBSOCKET_NO_TLS
+	// TLS state (wss:// only). One context per client so its session survives reconnects.
+	std::shared_ptr<asio::ssl::context> m_tlsContext;
+	std::string m_tlsCaFile;
+	std::mutex m_tlsSessionMutex;
+	SSL_SESSION *m_tlsSession = nullptr;
+	std::atomic<bool> m_tlsSessionResumed{false};
+#endif
 };
 
+using WebSocketPPClient = BasicWebSocketPPClient<TunedAsioConfig>;
+#ifndef AUDIO_TO_WEBSOCKET_NO_TLS
+using WebSocketPPTlsClient = BasicWebSocketPPClient<TunedAsioTlsConfig>;
+#endif
+
 } // namespace obs_audio_to_websocket
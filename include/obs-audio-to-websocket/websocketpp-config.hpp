@@ -0,0 +1,136 @@
+#pragma once
+
+// These macros are defined in CMakeLists.txt, don't redefine them here
+
+#include <websocketpp/config/asio_no_tls.hpp>
+#ifndef AUDIO_TO_WEBSOCKET_NO_TLS
+#include <websocketpp/config/asio_client.hpp>
+#endif
+#include <websocketpp/message_buffer/message.hpp>
+#include <websocketpp/message_buffer/alloc.hpp>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace obs_audio_to_websocket {
+
+// Free list of websocketpp messages for one connection. Messages come back through the
+// shared_ptr deleter with their payload capacity intact, so in steady state a send reuses
+// buffers instead of allocating a message and payload string for both the user frame and
+// the prepared (masked) frame.
+template<typename Message> class MessagePool {
+public:
+	static constexpr size_t MAX_POOLED_MESSAGES = 64;
+	static constexpr size_t MAX_POOLED_CAPACITY = 1024 * 1024; // Don't pin buffers grown by an odd huge message
+
+	~MessagePool()
+	{
+		for (Message *msg : m_free) {
+			delete msg;
+		}
+	}
+
+	Message *Acquire()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_free.empty())
+			return nullptr;
+		Message *msg = m_free.back();
+		m_free.pop_back();
+		return msg;
+	}
+
+	void Release(Message *msg)
+	{
+		if (msg->get_raw_payload().capacity() <= MAX_POOLED_CAPACITY) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_free.size() < MAX_POOLED_MESSAGES) {
+				m_free.push_back(msg);
+				return;
+			}
+		}
+		delete msg;
+	}
+
+private:
+	std::mutex m_mutex;
+	std::vector<Message *> m_free;
+};
+
+// Drop-in for websocketpp::message_buffer::alloc::con_msg_manager backed by a MessagePool
+template<typename message>
+class PooledConMsgManager : public websocketpp::lib::enable_shared_from_this<PooledConMsgManager<message>> {
+public:
+	typedef PooledConMsgManager<message> type;
+	typedef websocketpp::lib::shared_ptr<PooledConMsgManager> ptr;
+	typedef websocketpp::lib::weak_ptr<PooledConMsgManager> weak_ptr;
+	typedef typename message::ptr message_ptr;
+
+	PooledConMsgManager() : m_pool(std::make_shared<MessagePool<message>>()) {}
+
+	message_ptr get_message()
+	{
+		message *msg = m_pool->Acquire();
+		if (msg) {
+			Reset(msg);
+		} else {
+			msg = new message(type::shared_from_this());
+		}
+		return Wrap(msg);
+	}
+
+	message_ptr get_message(websocketpp::frame::opcode::value op, size_t size)
+	{
+		message *msg = m_pool->Acquire();
+		if (msg) {
+			Reset(msg);
+			msg->set_opcode(op);
+			msg->get_raw_payload().reserve(size);
+		} else {
+			msg = new message(type::shared_from_this(), op, size);
+		}
+		return Wrap(msg);
+	}
+
+	// Messages return to the pool through their deleter instead
+	bool recycle(message *) { return false; }
+
+private:
+	static void Reset(message *msg)
+	{
+		msg->set_header("");
+		msg->get_raw_payload().clear();
+		msg->set_prepared(false);
+		msg->set_fin(true);
+		msg->set_terminal(false);
+		msg->set_compressed(false);
+	}
+
+	message_ptr Wrap(message *msg)
+	{
+		// The deleter keeps the pool alive for messages that outlive their connection
+		std::shared_ptr<MessagePool<message>> pool = m_pool;
+		return message_ptr(msg, [pool](message *m) { pool->Release(m); });
+	}
+
+	std::shared_ptr<MessagePool<message>> m_pool;
+};
+
+// Stock asio client configs with the pooled message manager. Socket options (TCP_NODELAY,
+// SO_SNDBUF, DSCP) are applied per connection by the client's tcp pre-init handler.
+template<typename Base> struct TunedConfig : public Base {
+	typedef TunedConfig<Base> type;
+	typedef Base base;
+
+	typedef websocketpp::message_buffer::message<PooledConMsgManager> message_type;
+	typedef PooledConMsgManager<message_type> con_msg_manager_type;
+	typedef websocketpp::message_buffer::alloc::endpoint_msg_manager<con_msg_manager_type>
+		endpoint_msg_manager_type;
+};
+
+using TunedAsioConfig = TunedConfig<websocketpp::config::asio>;
+#ifndef AUDIO_TO_WEBSOCKET_NO_TLS
+using TunedAsioTlsConfig = TunedConfig<websocketpp::config::asio_tls_client>;
+#endif
+
+} // namespace obs_audio_to_websocket
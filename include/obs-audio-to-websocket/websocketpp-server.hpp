@@ -0,0 +1,88 @@
+#pragma once
+
+// These macros are defined in CMakeLists.txt, don't redefine them here
+
+#include <websocketpp/config/asio_no_tls.hpp>
+#include <websocketpp/server.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include <chrono>
+#include "audio-packet.hpp"
+#include "io-context-pool.hpp"
+
+namespace obs_audio_to_websocket {
+
+using server = websocketpp::server<websocketpp::config::asio>;
+
+// Embedded WebSocket server: consumers connect to OBS and pull audio instead of
+// the plugin pushing to each of them.
+class WebSocketPPServer {
+public:
+	using OnSubscribersChangedCallback = std::function<void(size_t)>;
+	using OnErrorCallback = std::function<void(const std::string &)>;
+
+	WebSocketPPServer();
+	~WebSocketPPServer();
+
+	// Port 0 listens on a free port; GetPort() returns the one in use
+	bool Start(uint16_t port);
+	// Closes every subscriber and waits, up to SERVER_CLOSE_TIMEOUT_MS, for their close handshakes
+	void Stop();
+	bool IsRunning() const { return m_running.load(); }
+	uint16_t GetPort() const { return m_port; }
+
+	size_t GetSubscriberCount() const;
+	uint64_t GetEvictedCount() const { return m_evicted.load(); }
+	uint64_t GetDroppedPackets() const { return m_droppedPackets.load(); }
+
+	// Sends the packet to every subscriber interested in its source. Safe to call from the audio thread.
+	void Broadcast(const AudioPacketPtr &packet);
+	void BroadcastControlText(const std::string &payload);
+
+	void SetOnSubscribersChanged(OnSubscribersChangedCallback cb) { m_onSubscribersChanged = cb; }
+	void SetOnError(OnErrorCallback cb) { m_onError = cb; }
+
+private:
+	struct Subscriber {
+		websocketpp::connection_hdl hdl;
+		std::string remote;
+		// Empty set means "all sources"; swapped atomically when the subscriber re-subscribes
+		std::shared_ptr<const std::set<std::string>> sources;
+		std::atomic<int64_t> laggingSinceMs{0};
+		std::atomic<bool> evicting{false};
+	};
+	using SubscriberList = std::vector<std::shared_ptr<Subscriber>>;
+
+	void OnOpen(websocketpp::connection_hdl hdl);
+	void OnClose(websocketpp::connection_hdl hdl);
+	void OnMessage(websocketpp::connection_hdl hdl, server::message_ptr msg);
+
+	std::shared_ptr<Subscriber> FindSubscriber(websocketpp::connection_hdl hdl) const;
+	bool WantsSource(const Subscriber &subscriber, const std::string &sourceName) const;
+	void Evict(const std::shared_ptr<Subscriber> &subscriber, const char *reason);
+	void SendControlText(websocketpp::connection_hdl hdl, const std::string &payload);
+
+	asio::io_context &m_io;
+	server m_server;
+	uint16_t m_port = 0;
+
+	std::atomic<bool> m_running{false};
+	std::atomic<uint64_t> m_evicted{0};
+	std::atomic<uint64_t> m_droppedPackets{0};
+
+	// Copy-on-write so Broadcast never waits on connection churn
+	std::shared_ptr<const SubscriberList> m_subscribers;
+	std::mutex m_subscribersMutex; // Serializes writers only
+	std::condition_variable m_subscriberClosed;
+
+	OnSubscribersChangedCallback m_onSubscribersChanged;
+	OnErrorCallback m_onError;
+};
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,244 @@
+#include "obs-audio-to-websocket/audio-filter.hpp"
+#include "obs-audio-to-websocket/audio-streamer.hpp"
+#include "obs-audio-to-websocket/stream-pipeline.hpp"
+#include "obs-audio-to-websocket/stream-profile.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <obs-module.h>
+
+namespace obs_audio_to_websocket {
+
+namespace {
+
+constexpr const char *FILTER_ID = "audio_to_websocket_filter";
+
+constexpr const char *S_URLS = "urls";
+constexpr const char *S_FORMAT = "format";
+constexpr const char *S_NATIVE_WEBSOCKET = "native_websocket";
+
+struct AudioToWebSocketFilter {
+	obs_source_t *context = nullptr;
+
+	// Guards the settings below and pipeline replacement; the audio thread only reads the pipeline
+	std::mutex mutex;
+	std::string urls;
+	std::string format = "s16"; // OutputFormatName()
+	bool nativeWebSocket = false;
+
+	std::shared_ptr<StreamPipeline> pipeline;
+	// FilterAudio calls that may still be pushing into a pipeline taken out of `pipeline`
+	std::atomic<int> pushing{0};
+};
+
+// Takes the pipeline out and stops it once the audio thread is done with it, so Stop never runs alongside
+// PushAudio (with inline encoding both would publish levels, and those have a single writer).
+void RetirePipeline(AudioToWebSocketFilter *filter)
+{
+	auto old = std::atomic_exchange(&filter->pipeline, std::shared_ptr<StreamPipeline>());
+	if (!old)
+		return;
+
+	AudioStreamer::Instance().RemoveFilterPipeline(old);
+	// Paired with FilterAudio: either it loads the empty pointer, or this sees its push in progress
+	while (filter->pushing.load() > 0) {
+		std::this_thread::yield();
+	}
+	old->Stop();
+}
+
+// Tears down the current pipeline and, if the filter is attached, enabled and has somewhere to send, starts a
+// fresh one. The profile name is the filter's name and the source name is its parent, both as they are now.
+void RestartPipeline(AudioToWebSocketFilter *filter)
+{
+	std::lock_guard<std::mutex> lock(filter->mutex);
+	RetirePipeline(filter);
+
+	obs_source_t *parent = obs_filter_get_parent(filter->context);
+	if (!parent || !obs_source_enabled(filter->context) || ParseUrlList(filter->urls).empty())
+		return;
+
+	StreamProfile profile;
+	profile.name = obs_source_get_name(filter->context);
+	profile.audioSource = obs_source_get_name(parent);
+	profile.urls = filter->urls;
+	ApplyOutputFormat(filter->format, profile);
+	profile.nativeWebSocket = filter->nativeWebSocket;
+
+	std::string label = profile.audioSource + "/" + profile.name;
+	auto pipeline = std::make_shared<StreamPipeline>(std::move(profile));
+	pipeline->SetOnError([label](const std::string &error) {
+		blog(LOG_WARNING, "[Audio to WebSocket] Filter '%s': %s", label.c_str(), error.c_str());
+	});
+	pipeline->SetOnFailed([label]() {
+		blog(LOG_ERROR, "[Audio to WebSocket] Filter '%s' gave up reconnecting; toggle the filter to retry",
+		     label.c_str());
+	});
+
+	pipeline->SetCpuBudget(AudioStreamer::Instance().GetCpuBudget());
+	pipeline->SetRemoteTraceControl(AudioStreamer::Instance().GetRemoteTraceControl());
+
+	// Filter pipelines push to their own endpoints only; the embedded server belongs to the dialog's profiles
+	if (!pipeline->Start(nullptr, AudioStreamer::Instance().GetDscp()))
+		return;
+
+	blog(LOG_INFO, "[Audio to WebSocket] Filter '%s' streaming to %s", label.c_str(), filter->urls.c_str());
+	AudioStreamer::Instance().AddFilterPipeline(label, pipeline);
+	std::atomic_store(&filter->pipeline, pipeline);
+}
+
+void StopPipeline(AudioToWebSocketFilter *filter)
+{
+	std::lock_guard<std::mutex> lock(filter->mutex);
+	RetirePipeline(filter);
+}
+
+// "enable" fires when the filter is toggled, "rename" when the filter is renamed
+void OnFilterSignal(void *data, calldata_t *cd)
+{
+	UNUSED_PARAMETER(cd);
+	RestartPipeline(static_cast<AudioToWebSocketFilter *>(data));
+}
+
+const char *FilterGetName(void *type_data)
+{
+	UNUSED_PARAMETER(type_data);
+	return obs_module_text("AudioToWebSocketFilter");
+}
+
+void FilterUpdate(void *data, obs_data_t *settings)
+{
+	auto *filter = static_cast<AudioToWebSocketFilter *>(data);
+
+	{
+		std::lock_guard<std::mutex> lock(filter->mutex);
+		filter->urls = obs_data_get_string(settings, S_URLS);
+		filter->format = obs_data_get_string(settings, S_FORMAT);
+		StreamProfile parsed;
+		if (!ApplyOutputFormat(filter->format, parsed)) {
+			filter->format = OutputFormatName(parsed);
+		}
+		filter->nativeWebSocket = obs_data_get_bool(settings, S_NATIVE_WEBSOCKET);
+	}
+
+	RestartPipeline(filter);
+}
+
+void *FilterCreate(obs_data_t *settings, obs_source_t *source)
+{
+	auto *filter = new AudioToWebSocketFilter();
+	filter->context = source;
+
+	signal_handler_t *handler = obs_source_get_signal_handler(source);
+	signal_handler_connect(handler, "enable", OnFilterSignal, filter);
+	signal_handler_connect(handler, "rename", OnFilterSignal, filter);
+
+	// No parent yet, so this only stores the settings; FilterAdd starts the pipeline
+	FilterUpdate(filter, settings);
+	return filter;
+}
+
+void FilterDestroy(void *data)
+{
+	auto *filter = static_cast<AudioToWebSocketFilter *>(data);
+
+	signal_handler_t *handler = obs_source_get_signal_handler(filter->context);
+	signal_handler_disconnect(handler, "enable", OnFilterSignal, filter);
+	signal_handler_disconnect(handler, "rename", OnFilterSignal, filter);
+
+	StopPipeline(filter);
+	delete filter;
+}
+
+void FilterAdd(void *data, obs_source_t *parent)
+{
+	UNUSED_PARAMETER(parent);
+	RestartPipeline(static_cast<AudioToWebSocketFilter *>(data));
+}
+
+void FilterRemove(void *data, obs_source_t *parent)
+{
+	UNUSED_PARAMETER(parent);
+	StopPipeline(static_cast<AudioToWebSocketFilter *>(data));
+}
+
+// Audio thread. Passes the audio through untouched; filters always see the global rate as planar float.
+struct obs_audio_data *FilterAudio(void *data, struct obs_audio_data *audio)
+{
+	auto *filter = static_cast<AudioToWebSocketFilter *>(data);
+	if (!audio)
+		return audio;
+
+	filter->pushing.fetch_add(1);
+	auto pipeline = std::atomic_load(&filter->pipeline);
+	if (!pipeline) {
+		filter->pushing.fetch_sub(1);
+		return audio;
+	}
+
+	audio_t *output = obs_get_audio();
+	AudioFrame frame;
+	frame.frames = audio->frames;
+	frame.channels = static_cast<uint32_t>(audio_output_get_channels(output));
+	frame.sampleRate = audio_output_get_sample_rate(output);
+	frame.timestamp = audio->timestamp;
+	for (size_t ch = 0; ch < frame.channels && ch < MAX_FRAME_CHANNELS; ++ch) {
+		frame.planes[ch] = reinterpret_cast<const float *>(audio->data[ch]);
+	}
+
+	pipeline->PushAudio(frame);
+	filter->pushing.fetch_sub(1);
+	return audio;
+}
+
+obs_properties_t *FilterProperties(void *data)
+{
+	UNUSED_PARAMETER(data);
+
+	obs_properties_t *props = obs_properties_create();
+	obs_properties_add_text(props, S_URLS, obs_module_text("FilterUrls"), OBS_TEXT_DEFAULT);
+
+	obs_property_t *format = obs_properties_add_list(props, S_FORMAT, obs_module_text("Format"),
+							  OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+	obs_property_list_add_string(format, obs_module_text("FormatInt16"), SampleEncodingName(SampleEncoding::Int16));
+	obs_property_list_add_string(format, obs_module_text("FormatFloat32"),
+				     SampleEncodingName(SampleEncoding::Float32));
+	obs_property_list_add_string(format, obs_module_text("FormatLogMel16"), "logmel-f16");
+	obs_property_list_add_string(format, obs_module_text("FormatLogMel32"), "logmel-f32");
+
+	obs_properties_add_bool(props, S_NATIVE_WEBSOCKET, obs_module_text("NativeWebSocket"));
+	return props;
+}
+
+void FilterDefaults(obs_data_t *settings)
+{
+	StreamProfile defaults;
+	obs_data_set_default_string(settings, S_URLS, defaults.urls.c_str());
+	obs_data_set_default_string(settings, S_FORMAT, OutputFormatName(defaults).c_str());
+	obs_data_set_default_bool(settings, S_NATIVE_WEBSOCKET, defaults.nativeWebSocket);
+}
+
+} // namespace
+
+void RegisterAudioFilter()
+{
+	struct obs_source_info info = {};
+	info.id = FILTER_ID;
+	info.type = OBS_SOURCE_TYPE_FILTER;
+	info.output_flags = OBS_SOURCE_AUDIO;
+	info.get_name = FilterGetName;
+	info.create = FilterCreate;
+	info.destroy = FilterDestroy;
+	info.update = FilterUpdate;
+	info.filter_add = FilterAdd;
+	info.filter_remove = FilterRemove;
+	info.filter_audio = FilterAudio;
+	info.get_properties = FilterProperties;
+	info.get_defaults = FilterDefaults;
+
+	obs_register_source(&info);
+}
+
+} // namespace obs_audio_to_websocket
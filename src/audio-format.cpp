@@ -1,4 +1,7 @@
 #include "obs-audio-to-websocket/audio-format.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 namespace obs_audio_to_websocket {
 
@@ -13,4 +16,99 @@ bool AudioFormat::isValid() const
 	return channels > 0 && sampleRate > 0 && bitDepth > 0;
 }
 
+void ConvertPlanar(const AudioFrame &frame, bool to_float, uint8_t *out_ptr)
+{
+	// Process audio frame by frame (interleaved output)
+	size_t out_idx = 0;
+	for (size_t i = 0; i < frame.frames; ++i) {
+		for (size_t ch = 0; ch < frame.channels; ++ch) {
+			float sample = frame.planes[ch][i];
+
+			if (to_float) {
+				// IEEE 754 bits, written little-endian explicitly
+				uint32_t bits;
+				memcpy(&bits, &sample, sizeof(bits));
+				out_ptr[out_idx++] = bits & 0xFF;
+				out_ptr[out_idx++] = (bits >> 8) & 0xFF;
+				out_ptr[out_idx++] = (bits >> 16) & 0xFF;
+				out_ptr[out_idx++] = (bits >> 24) & 0xFF;
+				continue;
+			}
+
+			// Clamp to [-1, 1] range
+			sample = (std::max)(-1.0f, (std::min)(1.0f, sample));
+			// Convert to 16-bit signed PCM with proper rounding
+			int16_t sample_16 = static_cast<int16_t>(std::round(sample * 32767.0f));
+
+			// Write in little-endian format explicitly
+			out_ptr[out_idx++] = sample_16 & 0xFF;        // Low byte
+			out_ptr[out_idx++] = (sample_16 >> 8) & 0xFF; // High byte
+		}
+	}
+}
+
+void DownmixMono(const AudioFrame &frame, std::vector<float> &mono)
+{
+	size_t frames = frame.frames;
+	uint32_t channels = frame.channels;
+	float scale = 1.0f / channels;
+	mono.assign(frames, 0.0f);
+
+	if (!frame.interleaved) {
+		for (uint32_t ch = 0; ch < channels; ++ch) {
+			const float *plane = frame.planes[ch];
+			for (size_t i = 0; i < frames; ++i) {
+				mono[i] += plane[i] * scale;
+			}
+		}
+		return;
+	}
+
+	bool is_float = frame.bitDepth == 32;
+	size_t sample_size = is_float ? sizeof(float) : sizeof(int16_t);
+	const uint8_t *in_ptr = frame.interleaved;
+	for (size_t i = 0; i < frames; ++i) {
+		for (uint32_t ch = 0; ch < channels; ++ch, in_ptr += sample_size) {
+			float sample;
+			if (is_float) {
+				memcpy(&sample, in_ptr, sizeof(sample));
+			} else {
+				int16_t sample_16;
+				memcpy(&sample_16, in_ptr, sizeof(sample_16));
+				sample = sample_16 / 32768.0f;
+			}
+			mono[i] += sample * scale;
+		}
+	}
+}
+
+void DeinterleaveFrame(const AudioFrame &frame, std::vector<float> &samples, AudioFrame &planar)
+{
+	size_t frames = frame.frames;
+	uint32_t channels = frame.channels;
+	samples.resize(frames * channels);
+	planar = frame;
+	planar.interleaved = nullptr;
+	for (uint32_t ch = 0; ch < channels; ++ch) {
+		planar.planes[ch] = samples.data() + ch * frames;
+	}
+
+	bool is_float = frame.bitDepth == 32;
+	size_t sample_size = is_float ? sizeof(float) : sizeof(int16_t);
+	const uint8_t *in_ptr = frame.interleaved;
+	for (size_t i = 0; i < frames; ++i) {
+		for (uint32_t ch = 0; ch < channels; ++ch, in_ptr += sample_size) {
+			float sample;
+			if (is_float) {
+				memcpy(&sample, in_ptr, sizeof(sample));
+			} else {
+				int16_t sample_16;
+				memcpy(&sample_16, in_ptr, sizeof(sample_16));
+				sample = sample_16 / 32768.0f;
+			}
+			samples[ch * frames + i] = sample;
+		}
+	}
+}
+
 } // namespace obs_audio_to_websocket
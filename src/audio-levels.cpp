@@ -0,0 +1,230 @@
+#include "obs-audio-to-websocket/audio-levels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace obs_audio_to_websocket {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr size_t PHASES = 4;
+constexpr size_t TAPS = 12;
+
+// Windowed-sinc 4x interpolator split into its phases, each normalized to unity gain. Same length and
+// oversampling as the filter in ITU-R BS.1770 Annex 2.
+struct Interpolator {
+	float taps[PHASES][TAPS];
+
+	Interpolator()
+	{
+		constexpr size_t LENGTH = PHASES * TAPS;
+		constexpr double CENTER = (LENGTH - 1) / 2.0;
+		for (size_t phase = 0; phase < PHASES; ++phase) {
+			double sum = 0.0;
+			for (size_t k = 0; k < TAPS; ++k) {
+				size_t n = k * PHASES + phase;
+				double x = (n - CENTER) / PHASES;
+				double sinc = std::sin(PI * x) / (PI * x);
+				double window = 0.5 - 0.5 * std::cos(2.0 * PI * (n + 0.5) / LENGTH);
+				taps[phase][k] = static_cast<float>(sinc * window);
+				sum += taps[phase][k];
+			}
+			for (size_t k = 0; k < TAPS; ++k) {
+				taps[phase][k] = static_cast<float>(taps[phase][k] / sum);
+			}
+		}
+	}
+};
+
+const Interpolator &GetInterpolator()
+{
+	static const Interpolator interpolator;
+	return interpolator;
+}
+
+} // namespace
+
+float AudioLevels::MaxPeak() const
+{
+	float peakLevel = 0.0f;
+	for (uint32_t ch = 0; ch < channels; ++ch) {
+		peakLevel = (std::max)(peakLevel, peak[ch]);
+	}
+	return peakLevel;
+}
+
+float AmplitudeToDb(float amplitude)
+{
+	if (amplitude <= 0.00001f)
+		return -100.0f;
+	return 20.0f * std::log10(amplitude);
+}
+
+LevelMeter::LevelMeter(uint32_t intervalMs) : m_intervalMs(std::max(1u, intervalMs))
+{
+	GetInterpolator();
+}
+
+void LevelMeter::Reset()
+{
+	m_levels = AudioLevels();
+	m_channels = 0;
+	m_sampleRate = 0;
+	m_intervalFrames = 0;
+	m_peak.fill(0.0f);
+	m_sumSquares.fill(0.0);
+	m_truePeak.fill(0.0f);
+	for (auto &history : m_history) {
+		history.fill(0.0f);
+	}
+}
+
+float LevelMeter::Measure(const AudioFrame &frame, bool &completed)
+{
+	completed = false;
+	uint32_t channels = std::min<uint32_t>(frame.channels, MAX_FRAME_CHANNELS);
+	if (channels == 0 || frame.frames == 0)
+		return 0.0f;
+
+	if (channels != m_channels || frame.sampleRate != m_sampleRate) {
+		// New layout: drop the partial interval and the interpolator history
+		Reset();
+		m_channels = channels;
+		m_sampleRate = frame.sampleRate;
+	}
+	if (m_intervalFrames == 0) {
+		m_intervalStart = frame.timestamp;
+	}
+
+	float blockPeak = 0.0f;
+	for (uint32_t ch = 0; ch < channels; ++ch) {
+		LoadChannel(frame, ch);
+		blockPeak = (std::max)(blockPeak, MeasureChannel(ch, frame.frames));
+	}
+	m_intervalFrames += frame.frames;
+
+	if (static_cast<uint64_t>(m_intervalFrames) * 1000 >= static_cast<uint64_t>(m_sampleRate) * m_intervalMs) {
+		m_levels.channels = m_channels;
+		m_levels.timestamp = m_intervalStart;
+		m_levels.frames = m_intervalFrames;
+		m_levels.sampleRate = m_sampleRate;
+		for (uint32_t ch = 0; ch < m_channels; ++ch) {
+			m_levels.peak[ch] = m_peak[ch];
+			m_levels.rms[ch] = static_cast<float>(std::sqrt(m_sumSquares[ch] / m_intervalFrames));
+			m_levels.truePeak[ch] = (std::max)(m_truePeak[ch], m_peak[ch]);
+		}
+
+		m_intervalFrames = 0;
+		m_peak.fill(0.0f);
+		m_sumSquares.fill(0.0);
+		m_truePeak.fill(0.0f);
+		completed = true;
+	}
+	return blockPeak;
+}
+
+void LevelMeter::LoadChannel(const AudioFrame &frame, uint32_t channel)
+{
+	const size_t history = TRUE_PEAK_TAPS - 1;
+	m_scratch.resize(history + frame.frames);
+	std::copy(m_history[channel].begin(), m_history[channel].end(), m_scratch.begin());
+	float *out = m_scratch.data() + history;
+
+	if (!frame.interleaved) {
+		memcpy(out, frame.planes[channel], frame.frames * sizeof(float));
+	} else if (frame.bitDepth == 32) {
+		const uint8_t *in = frame.interleaved + channel * sizeof(float);
+		for (size_t i = 0; i < frame.frames; ++i, in += frame.channels * sizeof(float)) {
+			memcpy(&out[i], in, sizeof(float));
+		}
+	} else {
+		const uint8_t *in = frame.interleaved + channel * sizeof(int16_t);
+		for (size_t i = 0; i < frame.frames; ++i, in += frame.channels * sizeof(int16_t)) {
+			int16_t sample;
+			memcpy(&sample, in, sizeof(sample));
+			out[i] = sample / 32768.0f;
+		}
+	}
+
+	std::copy(m_scratch.end() - history, m_scratch.end(), m_history[channel].begin());
+}
+
+float LevelMeter::MeasureChannel(uint32_t channel, size_t frames)
+{
+	static_assert(TRUE_PEAK_TAPS == TAPS, "history must cover the interpolator");
+	const float *samples = m_scratch.data() + (TAPS - 1);
+	float peak = 0.0f;
+	double sumSquares = 0.0;
+	for (size_t i = 0; i < frames; ++i) {
+		float sample = samples[i];
+		peak = (std::max)(peak, std::abs(sample));
+		sumSquares += static_cast<double>(sample) * sample;
+	}
+
+	// Four interpolated points per input sample, trailing it by the filter's delay of about six samples
+	const Interpolator &interpolator = GetInterpolator();
+	float truePeak = 0.0f;
+	for (size_t i = 0; i < frames; ++i) {
+		const float *window = m_scratch.data() + i;
+		for (size_t phase = 0; phase < PHASES; ++phase) {
+			const float *taps = interpolator.taps[phase];
+			float value = 0.0f;
+			for (size_t k = 0; k < TAPS; ++k) {
+				value += taps[k] * window[TAPS - 1 - k];
+			}
+			truePeak = (std::max)(truePeak, std::abs(value));
+		}
+	}
+
+	m_peak[channel] = (std::max)(m_peak[channel], peak);
+	m_sumSquares[channel] += sumSquares;
+	m_truePeak[channel] = (std::max)(m_truePeak[channel], truePeak);
+	return peak;
+}
+
+void LevelSnapshot::Publish(const AudioLevels &levels)
+{
+	// Odd while the fields are being written
+	uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+	m_sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	m_channels.store(levels.channels, std::memory_order_relaxed);
+	m_frames.store(levels.frames, std::memory_order_relaxed);
+	m_sampleRate.store(levels.sampleRate, std::memory_order_relaxed);
+	m_timestamp.store(levels.timestamp, std::memory_order_relaxed);
+	for (size_t ch = 0; ch < MAX_FRAME_CHANNELS; ++ch) {
+		m_peak[ch].store(levels.peak[ch], std::memory_order_relaxed);
+		m_rms[ch].store(levels.rms[ch], std::memory_order_relaxed);
+		m_truePeak[ch].store(levels.truePeak[ch], std::memory_order_relaxed);
+	}
+
+	m_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+AudioLevels LevelSnapshot::Read() const
+{
+	AudioLevels levels;
+	for (;;) {
+		uint32_t before = m_sequence.load(std::memory_order_acquire);
+		if (before & 1)
+			continue;
+
+		levels.channels = m_channels.load(std::memory_order_relaxed);
+		levels.frames = m_frames.load(std::memory_order_relaxed);
+		levels.sampleRate = m_sampleRate.load(std::memory_order_relaxed);
+		levels.timestamp = m_timestamp.load(std::memory_order_relaxed);
+		for (size_t ch = 0; ch < MAX_FRAME_CHANNELS; ++ch) {
+			levels.peak[ch] = m_peak[ch].load(std::memory_order_relaxed);
+			levels.rms[ch] = m_rms[ch].load(std::memory_order_relaxed);
+			levels.truePeak[ch] = m_truePeak[ch].load(std::memory_order_relaxed);
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (m_sequence.load(std::memory_order_relaxed) == before)
+			return levels;
+	}
+}
+
+} // namespace obs_audio_to_websocket
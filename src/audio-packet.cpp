@@ -0,0 +1,61 @@
+#include "obs-audio-to-websocket/audio-packet.hpp"
+#include <cstring>
+
+namespace obs_audio_to_websocket {
+
+std::shared_ptr<AudioPacket> CreateAudioPacket(uint64_t timestamp, const AudioFormat &format,
+					       const std::string &sourceId, const std::string &sourceName,
+					       size_t payloadSize)
+{
+	auto packet = std::make_shared<AudioPacket>();
+	packet->timestamp = timestamp;
+	packet->format = format;
+	packet->sourceName = sourceName;
+	packet->payloadOffset = AUDIO_PACKET_HEADER_SIZE + sourceId.length() + sourceName.length();
+	packet->data.resize(packet->payloadOffset + payloadSize);
+
+	uint8_t *out = packet->data.data();
+
+	// Write header (all multi-byte values in little-endian format)
+	auto writeUint64 = [&out](uint64_t val) {
+		for (int i = 0; i < 8; ++i) {
+			*out++ = (val >> (i * 8)) & 0xFF;
+		}
+	};
+
+	auto writeUint32 = [&out](uint32_t val) {
+		for (int i = 0; i < 4; ++i) {
+			*out++ = (val >> (i * 8)) & 0xFF;
+		}
+	};
+
+	writeUint64(timestamp);
+	writeUint32(format.sampleRate);
+	writeUint32(format.channels);
+	writeUint32(format.bitDepth);
+	writeUint32(static_cast<uint32_t>(sourceId.length()));
+	writeUint32(static_cast<uint32_t>(sourceName.length()));
+
+	// Write strings
+	if (!sourceId.empty()) {
+		memcpy(out, sourceId.data(), sourceId.length());
+		out += sourceId.length();
+	}
+	if (!sourceName.empty()) {
+		memcpy(out, sourceName.data(), sourceName.length());
+	}
+
+	return packet;
+}
+
+AudioPacketPtr EncodeAudioPacket(const AudioChunk &chunk)
+{
+	auto packet = CreateAudioPacket(chunk.timestamp, chunk.format, chunk.sourceId, chunk.sourceName,
+					chunk.data.size());
+	if (!chunk.data.empty()) {
+		memcpy(packet->payload(), chunk.data.data(), chunk.data.size());
+	}
+	return packet;
+}
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,130 @@
+#include "obs-audio-to-websocket/audio-sink.hpp"
+#include "obs-audio-to-websocket/websocketpp-client.hpp"
+#include "obs-audio-to-websocket/native-websocket-client.hpp"
+#include "obs-audio-to-websocket/log.hpp"
+#include "obs-audio-to-websocket/pipeline-stats.hpp"
+#include "obs-audio-to-websocket/trace.hpp"
+#include "obs-audio-to-websocket/shm-ring-sink.hpp"
+#include "obs-audio-to-websocket/stream-socket-sink.hpp"
+#include "obs-audio-to-websocket/rtp-sink.hpp"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstring>
+
+namespace obs_audio_to_websocket {
+
+namespace {
+
+bool HasScheme(const std::string &uri, const char *scheme)
+{
+	return uri.compare(0, strlen(scheme), scheme) == 0;
+}
+
+} // namespace
+
+std::string MakeControlMessage(const std::string &type, const nlohmann::json &fields)
+{
+	nlohmann::json msg = fields.is_object() ? fields : nlohmann::json::object();
+	msg["type"] = type;
+	msg["timestamp"] = std::chrono::duration_cast<std::chrono::microseconds>(
+				   std::chrono::system_clock::now().time_since_epoch())
+				   .count();
+	return msg.dump();
+}
+
+void AudioSink::RecordSent(uint64_t captureNs, size_t bytes)
+{
+	Tracer::Instant("written", captureNs);
+	if (!m_stats)
+		return;
+	m_stats->packetsSent.fetch_add(1, std::memory_order_relaxed);
+	m_stats->bytesSent.fetch_add(bytes, std::memory_order_relaxed);
+	if (captureNs) {
+		uint64_t now = SteadyNowNs();
+		m_stats->captureToSendNs.Record(now > captureNs ? now - captureNs : 0);
+	}
+}
+
+void AudioSink::RecordDropped()
+{
+	if (m_stats) {
+		m_stats->packetsDropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void AudioSink::ReportConnectionLost(bool wasConnected, bool retrying, const std::string &what,
+				     const std::string &reason)
+{
+	if (wasConnected) {
+		blog(LOG_INFO, "[Audio to WebSocket] Disconnected from %s: %s", m_uri.c_str(), reason.c_str());
+		if (m_onDisconnected) {
+			m_onDisconnected();
+		}
+		return;
+	}
+
+	blog(LOG_ERROR, "[Audio to WebSocket] %s: %s", what.c_str(), reason.c_str());
+	if (!retrying && m_onError) {
+		m_onError(what + ": " + reason);
+	}
+}
+
+void AudioSink::RecordQueuedBytes(size_t bytes)
+{
+	m_queuedBytes.store(bytes, std::memory_order_relaxed);
+	if (m_stats) {
+		m_stats->sinkQueueBytes.Record(bytes);
+	}
+}
+
+bool IsSupportedSinkUri(const std::string &uri)
+{
+	if (HasScheme(uri, "unix://")) {
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+		return true;
+#else
+		return false;
+#endif
+	}
+	if (HasScheme(uri, "wss://")) {
+#ifndef AUDIO_TO_WEBSOCKET_NO_TLS
+		return true;
+#else
+		return false;
+#endif
+	}
+	return HasScheme(uri, "ws://") || HasScheme(uri, "shm://") || HasScheme(uri, "tcp://") ||
+	       HasScheme(uri, "rtp://");
+}
+
+std::shared_ptr<AudioSink> CreateAudioSink(const std::string &uri, const SinkOptions &options)
+{
+	if (HasScheme(uri, "shm://")) {
+		return std::make_shared<ShmRingSink>();
+	}
+	if (HasScheme(uri, "tcp://")) {
+		return std::make_shared<TcpSink>();
+	}
+	if (HasScheme(uri, "rtp://")) {
+		return std::make_shared<RtpSink>();
+	}
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+	if (HasScheme(uri, "unix://")) {
+		return std::make_shared<UnixSocketSink>();
+	}
+#endif
+#ifndef AUDIO_TO_WEBSOCKET_NO_TLS
+	if (HasScheme(uri, "wss://")) {
+		return std::make_shared<WebSocketPPTlsClient>();
+	}
+#endif
+	if (HasScheme(uri, "ws://")) {
+		if (options.nativeWebSocket) {
+			return std::make_shared<NativeWebSocketClient>();
+		}
+		return std::make_shared<WebSocketPPClient>();
+	}
+	return nullptr;
+}
+
+} // namespace obs_audio_to_websocket
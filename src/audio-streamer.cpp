@@ -1,12 +1,15 @@
 #include "obs-audio-to-websocket/audio-streamer.hpp"
 #include "obs-audio-to-websocket/settings-dialog.hpp"
-#include <chrono>
-#include <cmath>
+#include "obs-audio-to-websocket/encoder-pool.hpp"
+#include "obs-audio-to-websocket/io-context-pool.hpp"
+#include "obs-audio-to-websocket/obs-audio-input.hpp"
 #include <algorithm>
+#include <cstring>
 #include <util/platform.h>
 #include <util/threading.h>
 #include <util/config-file.h>
 #include <obs-module.h>
+#include <nlohmann/json.hpp>
 
 #ifndef UNUSED_PARAMETER
 #define UNUSED_PARAMETER(param) (void)param
@@ -21,11 +24,13 @@ AudioStreamer &AudioStreamer::Instance()
 	return instance;
 }
 
-AudioStreamer::AudioStreamer() : m_lastRateUpdate(std::chrono::steady_clock::now()) {}
+AudioStreamer::AudioStreamer()
+{
+	m_profiles.emplace_back();
+}
 
 AudioStreamer::~AudioStreamer()
 {
-	m_shuttingDown = true;
 	Stop();
 }
 
@@ -36,8 +41,15 @@ void AudioStreamer::Start()
 
 	m_streaming = true;
 
-	ConnectToWebSocket();
-	AttachAudioSource();
+	StartServer();
+	StartPipelines();
+
+	auto pipelines = GetPipelines();
+	if (!pipelines || pipelines->empty()) {
+		// Every enabled profile failed to start and has reported why
+		Stop();
+		return;
+	}
 
 	emit streamingStatusChanged(true);
 }
@@ -49,29 +61,22 @@ void AudioStreamer::Stop()
 
 	m_streaming = false;
 
-	DetachAudioSource();
-	DisconnectFromWebSocket();
+	StopPipelines();
+	StopServer();
 
 	emit streamingStatusChanged(false);
 }
 
-void AudioStreamer::SetAudioSource(const std::string &sourceName)
+std::vector<StreamProfile> AudioStreamer::GetProfiles() const
 {
-	std::lock_guard<std::recursive_mutex> lock(m_sourceMutex);
-
-	if (m_audioSourceName == sourceName)
-		return;
-
-	bool wasStreaming = m_streaming.load();
-	if (wasStreaming) {
-		DetachAudioSource();
-	}
-
-	m_audioSourceName = sourceName;
+	std::lock_guard<std::mutex> lock(m_profilesMutex);
+	return m_profiles;
+}
 
-	if (wasStreaming) {
-		AttachAudioSource();
-	}
+void AudioStreamer::SetProfiles(std::vector<StreamProfile> profiles)
+{
+	std::lock_guard<std::mutex> lock(m_profilesMutex);
+	m_profiles = std::move(profiles);
 }
 
 void AudioStreamer::ShowSettings()
@@ -99,297 +104,357 @@ void AudioStreamer::LoadSettings()
 	config_t *config = obs_frontend_get_profile_config();
 #endif
 
-	const char *url = config_get_string(config, "AudioStreamer", "WebSocketUrl");
-	if (url && strlen(url) > 0) {
-		std::lock_guard<std::mutex> lock(m_urlMutex);
-		m_wsUrl = url;
+	std::vector<StreamProfile> profiles;
+	const char *profilesJson = config_get_string(config, "AudioStreamer", "Profiles");
+	if (profilesJson && strlen(profilesJson) > 0) {
+		profiles = ParseProfiles(profilesJson);
 	}
 
-	const char *source = config_get_string(config, "AudioStreamer", "AudioSource");
-	if (source && strlen(source) > 0) {
-		std::lock_guard<std::recursive_mutex> lock(m_sourceMutex);
-		m_audioSourceName = source;
+	if (profiles.empty()) {
+		// Settings saved before stream profiles existed describe a single stream
+		StreamProfile profile;
+		const char *url = config_get_string(config, "AudioStreamer", "WebSocketUrl");
+		if (url && strlen(url) > 0) {
+			profile.urls = url;
+		}
+		const char *source = config_get_string(config, "AudioStreamer", "AudioSource");
+		if (source && strlen(source) > 0) {
+			profile.audioSource = source;
+		}
+		profile.nativeWebSocket = config_get_bool(config, "AudioStreamer", "NativeWebSocket");
+		// Receivers keyed on the old sourceId must not notice the upgrade
+		profile.legacySourceId = true;
+		profiles.push_back(profile);
 	}
+	SetProfiles(std::move(profiles));
 
 	bool autoConnect = config_get_bool(config, "AudioStreamer", "AutoConnect");
 	m_autoConnectEnabled.store(autoConnect);
-}
-
-void AudioStreamer::ConnectToWebSocket()
-{
-	if (!m_wsClient) {
-		m_wsClient = std::make_shared<WebSocketPPClient>();
 
-		m_wsClient->SetOnConnected([this]() { OnWebSocketConnected(); });
-		m_wsClient->SetOnDisconnected([this]() { OnWebSocketDisconnected(); });
-		m_wsClient->SetOnMessage([this](const std::string &msg) { OnWebSocketMessage(msg); });
-		m_wsClient->SetOnError([this](const std::string &err) { OnWebSocketError(err); });
+	m_serverEnabled.store(config_get_bool(config, "AudioStreamer", "ServerEnabled"));
+	int port = static_cast<int>(config_get_int(config, "AudioStreamer", "ServerPort"));
+	if (port > 0 && port <= 65535) {
+		m_serverPort.store(port);
 	}
 
-	std::string url;
-	{
-		std::lock_guard<std::mutex> lock(m_urlMutex);
-		url = m_wsUrl;
-	}
-	m_wsClient->Connect(url);
-}
+	// Advanced, config file only: DSCP code point for outgoing WebSocket traffic (0 = OS default)
+	int dscp = static_cast<int>(config_get_int(config, "AudioStreamer", "Dscp"));
+	m_dscp.store(std::clamp(dscp, 0, 63));
 
-void AudioStreamer::DisconnectFromWebSocket()
-{
-	if (m_wsClient) {
-		m_wsClient->SendControlMessage("stop");
-		m_wsClient->Disconnect();
+	// Advanced, config file only: CPU budget per block in percent of its duration (0 = default, -1 = off)
+	int cpuBudget = static_cast<int>(config_get_int(config, "AudioStreamer", "CpuBudgetPercent"));
+	if (cpuBudget < 0) {
+		m_cpuBudget.store(0.0);
+	} else {
+		cpuBudget = cpuBudget == 0 ? constants::DEFAULT_CPU_BUDGET_PERCENT : std::min(cpuBudget, 100);
+		m_cpuBudget.store(cpuBudget / 100.0);
 	}
-}
 
-void AudioStreamer::AttachAudioSource()
-{
-	std::lock_guard<std::recursive_mutex> lock(m_sourceMutex);
+	// Advanced, config file only: let endpoints start, stop and fetch traces
+	m_remoteTraceControl.store(config_get_bool(config, "AudioStreamer", "RemoteTraceControl"));
 
-	if (m_audioSourceName.empty()) {
-		blog(LOG_WARNING, "[Audio to WebSocket] No audio source name specified");
-		return;
-	}
+	// Advanced, config file only: shared network thread pool (0 = sized from the CPU count)
+	int networkThreads = static_cast<int>(config_get_int(config, "AudioStreamer", "NetworkThreads"));
+	IoContextPool::Instance().Configure(static_cast<size_t>(std::max(networkThreads, 0)),
+					    config_get_bool(config, "AudioStreamer", "PinNetworkThreads"));
 
-	// Check if already attached to the same source
-	if (m_audioSource && m_audioSourceName == m_audioSource.get_name()) {
-		return;
-	}
+	// Advanced, config file only: encoder threads (0 = one per core but one, -1 = encode on the capture thread)
+	int encoderThreads = static_cast<int>(config_get_int(config, "AudioStreamer", "EncoderThreads"));
+	EncoderPool::Instance().Configure(static_cast<size_t>(std::max(encoderThreads, 0)), encoderThreads >= 0);
 
-	// Detach any existing source first
-	DetachAudioSource();
-
-	// Get the source by name
-	m_audioSource = OBSSourceWrapper(m_audioSourceName);
-	if (!m_audioSource) {
-		blog(LOG_ERROR, "[Audio to WebSocket] Audio source '%s' not found", m_audioSourceName.c_str());
-		emit errorOccurred(QString("Audio source not found"));
-		// Stop streaming if source attachment fails
-		if (m_streaming) {
-			Stop();
+	// Advanced, config file only: Prometheus endpoint on 127.0.0.1 (0 = off)
+	int metricsPort = static_cast<int>(config_get_int(config, "AudioStreamer", "MetricsPort"));
+	if (metricsPort > 0 && metricsPort <= 65535 && !m_metrics) {
+		m_metrics = std::make_shared<MetricsServer>([this]() { return RenderMetrics(); });
+		if (!m_metrics->Start(static_cast<uint16_t>(metricsPort))) {
+			m_metrics.reset();
 		}
-		return;
 	}
-
-	// Verify it's an audio source
-	if (!m_audioSource.is_audio_source()) {
-		blog(LOG_ERROR, "[Audio to WebSocket] Source '%s' is not an audio source", m_audioSourceName.c_str());
-		emit errorOccurred(QString("Selected source is not an audio source"));
-		m_audioSource.reset();
-		// Stop streaming if source attachment fails
-		if (m_streaming) {
-			Stop();
-		}
-		return;
-	}
-
-	// Use OBS audio capture API with static callback
-	obs_source_add_audio_capture_callback(m_audioSource.get(), AudioCaptureCallback, this);
 }
 
-void AudioStreamer::DetachAudioSource()
+void AudioStreamer::Shutdown()
 {
-	std::lock_guard<std::recursive_mutex> lock(m_sourceMutex);
-
-	if (m_audioSource) {
-		// Remove audio capture callback
-		obs_source_remove_audio_capture_callback(m_audioSource.get(), AudioCaptureCallback, this);
+	Stop();
+	m_metrics.reset();
+	std::atomic_exchange(&m_server, std::shared_ptr<WebSocketPPServer>()).reset();
 
-		// RAII wrapper will handle release
-		m_audioSource.reset();
-	}
+	std::lock_guard<std::mutex> lock(m_filterPipelinesMutex);
+	m_filterPipelines.clear();
 }
 
-void AudioStreamer::AudioCaptureCallback(void *param, obs_source_t *source, const struct audio_data *audio_data,
-					 bool muted)
+void AudioStreamer::AddFilterPipeline(const std::string &label, std::shared_ptr<StreamPipeline> pipeline)
 {
-	auto *streamer = static_cast<AudioStreamer *>(param);
-	streamer->ProcessAudioData(source, audio_data, muted);
+	std::lock_guard<std::mutex> lock(m_filterPipelinesMutex);
+	m_filterPipelines.emplace_back(label, std::move(pipeline));
 }
 
-void AudioStreamer::ProcessAudioData(obs_source_t *source, const struct audio_data *audio_data, bool muted)
+void AudioStreamer::RemoveFilterPipeline(const std::shared_ptr<StreamPipeline> &pipeline)
 {
-	static bool first_call = true;
-	static int callback_count = 0;
-	callback_count++;
-
-	first_call = false;
-
-	bool is_connected = m_wsClient && m_wsClient->IsConnected();
-
-	if (m_shuttingDown || !m_streaming || muted || !m_wsClient || !is_connected) {
-		return;
-	}
-
-	const audio_output_info *aoi = audio_output_get_info(obs_get_audio());
-	if (!aoi)
-		return;
+	std::lock_guard<std::mutex> lock(m_filterPipelinesMutex);
+	m_filterPipelines.erase(std::remove_if(m_filterPipelines.begin(), m_filterPipelines.end(),
+					       [&pipeline](const auto &entry) { return entry.second == pipeline; }),
+				m_filterPipelines.end());
+}
 
-	// Verify audio format
-	if (aoi->format != AUDIO_FORMAT_FLOAT_PLANAR) {
-		static bool format_error_logged = false;
-		if (!format_error_logged) {
-			format_error_logged = true;
-			blog(LOG_ERROR, "[Audio to WebSocket] Unexpected audio format: %d (expected FLOAT_PLANAR)",
-			     aoi->format);
+std::string AudioStreamer::RenderMetrics() const
+{
+	// Each histogram is copied bucket by bucket, so a scrape costs the same however much audio has flowed
+	struct Stream {
+		std::string labels;
+		bool connected;
+		uint64_t packetsSent, bytesSent, packetsDropped, formatRung, formatSwitches, budgetOverruns, shedStage,
+			blocksShed;
+		HistogramSnapshot callback, queueWait, encode, captureToSend, queueDepth, sinkBuffer, captureToConsumer,
+			syncRtt;
+	};
+	std::vector<std::unique_ptr<Stream>> streams;
+	auto addStream = [&streams](const std::string &name, const StreamPipeline &pipeline) {
+		const PipelineStats &stats = pipeline.GetStats();
+		auto stream = std::make_unique<Stream>();
+		stream->labels = PrometheusWriter::Label("stream", name);
+		stream->connected = pipeline.IsConnected();
+		stream->packetsSent = stats.packetsSent.load(std::memory_order_relaxed);
+		stream->bytesSent = stats.bytesSent.load(std::memory_order_relaxed);
+		stream->packetsDropped = stats.packetsDropped.load(std::memory_order_relaxed);
+		stream->formatRung = stats.formatRung.load(std::memory_order_relaxed);
+		stream->formatSwitches = stats.formatSwitches.load(std::memory_order_relaxed);
+		stream->budgetOverruns = stats.budgetOverruns.load(std::memory_order_relaxed);
+		stream->shedStage = stats.shedStage.load(std::memory_order_relaxed);
+		stream->blocksShed = stats.blocksShed.load(std::memory_order_relaxed);
+		stream->callback.Add(stats.callbackNs);
+		stream->queueWait.Add(stats.queueWaitNs);
+		stream->encode.Add(stats.encodeNs);
+		stream->captureToSend.Add(stats.captureToSendNs);
+		stream->queueDepth.Add(stats.encoderQueueDepth);
+		stream->sinkBuffer.Add(stats.sinkQueueBytes);
+		stream->captureToConsumer.Add(stats.captureToConsumerNs);
+		stream->syncRtt.Add(stats.clockSyncRttNs);
+		streams.push_back(std::move(stream));
+	};
+	if (auto pipelines = GetPipelines()) {
+		for (const auto &pipeline : *pipelines) {
+			addStream(pipeline->GetProfile().name, *pipeline);
 		}
-		return;
 	}
-
-	uint32_t sample_rate = aoi->samples_per_sec;
-	uint32_t channels = static_cast<uint32_t>(audio_output_get_channels(obs_get_audio()));
-
-	// Validate channel count
-	if (channels > 8) { // OBS max is 8 channels
-		static bool channel_error_logged = false;
-		if (!channel_error_logged) {
-			channel_error_logged = true;
-			blog(LOG_ERROR, "[Audio to WebSocket] Too many channels: %u (max 8)", channels);
+	{
+		std::lock_guard<std::mutex> lock(m_filterPipelinesMutex);
+		for (const auto &[label, pipeline] : m_filterPipelines) {
+			addStream(label, *pipeline);
 		}
-		return;
 	}
 
-	// Convert to 16-bit PCM if needed
-	size_t frames = audio_data->frames;
-	size_t sample_size = sizeof(int16_t);
-	size_t data_size = frames * channels * sample_size;
-
-	AudioChunk chunk;
-	chunk.data.resize(data_size);
-	chunk.timestamp = audio_data->timestamp;
-	chunk.format = AudioFormat(sample_rate, channels, 16);
-	chunk.sourceId = obs_source_get_name(source);
-	chunk.sourceName = obs_source_get_name(source);
-
-	// Copy and convert audio data to 16-bit signed PCM (little-endian)
-	uint8_t *out_ptr = chunk.data.data();
-
-	// Variables for audio level analysis
-	float peak_level = 0.0f;
-	float rms_sum = 0.0f;
-	size_t total_samples = 0;
-
-	// Process audio frame by frame (interleaved output)
-	size_t out_idx = 0;
-	for (size_t i = 0; i < frames; ++i) {
-		for (size_t ch = 0; ch < channels; ++ch) {
-			// Validate that this channel's data exists
-			if (!audio_data->data[ch]) {
-				blog(LOG_ERROR, "[Audio to WebSocket] Missing data for channel %zu", ch);
-				return;
-			}
-
-			const float *in_ptr = reinterpret_cast<const float *>(audio_data->data[ch]);
-			float sample = in_ptr[i];
-
-			// Track audio levels
-			float abs_sample = std::abs(sample);
-			if (abs_sample > peak_level) {
-				peak_level = abs_sample;
-			}
-			rms_sum += sample * sample;
-			total_samples++;
-
-			// Clamp to [-1, 1] range
-			sample = (std::max)(-1.0f, (std::min)(1.0f, sample));
-			// Convert to 16-bit signed PCM with proper rounding
-			int16_t sample_16 = static_cast<int16_t>(std::round(sample * 32767.0f));
-
-			// Write in little-endian format explicitly
-			out_ptr[out_idx++] = sample_16 & 0xFF;        // Low byte
-			out_ptr[out_idx++] = (sample_16 >> 8) & 0xFF; // High byte
+	static const std::vector<uint64_t> latencyBounds = {
+		10000,    25000,    50000,     100000,    250000,    500000,     1000000,    2500000,   5000000,
+		10000000, 25000000, 50000000, 100000000, 250000000, 500000000, 1000000000, 2500000000};
+	static const std::vector<uint64_t> depthBounds = {0, 1, 2, 4, 8, 16, 32, 64, 128};
+	static const std::vector<uint64_t> byteBounds = {0,          4 * 1024,   16 * 1024,  64 * 1024,
+							 128 * 1024, 256 * 1024, 512 * 1024, 1024 * 1024};
+
+	PrometheusWriter writer;
+	writer.Family("obs_audio_ws_streaming", "gauge", "1 while the dialog's streams are started");
+	writer.Sample("obs_audio_ws_streaming", "", static_cast<uint64_t>(IsStreaming() ? 1 : 0));
+	writer.Family("obs_audio_ws_server_subscribers", "gauge", "Consumers connected to the embedded server");
+	writer.Sample("obs_audio_ws_server_subscribers", "", static_cast<uint64_t>(GetSubscriberCount()));
+
+	auto perStream = [&](const char *name, const char *type, const char *help, auto value) {
+		writer.Family(name, type, help);
+		for (const auto &stream : streams) {
+			writer.Sample(name, stream->labels, static_cast<uint64_t>(value(*stream)));
 		}
-	}
+	};
+	perStream("obs_audio_ws_connected", "gauge", "1 while at least one endpoint of the stream is connected",
+		[](const Stream &s) { return s.connected ? 1 : 0; });
+	perStream("obs_audio_ws_packets_sent_total", "counter", "Packets written out, summed over endpoints",
+		[](const Stream &s) { return s.packetsSent; });
+	perStream("obs_audio_ws_bytes_sent_total", "counter", "Bytes written out, summed over endpoints",
+		[](const Stream &s) { return s.bytesSent; });
+	perStream("obs_audio_ws_packets_dropped_total", "counter", "Packets dropped by full or failing endpoints",
+		[](const Stream &s) { return s.packetsDropped; });
+	perStream("obs_audio_ws_format_rung", "gauge", "Adaptive streams: current rung of the format ladder, 0 = best",
+		[](const Stream &s) { return s.formatRung; });
+	perStream("obs_audio_ws_format_switches_total", "counter", "Adaptive streams: format ladder switches",
+		[](const Stream &s) { return s.formatSwitches; });
+	perStream("obs_audio_ws_budget_overruns_total", "counter", "Blocks whose processing overran the CPU budget",
+		[](const Stream &s) { return s.budgetOverruns; });
+	perStream("obs_audio_ws_shed_stage", "gauge",
+		"Optional work shed by the CPU watchdog: 0 none, 1 metering, 2 features, 3 resampling, 4 packets",
+		[](const Stream &s) { return s.shedStage; });
+	perStream("obs_audio_ws_blocks_shed_total", "counter",
+		"Blocks dropped unprocessed: shed by the CPU watchdog or with the encoder lane full",
+		[](const Stream &s) { return s.blocksShed; });
+
+	auto histogram = [&](const char *name, const char *help, HistogramSnapshot Stream::*member,
+			     const std::vector<uint64_t> &bounds, double scale) {
+		writer.Family(name, "histogram", help);
+		for (const auto &stream : streams) {
+			writer.Histogram(name, stream->labels, (*stream).*member, bounds, scale);
+		}
+	};
+	histogram("obs_audio_ws_callback_seconds", "OBS audio callback duration", &Stream::callback, latencyBounds,
+		  1e9);
+	histogram("obs_audio_ws_queue_wait_seconds", "Time a block waits on its encoder lane", &Stream::queueWait,
+		  latencyBounds, 1e9);
+	histogram("obs_audio_ws_encode_seconds", "Conversion, serialization and hand-off to endpoints",
+		  &Stream::encode, latencyBounds, 1e9);
+	histogram("obs_audio_ws_capture_to_send_seconds", "Audio callback until an endpoint wrote the packet",
+		  &Stream::captureToSend, latencyBounds, 1e9);
+	histogram("obs_audio_ws_encoder_queue_depth", "Blocks already queued on the encoder lane at post",
+		  &Stream::queueDepth, depthBounds, 1.0);
+	histogram("obs_audio_ws_sink_queue_bytes", "Bytes already buffered in an endpoint when a packet is queued",
+		  &Stream::sinkBuffer, byteBounds, 1.0);
+	histogram("obs_audio_ws_capture_to_consumer_seconds", "Audio timestamp until a consumer received it (acks)",
+		  &Stream::captureToConsumer, latencyBounds, 1e9);
+	histogram("obs_audio_ws_clock_sync_rtt_seconds", "Round trip of clock sync exchanges with consumers",
+		  &Stream::syncRtt, latencyBounds, 1e9);
+	return writer.Text();
+}
+
+double AudioStreamer::GetDataRate() const
+{
+	auto pipelines = GetPipelines();
+	if (!pipelines)
+		return 0.0;
 
-	// Calculate RMS level
-	float rms_level = 0.0f;
-	if (total_samples > 0) {
-		rms_level = std::sqrt(rms_sum / total_samples);
+	double total = 0.0;
+	for (const auto &pipeline : *pipelines) {
+		total += pipeline->GetDataRate();
 	}
+	return total;
+}
+
+bool AudioStreamer::IsConnected() const
+{
+	if (GetSubscriberCount() > 0)
+		return true;
 
-	// Log audio format info only once at startup
-	static bool format_logged = false;
-	if (!format_logged) {
-		format_logged = true;
-		blog(LOG_INFO, "[Audio to WebSocket] Streaming %u Hz, %u ch, 16-bit PCM (LE)", sample_rate, channels);
-		blog(LOG_INFO, "[Audio to WebSocket] Source: %s, Format: FLOAT_PLANAR", obs_source_get_name(source));
-		blog(LOG_INFO, "[Audio to WebSocket] Frame size: %zu samples, Buffer: %.1fms", frames,
-		     (frames * 1000.0f) / sample_rate);
-
-		// Log first few samples for debugging (only once)
-		if (frames > 0 && channels > 0 && audio_data->data[0]) {
-			const float *first_channel = reinterpret_cast<const float *>(audio_data->data[0]);
-			blog(LOG_INFO, "[Audio to WebSocket] First 5 samples (ch0): %.4f %.4f %.4f %.4f %.4f",
-			     first_channel[0], first_channel[1], first_channel[2], first_channel[3], first_channel[4]);
+	auto pipelines = GetPipelines();
+	if (!pipelines)
+		return false;
+
+	return std::any_of(pipelines->begin(), pipelines->end(),
+			   [](const std::shared_ptr<StreamPipeline> &pipeline) { return pipeline->IsConnected(); });
+}
+
+void AudioStreamer::StartPipelines()
+{
+	std::vector<StreamProfile> profiles = GetProfiles();
+	size_t enabledCount = std::count_if(profiles.begin(), profiles.end(),
+					    [](const StreamProfile &profile) { return profile.enabled; });
+	WebSocketPPServer *server = m_server && m_server->IsRunning() ? m_server.get() : nullptr;
+
+	// Mix track profiles stream every selected track separately
+	std::vector<StreamProfile> streams;
+	for (const auto &profile : profiles) {
+		if (!profile.enabled)
+			continue;
+
+		std::vector<StreamProfile> expanded = ExpandMixTracks(profile);
+		if (expanded.empty()) {
+			blog(LOG_WARNING, "[Audio to WebSocket] Profile '%s': no output track selected", profile.name.c_str());
+			emit errorOccurred(QString::fromStdString(profile.name + ": no output track selected"));
 		}
+		streams.insert(streams.end(), expanded.begin(), expanded.end());
 	}
 
-	// Only warn about silence, don't log normal levels
-	static int silence_counter = 0;
-	if (peak_level < 0.0001f) { // Essentially silence (-80 dB)
-		silence_counter++;
-		if (silence_counter == 500) { // After ~10 seconds at 48kHz
-			blog(LOG_WARNING, "[Audio to WebSocket] No audio detected - check source");
+	auto pipelines = std::make_shared<PipelineList>();
+	for (const auto &stream : streams) {
+		auto pipeline = std::make_shared<StreamPipeline>(stream);
+		std::weak_ptr<StreamPipeline> weakPipeline = pipeline;
+		std::string prefix = streams.size() > 1 ? stream.name + ": " : std::string();
+
+		pipeline->SetOnConnectionChanged([this]() { emit connectionStatusChanged(IsConnected()); });
+		pipeline->SetOnError(
+			[this, prefix](const std::string &err) { emit errorOccurred(QString::fromStdString(prefix + err)); });
+		pipeline->SetOnFailed([this, weakPipeline]() {
+			// Stopping waits on network threads, so leave the one reporting the failure first
+			QMetaObject::invokeMethod(this, [this, weakPipeline]() { OnPipelineFailed(weakPipeline); },
+						  Qt::QueuedConnection);
+		});
+		pipeline->SetOnDataRate([this]() { emit dataRateChanged(GetDataRate()); });
+		QString name = QString::fromStdString(stream.name);
+		pipeline->SetOnCpuLoad([this, name](ShedStage stage, bool degraded) {
+			emit cpuLoadChanged(name, ShedStageName(stage), degraded);
+		});
+		pipeline->SetCpuBudget(m_cpuBudget.load());
+		pipeline->SetRemoteTraceControl(m_remoteTraceControl.load());
+
+		if (pipeline->Start(server, m_dscp.load(), std::make_unique<ObsAudioInput>(stream))) {
+			pipelines->push_back(pipeline);
 		}
-	} else {
-		silence_counter = 0;
 	}
 
-	if (m_wsClient) {
-		m_wsClient->SendAudioData(chunk);
+	if (enabledCount == 0) {
+		blog(LOG_WARNING, "[Audio to WebSocket] No stream profile is enabled");
+		emit errorOccurred("No stream profile is enabled");
 	}
-	UpdateDataRate(data_size);
-}
 
-void AudioStreamer::OnWebSocketConnected()
-{
-	emit connectionStatusChanged(true);
+	std::atomic_store(&m_pipelines, std::shared_ptr<const PipelineList>(pipelines));
 }
 
-void AudioStreamer::OnWebSocketDisconnected()
+void AudioStreamer::StopPipelines()
 {
-	emit connectionStatusChanged(false);
-}
+	auto pipelines = std::atomic_exchange(&m_pipelines, std::shared_ptr<const PipelineList>());
+	if (!pipelines)
+		return;
 
-void AudioStreamer::OnWebSocketMessage(const std::string &message)
-{
-	UNUSED_PARAMETER(message);
-	// Handle status messages from server
-	try {
-		// Parse JSON status message if needed
-	} catch (...) {
-		// Ignore parse errors
+	for (const auto &pipeline : *pipelines) {
+		pipeline->Stop();
 	}
 }
 
-void AudioStreamer::OnWebSocketError(const std::string &error)
+void AudioStreamer::OnPipelineFailed(const std::weak_ptr<StreamPipeline> &weakPipeline)
 {
-	emit errorOccurred(QString::fromStdString(error));
+	auto pipeline = weakPipeline.lock();
+	if (!pipeline || !pipeline->IsRunning())
+		return;
 
-	// Stop streaming if connection permanently failed
-	if (error.find("Max reconnection attempts exceeded") != std::string::npos) {
-		blog(LOG_ERROR, "[Audio to WebSocket] Connection permanently failed, stopping stream");
-		Stop();
+	pipeline->Stop();
+
+	// Other profiles keep streaming on their own connections
+	auto pipelines = GetPipelines();
+	bool othersRunning = pipelines && std::any_of(pipelines->begin(), pipelines->end(),
+						      [](const std::shared_ptr<StreamPipeline> &other) {
+							      return other->IsRunning();
+						      });
+	if (othersRunning) {
+		blog(LOG_ERROR, "[Audio to WebSocket] Stopped profile '%s'", pipeline->GetProfile().name.c_str());
+		emit connectionStatusChanged(IsConnected());
+		return;
 	}
+
+	blog(LOG_ERROR, "[Audio to WebSocket] Connection permanently failed, stopping stream");
+	Stop();
 }
 
-void AudioStreamer::UpdateDataRate(size_t bytes)
+void AudioStreamer::StartServer()
 {
-	std::lock_guard<std::mutex> lock(m_rateMutex);
-
-	m_bytesSinceLastUpdate += bytes;
+	if (!m_serverEnabled)
+		return;
 
-	auto now = std::chrono::steady_clock::now();
-	auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_lastRateUpdate);
+	if (!m_server) {
+		auto server = std::make_shared<WebSocketPPServer>();
+		server->SetOnSubscribersChanged([this](size_t count) {
+			UNUSED_PARAMETER(count);
+			emit connectionStatusChanged(IsConnected());
+		});
+		server->SetOnError([this](const std::string &err) { emit errorOccurred(QString::fromStdString(err)); });
+		std::atomic_store(&m_server, server);
+	}
 
-	if (elapsed.count() >= 1000) {                                          // Update every second
-		double kbps = (m_bytesSinceLastUpdate * 8.0) / elapsed.count(); // Convert to kilobits per second
-		m_dataRate = kbps;
+	m_server->Start(static_cast<uint16_t>(m_serverPort.load()));
+}
 
-		m_bytesSinceLastUpdate = 0;
-		m_lastRateUpdate = now;
+size_t AudioStreamer::GetSubscriberCount() const
+{
+	auto server = std::atomic_load(&m_server);
+	return server ? server->GetSubscriberCount() : 0;
+}
 
-		emit dataRateChanged(kbps);
+void AudioStreamer::StopServer()
+{
+	if (m_server) {
+		m_server->BroadcastControlText(MakeControlMessage("stop"));
+		m_server->Stop();
 	}
 }
 
@@ -0,0 +1,116 @@
+#include "obs-audio-to-websocket/bitrate-controller.hpp"
+#include <algorithm>
+
+namespace obs_audio_to_websocket {
+
+namespace {
+
+constexpr uint64_t NS_PER_MS = 1000000;
+
+} // namespace
+
+BitrateController::BitrateController(size_t rungs, BitrateControllerSettings settings)
+	: m_rungs(std::max<size_t>(rungs, 1)),
+	  m_settings(settings)
+{
+	Reset();
+}
+
+void BitrateController::Reset()
+{
+	m_rung = 0;
+	m_reason = Reason::None;
+	m_switched = false;
+	m_lastSwitchUp = false;
+	m_lastSwitchNs = 0;
+	m_clearSinceNs = 0;
+	m_stepUpAfterNs = m_settings.stepUpAfterMs * NS_PER_MS;
+	m_previousQueuedBytes = 0;
+	m_growingEvaluations = 0;
+}
+
+BitrateController::Reason BitrateController::Diagnose(const LinkSignals &signals)
+{
+	bool draining = signals.queuedBytes < m_previousQueuedBytes;
+	m_growingEvaluations = signals.queuedBytes > m_previousQueuedBytes ? m_growingEvaluations + 1 : 0;
+	m_previousQueuedBytes = signals.queuedBytes;
+
+	if (signals.newDrops > 0)
+		return Reason::Drops;
+
+	// A deep backlog that is draining was left by a faster rung; the current one is keeping up
+	uint64_t backlogMs = signals.bytesPerSecond ? signals.queuedBytes * 1000 / signals.bytesPerSecond : 0;
+	if ((backlogMs >= m_settings.congestedBacklogMs && !draining) ||
+	    (m_growingEvaluations >= m_settings.growthEvaluations && backlogMs >= m_settings.clearBacklogMs))
+		return Reason::Backlog;
+
+	if (signals.rttGrowthNs >= static_cast<int64_t>(m_settings.rttGrowthMs * NS_PER_MS))
+		return Reason::Latency;
+
+	return backlogMs < m_settings.clearBacklogMs ? Reason::Recovered : Reason::None;
+}
+
+bool BitrateController::Update(const LinkSignals &signals, uint64_t nowNs)
+{
+	Reason diagnosis = Diagnose(signals);
+	uint64_t sinceSwitch = m_switched ? nowNs - m_lastSwitchNs : UINT64_MAX;
+
+	if (diagnosis == Reason::Recovered) {
+		if (!m_clearSinceNs) {
+			m_clearSinceNs = nowNs;
+		}
+		if (m_lastSwitchUp && sinceSwitch >= m_stepUpAfterNs) {
+			// The last probe held; the next one needn't wait longer than usual
+			m_stepUpAfterNs = m_settings.stepUpAfterMs * NS_PER_MS;
+			m_lastSwitchUp = false;
+		}
+		if (m_rung == 0 || nowNs - m_clearSinceNs < m_stepUpAfterNs || sinceSwitch < m_stepUpAfterNs)
+			return false;
+
+		--m_rung;
+		m_reason = Reason::Recovered;
+		m_lastSwitchUp = true;
+		m_switched = true;
+		m_lastSwitchNs = nowNs;
+		m_clearSinceNs = nowNs;
+		return true;
+	}
+
+	// Between clear and congested is the hysteresis band: no switch, and the clear stretch starts over
+	m_clearSinceNs = 0;
+	if (diagnosis == Reason::None)
+		return false;
+
+	if (m_lastSwitchUp && sinceSwitch < m_stepUpAfterNs) {
+		// The rung just probed can't be sustained
+		m_stepUpAfterNs = std::min<uint64_t>(m_stepUpAfterNs * 2, m_settings.maxStepUpAfterMs * NS_PER_MS);
+	}
+	m_lastSwitchUp = false;
+	if (m_rung + 1 >= m_rungs || sinceSwitch < m_settings.stepDownHoldMs * NS_PER_MS)
+		return false;
+
+	++m_rung;
+	m_reason = diagnosis;
+	m_switched = true;
+	m_lastSwitchNs = nowNs;
+	return true;
+}
+
+const char *BitrateReasonName(BitrateController::Reason reason)
+{
+	switch (reason) {
+	case BitrateController::Reason::Drops:
+		return "drops";
+	case BitrateController::Reason::Backlog:
+		return "backlog";
+	case BitrateController::Reason::Latency:
+		return "latency";
+	case BitrateController::Reason::Recovered:
+		return "recovered";
+	case BitrateController::Reason::None:
+	default:
+		return "none";
+	}
+}
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,41 @@
+#include "obs-audio-to-websocket/clock-sync.hpp"
+
+namespace obs_audio_to_websocket {
+
+bool ClockSync::AddSample(int64_t t1, int64_t t2, int64_t t3, int64_t t4)
+{
+	// Time on the wire both ways: the whole exchange minus the consumer's turnaround
+	int64_t rtt = (t4 - t1) - (t3 - t2);
+	if (rtt < 0 || t4 < t1)
+		return false;
+
+	m_samples[m_next] = {((t2 - t1) + (t3 - t4)) / 2, rtt};
+	m_next = (m_next + 1) % FILTER_SIZE;
+	if (m_count < FILTER_SIZE)
+		++m_count;
+
+	const Sample *best = &m_samples[0];
+	for (size_t i = 1; i < m_count; ++i) {
+		if (m_samples[i].rttNs < best->rttNs)
+			best = &m_samples[i];
+	}
+	m_offsetNs.store(best->offsetNs, std::memory_order_relaxed);
+	m_rttNs.store(best->rttNs, std::memory_order_relaxed);
+	m_lastRttNs.store(rtt, std::memory_order_relaxed);
+	int64_t minRtt = m_minRttNs.load(std::memory_order_relaxed);
+	if (minRtt == 0 || rtt < minRtt)
+		m_minRttNs.store(rtt, std::memory_order_relaxed);
+	m_valid.store(true, std::memory_order_release);
+	return true;
+}
+
+void ClockSync::Reset()
+{
+	m_count = 0;
+	m_next = 0;
+	m_lastRttNs.store(0, std::memory_order_relaxed);
+	m_minRttNs.store(0, std::memory_order_relaxed);
+	m_valid.store(false, std::memory_order_release);
+}
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,109 @@
+#include "obs-audio-to-websocket/cpu-watchdog.hpp"
+#include <algorithm>
+
+namespace obs_audio_to_websocket {
+
+namespace {
+
+constexpr uint64_t NS_PER_MS = 1000000;
+
+} // namespace
+
+const char *ShedStageName(ShedStage stage)
+{
+	switch (stage) {
+	case ShedStage::Metering:
+		return "level metering";
+	case ShedStage::Features:
+		return "feature extraction";
+	case ShedStage::Resampling:
+		return "high-quality resampling";
+	case ShedStage::Packets:
+		return "packets";
+	case ShedStage::None:
+	default:
+		return "nothing";
+	}
+}
+
+CpuWatchdog::CpuWatchdog(std::vector<ShedStage> stages, CpuBudgetSettings settings)
+	: m_stages(std::move(stages)),
+	  m_settings(settings)
+{
+	Reset();
+}
+
+void CpuWatchdog::Reset()
+{
+	m_level = 0;
+	m_blocks = 0;
+	m_overruns = 0;
+	m_costNs = 0;
+	m_budgetNs = 0;
+	m_clearSinceNs = 0;
+	m_restoredNs = 0;
+	m_restoreAfterNs = m_settings.restoreAfterMs * NS_PER_MS;
+}
+
+bool CpuWatchdog::Record(uint64_t costNs, uint64_t blockNs, uint64_t nowNs)
+{
+	uint64_t budgetNs = static_cast<uint64_t>(static_cast<double>(blockNs) * m_settings.budgetFraction);
+	if (costNs > budgetNs) {
+		++m_overruns;
+	}
+	m_costNs += costNs;
+	m_budgetNs += budgetNs;
+
+	m_changed = false;
+	if (++m_blocks >= m_settings.windowBlocks) {
+		EndWindow(nowNs);
+	}
+	return m_changed;
+}
+
+void CpuWatchdog::EndWindow(uint64_t nowNs)
+{
+	bool sustained = m_overruns >= m_settings.overrunsToShed;
+	bool clear = m_overruns == 0 &&
+		     static_cast<double>(m_costNs) < static_cast<double>(m_budgetNs) * m_settings.headroomFraction;
+	m_blocks = 0;
+	m_overruns = 0;
+	m_costNs = 0;
+	m_budgetNs = 0;
+
+	if (sustained) {
+		m_clearSinceNs = 0;
+		if (m_restoredNs && nowNs - m_restoredNs < m_restoreAfterNs) {
+			// The stage just restored can't be afforded yet
+			m_restoreAfterNs =
+				std::min<uint64_t>(m_restoreAfterNs * 2, m_settings.maxRestoreAfterMs * NS_PER_MS);
+		}
+		m_restoredNs = 0;
+		if (m_level < m_stages.size()) {
+			++m_level;
+			m_changed = true;
+		}
+		return;
+	}
+
+	if (!clear) {
+		m_clearSinceNs = 0;
+		return;
+	}
+	if (m_restoredNs && nowNs - m_restoredNs >= m_restoreAfterNs) {
+		// The last restore held
+		m_restoreAfterNs = m_settings.restoreAfterMs * NS_PER_MS;
+		m_restoredNs = 0;
+	}
+	if (!m_clearSinceNs) {
+		m_clearSinceNs = nowNs;
+	}
+	if (m_level > 0 && nowNs - m_clearSinceNs >= m_restoreAfterNs) {
+		--m_level;
+		m_changed = true;
+		m_clearSinceNs = nowNs;
+		m_restoredNs = nowNs;
+	}
+}
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,352 @@
+#include "obs-audio-to-websocket/encoder-pool.hpp"
+#include "obs-audio-to-websocket/trace.hpp"
+#include "obs-audio-to-websocket/log.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace obs_audio_to_websocket {
+
+namespace {
+
+constexpr size_t MAX_THREADS = 16;
+// Jobs a lane runs before going to the back of the queue, so one busy stream can't starve the rest
+constexpr size_t LANE_BATCH = 4;
+// Lanes the pool hands out at most; every worker queue has room for all of them (a power of two)
+constexpr size_t MAX_LANES = 256;
+// Longest an idle worker can miss a wakeup for, see WorkerLoop
+constexpr std::chrono::milliseconds WAKE_BACKSTOP{2};
+
+// Which pool and worker the current thread belongs to, if any
+thread_local EncoderPool *t_pool = nullptr;
+thread_local size_t t_worker = 0;
+
+} // namespace
+
+uint64_t ThreadCpuTimeNs()
+{
+#if defined(_WIN32)
+	FILETIME creation, exit, kernel, user;
+	if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+		return 0;
+	ULARGE_INTEGER k, u;
+	k.LowPart = kernel.dwLowDateTime;
+	k.HighPart = kernel.dwHighDateTime;
+	u.LowPart = user.dwLowDateTime;
+	u.HighPart = user.dwHighDateTime;
+	return (k.QuadPart + u.QuadPart) * 100; // 100 ns units
+#else
+	timespec ts;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+		return 0;
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+#endif
+}
+
+EncoderStream::~EncoderStream()
+{
+	Close();
+	m_pool->m_lanes.fetch_sub(1);
+}
+
+void EncoderStream::Post()
+{
+	if (m_closed.load(std::memory_order_relaxed))
+		return;
+	if (m_pending.fetch_add(1) == 0) {
+		m_pool->Schedule(this);
+	}
+}
+
+void EncoderStream::Close()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_closed = true;
+	// A queued lane is dropped by the worker that takes it; the queues hold plain pointers, so this must
+	// not return while the lane is still in one
+	m_idle.wait(lock, [this]() { return !m_running && m_pending.load() == 0; });
+}
+
+bool EncoderStream::RunSome()
+{
+	for (size_t i = 0; i < LANE_BATCH; ++i) {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_closed) {
+				m_pending = 0;
+				m_idle.notify_all();
+				return false;
+			}
+			m_running = true;
+		}
+
+		uint64_t start = ThreadCpuTimeNs();
+		try {
+			m_job();
+		} catch (const std::exception &e) {
+			blog(LOG_ERROR, "[Audio to WebSocket] Exception in encoder job: %s", e.what());
+		}
+		m_cpuNs.fetch_add(ThreadCpuTimeNs() - start, std::memory_order_relaxed);
+		m_jobs.fetch_add(1, std::memory_order_relaxed);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_running = false;
+		if (m_closed) {
+			m_pending = 0;
+		} else if (m_pending.fetch_sub(1) > 1) {
+			continue;
+		}
+		// Notified under the lock: once Close sees the lane idle it may destroy it
+		m_idle.notify_all();
+		return false;
+	}
+	return true;
+}
+
+void EncoderStream::Unschedule()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_pending = 0;
+	m_idle.notify_all();
+}
+
+EncoderPool::LaneQueue::LaneQueue() : m_cells(new Cell[MAX_LANES])
+{
+	for (size_t i = 0; i < MAX_LANES; ++i) {
+		m_cells[i].sequence.store(i, std::memory_order_relaxed);
+		m_cells[i].lane = nullptr;
+	}
+}
+
+bool EncoderPool::LaneQueue::Push(EncoderStream *lane)
+{
+	size_t pos = m_enqueue.load(std::memory_order_relaxed);
+	for (;;) {
+		Cell &cell = m_cells[pos & (MAX_LANES - 1)];
+		size_t sequence = cell.sequence.load(std::memory_order_acquire);
+		auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+		if (diff == 0) {
+			if (m_enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				cell.lane = lane;
+				cell.sequence.store(pos + 1, std::memory_order_release);
+				return true;
+			}
+		} else if (diff < 0) {
+			return false; // Full
+		} else {
+			pos = m_enqueue.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+EncoderStream *EncoderPool::LaneQueue::Pop()
+{
+	size_t pos = m_dequeue.load(std::memory_order_relaxed);
+	for (;;) {
+		Cell &cell = m_cells[pos & (MAX_LANES - 1)];
+		size_t sequence = cell.sequence.load(std::memory_order_acquire);
+		auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+		if (diff == 0) {
+			if (m_dequeue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				EncoderStream *lane = cell.lane;
+				cell.sequence.store(pos + MAX_LANES, std::memory_order_release);
+				return lane;
+			}
+		} else if (diff < 0) {
+			return nullptr; // Empty
+		} else {
+			pos = m_dequeue.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+EncoderPool &EncoderPool::Instance()
+{
+	static EncoderPool instance;
+	return instance;
+}
+
+EncoderPool::EncoderPool(size_t threads)
+{
+	Configure(threads);
+}
+
+EncoderPool::~EncoderPool()
+{
+	Stop();
+}
+
+void EncoderPool::Configure(size_t threads, bool enabled)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_configuredThreads = std::min(threads, MAX_THREADS);
+	m_enabled = enabled;
+}
+
+void EncoderPool::StartLocked()
+{
+	size_t count = m_configuredThreads;
+	if (count == 0) {
+		// Leave a core for OBS's own audio and render threads
+		count = std::clamp<size_t>(std::thread::hardware_concurrency(), 2, MAX_THREADS + 1) - 1;
+	}
+
+	for (size_t i = 0; i < count; ++i) {
+		m_workers.push_back(std::make_unique<Worker>());
+	}
+	// Threads start once every worker exists, since any of them may steal from any other
+	for (size_t i = 0; i < count; ++i) {
+		m_workers[i]->thread = std::thread([this, i]() { WorkerLoop(i); });
+	}
+	m_workerCount = count;
+
+	blog(LOG_INFO, "[Audio to WebSocket] Encoder pool started with %zu thread(s)", count);
+}
+
+std::shared_ptr<EncoderStream> EncoderPool::CreateStream(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_stopping)
+			return nullptr;
+		if (m_lanes.fetch_add(1) >= MAX_LANES) {
+			m_lanes.fetch_sub(1);
+			blog(LOG_WARNING, "[Audio to WebSocket] Encoder pool is full (%zu streams); encoding inline",
+			     MAX_LANES);
+			return nullptr;
+		}
+		if (m_workers.empty()) {
+			StartLocked();
+		}
+	}
+	return std::shared_ptr<EncoderStream>(new EncoderStream(this, std::move(job)));
+}
+
+void EncoderPool::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_workers.empty() || m_stopping)
+			return;
+		m_stopping = true;
+	}
+
+	// Schedule calls that got past the m_stopping check may still be pushing into the worker queues
+	while (m_scheduling.load() > 0) {
+		std::this_thread::yield();
+	}
+	{
+		std::lock_guard<std::mutex> wakeLock(m_wakeMutex);
+	}
+	m_wake.notify_all();
+
+	// Joined without m_mutex, so nothing that takes it waits on the join
+	for (auto &worker : m_workers) {
+		if (worker->thread.joinable()) {
+			worker->thread.join();
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	// Lanes still queued were never taken; they must not stay marked as scheduled
+	for (auto &worker : m_workers) {
+		while (EncoderStream *lane = worker->lanes.Pop()) {
+			lane->Unschedule();
+		}
+	}
+	m_workerCount = 0;
+	m_workers.clear();
+	m_pending = 0;
+	m_stopping = false;
+}
+
+size_t EncoderPool::GetThreadCount() const
+{
+	return m_workerCount.load();
+}
+
+void EncoderPool::Schedule(EncoderStream *lane)
+{
+	if (t_pool == this) {
+		// Posted from one of our own jobs: keep it local, idle workers will steal it if needed
+		Enqueue(t_worker, lane);
+		return;
+	}
+
+	// Paired with Stop: either it sees this call in progress, or this call sees m_stopping
+	m_scheduling.fetch_add(1);
+	size_t count = m_workerCount.load();
+	if (count > 0 && !m_stopping.load()) {
+		Enqueue(m_next.fetch_add(1, std::memory_order_relaxed) % count, lane);
+		m_scheduling.fetch_sub(1);
+		return;
+	}
+	m_scheduling.fetch_sub(1);
+	lane->Unschedule();
+}
+
+void EncoderPool::Enqueue(size_t index, EncoderStream *lane)
+{
+	if (!m_workers[index]->lanes.Push(lane)) {
+		// Can't happen while every lane fits in one queue; don't leave the lane marked scheduled
+		lane->Unschedule();
+		return;
+	}
+	m_pending.fetch_add(1);
+	if (m_sleeping.load() > 0) {
+		m_wake.notify_one();
+	}
+}
+
+EncoderStream *EncoderPool::TakeWork(size_t index)
+{
+	// Own queue first, oldest lane first
+	if (EncoderStream *lane = m_workers[index]->lanes.Pop()) {
+		m_pending.fetch_sub(1);
+		return lane;
+	}
+
+	// Then steal, starting from the next worker so thieves spread out
+	for (size_t i = 1; i < m_workers.size(); ++i) {
+		if (EncoderStream *lane = m_workers[(index + i) % m_workers.size()]->lanes.Pop()) {
+			m_pending.fetch_sub(1);
+			return lane;
+		}
+	}
+	return nullptr;
+}
+
+void EncoderPool::WorkerLoop(size_t index)
+{
+	t_pool = this;
+	t_worker = index;
+	Tracer::SetThreadName("encoder");
+
+	while (!m_stopping) {
+		EncoderStream *lane = TakeWork(index);
+		if (!lane) {
+			std::unique_lock<std::mutex> lock(m_wakeMutex);
+			m_sleeping.fetch_add(1);
+			// A notify that lands between the predicate check and the wait is lost, since posters don't
+			// take the mutex; the timeout bounds the delay that costs
+			m_wake.wait_for(lock, WAKE_BACKSTOP,
+					[this]() { return m_pending.load() > 0 || m_stopping.load(); });
+			m_sleeping.fetch_sub(1);
+			continue;
+		}
+
+		if (lane->RunSome()) {
+			// More runs pending: back of our own queue, behind lanes that have been waiting
+			Enqueue(index, lane);
+		}
+	}
+}
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,26 @@
+#include "obs-audio-to-websocket/log.hpp"
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+
+// blog for builds of the core without libobs: the command-line tools and the benchmarks
+namespace {
+std::atomic<int> g_level{LOG_WARNING};
+}
+
+void SetHeadlessLogLevel(int level)
+{
+	g_level = level;
+}
+
+extern "C" void blog(int log_level, const char *format, ...)
+{
+	if (log_level > g_level.load(std::memory_order_relaxed))
+		return;
+
+	va_list args;
+	va_start(args, format);
+	vfprintf(stderr, format, args);
+	va_end(args);
+	fputc('\n', stderr);
+}
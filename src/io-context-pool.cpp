@@ -0,0 +1,162 @@
+#include "obs-audio-to-websocket/io-context-pool.hpp"
+#include "obs-audio-to-websocket/trace.hpp"
+#include "obs-audio-to-websocket/log.hpp"
+#include <algorithm>
+#include <future>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace obs_audio_to_websocket {
+
+namespace {
+
+// Network clients are mostly idle between small writes; a couple of threads serve dozens of sinks
+constexpr size_t DEFAULT_MAX_THREADS = 2;
+constexpr size_t MAX_THREADS = 16;
+
+bool PinThreadToCpu(std::thread &thread, unsigned cpu)
+{
+#if defined(_WIN32)
+	return SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << (cpu % (sizeof(DWORD_PTR) * 8))) != 0;
+#elif defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+	// macOS only offers affinity hints, not pinning
+	(void)thread;
+	(void)cpu;
+	return false;
+#endif
+}
+
+} // namespace
+
+IoContextPool &IoContextPool::Instance()
+{
+	static IoContextPool instance;
+	return instance;
+}
+
+IoContextPool::~IoContextPool()
+{
+	Stop();
+}
+
+void IoContextPool::Configure(size_t threads, bool pinThreads)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_configuredThreads = std::min(threads, MAX_THREADS);
+	m_pinThreads = pinThreads;
+}
+
+void IoContextPool::StartLocked()
+{
+	size_t count = m_configuredThreads;
+	if (count == 0) {
+		count = std::clamp<size_t>(std::thread::hardware_concurrency() / 4, 1, DEFAULT_MAX_THREADS);
+	}
+	unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+
+	for (size_t i = 0; i < count; ++i) {
+		auto worker = std::make_unique<Worker>();
+		worker->work = std::make_unique<asio::executor_work_guard<asio::io_context::executor_type>>(
+			worker->io.get_executor());
+		Worker *w = worker.get();
+		worker->thread = std::thread([w]() {
+			Tracer::SetThreadName("network");
+			// A throwing handler must not take the shared loop down with it
+			for (;;) {
+				try {
+					w->io.run();
+					break;
+				} catch (const std::exception &e) {
+					blog(LOG_ERROR, "[Audio to WebSocket] Exception in network event loop: %s", e.what());
+				}
+			}
+		});
+
+		if (m_pinThreads) {
+			// Spread from the last CPU down; OBS's own render/audio threads tend to start low
+			unsigned cpu = cpus - 1 - static_cast<unsigned>(i % cpus);
+			if (!PinThreadToCpu(worker->thread, cpu)) {
+				blog(LOG_WARNING, "[Audio to WebSocket] Could not pin network thread %zu to CPU %u", i, cpu);
+			}
+		}
+		m_workers.push_back(std::move(worker));
+	}
+
+	blog(LOG_INFO, "[Audio to WebSocket] Network thread pool started with %zu thread(s)%s", count,
+	     m_pinThreads ? ", pinned" : "");
+}
+
+asio::io_context &IoContextPool::Acquire()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_workers.empty()) {
+		StartLocked();
+	}
+	Worker &worker = *m_workers[m_next++ % m_workers.size()];
+	return worker.io;
+}
+
+void IoContextPool::Stop()
+{
+	std::vector<std::unique_ptr<Worker>> workers;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		workers.swap(m_workers);
+		m_next = 0;
+	}
+
+	for (auto &worker : workers) {
+		worker->work.reset();
+		worker->io.stop();
+	}
+	for (auto &worker : workers) {
+		if (worker->thread.joinable()) {
+			worker->thread.join();
+		}
+	}
+}
+
+size_t IoContextPool::GetThreadCount() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_workers.size();
+}
+
+void RunOnContext(asio::io_context &io, const std::function<void()> &fn)
+{
+	if (io.get_executor().running_in_this_thread() || io.stopped()) {
+		fn();
+		return;
+	}
+
+	// The handler owns the promise: if the pool stops before running it, destroying it breaks the promise
+	// instead of leaving this thread waiting forever
+	auto done = std::make_shared<std::promise<void>>();
+	std::future<void> finished = done->get_future();
+	asio::post(io, [&fn, done = std::move(done)]() {
+		try {
+			fn();
+			done->set_value();
+		} catch (...) {
+			done->set_exception(std::current_exception());
+		}
+	});
+
+	try {
+		finished.get();
+	} catch (const std::future_error &) {
+		blog(LOG_WARNING, "[Audio to WebSocket] Network thread stopped before a queued teardown could run");
+	}
+}
+
+} // namespace obs_audio_to_websocket
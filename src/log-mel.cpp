@@ -0,0 +1,260 @@
+#include "obs-audio-to-websocket/log-mel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace obs_audio_to_websocket {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr float LOG_FLOOR = 1e-10f;
+
+double HzToMel(double hz)
+{
+	return 2595.0 * std::log10(1.0 + hz / 700.0);
+}
+
+double MelToHz(double mel)
+{
+	return 700.0 * (std::pow(10.0, mel / 2595.0) - 1.0);
+}
+
+size_t NextPowerOfTwo(size_t n)
+{
+	size_t p = 1;
+	while (p < n) {
+		p <<= 1;
+	}
+	return p;
+}
+
+} // namespace
+
+LogMelExtractor::LogMelExtractor(uint32_t sampleRate, const FeatureSettings &settings)
+	: m_sampleRate(sampleRate),
+	  m_melBins(std::max(1u, settings.melBins))
+{
+	m_windowSize = std::max<size_t>(16, static_cast<size_t>(std::lround(sampleRate * settings.windowMs / 1000.0)));
+	m_hopSize = std::clamp<size_t>(static_cast<size_t>(std::lround(sampleRate * settings.hopMs / 1000.0)), 1,
+				       m_windowSize);
+	m_fftSize = NextPowerOfTwo(m_windowSize);
+	const size_t half = m_fftSize / 2;
+
+	// Periodic Hann, the usual choice for STFT features
+	m_window.resize(m_windowSize);
+	for (size_t n = 0; n < m_windowSize; ++n) {
+		m_window[n] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * PI * n / m_windowSize));
+	}
+
+	m_re.resize(half);
+	m_im.resize(half);
+	m_power.resize(half + 1);
+
+	size_t bits = 0;
+	while ((size_t(1) << bits) < half) {
+		++bits;
+	}
+	m_bitReverse.resize(half);
+	for (size_t i = 0; i < half; ++i) {
+		uint32_t reversed = 0;
+		for (size_t b = 0; b < bits; ++b) {
+			reversed |= ((i >> b) & 1u) << (bits - 1 - b);
+		}
+		m_bitReverse[i] = reversed;
+	}
+
+	// Stage with butterfly span h uses twiddles e^{-2 pi i j / 2h}, j < h, stored at offset h - 1
+	m_twiddleRe.resize(half > 1 ? half - 1 : 0);
+	m_twiddleIm.resize(m_twiddleRe.size());
+	for (size_t span = 1; span < half; span <<= 1) {
+		for (size_t j = 0; j < span; ++j) {
+			double angle = -PI * j / span;
+			m_twiddleRe[span - 1 + j] = static_cast<float>(std::cos(angle));
+			m_twiddleIm[span - 1 + j] = static_cast<float>(std::sin(angle));
+		}
+	}
+
+	m_splitRe.resize(half + 1);
+	m_splitIm.resize(half + 1);
+	for (size_t k = 0; k <= half; ++k) {
+		double angle = -2.0 * PI * k / m_fftSize;
+		m_splitRe[k] = static_cast<float>(std::cos(angle));
+		m_splitIm[k] = static_cast<float>(std::sin(angle));
+	}
+
+	// Triangular filters on the HTK mel scale, evaluated at each bin's exact frequency
+	double maxMel = HzToMel(sampleRate / 2.0);
+	std::vector<double> edges(m_melBins + 2);
+	for (size_t i = 0; i < edges.size(); ++i) {
+		edges[i] = MelToHz(maxMel * i / (m_melBins + 1));
+	}
+
+	m_filterStart.resize(m_melBins);
+	m_filterWeights.resize(m_melBins);
+	for (size_t m = 0; m < m_melBins; ++m) {
+		double lower = edges[m], center = edges[m + 1], upper = edges[m + 2];
+		std::vector<float> weights;
+		size_t start = 0;
+		for (size_t k = 0; k <= half; ++k) {
+			double hz = static_cast<double>(k) * sampleRate / m_fftSize;
+			double weight = 0.0;
+			if (hz > lower && hz < upper) {
+				weight = hz <= center ? (hz - lower) / (center - lower) : (upper - hz) / (upper - center);
+			}
+			if (weight <= 0.0) {
+				if (!weights.empty())
+					break;
+				continue;
+			}
+			if (weights.empty()) {
+				start = k;
+			}
+			weights.push_back(static_cast<float>(weight));
+		}
+		m_filterStart[m] = start;
+		m_filterWeights[m] = std::move(weights);
+	}
+}
+
+void LogMelExtractor::Reset()
+{
+	m_pending.clear();
+}
+
+size_t LogMelExtractor::Process(const float *samples, size_t count, std::vector<float> &frames,
+				int64_t &firstFrameOffset)
+{
+	int64_t buffered = static_cast<int64_t>(m_pending.size());
+	m_pending.insert(m_pending.end(), samples, samples + count);
+
+	size_t produced = 0;
+	size_t pos = 0;
+	while (pos + m_windowSize <= m_pending.size()) {
+		if (produced == 0) {
+			firstFrameOffset = static_cast<int64_t>(pos) - buffered;
+		}
+		frames.resize(frames.size() + m_melBins);
+		ComputeFrame(m_pending.data() + pos, frames.data() + frames.size() - m_melBins);
+		pos += m_hopSize;
+		++produced;
+	}
+
+	// Hop never exceeds the window, so pos is always within the buffer
+	m_pending.erase(m_pending.begin(), m_pending.begin() + static_cast<std::ptrdiff_t>(pos));
+	return produced;
+}
+
+void LogMelExtractor::ComputeFrame(const float *window, float *out)
+{
+	const size_t half = m_fftSize / 2;
+
+	// Pack the windowed, zero-padded real frame as half as many complex values (even -> re, odd -> im),
+	// already in bit-reversed order for the in-place FFT
+	for (size_t n = 0; n < half; ++n) {
+		size_t even = 2 * n, odd = 2 * n + 1;
+		float re = even < m_windowSize ? window[even] * m_window[even] : 0.0f;
+		float im = odd < m_windowSize ? window[odd] * m_window[odd] : 0.0f;
+		m_re[m_bitReverse[n]] = re;
+		m_im[m_bitReverse[n]] = im;
+	}
+
+	Fft();
+
+	// Untangle the two interleaved half-size transforms into bins 0..N/2 of the real transform
+	for (size_t k = 0; k <= half; ++k) {
+		size_t a = k % half;
+		size_t b = (half - k) % half;
+		float ar = m_re[a], ai = m_im[a];
+		float br = m_re[b], bi = -m_im[b];
+
+		float evenRe = 0.5f * (ar + br), evenIm = 0.5f * (ai + bi);
+		float oddRe = 0.5f * (ai - bi), oddIm = -0.5f * (ar - br);
+
+		float wr = m_splitRe[k], wi = m_splitIm[k];
+		float xr = evenRe + wr * oddRe - wi * oddIm;
+		float xi = evenIm + wr * oddIm + wi * oddRe;
+		m_power[k] = xr * xr + xi * xi;
+	}
+
+	for (size_t m = 0; m < m_melBins; ++m) {
+		const std::vector<float> &weights = m_filterWeights[m];
+		const float *power = m_power.data() + m_filterStart[m];
+		float energy = 0.0f;
+		for (size_t i = 0; i < weights.size(); ++i) {
+			energy += weights[i] * power[i];
+		}
+		out[m] = std::log(std::max(energy, LOG_FLOOR));
+	}
+}
+
+void LogMelExtractor::Fft()
+{
+	const size_t n = m_fftSize / 2;
+	float *re = m_re.data();
+	float *im = m_im.data();
+
+	for (size_t span = 1; span < n; span <<= 1) {
+		const float *twRe = m_twiddleRe.data() + span - 1;
+		const float *twIm = m_twiddleIm.data() + span - 1;
+		for (size_t start = 0; start < n; start += 2 * span) {
+			float *aRe = re + start, *aIm = im + start;
+			float *bRe = aRe + span, *bIm = aIm + span;
+			// Contiguous, branch-free and independent across j: vectorized by the compiler
+			for (size_t j = 0; j < span; ++j) {
+				float tRe = bRe[j] * twRe[j] - bIm[j] * twIm[j];
+				float tIm = bRe[j] * twIm[j] + bIm[j] * twRe[j];
+				bRe[j] = aRe[j] - tRe;
+				bIm[j] = aIm[j] - tIm;
+				aRe[j] += tRe;
+				aIm[j] += tIm;
+			}
+		}
+	}
+}
+
+uint16_t FloatToHalf(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+	uint32_t rawExponent = (bits >> 23) & 0xFF;
+	uint32_t mantissa = bits & 0x7FFFFF;
+
+	if (rawExponent == 0xFF) {
+		// Infinity stays infinity, NaN stays a (quiet) NaN
+		return sign | 0x7C00 | (mantissa ? 0x200 : 0);
+	}
+
+	int32_t exponent = static_cast<int32_t>(rawExponent) - 127 + 15;
+	if (exponent >= 31) {
+		return sign | 0x7C00;
+	}
+
+	if (exponent <= 0) {
+		// Subnormal half (or zero)
+		if (exponent < -10) {
+			return sign;
+		}
+		mantissa |= 0x800000;
+		uint32_t shift = static_cast<uint32_t>(14 - exponent);
+		uint32_t result = mantissa >> shift;
+		uint32_t remainder = mantissa & ((1u << shift) - 1);
+		uint32_t halfway = 1u << (shift - 1);
+		if (remainder > halfway || (remainder == halfway && (result & 1))) {
+			++result;
+		}
+		return sign | static_cast<uint16_t>(result);
+	}
+
+	uint32_t result = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+	uint32_t remainder = mantissa & 0x1FFF;
+	// A carry out of the mantissa correctly bumps the exponent, up to infinity
+	if (remainder > 0x1000 || (remainder == 0x1000 && (result & 1))) {
+		++result;
+	}
+	return sign | static_cast<uint16_t>(result);
+}
+
+} // namespace obs_audio_to_websocket
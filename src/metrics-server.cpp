@@ -0,0 +1,239 @@
+#include "obs-audio-to-websocket/metrics-server.hpp"
+#include "obs-audio-to-websocket/io-context-pool.hpp"
+#include "obs-audio-to-websocket/log.hpp"
+#include <cstdio>
+
+namespace obs_audio_to_websocket {
+
+namespace {
+
+// Concurrent scrapes beyond this are refused; a monitoring agent needs one
+constexpr size_t MAX_SESSIONS = 8;
+constexpr int SESSION_TIMEOUT_MS = 5000;
+
+std::string FormatValue(double value)
+{
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%.9g", value);
+	return buffer;
+}
+
+std::string HttpResponse(const char *status, const char *contentType, const std::string &body)
+{
+	std::string response = std::string("HTTP/1.1 ") + status + "\r\n";
+	response += std::string("Content-Type: ") + contentType + "\r\n";
+	response += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+	response += "Connection: close\r\n\r\n";
+	response += body;
+	return response;
+}
+
+} // namespace
+
+void PrometheusWriter::Family(const char *name, const char *type, const char *help)
+{
+	m_text += std::string("# HELP ") + name + " " + help + "\n";
+	m_text += std::string("# TYPE ") + name + " " + type + "\n";
+}
+
+void PrometheusWriter::Sample(const char *name, const std::string &labels, double value)
+{
+	Line(name, "", labels, FormatValue(value));
+}
+
+void PrometheusWriter::Sample(const char *name, const std::string &labels, uint64_t value)
+{
+	Line(name, "", labels, std::to_string(value));
+}
+
+void PrometheusWriter::Histogram(const char *name, const std::string &labels, const HistogramSnapshot &histogram,
+				 const std::vector<uint64_t> &bounds, double scale)
+{
+	// A bucket counts towards a bound once its whole range lies at or below it, so each cumulative count
+	// is exact to within the histogram's 1/16 resolution
+	const auto &counts = histogram.GetCounts();
+	std::string prefix = labels.empty() ? std::string() : labels + ",";
+	uint64_t cumulative = 0;
+	size_t index = 0;
+	for (uint64_t bound : bounds) {
+		while (index < counts.size() && Histogram::BucketUpperBound(index) <= bound) {
+			cumulative += counts[index++];
+		}
+		Line(name, "_bucket", prefix + Label("le", FormatValue(bound / scale)), std::to_string(cumulative));
+	}
+	Line(name, "_bucket", prefix + "le=\"+Inf\"", std::to_string(histogram.GetCount()));
+	Line(name, "_sum", labels, FormatValue(histogram.GetSum() / scale));
+	Line(name, "_count", labels, std::to_string(histogram.GetCount()));
+}
+
+std::string PrometheusWriter::Label(const char *key, const std::string &value)
+{
+	std::string label = std::string(key) + "=\"";
+	for (char c : value) {
+		if (c == '\\' || c == '"') {
+			label += '\\';
+			label += c;
+		} else if (c == '\n') {
+			label += "\\n";
+		} else {
+			label += c;
+		}
+	}
+	label += '"';
+	return label;
+}
+
+void PrometheusWriter::Line(const char *name, const char *suffix, const std::string &labels, const std::string &value)
+{
+	m_text += name;
+	m_text += suffix;
+	if (!labels.empty()) {
+		m_text += "{" + labels + "}";
+	}
+	m_text += " " + value + "\n";
+}
+
+MetricsServer::MetricsServer(RenderCallback render)
+	: m_io(IoContextPool::Instance().Acquire()),
+	  m_acceptor(m_io),
+	  m_render(std::move(render))
+{
+}
+
+MetricsServer::~MetricsServer()
+{
+	Stop();
+}
+
+bool MetricsServer::Start(uint16_t port)
+{
+	if (m_running)
+		return false;
+
+	// Loopback only: the endpoint has no authentication
+	asio::error_code ec;
+	asio::ip::tcp::endpoint endpoint(asio::ip::address_v4::loopback(), port);
+	RunOnContext(m_io, [&]() {
+		m_acceptor.open(endpoint.protocol(), ec);
+		if (!ec)
+			m_acceptor.set_option(asio::socket_base::reuse_address(true), ec);
+		if (!ec)
+			m_acceptor.bind(endpoint, ec);
+		if (!ec)
+			m_acceptor.listen(asio::socket_base::max_listen_connections, ec);
+		if (ec) {
+			asio::error_code ignored;
+			m_acceptor.close(ignored);
+			return;
+		}
+		m_running = true;
+		StartAccept();
+	});
+
+	if (ec) {
+		blog(LOG_ERROR, "[Audio to WebSocket] Metrics endpoint could not listen on 127.0.0.1:%u: %s", port,
+		     ec.message().c_str());
+		return false;
+	}
+
+	m_port = port;
+	blog(LOG_INFO, "[Audio to WebSocket] Metrics endpoint at http://127.0.0.1:%u/metrics", port);
+	return true;
+}
+
+void MetricsServer::Stop()
+{
+	if (!m_running.exchange(false))
+		return;
+
+	RunOnContext(m_io, [this]() {
+		asio::error_code ec;
+		m_acceptor.close(ec);
+		for (const auto &session : m_sessions) {
+			session->socket.close(ec);
+			session->deadline.cancel();
+		}
+		m_sessions.clear();
+	});
+
+	blog(LOG_INFO, "[Audio to WebSocket] Metrics endpoint on port %u stopped", m_port);
+}
+
+void MetricsServer::StartAccept()
+{
+	auto session = std::make_shared<Session>(m_io);
+	m_acceptor.async_accept(session->socket, WeakHandler(this, [this, session](const asio::error_code &ec) {
+		if (!m_running)
+			return;
+
+		if (!ec) {
+			if (m_sessions.size() < MAX_SESSIONS) {
+				StartSession(session);
+			} else {
+				asio::error_code ignored;
+				session->socket.close(ignored);
+			}
+		}
+		StartAccept();
+	}));
+}
+
+void MetricsServer::StartSession(const std::shared_ptr<Session> &session)
+{
+	m_sessions.insert(session);
+
+	session->deadline.expires_after(std::chrono::milliseconds(SESSION_TIMEOUT_MS));
+	session->deadline.async_wait(WeakHandler(this, [this, session](const asio::error_code &ec) {
+		if (!ec && m_running) {
+			EndSession(session);
+		}
+	}));
+
+	asio::async_read_until(session->socket, session->request, "\r\n\r\n",
+			       WeakHandler(this, [this, session](const asio::error_code &ec, size_t) {
+				       if (!m_running || !m_sessions.count(session))
+					       return;
+				       if (ec) {
+					       EndSession(session);
+					       return;
+				       }
+				       OnRequest(session);
+			       }));
+}
+
+void MetricsServer::OnRequest(const std::shared_ptr<Session> &session)
+{
+	std::istream stream(&session->request);
+	std::string method, target;
+	stream >> method >> target;
+
+	if (method != "GET" && method != "HEAD") {
+		session->response = HttpResponse("405 Method Not Allowed", "text/plain", "Method not allowed\n");
+	} else if (target == "/metrics" || target.rfind("/metrics?", 0) == 0) {
+		session->response = HttpResponse("200 OK", "text/plain; version=0.0.4; charset=utf-8", m_render());
+	} else {
+		session->response = HttpResponse("404 Not Found", "text/plain", "Try /metrics\n");
+	}
+
+	if (method == "HEAD") {
+		session->response.erase(session->response.find("\r\n\r\n") + 4);
+	}
+
+	asio::async_write(session->socket, asio::buffer(session->response),
+			  WeakHandler(this, [this, session](const asio::error_code &, size_t) {
+				  if (m_running) {
+					  EndSession(session);
+				  }
+			  }));
+}
+
+void MetricsServer::EndSession(const std::shared_ptr<Session> &session)
+{
+	asio::error_code ec;
+	session->socket.shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+	session->socket.close(ec);
+	session->deadline.cancel();
+	m_sessions.erase(session);
+}
+
+} // namespace obs_audio_to_websocket
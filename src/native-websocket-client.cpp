@@ -0,0 +1,603 @@
+#include "obs-audio-to-websocket/native-websocket-client.hpp"
+#include "obs-audio-to-websocket/constants.hpp"
+#include "obs-audio-to-websocket/socket-options.hpp"
+#include "obs-audio-to-websocket/log.hpp"
+#include <websocketpp/base64/base64.hpp>
+#include <websocketpp/sha1/sha1.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <random>
+
+namespace obs_audio_to_websocket {
+
+namespace {
+
+constexpr const char *WS_SCHEME = "ws://";
+constexpr const char *WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+constexpr int HANDSHAKE_TIMEOUT_MS = 5000; // Same as websocketpp's open handshake timeout
+
+// Server messages are small JSON control messages; anything larger is a protocol error
+constexpr size_t MAX_INCOMING_MESSAGE_BYTES = 1024 * 1024;
+constexpr size_t READ_CHUNK_BYTES = 16 * 1024;
+
+// Frame buffers kept for reuse; larger ones (an odd huge message) are freed
+constexpr size_t MAX_POOLED_FRAMES = 64;
+constexpr size_t MAX_POOLED_FRAME_CAPACITY = 1024 * 1024;
+
+size_t FrameHeaderSize(size_t length)
+{
+	// 2 bytes + extended length + 4-byte masking key (client frames are always masked)
+	return 2 + (length < 126 ? 0 : length <= 0xFFFF ? 2 : 8) + 4;
+}
+
+// Copies src to dst XOR-ed with the 4-byte mask, 8 bytes at a time
+void MaskCopy(uint8_t *dst, const uint8_t *src, size_t length, const uint8_t mask[4])
+{
+	uint8_t mask8[8];
+	for (int i = 0; i < 8; ++i) {
+		mask8[i] = mask[i & 3];
+	}
+	uint64_t wideMask;
+	memcpy(&wideMask, mask8, sizeof(wideMask));
+
+	size_t i = 0;
+	for (; i + 8 <= length; i += 8) {
+		uint64_t word;
+		memcpy(&word, src + i, sizeof(word));
+		word ^= wideMask;
+		memcpy(dst + i, &word, sizeof(word));
+	}
+	for (; i < length; ++i) {
+		dst[i] = src[i] ^ mask[i & 3];
+	}
+}
+
+std::string ToLower(std::string s)
+{
+	std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+	return s;
+}
+
+// Value of an HTTP header (name given in lower case), or empty
+std::string HeaderValue(const std::string &response, const std::string &name)
+{
+	std::string lower = ToLower(response);
+	size_t pos = lower.find("\r\n" + name + ":");
+	if (pos == std::string::npos)
+		return "";
+
+	size_t start = pos + 2 + name.size() + 1;
+	size_t end = response.find("\r\n", start);
+	std::string value = response.substr(start, end - start);
+	value.erase(0, value.find_first_not_of(" \t"));
+	value.erase(value.find_last_not_of(" \t") + 1);
+	return value;
+}
+
+} // namespace
+
+NativeWebSocketClient::NativeWebSocketClient()
+	: m_io(IoContextPool::Instance().Acquire()),
+	  m_socket(m_io),
+	  m_reconnect(m_io),
+	  m_handshakeTimer(m_io)
+{
+	m_readBuffer.resize(READ_CHUNK_BYTES);
+}
+
+NativeWebSocketClient::~NativeWebSocketClient()
+{
+	Disconnect();
+}
+
+bool NativeWebSocketClient::ParseUri(const std::string &uri)
+{
+	if (uri.compare(0, strlen(WS_SCHEME), WS_SCHEME) != 0)
+		return false;
+
+	std::string rest = uri.substr(strlen(WS_SCHEME));
+	size_t slash = rest.find('/');
+	m_resource = slash == std::string::npos ? "/" : rest.substr(slash);
+	std::string authority = rest.substr(0, slash);
+
+	// ws://[::1]:8889/path
+	size_t portColon = authority.rfind(':');
+	size_t bracket = authority.rfind(']');
+	if (portColon != std::string::npos && (bracket == std::string::npos || portColon > bracket)) {
+		m_host = authority.substr(0, portColon);
+		m_port = authority.substr(portColon + 1);
+	} else {
+		m_host = authority;
+		m_port = "80";
+	}
+	m_hostHeader = authority;
+	if (m_host.size() > 2 && m_host.front() == '[' && m_host.back() == ']') {
+		m_host = m_host.substr(1, m_host.size() - 2);
+	}
+	return !m_host.empty() && !m_port.empty();
+}
+
+bool NativeWebSocketClient::Connect(const std::string &uri)
+{
+	if (m_connected) {
+		blog(LOG_WARNING, "[Audio to WebSocket] Already connected");
+		return false;
+	}
+
+	m_uri = uri;
+	if (!ParseUri(uri)) {
+		blog(LOG_ERROR, "[Audio to WebSocket] Invalid URL: %s", uri.c_str());
+		if (m_onError) {
+			m_onError("Invalid URL: " + uri);
+		}
+		return false;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		std::random_device rd;
+		m_maskState = (static_cast<uint64_t>(rd()) << 32) | rd() | 1;
+	}
+
+	m_running = true;
+	m_reconnect.Reset();
+	asio::post(m_io, WeakHandler(this, [this]() { StartConnect(); }));
+	return true;
+}
+
+void NativeWebSocketClient::Disconnect()
+{
+	if (!m_running.exchange(false))
+		return;
+
+	// On the socket's own thread, so no handler is running while its state is torn down
+	RunOnContext(m_io, [this]() {
+		asio::error_code ec;
+		m_reconnect.Cancel();
+		m_handshakeTimer.cancel();
+
+		// Best-effort close handshake, unless a write is in flight on the socket
+		if (m_connected) {
+			std::vector<uint8_t> frame;
+			const uint8_t status[2] = {0x03, 0xE8}; // 1000 normal closure
+			{
+				std::lock_guard<std::mutex> lock(m_queueMutex);
+				if (!m_writing) {
+					BuildFrame(frame, Close, status, sizeof(status));
+				}
+			}
+			if (!frame.empty()) {
+				asio::write(m_socket, asio::buffer(frame), ec);
+			}
+		}
+
+		m_socket.shutdown(asio::socket_base::shutdown_both, ec);
+		m_socket.close(ec);
+	});
+
+	bool wasConnected = m_connected.exchange(false);
+
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		DropQueueLocked();
+	}
+
+	if (wasConnected && m_onDisconnected) {
+		m_onDisconnected();
+	}
+}
+
+void NativeWebSocketClient::StartConnect()
+{
+	if (!m_running)
+		return;
+
+	auto resolver = std::make_shared<asio::ip::tcp::resolver>(m_io);
+	auto onConnected = [this](const asio::error_code &ec, const asio::ip::tcp::endpoint &) {
+		OnConnect(ec);
+	};
+	auto onResolved = [this, resolver, onConnected](const asio::error_code &ec,
+							asio::ip::tcp::resolver::results_type results) {
+		if (ec) {
+			HandleError("Could not resolve host", ec);
+			return;
+		}
+		asio::async_connect(m_socket, results, WeakHandler(this, onConnected));
+	};
+	resolver->async_resolve(m_host, m_port, WeakHandler(this, onResolved));
+}
+
+void NativeWebSocketClient::OnConnect(const asio::error_code &ec)
+{
+	if (ec) {
+		HandleError("Connection failed", ec);
+		return;
+	}
+
+	int dscp = m_dscp.load();
+	asio::error_code optionEc = TuneAudioSocket(m_socket, dscp);
+	if (optionEc) {
+		blog(LOG_WARNING, "[Audio to WebSocket] Could not apply socket options (DSCP %d): %s", dscp,
+		     optionEc.message().c_str());
+	}
+
+	StartHandshake();
+}
+
+void NativeWebSocketClient::StartHandshake()
+{
+	uint8_t nonce[16];
+	std::random_device rd;
+	for (uint8_t &b : nonce) {
+		b = static_cast<uint8_t>(rd());
+	}
+	m_handshakeKey = websocketpp::base64_encode(nonce, sizeof(nonce));
+
+	m_handshakeRequest = "GET " + m_resource + " HTTP/1.1\r\n" + "Host: " + m_hostHeader + "\r\n" +
+			     "Upgrade: websocket\r\n" + "Connection: Upgrade\r\n" + "Sec-WebSocket-Key: " +
+			     m_handshakeKey + "\r\n" + "Sec-WebSocket-Version: 13\r\n" +
+			     "User-Agent: obs-audio-to-websocket\r\n\r\n";
+
+	m_handshakeTimer.expires_after(std::chrono::milliseconds(HANDSHAKE_TIMEOUT_MS));
+	m_handshakeTimer.async_wait(WeakHandler(this, [this](const asio::error_code &ec) {
+		if (!ec) {
+			HandleError("WebSocket handshake timed out", asio::error::timed_out);
+		}
+	}));
+
+	auto onRequestSent = [this](const asio::error_code &ec, size_t) {
+		if (ec) {
+			HandleError("WebSocket handshake failed", ec);
+			return;
+		}
+
+		m_handshakeResponse.consume(m_handshakeResponse.size());
+		auto onResponse = [this](const asio::error_code &readEc, size_t length) {
+			if (readEc) {
+				HandleError("WebSocket handshake failed", readEc);
+				return;
+			}
+			m_handshakeTimer.cancel();
+
+			const char *data = static_cast<const char *>(m_handshakeResponse.data().data());
+			std::string response(data, length);
+			m_handshakeResponse.consume(length);
+
+			if (!ValidateHandshake(response)) {
+				HandleError("WebSocket handshake rejected", asio::error::connection_refused);
+				return;
+			}
+
+			// The server may have sent frames right behind the response
+			m_incoming.clear();
+			const uint8_t *extra = static_cast<const uint8_t *>(m_handshakeResponse.data().data());
+			m_incoming.assign(extra, extra + m_handshakeResponse.size());
+			m_handshakeResponse.consume(m_handshakeResponse.size());
+			m_fragment.clear();
+
+			blog(LOG_INFO, "[Audio to WebSocket] Connected to %s", m_uri.c_str());
+			m_closing = false;
+			m_connected = true;
+			m_reconnect.Reset();
+
+			if (m_onConnected) {
+				m_onConnected();
+			}
+
+			SendControlMessage("start");
+			if (!ProcessIncoming()) {
+				HandleError("WebSocket protocol error", asio::error::invalid_argument);
+				return;
+			}
+			StartRead();
+		};
+		asio::async_read_until(m_socket, m_handshakeResponse, "\r\n\r\n", WeakHandler(this, onResponse));
+	};
+	asio::async_write(m_socket, asio::buffer(m_handshakeRequest), WeakHandler(this, onRequestSent));
+}
+
+bool NativeWebSocketClient::ValidateHandshake(const std::string &response)
+{
+	// "HTTP/1.1 101 Switching Protocols"
+	size_t space = response.find(' ');
+	if (space == std::string::npos || response.compare(space + 1, 3, "101") != 0) {
+		std::string statusLine = response.substr(0, response.find("\r\n"));
+		blog(LOG_ERROR, "[Audio to WebSocket] Unexpected handshake response: %s", statusLine.c_str());
+		return false;
+	}
+
+	if (ToLower(HeaderValue(response, "upgrade")) != "websocket")
+		return false;
+
+	std::string accept = m_handshakeKey + WS_GUID;
+	unsigned char hash[20];
+	websocketpp::sha1::calc(accept.data(), accept.size(), hash);
+	return HeaderValue(response, "sec-websocket-accept") == websocketpp::base64_encode(hash, sizeof(hash));
+}
+
+void NativeWebSocketClient::StartRead()
+{
+	auto onRead = [this](const asio::error_code &ec, size_t n) {
+		if (ec) {
+			HandleError("Connection closed", ec);
+			return;
+		}
+
+		m_incoming.insert(m_incoming.end(), m_readBuffer.begin(), m_readBuffer.begin() + n);
+		if (!ProcessIncoming()) {
+			HandleError("WebSocket protocol error", asio::error::invalid_argument);
+			return;
+		}
+		StartRead();
+	};
+	m_socket.async_read_some(asio::buffer(m_readBuffer), WeakHandler(this, onRead));
+}
+
+bool NativeWebSocketClient::ProcessIncoming()
+{
+	size_t offset = 0;
+	while (m_incoming.size() - offset >= 2) {
+		const uint8_t *p = m_incoming.data() + offset;
+		bool fin = (p[0] & 0x80) != 0;
+		uint8_t opcode = p[0] & 0x0F;
+		// Servers must not mask, and we negotiated no extensions (RSV bits)
+		if ((p[0] & 0x70) != 0 || (p[1] & 0x80) != 0)
+			return false;
+
+		size_t headerSize = 2;
+		uint64_t length = p[1] & 0x7F;
+		if (length == 126) {
+			headerSize = 4;
+		} else if (length == 127) {
+			headerSize = 10;
+		}
+		if (m_incoming.size() - offset < headerSize)
+			break;
+		if (headerSize > 2) {
+			length = 0;
+			for (size_t i = 2; i < headerSize; ++i) {
+				length = (length << 8) | p[i];
+			}
+		}
+
+		if (length > MAX_INCOMING_MESSAGE_BYTES || m_fragment.size() + length > MAX_INCOMING_MESSAGE_BYTES)
+			return false;
+		if (m_incoming.size() - offset < headerSize + length)
+			break;
+
+		std::string payload(reinterpret_cast<const char *>(p + headerSize), static_cast<size_t>(length));
+		offset += headerSize + static_cast<size_t>(length);
+		HandleFrame(opcode, fin, std::move(payload));
+	}
+
+	m_incoming.erase(m_incoming.begin(), m_incoming.begin() + offset);
+	return true;
+}
+
+void NativeWebSocketClient::HandleFrame(uint8_t opcode, bool fin, std::string &&payload)
+{
+	switch (opcode) {
+	case Ping:
+		QueueFrame(Pong, reinterpret_cast<const uint8_t *>(payload.data()), payload.size(), false);
+		return;
+	case Pong:
+		return;
+	case Close:
+		// Echo the close; the server then closes TCP and the read loop reports the disconnect
+		if (!m_closing.exchange(true)) {
+			QueueFrame(Close, reinterpret_cast<const uint8_t *>(payload.data()), std::min<size_t>(payload.size(), 2),
+				   false);
+		}
+		return;
+	case Continuation:
+		m_fragment += payload;
+		break;
+	default:
+		m_fragmentOpcode = opcode;
+		m_fragment = std::move(payload);
+		break;
+	}
+
+	if (fin) {
+		if (m_fragmentOpcode == Text && m_onMessage) {
+			m_onMessage(m_fragment);
+		}
+		m_fragment.clear();
+	}
+}
+
+void NativeWebSocketClient::BuildFrame(std::vector<uint8_t> &frame, uint8_t opcode, const uint8_t *data, size_t length)
+{
+	size_t headerSize = FrameHeaderSize(length);
+	frame.resize(headerSize + length);
+
+	uint8_t *p = frame.data();
+	p[0] = 0x80 | opcode; // FIN, no fragmentation
+	if (length < 126) {
+		p[1] = 0x80 | static_cast<uint8_t>(length);
+	} else if (length <= 0xFFFF) {
+		p[1] = 0x80 | 126;
+		p[2] = static_cast<uint8_t>(length >> 8);
+		p[3] = static_cast<uint8_t>(length);
+	} else {
+		p[1] = 0x80 | 127;
+		for (int i = 0; i < 8; ++i) {
+			p[2 + i] = static_cast<uint8_t>(static_cast<uint64_t>(length) >> (56 - 8 * i));
+		}
+	}
+
+	// xorshift64* - masking keys only need to be unpredictable to intermediaries, not cryptographic
+	m_maskState ^= m_maskState >> 12;
+	m_maskState ^= m_maskState << 25;
+	m_maskState ^= m_maskState >> 27;
+	uint32_t key = static_cast<uint32_t>((m_maskState * 0x2545F4914F6CDD1DULL) >> 32);
+
+	uint8_t *mask = p + headerSize - 4;
+	memcpy(mask, &key, 4);
+	MaskCopy(p + headerSize, data, length, mask);
+}
+
+bool NativeWebSocketClient::QueueFrame(uint8_t opcode, const uint8_t *data, size_t length, bool droppable,
+				       const AudioPacket *packet)
+{
+	bool startWrite = false;
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		size_t frameSize = FrameHeaderSize(length) + length;
+		if (droppable && m_queuedBytes + frameSize > constants::MAX_SEND_BUFFERED_BYTES) {
+			return false;
+		}
+		if (packet) {
+			RecordQueuedBytes(m_queuedBytes);
+		}
+
+		std::vector<uint8_t> frame;
+		if (!m_freeBuffers.empty()) {
+			frame = std::move(m_freeBuffers.back());
+			m_freeBuffers.pop_back();
+		}
+		BuildFrame(frame, opcode, data, length);
+
+		m_queuedBytes += frame.size();
+		m_queue.push_back(std::move(frame));
+		m_queueSends.emplace_back(packet ? packet->captureNs : 0, packet ? packet->data.size() : 0);
+		if (!m_writing) {
+			m_writing = true;
+			startWrite = true;
+		}
+	}
+
+	if (startWrite) {
+		asio::post(m_io, WeakHandler(this, [this]() { StartWrite(); }));
+	}
+	return true;
+}
+
+void NativeWebSocketClient::SendAudioPacket(const AudioPacketPtr &packet)
+{
+	if (!m_connected || m_closing || !packet)
+		return;
+
+	if (!QueueFrame(Binary, packet->data.data(), packet->data.size(), true, packet.get())) {
+		m_droppedPackets++;
+		RecordDropped();
+		if (!m_backpressured.exchange(true)) {
+			blog(LOG_WARNING, "[Audio to WebSocket] Send buffer full for %s, dropping audio", m_uri.c_str());
+		}
+		return;
+	}
+	if (m_backpressured.exchange(false)) {
+		blog(LOG_INFO, "[Audio to WebSocket] Send buffer drained for %s (%llu packets dropped)", m_uri.c_str(),
+		     static_cast<unsigned long long>(m_droppedPackets.load()));
+	}
+}
+
+void NativeWebSocketClient::SendControlText(const std::string &payload)
+{
+	if (!m_connected || m_closing)
+		return;
+
+	QueueFrame(Text, reinterpret_cast<const uint8_t *>(payload.data()), payload.size(), false);
+}
+
+void NativeWebSocketClient::StartWrite()
+{
+	// Coalesce everything queued so far into one vectored write
+	std::shared_ptr<WriteBatch> batch;
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		if (m_queue.empty() || !m_connected) {
+			m_writing = false;
+			return;
+		}
+
+		batch = m_spareBatch ? std::move(m_spareBatch) : std::make_shared<WriteBatch>();
+		batch->generation = m_writeGeneration;
+		while (!m_queue.empty()) {
+			batch->bytes += m_queue.front().size();
+			batch->frames.push_back(std::move(m_queue.front()));
+			batch->sends.push_back(m_queueSends.front());
+			m_queue.pop_front();
+			m_queueSends.pop_front();
+		}
+		for (const auto &frame : batch->frames) {
+			batch->buffers.push_back(asio::buffer(frame));
+		}
+	}
+
+	auto onWritten = [this, batch](const asio::error_code &ec, size_t) {
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			bool current = batch->generation == m_writeGeneration;
+			for (size_t i = 0; i < batch->frames.size(); ++i) {
+				std::vector<uint8_t> &frame = batch->frames[i];
+				if (!ec && current && batch->sends[i].second > 0) {
+					RecordSent(batch->sends[i].first, batch->sends[i].second);
+				}
+				if (m_freeBuffers.size() < MAX_POOLED_FRAMES && frame.capacity() <= MAX_POOLED_FRAME_CAPACITY) {
+					m_freeBuffers.push_back(std::move(frame));
+				}
+			}
+			if (current) {
+				m_queuedBytes -= batch->bytes;
+			}
+			batch->frames.clear();
+			batch->sends.clear();
+			batch->buffers.clear();
+			batch->bytes = 0;
+			m_spareBatch = batch;
+
+			// The queue was dropped while this write was in flight, and whatever writes now isn't ours
+			if (!current)
+				return;
+			if (ec) {
+				m_writing = false;
+			}
+		}
+
+		if (ec) {
+			HandleError("Failed to send audio data", ec);
+			return;
+		}
+		StartWrite();
+	};
+	asio::async_write(m_socket, batch->buffers, WeakHandler(this, onWritten));
+}
+
+void NativeWebSocketClient::DropQueueLocked()
+{
+	m_queue.clear();
+	m_queueSends.clear();
+	m_queuedBytes = 0;
+	m_writing = false;
+	m_writeGeneration++;
+}
+
+void NativeWebSocketClient::HandleError(const std::string &what, const asio::error_code &ec)
+{
+	// Cancelled operations are expected while shutting down
+	if (!m_running || ec == asio::error::operation_aborted)
+		return;
+
+	asio::error_code closeEc;
+	m_handshakeTimer.cancel();
+	m_socket.close(closeEc);
+
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		DropQueueLocked();
+	}
+
+	ReportConnectionLost(m_connected.exchange(false), m_reconnect.IsReconnecting(), what, ec.message());
+	ScheduleReconnect();
+}
+
+void NativeWebSocketClient::ScheduleReconnect()
+{
+	if (!m_reconnect.Schedule(this, m_uri, [this]() { StartConnect(); }) && m_onError) {
+		m_onError(Reconnector::GAVE_UP_ERROR);
+	}
+}
+
+} // namespace obs_audio_to_websocket
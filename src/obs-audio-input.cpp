@@ -0,0 +1,166 @@
+#include "obs-audio-to-websocket/obs-audio-input.hpp"
+#include <obs-module.h>
+
+#ifndef UNUSED_PARAMETER
+#define UNUSED_PARAMETER(param) (void)param
+#endif
+
+namespace obs_audio_to_websocket {
+
+ObsAudioInput::ObsAudioInput(StreamProfile profile) : m_profile(std::move(profile)) {}
+
+ObsAudioInput::~ObsAudioInput()
+{
+	Detach();
+}
+
+bool ObsAudioInput::Attach(StreamPipeline &pipeline, std::string &error)
+{
+	m_pipeline = &pipeline;
+	m_formatErrorLogged = false;
+
+	if (m_profile.capture == CaptureMode::MixTracks)
+		return AttachMixTrack(error);
+	return AttachAudioSource(error);
+}
+
+bool ObsAudioInput::AttachAudioSource(std::string &error)
+{
+	const std::string &sourceName = m_profile.audioSource;
+	if (sourceName.empty()) {
+		blog(LOG_WARNING, "[Audio to WebSocket] Profile '%s': no audio source specified", m_profile.name.c_str());
+		error = "No audio source selected";
+		return false;
+	}
+
+	m_audioSource = OBSSourceWrapper(sourceName);
+	if (!m_audioSource) {
+		blog(LOG_ERROR, "[Audio to WebSocket] Audio source '%s' not found", sourceName.c_str());
+		error = "Audio source not found";
+		return false;
+	}
+
+	// Verify it's an audio source
+	if (!m_audioSource.is_audio_source()) {
+		blog(LOG_ERROR, "[Audio to WebSocket] Source '%s' is not an audio source", sourceName.c_str());
+		error = "Selected source is not an audio source";
+		m_audioSource.reset();
+		return false;
+	}
+
+	obs_source_add_audio_capture_callback(m_audioSource.get(), AudioCaptureCallback, this);
+	return true;
+}
+
+bool ObsAudioInput::AttachMixTrack(std::string &error)
+{
+	int mixIndex = -1;
+	for (size_t i = 0; i < MAX_MIX_TRACKS; ++i) {
+		if (m_profile.mixTracks == (1u << i)) {
+			mixIndex = static_cast<int>(i);
+		}
+	}
+	if (mixIndex < 0) {
+		blog(LOG_ERROR, "[Audio to WebSocket] Profile '%s': expected exactly one output track",
+		     m_profile.name.c_str());
+		error = "Select an output track";
+		return false;
+	}
+
+	const audio_output_info *aoi = audio_output_get_info(obs_get_audio());
+	if (!aoi) {
+		error = "OBS audio output is not available";
+		return false;
+	}
+
+	// libobs resamples, remixes and converts the sample format before calling us, so the callback only
+	// copies samples into the packet
+	struct audio_convert_info conversion = {};
+	conversion.samples_per_sec = m_profile.sampleRate ? m_profile.sampleRate : aoi->samples_per_sec;
+	// Feature extraction wants float input whatever goes on the wire
+	bool want_float = m_profile.IsFeatureStream() || m_profile.encoding == SampleEncoding::Float32;
+	conversion.format = want_float ? AUDIO_FORMAT_FLOAT : AUDIO_FORMAT_16BIT;
+	conversion.speakers = m_profile.channels ? static_cast<enum speaker_layout>(m_profile.channels)
+						 : aoi->speakers;
+
+	m_mixIndex = mixIndex;
+	m_mixSampleRate = conversion.samples_per_sec;
+	m_mixChannels = get_audio_channels(conversion.speakers);
+	m_mixBitDepth = want_float ? 32 : 16;
+
+	blog(LOG_INFO, "[Audio to WebSocket] Profile '%s': tapping output track %d (%u Hz, %u ch)",
+	     m_profile.name.c_str(), mixIndex + 1, m_mixSampleRate, m_mixChannels);
+	obs_add_raw_audio_callback(static_cast<size_t>(mixIndex), &conversion, RawAudioCallback, this);
+	return true;
+}
+
+void ObsAudioInput::Detach()
+{
+	if (m_audioSource) {
+		// Returns once any callback in progress has finished
+		obs_source_remove_audio_capture_callback(m_audioSource.get(), AudioCaptureCallback, this);
+		m_audioSource.reset();
+	}
+	if (m_mixIndex >= 0) {
+		// Also waits out a running callback: libobs holds the same lock while calling it
+		obs_remove_raw_audio_callback(static_cast<size_t>(m_mixIndex), RawAudioCallback, this);
+		m_mixIndex = -1;
+	}
+}
+
+void ObsAudioInput::AudioCaptureCallback(void *param, obs_source_t *source, const struct audio_data *audio_data,
+					 bool muted)
+{
+	UNUSED_PARAMETER(source);
+
+	auto *input = static_cast<ObsAudioInput *>(param);
+	if (muted)
+		return;
+
+	const audio_output_info *aoi = audio_output_get_info(obs_get_audio());
+	if (!aoi)
+		return;
+
+	// Verify audio format
+	if (aoi->format != AUDIO_FORMAT_FLOAT_PLANAR) {
+		if (!input->m_formatErrorLogged) {
+			input->m_formatErrorLogged = true;
+			blog(LOG_ERROR, "[Audio to WebSocket] Unexpected audio format: %d (expected FLOAT_PLANAR)",
+			     aoi->format);
+		}
+		return;
+	}
+
+	AudioFrame frame;
+	frame.frames = audio_data->frames;
+	frame.channels = static_cast<uint32_t>(audio_output_get_channels(obs_get_audio()));
+	frame.sampleRate = aoi->samples_per_sec;
+	frame.timestamp = audio_data->timestamp;
+	for (size_t ch = 0; ch < frame.channels && ch < MAX_FRAME_CHANNELS; ++ch) {
+		frame.planes[ch] = reinterpret_cast<const float *>(audio_data->data[ch]);
+	}
+
+	input->m_pipeline->PushAudio(frame);
+}
+
+void ObsAudioInput::RawAudioCallback(void *param, size_t mix_idx, struct audio_data *data)
+{
+	UNUSED_PARAMETER(mix_idx);
+
+	auto *input = static_cast<ObsAudioInput *>(param);
+	if (!data)
+		return;
+
+	// Interleaved, so everything is in the first plane
+	AudioFrame frame;
+	frame.interleaved = data->data[0];
+	frame.bitDepth = input->m_mixBitDepth;
+	frame.frames = data->frames;
+	frame.channels = input->m_mixChannels;
+	frame.sampleRate = input->m_mixSampleRate;
+	frame.timestamp = data->timestamp;
+
+	input->m_pipeline->PushAudio(frame);
+}
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,92 @@
+#include "obs-audio-to-websocket/pipeline-stats.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace obs_audio_to_websocket {
+
+namespace {
+
+constexpr size_t SUB_BUCKET_BITS = 4;
+static_assert((size_t(1) << SUB_BUCKET_BITS) == Histogram::SUB_BUCKETS, "sub-bucket count must match its bits");
+
+size_t HighestBit(uint64_t value)
+{
+	size_t bit = 0;
+	while (value >>= 1) {
+		++bit;
+	}
+	return bit;
+}
+
+} // namespace
+
+size_t Histogram::BucketIndex(uint64_t value)
+{
+	if (value < 2 * SUB_BUCKETS)
+		return static_cast<size_t>(value);
+
+	// value >> shift lands in [16, 32): the top five bits pick the power of two's sub-bucket
+	size_t shift = HighestBit(value) - SUB_BUCKET_BITS;
+	return (shift + 1) * SUB_BUCKETS + static_cast<size_t>((value >> shift) - SUB_BUCKETS);
+}
+
+uint64_t Histogram::BucketUpperBound(size_t index)
+{
+	if (index < 2 * SUB_BUCKETS)
+		return index;
+
+	size_t shift = index / SUB_BUCKETS - 1;
+	uint64_t lower = static_cast<uint64_t>(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+	return lower + ((uint64_t(1) << shift) - 1);
+}
+
+void Histogram::Record(uint64_t value)
+{
+	m_counts[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+	m_count.fetch_add(1, std::memory_order_relaxed);
+	m_sum.fetch_add(value, std::memory_order_relaxed);
+
+	uint64_t max = m_max.load(std::memory_order_relaxed);
+	while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+	}
+}
+
+void HistogramSnapshot::Add(const Histogram &histogram)
+{
+	uint64_t count = 0;
+	for (size_t i = 0; i < Histogram::BUCKET_COUNT; ++i) {
+		uint64_t bucket = histogram.m_counts[i].load(std::memory_order_relaxed);
+		m_counts[i] += bucket;
+		count += bucket;
+	}
+	// Summed from the buckets so percentiles stay consistent with a writer racing the copy
+	m_count += count;
+	m_sum += histogram.m_sum.load(std::memory_order_relaxed);
+	m_max = std::max(m_max, histogram.m_max.load(std::memory_order_relaxed));
+}
+
+uint64_t HistogramSnapshot::Percentile(double quantile) const
+{
+	if (m_count == 0)
+		return 0;
+
+	uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(quantile, 0.0, 1.0) * m_count));
+	rank = std::max<uint64_t>(rank, 1);
+	uint64_t seen = 0;
+	for (size_t i = 0; i < Histogram::BUCKET_COUNT; ++i) {
+		seen += m_counts[i];
+		if (seen >= rank)
+			return std::min(Histogram::BucketUpperBound(i), m_max);
+	}
+	return m_max;
+}
+
+uint64_t SteadyNowNs()
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+					     std::chrono::steady_clock::now().time_since_epoch())
+					     .count());
+}
+
+} // namespace obs_audio_to_websocket
@@ -2,7 +2,10 @@
 #include <obs-frontend-api.h>
 #include <QAction>
 #include <QMainWindow>
+#include "obs-audio-to-websocket/audio-filter.hpp"
 #include "obs-audio-to-websocket/audio-streamer.hpp"
+#include "obs-audio-to-websocket/encoder-pool.hpp"
+#include "obs-audio-to-websocket/io-context-pool.hpp"
 
 OBS_DECLARE_MODULE()
 OBS_MODULE_USE_DEFAULT_LOCALE("obs-audio-to-websocket", "en-US")
@@ -43,6 +46,9 @@ bool obs_module_load(void)
 	// Load saved settings
 	obs_audio_to_websocket::AudioStreamer::Instance().LoadSettings();
 
+	// Per-source taps anywhere in a filter chain, configured from the source's Filters window
+	obs_audio_to_websocket::RegisterAudioFilter();
+
 	obs_frontend_add_tools_menu_item(
 		obs_module_text("AudioStreamerSettings"),
 		[](void *data) {
@@ -62,6 +68,11 @@ void obs_module_unload(void)
 {
 	obs_frontend_remove_event_callback(on_frontend_event, nullptr);
 
+	// Encoder and network threads must be joined before the module is unmapped
+	obs_audio_to_websocket::AudioStreamer::Instance().Shutdown();
+	obs_audio_to_websocket::EncoderPool::Instance().Stop();
+	obs_audio_to_websocket::IoContextPool::Instance().Stop();
+
 	blog(LOG_INFO, "[Audio to WebSocket] Plugin unloaded");
 }
 
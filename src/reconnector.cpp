@@ -0,0 +1,51 @@
+#include "obs-audio-to-websocket/reconnector.hpp"
+#include "obs-audio-to-websocket/constants.hpp"
+#include "obs-audio-to-websocket/log.hpp"
+
+namespace obs_audio_to_websocket {
+
+void Reconnector::Reset()
+{
+	m_attempts = 0;
+	m_reconnecting = false;
+}
+
+void Reconnector::Cancel()
+{
+	m_timer.cancel();
+	m_pending = false;
+	m_reconnecting = false;
+}
+
+int Reconnector::DelayMs(int attempt)
+{
+	int delay = constants::INITIAL_RECONNECT_DELAY_MS;
+	for (int i = 1; i < attempt && delay < constants::MAX_RECONNECT_DELAY_MS; i++) {
+		delay *= 2;
+	}
+	return delay > constants::MAX_RECONNECT_DELAY_MS ? constants::MAX_RECONNECT_DELAY_MS : delay;
+}
+
+bool Reconnector::Next(const std::string &uri, int &delayMs)
+{
+	if (m_pending) {
+		delayMs = -1;
+		return true;
+	}
+
+	int attempt = ++m_attempts;
+	if (attempt > constants::MAX_RECONNECT_ATTEMPTS) {
+		blog(LOG_ERROR, "[Audio to WebSocket] Max reconnection attempts reached for %s. Giving up.", uri.c_str());
+		m_reconnecting = false;
+		return false;
+	}
+
+	m_reconnecting = true;
+	m_pending = true;
+	delayMs = DelayMs(attempt);
+	blog(LOG_INFO, "[Audio to WebSocket] Reconnecting to %s in %d ms (attempt %d/%d)", uri.c_str(), delayMs,
+	     attempt, constants::MAX_RECONNECT_ATTEMPTS);
+	return true;
+}
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,124 @@
+#include "obs-audio-to-websocket/resampler.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace obs_audio_to_websocket {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double ZERO_CROSSINGS = 8.0;
+// Passband edge as a fraction of the lower Nyquist frequency; the rest is the transition band
+constexpr double PASSBAND = 0.92;
+
+double Sinc(double x)
+{
+	return x == 0.0 ? 1.0 : std::sin(PI * x) / (PI * x);
+}
+
+// Blackman window over [-1, 1]
+double Blackman(double t)
+{
+	if (t <= -1.0 || t >= 1.0)
+		return 0.0;
+	return 0.42 + 0.5 * std::cos(PI * t) + 0.08 * std::cos(2.0 * PI * t);
+}
+
+} // namespace
+
+Resampler::Resampler(uint32_t inputRate, uint32_t outputRate, uint32_t channels, Quality quality)
+	: m_inputRate(inputRate),
+	  m_outputRate(outputRate),
+	  m_channels(channels),
+	  m_quality(quality)
+{
+	// Phase p is the kernel for an output p / PHASES of the way from one input sample to the next; tap j
+	// weighs input sample (position - m_halfTaps + 1 + j)
+	if (quality == Quality::Linear) {
+		m_halfTaps = 1;
+		m_kernel.resize((PHASES + 1) * 2);
+		for (size_t p = 0; p <= PHASES; ++p) {
+			float fraction = static_cast<float>(p) / PHASES;
+			m_kernel[p * 2] = 1.0f - fraction;
+			m_kernel[p * 2 + 1] = fraction;
+		}
+	} else {
+		double cutoff = std::min(1.0, static_cast<double>(outputRate) / inputRate) * PASSBAND;
+		m_halfTaps = static_cast<size_t>(std::ceil(ZERO_CROSSINGS / cutoff));
+		const size_t taps = 2 * m_halfTaps;
+		m_kernel.resize((PHASES + 1) * taps);
+		for (size_t p = 0; p <= PHASES; ++p) {
+			double fraction = static_cast<double>(p) / PHASES;
+			double sum = 0.0;
+			std::vector<double> row(taps);
+			for (size_t j = 0; j < taps; ++j) {
+				double x = static_cast<double>(j) - static_cast<double>(m_halfTaps - 1) - fraction;
+				row[j] = cutoff * Sinc(cutoff * x) * Blackman(x / m_halfTaps);
+				sum += row[j];
+			}
+			// Unity gain at DC for every phase, so a constant signal stays constant
+			for (size_t j = 0; j < taps; ++j) {
+				m_kernel[p * taps + j] = static_cast<float>(row[j] / sum);
+			}
+		}
+	}
+
+	Reset();
+}
+
+void Resampler::Reset()
+{
+	// Silence before the first block, so the first output lines up with the first input sample
+	m_pending.assign(m_channels, std::vector<float>(m_halfTaps - 1, 0.0f));
+	m_position = m_halfTaps - 1;
+	m_fraction = 0;
+}
+
+size_t Resampler::Process(const AudioFrame &frame, std::vector<std::vector<float>> &out, int64_t &firstFrameOffsetNs)
+{
+	const size_t base = m_pending[0].size(); // Where this block starts in m_pending
+	for (uint32_t ch = 0; ch < m_channels; ++ch) {
+		m_pending[ch].insert(m_pending[ch].end(), frame.planes[ch], frame.planes[ch] + frame.frames);
+	}
+
+	double firstPosition = static_cast<double>(m_position) - static_cast<double>(base) +
+			       static_cast<double>(m_fraction) / m_outputRate;
+	firstFrameOffsetNs = static_cast<int64_t>(std::floor(firstPosition * 1e9 / m_inputRate));
+
+	out.resize(m_channels);
+	for (auto &channel : out) {
+		channel.clear();
+	}
+
+	const size_t taps = 2 * m_halfTaps;
+	const size_t available = m_pending[0].size();
+	size_t produced = 0;
+	while (m_position + m_halfTaps < available) {
+		size_t phase = static_cast<size_t>((m_fraction * PHASES + m_outputRate / 2) / m_outputRate);
+		const float *kernel = m_kernel.data() + phase * taps;
+		size_t start = m_position + 1 - m_halfTaps;
+		for (uint32_t ch = 0; ch < m_channels; ++ch) {
+			const float *in = m_pending[ch].data() + start;
+			float sum = 0.0f;
+			for (size_t j = 0; j < taps; ++j) {
+				sum += kernel[j] * in[j];
+			}
+			out[ch].push_back(sum);
+		}
+		++produced;
+
+		m_fraction += m_inputRate;
+		m_position += m_fraction / m_outputRate;
+		m_fraction %= m_outputRate;
+	}
+
+	// Keep only the history the next output still needs
+	size_t consumed = std::min(m_position + 1 - m_halfTaps, available);
+	for (auto &channel : m_pending) {
+		channel.erase(channel.begin(), channel.begin() + consumed);
+	}
+	m_position -= consumed;
+	return produced;
+}
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,391 @@
+#include "obs-audio-to-websocket/rtp-sink.hpp"
+#include "obs-audio-to-websocket/io-context-pool.hpp"
+#include "obs-audio-to-websocket/log.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+
+namespace obs_audio_to_websocket {
+
+namespace {
+
+constexpr const char *RTP_SCHEME = "rtp://";
+constexpr size_t RTP_HEADER_SIZE = 12;
+constexpr size_t FEC_HEADER_SIZE = 12;
+constexpr size_t MIN_MTU = 256;
+constexpr size_t MAX_MTU = 65000;
+
+void WriteUint16BE(uint8_t *out, uint16_t value)
+{
+	out[0] = static_cast<uint8_t>(value >> 8);
+	out[1] = static_cast<uint8_t>(value);
+}
+
+void WriteUint32BE(uint8_t *out, uint32_t value)
+{
+	out[0] = static_cast<uint8_t>(value >> 24);
+	out[1] = static_cast<uint8_t>(value >> 16);
+	out[2] = static_cast<uint8_t>(value >> 8);
+	out[3] = static_cast<uint8_t>(value);
+}
+
+std::string QueryValue(const std::string &query, const std::string &key)
+{
+	std::istringstream stream(query);
+	std::string pair;
+	while (std::getline(stream, pair, '&')) {
+		size_t eq = pair.find('=');
+		if (eq != std::string::npos && pair.substr(0, eq) == key) {
+			return pair.substr(eq + 1);
+		}
+	}
+	return "";
+}
+
+} // namespace
+
+RtpSink::RtpSink() : m_io(IoContextPool::Instance().Acquire()), m_socket(m_io) {}
+
+RtpSink::~RtpSink()
+{
+	Disconnect();
+}
+
+bool RtpSink::ParseUri(const std::string &uri)
+{
+	if (uri.compare(0, strlen(RTP_SCHEME), RTP_SCHEME) != 0)
+		return false;
+
+	std::string rest = uri.substr(strlen(RTP_SCHEME));
+	std::string query;
+	size_t q = rest.find('?');
+	if (q != std::string::npos) {
+		query = rest.substr(q + 1);
+		rest = rest.substr(0, q);
+	}
+	rest = rest.substr(0, rest.find('/'));
+
+	size_t colon = rest.rfind(':');
+	if (colon == std::string::npos || colon == 0 || colon + 1 >= rest.length())
+		return false;
+
+	m_host = rest.substr(0, colon);
+	m_port = rest.substr(colon + 1);
+	if (m_host.size() > 2 && m_host.front() == '[' && m_host.back() == ']') {
+		m_host = m_host.substr(1, m_host.size() - 2);
+	}
+
+	std::string payload = QueryValue(query, "payload");
+	if (!payload.empty() && payload != "l16" && payload != "L16") {
+		// Only linear PCM is available; there is no Opus encoder in this build
+		return false;
+	}
+
+	std::string pt = QueryValue(query, "pt");
+	if (!pt.empty()) {
+		int value = atoi(pt.c_str());
+		if (value < 96 || value > 126)
+			return false;
+		m_payloadType = static_cast<uint8_t>(value);
+	}
+
+	std::string fec = QueryValue(query, "fec");
+	if (!fec.empty()) {
+		m_fecGroup = std::clamp(atoi(fec.c_str()), 0, 48);
+	}
+
+	std::string mtu = QueryValue(query, "mtu");
+	if (!mtu.empty()) {
+		m_mtu = std::clamp(static_cast<size_t>(strtoul(mtu.c_str(), nullptr, 10)), MIN_MTU, MAX_MTU);
+	}
+
+	return true;
+}
+
+bool RtpSink::Connect(const std::string &uri)
+{
+	if (m_running) {
+		blog(LOG_WARNING, "[Audio to WebSocket] Already connected");
+		return false;
+	}
+
+	m_uri = uri;
+	if (!ParseUri(uri)) {
+		blog(LOG_ERROR, "[Audio to WebSocket] Invalid RTP URL: %s", uri.c_str());
+		if (m_onError) {
+			m_onError("Invalid RTP URL (expected rtp://host:port, payload=l16)");
+		}
+		return false;
+	}
+
+	m_running = true;
+	auto resolver = std::make_shared<asio::ip::udp::resolver>(m_io);
+	resolver->async_resolve(m_host, m_port,
+				WeakHandler(this, [this, resolver](const asio::error_code &ec,
+								   asio::ip::udp::resolver::results_type results) {
+					OnResolved(ec, results);
+				}));
+	return true;
+}
+
+void RtpSink::OnResolved(const asio::error_code &ec, const asio::ip::udp::resolver::results_type &results)
+{
+	std::unique_lock<std::mutex> lock(m_socketMutex);
+	// Disconnected while resolving
+	if (!m_running)
+		return;
+
+	asio::error_code socketEc = ec;
+	if (!socketEc && results.empty()) {
+		socketEc = asio::error::host_not_found;
+	}
+	if (!socketEc) {
+		asio::ip::udp::endpoint endpoint = *results.begin();
+		m_socket.open(endpoint.protocol(), socketEc);
+		// Connected UDP: fixed destination, and local_endpoint() gives the SDP origin address
+		if (!socketEc)
+			m_socket.connect(endpoint, socketEc);
+		if (!socketEc)
+			m_socket.non_blocking(true, socketEc);
+	}
+	if (socketEc) {
+		asio::error_code ignored;
+		m_socket.close(ignored);
+		m_running = false;
+		lock.unlock();
+
+		blog(LOG_ERROR, "[Audio to WebSocket] RTP connection to %s failed: %s", m_uri.c_str(),
+		     socketEc.message().c_str());
+		if (m_onError) {
+			m_onError("RTP connection failed: " + socketEc.message());
+		}
+		return;
+	}
+
+	std::random_device rd;
+	m_seq = static_cast<uint16_t>(rd());
+	m_ssrc = rd();
+	m_nextTimestamp = rd();
+	m_fecSeq = static_cast<uint16_t>(rd());
+	m_fecSsrc = rd();
+	m_haveNextPacketNs = false;
+	m_marker = true;
+	m_sampleRate = 0;
+	m_channels = 0;
+	m_fecCount = 0;
+	m_connected = true;
+	lock.unlock();
+
+	blog(LOG_INFO, "[Audio to WebSocket] RTP output to %s:%s (PT %u%s)", m_host.c_str(), m_port.c_str(),
+	     m_payloadType, m_fecGroup > 0 ? ", XOR FEC" : "");
+	if (m_onConnected) {
+		m_onConnected();
+	}
+}
+
+void RtpSink::Disconnect()
+{
+	if (!m_running.exchange(false))
+		return;
+
+	bool wasConnected;
+	{
+		// Waits out a send in progress on the audio thread, and a pending resolve sees m_running cleared
+		std::lock_guard<std::mutex> lock(m_socketMutex);
+		wasConnected = m_connected.exchange(false);
+		asio::error_code ec;
+		m_socket.close(ec);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_sdpMutex);
+		m_sdp.clear();
+	}
+
+	if (wasConnected && m_onDisconnected) {
+		m_onDisconnected();
+	}
+}
+
+std::string RtpSink::GetSdp() const
+{
+	std::lock_guard<std::mutex> lock(m_sdpMutex);
+	return m_sdp;
+}
+
+void RtpSink::UpdateDescription(uint32_t sampleRate, uint32_t channels, size_t framesPerPacket)
+{
+	asio::error_code ec;
+	asio::ip::udp::endpoint local = m_socket.local_endpoint(ec);
+	asio::ip::udp::endpoint remote = m_socket.remote_endpoint(ec);
+	const char *family = remote.address().is_v6() ? "IP6" : "IP4";
+
+	std::ostringstream sdp;
+	sdp << "v=0\r\n";
+	sdp << "o=- " << m_ssrc << " 1 IN " << family << " " << local.address().to_string() << "\r\n";
+	sdp << "s=OBS Audio to WebSocket\r\n";
+	sdp << "c=IN " << family << " " << remote.address().to_string() << "\r\n";
+	sdp << "t=0 0\r\n";
+	sdp << "m=audio " << remote.port() << " RTP/AVP " << static_cast<int>(m_payloadType);
+	if (m_fecGroup > 0) {
+		sdp << " " << static_cast<int>(m_payloadType + 1);
+	}
+	sdp << "\r\n";
+	sdp << "a=rtpmap:" << static_cast<int>(m_payloadType) << " L16/" << sampleRate << "/" << channels << "\r\n";
+	sdp << "a=ptime:" << (framesPerPacket * 1000.0 / sampleRate) << "\r\n";
+	if (m_fecGroup > 0) {
+		sdp << "a=rtpmap:" << static_cast<int>(m_payloadType + 1) << " x-xor-fec/" << sampleRate << "\r\n";
+		sdp << "a=fmtp:" << static_cast<int>(m_payloadType + 1) << " group=" << m_fecGroup
+		    << "; ssrc=" << m_fecSsrc << "\r\n";
+	}
+	sdp << "a=ssrc:" << m_ssrc << " cname:obs-audio-to-websocket\r\n";
+	sdp << "a=sendonly\r\n";
+
+	std::string description = sdp.str();
+	{
+		std::lock_guard<std::mutex> lock(m_sdpMutex);
+		m_sdp = description;
+	}
+
+	if (m_onDescription) {
+		m_onDescription(description);
+	}
+}
+
+void RtpSink::SendAudioPacket(const AudioPacketPtr &packet)
+{
+	if (!m_connected || !packet)
+		return;
+
+	// Only contended while connecting or disconnecting
+	std::lock_guard<std::mutex> lock(m_socketMutex);
+	if (!m_connected)
+		return;
+
+	const AudioFormat &format = packet->format;
+	if (format.bitDepth != 16 || format.channels == 0 || format.sampleRate == 0) {
+		if (!m_formatErrorLogged) {
+			m_formatErrorLogged = true;
+			blog(LOG_ERROR, "[Audio to WebSocket] RTP output only supports 16-bit PCM");
+		}
+		m_droppedPackets++;
+		RecordDropped();
+		return;
+	}
+
+	const size_t bytesPerFrame = format.channels * sizeof(int16_t);
+	const size_t frames = packet->payloadSize() / bytesPerFrame;
+	if (frames == 0)
+		return;
+
+	if (format.sampleRate != m_sampleRate || format.channels != m_channels) {
+		m_sampleRate = format.sampleRate;
+		m_channels = format.channels;
+		// Parity packets carry the FEC header on top of the largest media payload in their group
+		size_t overhead = RTP_HEADER_SIZE + (m_fecGroup > 0 ? FEC_HEADER_SIZE : 0);
+		m_framesPerPacket = std::max<size_t>(1, (m_mtu - overhead) / bytesPerFrame);
+		m_haveNextPacketNs = false;
+		m_marker = true;
+		UpdateDescription(m_sampleRate, m_channels, std::min(frames, m_framesPerPacket));
+	}
+
+	// RTP timestamps advance by the frames sent, so rounding in OBS's nanosecond timestamps can't make the
+	// steps uneven. They skip ahead only when at least a packet's worth of audio is missing (mute, stalls),
+	// so the gap stays visible to the receiver.
+	const uint64_t durationNs = frames * 1000000000ULL / m_sampleRate;
+	if (m_haveNextPacketNs && packet->timestamp > m_nextPacketNs + durationNs) {
+		uint64_t gapNs = packet->timestamp - m_nextPacketNs;
+		m_nextTimestamp += static_cast<uint32_t>(gapNs * m_sampleRate / 1000000000ULL);
+	}
+	m_nextPacketNs = packet->timestamp + durationNs;
+	m_haveNextPacketNs = true;
+	const uint32_t timestamp = m_nextTimestamp;
+	m_nextTimestamp += static_cast<uint32_t>(frames);
+
+	const uint8_t *in = packet->payload();
+	for (size_t offset = 0; offset < frames; offset += m_framesPerPacket) {
+		size_t count = std::min(m_framesPerPacket, frames - offset);
+		size_t length = count * bytesPerFrame;
+
+		// L16 is network byte order; the packet payload is little-endian
+		m_payload.resize(length);
+		const uint8_t *src = in + offset * bytesPerFrame;
+		for (size_t i = 0; i < length; i += 2) {
+			m_payload[i] = src[i + 1];
+			m_payload[i + 1] = src[i];
+		}
+
+		uint32_t ts = timestamp + static_cast<uint32_t>(offset);
+		SendRtp(m_payloadType, m_seq, ts, m_ssrc, m_marker, m_payload.data(), length);
+		if (m_fecGroup > 0) {
+			AddToFec(m_seq, ts, m_marker, m_payload.data(), length);
+		}
+
+		m_seq++;
+		m_marker = false;
+	}
+	RecordSent(packet->captureNs, packet->data.size());
+}
+
+void RtpSink::SendRtp(uint8_t payloadType, uint16_t seq, uint32_t timestamp, uint32_t ssrc, bool marker,
+		      const uint8_t *payload, size_t length)
+{
+	m_datagram.resize(RTP_HEADER_SIZE + length);
+	uint8_t *out = m_datagram.data();
+	out[0] = 0x80; // V=2, no padding, no extension, no CSRCs
+	out[1] = static_cast<uint8_t>((marker ? 0x80 : 0x00) | (payloadType & 0x7F));
+	WriteUint16BE(out + 2, seq);
+	WriteUint32BE(out + 4, timestamp);
+	WriteUint32BE(out + 8, ssrc);
+	memcpy(out + RTP_HEADER_SIZE, payload, length);
+
+	asio::error_code ec;
+	m_socket.send(asio::buffer(m_datagram), 0, ec);
+	if (ec) {
+		// would_block: socket buffer full, connection_refused: nobody listening yet - drop either way
+		m_droppedPackets++;
+	}
+}
+
+void RtpSink::AddToFec(uint16_t seq, uint32_t timestamp, bool marker, const uint8_t *payload, size_t length)
+{
+	if (m_fecCount == 0) {
+		m_fecBaseSeq = seq;
+		m_fecHeaderXor = 0;
+		m_fecTimestampXor = 0;
+		m_fecLengthXor = 0;
+		std::fill(m_fecPayload.begin(), m_fecPayload.end(), 0);
+	}
+
+	if (m_fecPayload.size() < length) {
+		m_fecPayload.resize(length, 0);
+	}
+	for (size_t i = 0; i < length; ++i) {
+		m_fecPayload[i] ^= payload[i];
+	}
+	m_fecHeaderXor ^= static_cast<uint8_t>((marker ? 0x80 : 0x00) | m_payloadType);
+	m_fecTimestampXor ^= timestamp;
+	m_fecLengthXor ^= static_cast<uint16_t>(length);
+	m_fecCount++;
+
+	if (m_fecCount < m_fecGroup)
+		return;
+
+	// Parity packet: header recovers M/PT, timestamp and length of a single lost packet in the group
+	m_fecPacket.resize(FEC_HEADER_SIZE + m_fecPayload.size());
+	uint8_t *fec = m_fecPacket.data();
+	WriteUint16BE(fec, m_fecBaseSeq);
+	fec[2] = m_fecCount;
+	fec[3] = m_fecHeaderXor;
+	WriteUint32BE(fec + 4, m_fecTimestampXor);
+	WriteUint16BE(fec + 8, m_fecLengthXor);
+	memcpy(fec + FEC_HEADER_SIZE, m_fecPayload.data(), m_fecPayload.size());
+
+	SendRtp(static_cast<uint8_t>(m_payloadType + 1), m_fecSeq++, timestamp, m_fecSsrc, false, fec,
+		m_fecPacket.size());
+	m_fecCount = 0;
+}
+
+} // namespace obs_audio_to_websocket
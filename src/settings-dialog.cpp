@@ -2,6 +2,9 @@
 #include "obs-audio-to-websocket/audio-streamer.hpp"
 #include "obs-audio-to-websocket/websocketpp-client.hpp"
 #include "obs-audio-to-websocket/obs-source-wrapper.hpp"
+#include "obs-audio-to-websocket/constants.hpp"
+#include "obs-audio-to-websocket/trace.hpp"
+#include <algorithm>
 #include <chrono>
 #include <util/config-file.h>
 #include <QVBoxLayout>
@@ -16,6 +19,12 @@
 #include <QMessageBox>
 #include <QUrl>
 #include <QCheckBox>
+#include <QSpinBox>
+#include <QStringList>
+#include <QInputDialog>
+#include <QFileDialog>
+#include <QFile>
+#include <QSignalBlocker>
 #include <obs.h>
 #include <obs-frontend-api.h>
 
@@ -41,18 +50,37 @@ SettingsDialog::SettingsDialog(QWidget *parent) : QDialog(parent), m_streamer(&A
 	m_updateTimer->start(100); // Update every 100ms
 }
 
-SettingsDialog::~SettingsDialog()
-{
-	cleanupVolumeMeter();
-}
+SettingsDialog::~SettingsDialog() = default;
 
 void SettingsDialog::setupUi()
 {
 	setWindowTitle("Audio to WebSocket Settings");
-	setFixedSize(450, 400);
+	setFixedSize(450, 965);
 
 	auto *mainLayout = new QVBoxLayout(this);
 
+	// Stream Profile Group
+	auto *profileGroup = new QGroupBox("Stream Profile", this);
+	auto *profileLayout = new QGridLayout(profileGroup);
+
+	profileLayout->addWidget(new QLabel("Profile:", this), 0, 0);
+	m_profileCombo = new QComboBox(this);
+	m_profileCombo->setToolTip("Each profile streams its own source to its own endpoints");
+	profileLayout->addWidget(m_profileCombo, 0, 1);
+
+	m_addProfileButton = new QPushButton("Add", this);
+	m_addProfileButton->setMaximumWidth(80);
+	profileLayout->addWidget(m_addProfileButton, 0, 2);
+
+	m_removeProfileButton = new QPushButton("Remove", this);
+	m_removeProfileButton->setMaximumWidth(80);
+	profileLayout->addWidget(m_removeProfileButton, 0, 3);
+
+	m_profileEnabledCheckBox = new QCheckBox("Stream this profile", this);
+	profileLayout->addWidget(m_profileEnabledCheckBox, 1, 0, 1, 4);
+
+	mainLayout->addWidget(profileGroup);
+
 	// Connection Settings Group
 	auto *connectionGroup = new QGroupBox("WebSocket Connection", this);
 	auto *connectionLayout = new QGridLayout(connectionGroup);
@@ -60,6 +88,7 @@ void SettingsDialog::setupUi()
 	connectionLayout->addWidget(new QLabel("URL:", this), 0, 0);
 	m_urlEdit = new QLineEdit(this);
 	m_urlEdit->setPlaceholderText("ws://localhost:8889/audio");
+	m_urlEdit->setToolTip("Separate multiple endpoints with commas to stream to all of them at once");
 	connectionLayout->addWidget(m_urlEdit, 0, 1, 1, 2);
 
 	m_testButton = new QPushButton("Test Connection", this);
@@ -68,23 +97,78 @@ void SettingsDialog::setupUi()
 	m_autoConnectCheckBox = new QCheckBox("Auto-connect when streaming starts", this);
 	connectionLayout->addWidget(m_autoConnectCheckBox, 1, 0, 1, 4);
 
+	m_serverCheckBox = new QCheckBox("Serve audio to subscribers on port:", this);
+	m_serverCheckBox->setToolTip("Consumers connect to OBS and receive audio instead of OBS connecting to them");
+	connectionLayout->addWidget(m_serverCheckBox, 2, 0, 1, 3);
+
+	m_serverPortSpin = new QSpinBox(this);
+	m_serverPortSpin->setRange(1, 65535);
+	m_serverPortSpin->setValue(constants::DEFAULT_SERVER_PORT);
+	connectionLayout->addWidget(m_serverPortSpin, 2, 3);
+
+	m_nativeWebSocketCheckBox = new QCheckBox("Use lightweight WebSocket client for ws:// endpoints", this);
+	m_nativeWebSocketCheckBox->setToolTip(
+		"Built-in RFC 6455 client that batches queued audio into fewer writes. wss:// always uses WebSocket++.");
+	connectionLayout->addWidget(m_nativeWebSocketCheckBox, 3, 0, 1, 4);
+
 	mainLayout->addWidget(connectionGroup);
 
 	// Audio Settings Group
 	auto *audioGroup = new QGroupBox("Audio Settings", this);
 	auto *audioLayout = new QGridLayout(audioGroup);
 
-	audioLayout->addWidget(new QLabel("Source:", this), 0, 0);
+	audioLayout->addWidget(new QLabel("Capture:", this), 0, 0);
+	m_captureCombo = new QComboBox(this);
+	m_captureCombo->addItem("Source", "source");
+	m_captureCombo->addItem("Output mix tracks", "mix");
+	m_captureCombo->setToolTip("Output mix tracks stream OBS's final mix; each selected track is its own stream");
+	audioLayout->addWidget(m_captureCombo, 0, 1, 1, 3);
+
+	audioLayout->addWidget(new QLabel("Source:", this), 1, 0);
 	m_audioSourceCombo = new QComboBox(this);
-	audioLayout->addWidget(m_audioSourceCombo, 0, 1, 1, 2);
+	audioLayout->addWidget(m_audioSourceCombo, 1, 1, 1, 2);
 
 	m_refreshButton = new QPushButton("Refresh", this);
 	m_refreshButton->setMaximumWidth(80);
 	connect(m_refreshButton, &QPushButton::clicked, this, &SettingsDialog::populateAudioSources);
-	audioLayout->addWidget(m_refreshButton, 0, 3);
+	audioLayout->addWidget(m_refreshButton, 1, 3);
+
+	audioLayout->addWidget(new QLabel("Tracks:", this), 2, 0);
+	auto *tracksLayout = new QHBoxLayout();
+	for (size_t i = 0; i < m_trackCheckBoxes.size(); ++i) {
+		m_trackCheckBoxes[i] = new QCheckBox(QString::number(i + 1), this);
+		tracksLayout->addWidget(m_trackCheckBoxes[i]);
+	}
+	tracksLayout->addStretch();
+	audioLayout->addLayout(tracksLayout, 2, 1, 1, 3);
+
+	audioLayout->addWidget(new QLabel("Format:", this), 3, 0);
+	m_formatCombo = new QComboBox(this);
+	m_formatCombo->addItem("16-bit PCM", SampleEncodingName(SampleEncoding::Int16));
+	m_formatCombo->addItem("32-bit float PCM", SampleEncodingName(SampleEncoding::Float32));
+	m_formatCombo->addItem("Log-mel features (16-bit float)", "logmel-f16");
+	m_formatCombo->addItem("Log-mel features (32-bit float)", "logmel-f32");
+	audioLayout->addWidget(m_formatCombo, 3, 1, 1, 3);
+
+	// OBS converts mix tracks itself; source capture always streams at OBS's rate and layout
+	audioLayout->addWidget(new QLabel("Convert:", this), 4, 0);
+	m_sampleRateCombo = new QComboBox(this);
+	m_sampleRateCombo->addItem("OBS rate", 0);
+	for (int rate : {16000, 22050, 24000, 32000, 44100, 48000}) {
+		m_sampleRateCombo->addItem(QString("%1 Hz").arg(rate), rate);
+	}
+	m_sampleRateCombo->setToolTip("Output mix tracks only: OBS resamples before handing audio over");
+	audioLayout->addWidget(m_sampleRateCombo, 4, 1, 1, 2);
+
+	m_channelsCombo = new QComboBox(this);
+	m_channelsCombo->addItem("OBS layout", 0);
+	m_channelsCombo->addItem("Mono", 1);
+	m_channelsCombo->addItem("Stereo", 2);
+	m_channelsCombo->setToolTip("Output mix tracks only: OBS downmixes before handing audio over");
+	audioLayout->addWidget(m_channelsCombo, 4, 3);
 
 	// Audio level indicator
-	audioLayout->addWidget(new QLabel("Level:", this), 1, 0);
+	audioLayout->addWidget(new QLabel("Level:", this), 5, 0);
 	m_audioLevelBar = new QProgressBar(this);
 	m_audioLevelBar->setRange(0, 100);
 	m_audioLevelBar->setValue(0);
@@ -99,7 +183,17 @@ void SettingsDialog::setupUi()
 				       "    stop: 0 #00ff00, stop: 0.8 #ffff00, stop: 1 #ff0000);"
 				       "  border-radius: 2px;"
 				       "}");
-	audioLayout->addWidget(m_audioLevelBar, 1, 1, 1, 3);
+	audioLayout->addWidget(m_audioLevelBar, 5, 1, 1, 3);
+
+	m_sendLevelsCheckBox = new QCheckBox("Send levels to consumers", this);
+	m_sendLevelsCheckBox->setToolTip(
+		"Adds a small \"levels\" message (per-channel peak, RMS and true peak) every 100 ms of audio");
+	audioLayout->addWidget(m_sendLevelsCheckBox, 6, 1, 1, 3);
+
+	m_adaptiveCheckBox = new QCheckBox("Adapt format to the link", this);
+	m_adaptiveCheckBox->setToolTip("PCM only: steps down to 16-bit, 16 kHz, then mono 8 kHz while endpoints "
+				       "back up or drop packets, and back up once the link has been clear for a while");
+	audioLayout->addWidget(m_adaptiveCheckBox, 7, 1, 1, 3);
 
 	mainLayout->addWidget(audioGroup);
 
@@ -118,8 +212,34 @@ void SettingsDialog::setupUi()
 	m_muteStatusLabel->setStyleSheet("QLabel { color: orange; font-weight: bold; }");
 	statusLayout->addWidget(m_muteStatusLabel);
 
+	m_subscribersLabel = new QLabel("", this);
+	statusLayout->addWidget(m_subscribersLabel);
+
 	mainLayout->addWidget(statusGroup);
 
+	// Pipeline Stats Group
+	auto *statsGroup = new QGroupBox("Pipeline Stats", this);
+	auto *statsLayout = new QVBoxLayout(statsGroup);
+
+	m_statsLabel = new QLabel("Not streaming", this);
+	m_statsLabel->setStyleSheet("QLabel { font-family: monospace; }");
+	m_statsLabel->setToolTip("Current profile, since streaming started. Capture to send ends when an endpoint "
+				 "writes the packet out, consumer when a consumer acknowledges receipt; endpoints and "
+				 "drops are summed.");
+	statsLayout->addWidget(m_statsLabel);
+
+	auto *traceLayout = new QHBoxLayout();
+	m_recordTraceCheckBox = new QCheckBox("Record trace", this);
+	m_recordTraceCheckBox->setToolTip("Record per-block timings of every stream (capture, encode, send, network "
+					  "write) for chrome://tracing or ui.perfetto.dev");
+	m_saveTraceButton = new QPushButton("Save Trace...", this);
+	traceLayout->addWidget(m_recordTraceCheckBox);
+	traceLayout->addStretch();
+	traceLayout->addWidget(m_saveTraceButton);
+	statsLayout->addLayout(traceLayout);
+
+	mainLayout->addWidget(statsGroup);
+
 	// Control Buttons
 	auto *buttonLayout = new QHBoxLayout();
 
@@ -140,11 +260,35 @@ void SettingsDialog::setupUi()
 
 void SettingsDialog::connectSignals()
 {
+	connect(m_profileCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+		&SettingsDialog::onProfileSelected);
+	connect(m_addProfileButton, &QPushButton::clicked, this, &SettingsDialog::onAddProfile);
+	connect(m_removeProfileButton, &QPushButton::clicked, this, &SettingsDialog::onRemoveProfile);
+	connect(m_profileEnabledCheckBox, &QCheckBox::toggled, this, &SettingsDialog::onProfileEnabledToggled);
+	connect(m_formatCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+		&SettingsDialog::onFormatChanged);
+	connect(m_captureCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+		&SettingsDialog::onCaptureModeChanged);
+	for (auto *trackCheckBox : m_trackCheckBoxes) {
+		connect(trackCheckBox, &QCheckBox::toggled, this, &SettingsDialog::onTrackToggled);
+	}
+	connect(m_sampleRateCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+		&SettingsDialog::onSampleRateChanged);
+	connect(m_channelsCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+		&SettingsDialog::onChannelsChanged);
 	connect(m_testButton, &QPushButton::clicked, this, &SettingsDialog::onTestConnection);
 	connect(m_startStopButton, &QPushButton::clicked, this, &SettingsDialog::onStartStopToggled);
 	connect(m_audioSourceCombo, &QComboBox::currentTextChanged, this, &SettingsDialog::onAudioSourceChanged);
 	connect(m_urlEdit, &QLineEdit::textChanged, this, &SettingsDialog::onUrlChanged);
 	connect(m_autoConnectCheckBox, &QCheckBox::toggled, this, &SettingsDialog::onAutoConnectToggled);
+	connect(m_serverCheckBox, &QCheckBox::toggled, this, &SettingsDialog::onServerModeToggled);
+	connect(m_serverPortSpin, QOverload<int>::of(&QSpinBox::valueChanged), this,
+		&SettingsDialog::onServerPortChanged);
+	connect(m_nativeWebSocketCheckBox, &QCheckBox::toggled, this, &SettingsDialog::onNativeWebSocketToggled);
+	connect(m_sendLevelsCheckBox, &QCheckBox::toggled, this, &SettingsDialog::onSendLevelsToggled);
+	connect(m_adaptiveCheckBox, &QCheckBox::toggled, this, &SettingsDialog::onAdaptiveToggled);
+	connect(m_recordTraceCheckBox, &QCheckBox::toggled, this, &SettingsDialog::onRecordTraceToggled);
+	connect(m_saveTraceButton, &QPushButton::clicked, this, &SettingsDialog::onSaveTrace);
 
 	// Connect thread-safe test connection error signal
 	connect(this, &SettingsDialog::testConnectionError, this, &SettingsDialog::onTestConnectionError,
@@ -155,45 +299,99 @@ void SettingsDialog::connectSignals()
 	connect(m_streamer, &AudioStreamer::streamingStatusChanged, this, &SettingsDialog::updateStreamingStatus);
 	connect(m_streamer, &AudioStreamer::dataRateChanged, this, &SettingsDialog::updateDataRate);
 	connect(m_streamer, &AudioStreamer::errorOccurred, this, &SettingsDialog::showError);
+	// Shedding shows up in the stats panel right away rather than at the next refresh
+	connect(m_streamer, &AudioStreamer::cpuLoadChanged, this, &SettingsDialog::updateStats);
 }
 
 void SettingsDialog::loadSettings()
 {
-	// Load from OBS user config
-#if LIBOBS_API_MAJOR_VER >= 31
-	config_t *config = obs_frontend_get_user_config();
-#else
-	config_t *config = obs_frontend_get_profile_config();
-#endif
+	// AudioStreamer::LoadSettings already read the config when the module loaded
+	m_profiles = m_streamer->GetProfiles();
 
-	const char *url = config_get_string(config, "AudioStreamer", "WebSocketUrl");
-	if (url && strlen(url) > 0) {
-		m_urlEdit->setText(url);
-		m_streamer->SetWebSocketUrl(url);
-	} else {
-		m_urlEdit->setText(QString::fromStdString(m_streamer->GetWebSocketUrl()));
+	m_loadingProfile = true;
+	m_profileCombo->clear();
+	for (const auto &profile : m_profiles) {
+		m_profileCombo->addItem(QString::fromStdString(profile.name));
 	}
+	m_loadingProfile = false;
+	showProfile(0);
 
-	const char *source = config_get_string(config, "AudioStreamer", "AudioSource");
-	if (source && strlen(source) > 0) {
-		int index = m_audioSourceCombo->findText(source);
-		if (index >= 0) {
-			m_audioSourceCombo->setCurrentIndex(index);
-			m_streamer->SetAudioSource(source);
-			// Enable start button if source is valid
-			m_startStopButton->setEnabled(true);
-		}
+	m_autoConnectCheckBox->setChecked(m_streamer->IsAutoConnectEnabled());
+	m_serverCheckBox->setChecked(m_streamer->IsServerEnabled());
+	m_serverPortSpin->setValue(m_streamer->GetServerPort());
+}
+
+void SettingsDialog::showProfile(int index)
+{
+	if (index < 0 || index >= static_cast<int>(m_profiles.size()))
+		return;
+
+	m_currentProfile = index;
+	const StreamProfile &profile = m_profiles[index];
+
+	m_loadingProfile = true;
+	m_profileCombo->setCurrentIndex(index);
+	m_profileEnabledCheckBox->setChecked(profile.enabled);
+	m_urlEdit->setText(QString::fromStdString(profile.urls));
+	m_captureCombo->setCurrentIndex(profile.capture == CaptureMode::MixTracks ? 1 : 0);
+	m_audioSourceCombo->setCurrentIndex(m_audioSourceCombo->findText(QString::fromStdString(profile.audioSource)));
+	for (size_t i = 0; i < m_trackCheckBoxes.size(); ++i) {
+		m_trackCheckBoxes[i]->setChecked(profile.mixTracks & (1u << i));
+	}
+	m_formatCombo->setCurrentIndex(m_formatCombo->findData(QString::fromStdString(OutputFormatName(profile))));
+	// Rates set by hand in the config file aren't in the list; show them as OBS's rather than nothing
+	int rateIndex = m_sampleRateCombo->findData(static_cast<int>(profile.sampleRate));
+	m_sampleRateCombo->setCurrentIndex(std::max(rateIndex, 0));
+	int channelsIndex = m_channelsCombo->findData(static_cast<int>(profile.channels));
+	m_channelsCombo->setCurrentIndex(std::max(channelsIndex, 0));
+	m_nativeWebSocketCheckBox->setChecked(profile.nativeWebSocket);
+	m_sendLevelsCheckBox->setChecked(profile.sendLevels);
+	m_adaptiveCheckBox->setChecked(profile.adaptive);
+	m_loadingProfile = false;
+
+	updateCaptureControls();
+
+	if (!m_streamer->IsStreaming()) {
+		m_removeProfileButton->setEnabled(m_profiles.size() > 1);
+		m_startStopButton->setEnabled(hasStreamableProfile());
 	}
+}
+
+void SettingsDialog::applyProfiles()
+{
+	m_streamer->SetProfiles(m_profiles);
+	// Save settings immediately
+	saveSettings();
+}
 
-	bool autoConnect = config_get_bool(config, "AudioStreamer", "AutoConnect");
-	m_autoConnectCheckBox->setChecked(autoConnect);
-	m_streamer->SetAutoConnectEnabled(autoConnect);
+bool SettingsDialog::hasStreamableProfile() const
+{
+	return std::any_of(m_profiles.begin(), m_profiles.end(),
+			   [](const StreamProfile &profile) { return profile.enabled && profile.HasInput(); });
+}
+
+void SettingsDialog::updateCaptureControls()
+{
+	bool editable = !m_streamer->IsStreaming();
+	bool mix = !m_profiles.empty() && m_profiles[m_currentProfile].capture == CaptureMode::MixTracks;
+
+	m_captureCombo->setEnabled(editable);
+	m_audioSourceCombo->setEnabled(editable && !mix);
+	m_refreshButton->setEnabled(editable && !mix);
+	for (auto *trackCheckBox : m_trackCheckBoxes) {
+		trackCheckBox->setEnabled(editable && mix);
+	}
+	m_sampleRateCombo->setEnabled(editable && mix);
+	m_channelsCombo->setEnabled(editable && mix);
+	// Feature streams are already small and have a single format
+	bool features = !m_profiles.empty() && m_profiles[m_currentProfile].IsFeatureStream();
+	m_adaptiveCheckBox->setEnabled(editable && !features);
 }
 
 bool SettingsDialog::saveSettings()
 {
 	// Silently fail if UI elements don't exist yet
-	if (!m_urlEdit || !m_audioSourceCombo || !m_autoConnectCheckBox) {
+	if (!m_autoConnectCheckBox || !m_serverCheckBox || !m_serverPortSpin) {
 		return false;
 	}
 
@@ -211,16 +409,139 @@ bool SettingsDialog::saveSettings()
 	}
 
 	// Save settings
-	std::string urlStdString = m_urlEdit->text().trimmed().toStdString();
-	std::string audioSourceStdString = m_audioSourceCombo->currentText().toStdString();
-	config_set_string(config, "AudioStreamer", "WebSocketUrl", urlStdString.c_str());
-	config_set_string(config, "AudioStreamer", "AudioSource", audioSourceStdString.c_str());
+	std::string profilesJson = SerializeProfiles(m_profiles);
+	config_set_string(config, "AudioStreamer", "Profiles", profilesJson.c_str());
 	config_set_bool(config, "AudioStreamer", "AutoConnect", m_autoConnectCheckBox->isChecked());
+	config_set_bool(config, "AudioStreamer", "ServerEnabled", m_serverCheckBox->isChecked());
+	config_set_int(config, "AudioStreamer", "ServerPort", m_serverPortSpin->value());
 
 	config_save(config);
 	return true;
 }
 
+void SettingsDialog::onProfileSelected(int index)
+{
+	if (m_loadingProfile)
+		return;
+	showProfile(index);
+}
+
+void SettingsDialog::onAddProfile()
+{
+	bool ok = false;
+	QString name = QInputDialog::getText(this, "Add Stream Profile", "Profile name:", QLineEdit::Normal,
+					     QString("Profile %1").arg(m_profiles.size() + 1), &ok)
+			       .trimmed();
+	if (!ok || name.isEmpty())
+		return;
+
+	std::string nameStdString = name.toStdString();
+	bool exists = std::any_of(m_profiles.begin(), m_profiles.end(),
+				  [&nameStdString](const StreamProfile &profile) { return profile.name == nameStdString; });
+	if (exists) {
+		QMessageBox::warning(this, "Add Stream Profile", "A profile with this name already exists.");
+		return;
+	}
+
+	StreamProfile profile;
+	profile.name = nameStdString;
+	m_profiles.push_back(profile);
+
+	m_loadingProfile = true;
+	m_profileCombo->addItem(name);
+	m_loadingProfile = false;
+	showProfile(static_cast<int>(m_profiles.size()) - 1);
+	applyProfiles();
+}
+
+void SettingsDialog::onRemoveProfile()
+{
+	if (m_profiles.size() <= 1)
+		return;
+
+	QString name = QString::fromStdString(m_profiles[m_currentProfile].name);
+	if (QMessageBox::question(this, "Remove Stream Profile", QString("Remove profile \"%1\"?").arg(name)) !=
+	    QMessageBox::Yes) {
+		return;
+	}
+
+	int index = m_currentProfile;
+	m_profiles.erase(m_profiles.begin() + index);
+
+	m_loadingProfile = true;
+	m_profileCombo->removeItem(index);
+	m_loadingProfile = false;
+	showProfile(std::min(index, static_cast<int>(m_profiles.size()) - 1));
+	applyProfiles();
+}
+
+void SettingsDialog::onProfileEnabledToggled(bool enabled)
+{
+	if (m_loadingProfile)
+		return;
+	m_profiles[m_currentProfile].enabled = enabled;
+	if (!m_streamer->IsStreaming()) {
+		m_startStopButton->setEnabled(hasStreamableProfile());
+	}
+	applyProfiles();
+}
+
+void SettingsDialog::onFormatChanged(int index)
+{
+	if (m_loadingProfile || index < 0)
+		return;
+	std::string name = m_formatCombo->itemData(index).toString().toStdString();
+	ApplyOutputFormat(name, m_profiles[m_currentProfile]);
+	updateCaptureControls();
+	applyProfiles();
+}
+
+void SettingsDialog::onCaptureModeChanged(int index)
+{
+	if (m_loadingProfile || index < 0)
+		return;
+	bool mix = m_captureCombo->itemData(index).toString() == "mix";
+	m_profiles[m_currentProfile].capture = mix ? CaptureMode::MixTracks : CaptureMode::Source;
+	updateCaptureControls();
+	if (!m_streamer->IsStreaming()) {
+		m_startStopButton->setEnabled(hasStreamableProfile());
+	}
+	applyProfiles();
+}
+
+void SettingsDialog::onTrackToggled()
+{
+	if (m_loadingProfile)
+		return;
+	uint32_t tracks = 0;
+	for (size_t i = 0; i < m_trackCheckBoxes.size(); ++i) {
+		if (m_trackCheckBoxes[i]->isChecked()) {
+			tracks |= 1u << i;
+		}
+	}
+	m_profiles[m_currentProfile].mixTracks = tracks;
+	if (!m_streamer->IsStreaming()) {
+		m_startStopButton->setEnabled(hasStreamableProfile());
+	}
+	applyProfiles();
+}
+
+void SettingsDialog::onSampleRateChanged(int index)
+{
+	if (m_loadingProfile || index < 0)
+		return;
+	m_profiles[m_currentProfile].sampleRate = m_sampleRateCombo->itemData(index).toUInt();
+	applyProfiles();
+}
+
+void SettingsDialog::onChannelsChanged(int index)
+{
+	if (m_loadingProfile || index < 0)
+		return;
+	m_profiles[m_currentProfile].channels = m_channelsCombo->itemData(index).toUInt();
+	applyProfiles();
+}
+
 void SettingsDialog::onStartStopToggled()
 {
 	if (m_streamer->IsStreaming()) {
@@ -238,18 +559,27 @@ void SettingsDialog::onTestConnection()
 		return;
 	}
 
-	// Validate URL format
-	if (!url.startsWith("ws://") && !url.startsWith("wss://")) {
-		QMessageBox::warning(this, "Invalid URL", "WebSocket URL must start with ws:// or wss://");
-		return;
-	}
+	// Validate URL format - each comma-separated endpoint is tested independently
+	std::vector<std::string> urls = ParseUrlList(url.toStdString());
+	for (const auto &entry : urls) {
+		QString entryUrl = QString::fromStdString(entry);
+		if (!IsSupportedSinkUri(entry)) {
+			const char *message =
+				entryUrl.startsWith("wss://")
+					? "This build has no TLS support; use ws:// or a build with wss:// enabled."
+					: "URL must start with ws://, wss://, tcp://, unix://, rtp:// or shm://";
+			QMessageBox::warning(this, "Invalid URL", message);
+			return;
+		}
 
-	// Basic URL validation - check for host and path
-	QUrl qurl(url);
-	if (!qurl.isValid() || qurl.host().isEmpty()) {
-		QMessageBox::warning(this, "Invalid URL",
-				     "Please enter a valid WebSocket URL.\nExample: ws://localhost:8889/audio");
-		return;
+		// Basic URL validation - check for host and path (unix:// carries a socket path instead)
+		QUrl qurl(entryUrl);
+		bool needsHost = !entryUrl.startsWith("unix://");
+		if (!qurl.isValid() || (needsHost && qurl.host().isEmpty())) {
+			QMessageBox::warning(this, "Invalid URL",
+					     "Please enter a valid WebSocket URL.\nExample: ws://localhost:8889/audio");
+			return;
+		}
 	}
 
 	// Test WebSocket connection without affecting current state
@@ -264,23 +594,49 @@ void SettingsDialog::onTestConnection()
 	m_statusLabel->setText("Testing connection...");
 	m_statusLabel->setStyleSheet("QLabel { font-weight: bold; color: blue; }");
 
-	// Create a temporary WebSocket client for testing
-	auto testClient = std::make_shared<WebSocketPPClient>();
+	// Create a temporary WebSocket client per endpoint for testing
+	std::vector<std::shared_ptr<AudioSink>> testClients;
+	for (const auto &entry : urls) {
+		// A shared-memory ring has no peer to reach, and a test writer would take over the name from a live one
+		if (entry.compare(0, 6, "shm://") == 0)
+			continue;
 
-	// Capture error messages using thread-safe signal
-	QString errorMsg;
-	testClient->SetOnError(
-		[this](const std::string &error) { emit testConnectionError(QString::fromStdString(error)); });
+		auto testClient = CreateAudioSink(entry, m_profiles[m_currentProfile].GetSinkOptions());
 
-	testClient->Connect(url.toStdString());
+		// Capture error messages using thread-safe signal
+		testClient->SetOnError(
+			[this](const std::string &error) { emit testConnectionError(QString::fromStdString(error)); });
+
+		testClient->Connect(entry);
+		testClients.push_back(testClient);
+	}
+
+	if (testClients.empty()) {
+		m_testButton->setEnabled(true);
+		m_testButton->setText("Test Connection");
+		m_statusLabel->setText(originalStatus);
+		m_statusLabel->setStyleSheet(originalStyle);
+		QMessageBox::information(this, "Connection Test",
+					 "Shared-memory endpoints have nothing to connect to; the ring is created when "
+					 "streaming starts.");
+		return;
+	}
 
 	QTimer::singleShot(2000, this, // 2 second timeout
-			   [this, testClient, originalStatus, originalStyle, errorMsg]() {
+			   [this, testClients, originalStatus, originalStyle]() {
 				   m_testButton->setEnabled(true);
 				   m_testButton->setText("Test Connection");
 
-				   if (testClient->IsConnected()) {
+				   QStringList failed;
+				   for (const auto &testClient : testClients) {
+					   if (!testClient->IsConnected()) {
+						   failed << QString::fromStdString(testClient->GetUri());
+					   }
+					   // Failed clients too: stops their reconnect timers on the shared network threads
 					   testClient->Disconnect();
+				   }
+
+				   if (failed.isEmpty()) {
 					   m_statusLabel->setText("Test successful!");
 					   m_statusLabel->setStyleSheet("QLabel { font-weight: bold; color: green; }");
 					   QMessageBox::information(this, "Connection Test",
@@ -290,8 +646,8 @@ void SettingsDialog::onTestConnection()
 					   m_statusLabel->setStyleSheet("QLabel { font-weight: bold; color: red; }");
 
 					   QString message = "Connection test failed.";
-					   if (!errorMsg.isEmpty()) {
-						   message += " " + errorMsg;
+					   if (testClients.size() > 1) {
+						   message += "\n\nUnreachable:\n" + failed.join("\n");
 					   }
 					   QMessageBox::warning(this, "Connection Test", message);
 				   }
@@ -306,20 +662,22 @@ void SettingsDialog::onTestConnection()
 
 void SettingsDialog::onAudioSourceChanged(const QString &source)
 {
-	m_streamer->SetAudioSource(source.toStdString());
-	// Enable/disable start button based on whether source is selected
+	if (m_loadingProfile)
+		return;
+	m_profiles[m_currentProfile].audioSource = source.toStdString();
+	// Enable/disable start button based on whether any profile has a source
 	if (!m_streamer->IsStreaming()) {
-		m_startStopButton->setEnabled(!source.isEmpty());
+		m_startStopButton->setEnabled(hasStreamableProfile());
 	}
-	// Save settings immediately
-	saveSettings();
+	applyProfiles();
 }
 
 void SettingsDialog::onUrlChanged(const QString &url)
 {
-	m_streamer->SetWebSocketUrl(url.toStdString());
-	// Save settings immediately
-	saveSettings();
+	if (m_loadingProfile)
+		return;
+	m_profiles[m_currentProfile].urls = url.trimmed().toStdString();
+	applyProfiles();
 }
 
 void SettingsDialog::onAutoConnectToggled(bool enabled)
@@ -331,6 +689,69 @@ void SettingsDialog::onAutoConnectToggled(bool enabled)
 	saveSettings();
 }
 
+void SettingsDialog::onServerModeToggled(bool enabled)
+{
+	m_streamer->SetServerEnabled(enabled);
+	// Save settings immediately
+	saveSettings();
+}
+
+void SettingsDialog::onServerPortChanged(int port)
+{
+	m_streamer->SetServerPort(port);
+	// Save settings immediately
+	saveSettings();
+}
+
+void SettingsDialog::onNativeWebSocketToggled(bool enabled)
+{
+	if (m_loadingProfile)
+		return;
+	m_profiles[m_currentProfile].nativeWebSocket = enabled;
+	applyProfiles();
+}
+
+void SettingsDialog::onSendLevelsToggled(bool enabled)
+{
+	if (m_loadingProfile)
+		return;
+	m_profiles[m_currentProfile].sendLevels = enabled;
+	applyProfiles();
+}
+
+void SettingsDialog::onAdaptiveToggled(bool enabled)
+{
+	if (m_loadingProfile)
+		return;
+	m_profiles[m_currentProfile].adaptive = enabled;
+	applyProfiles();
+}
+
+void SettingsDialog::onRecordTraceToggled(bool enabled)
+{
+	if (enabled && !Tracer::IsEnabled()) {
+		Tracer::Instance().Clear();
+	}
+	Tracer::Instance().SetEnabled(enabled);
+}
+
+void SettingsDialog::onSaveTrace()
+{
+	QString path = QFileDialog::getSaveFileName(this, "Save Trace", "audio-to-websocket-trace.json",
+						    "Trace files (*.json)");
+	if (path.isEmpty())
+		return;
+
+	std::string trace = Tracer::Instance().Collect().dump();
+	QFile file(path);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+	    file.write(trace.data(), static_cast<qint64>(trace.size())) != static_cast<qint64>(trace.size())) {
+		showError(QString("Could not write %1: %2").arg(path, file.errorString()));
+		return;
+	}
+	blog(LOG_INFO, "[Audio to WebSocket] Saved trace to %s", path.toUtf8().constData());
+}
+
 void SettingsDialog::updateConnectionStatus(bool connected)
 {
 	// Update status based on both connection and streaming state
@@ -344,10 +765,25 @@ void SettingsDialog::updateConnectionStatus(bool connected)
 				m_statusLabel->setStyleSheet("QLabel { font-weight: bold; color: green; }");
 			}
 		} else {
-			// Check if we're in reconnection phase
-			auto wsClient = m_streamer->GetWebSocketClient();
-			if (wsClient && wsClient->IsReconnecting()) {
-				int attempts = wsClient->GetReconnectAttempts();
+			// Check if any sink is in reconnection phase
+			std::shared_ptr<AudioSink> reconnecting;
+			if (auto pipelines = m_streamer->GetPipelines()) {
+				for (const auto &pipeline : *pipelines) {
+					auto sinks = pipeline->GetSinks();
+					if (!sinks)
+						continue;
+					for (const auto &sink : *sinks) {
+						if (sink->IsReconnecting()) {
+							reconnecting = sink;
+							break;
+						}
+					}
+					if (reconnecting)
+						break;
+				}
+			}
+			if (reconnecting) {
+				int attempts = reconnecting->GetReconnectAttempts();
 				m_statusLabel->setText(
 					QString("Streaming (Reconnecting... attempt %1/10)").arg(attempts));
 				m_statusLabel->setStyleSheet("QLabel { font-weight: bold; color: orange; }");
@@ -379,23 +815,37 @@ void SettingsDialog::updateStreamingStatus(bool streaming)
 			m_startStopButton->setEnabled(true);
 			m_startStopButton->setToolTip("");
 		}
-		// Disable changing settings while streaming
-		m_audioSourceCombo->setEnabled(false);
-		m_refreshButton->setEnabled(false);
+		// Disable changing settings while streaming; profiles can still be browsed
+		m_addProfileButton->setEnabled(false);
+		m_removeProfileButton->setEnabled(false);
+		m_profileEnabledCheckBox->setEnabled(false);
+		m_formatCombo->setEnabled(false);
 		m_urlEdit->setEnabled(false);
 		m_testButton->setEnabled(false);
+		m_serverCheckBox->setEnabled(false);
+		m_serverPortSpin->setEnabled(false);
+		m_nativeWebSocketCheckBox->setEnabled(false);
+		m_sendLevelsCheckBox->setEnabled(false);
 	} else {
 		m_startStopButton->setText("Start Streaming");
 		m_startStopButton->setToolTip("");
 		// Re-enable controls when not streaming
-		m_audioSourceCombo->setEnabled(true);
-		m_refreshButton->setEnabled(true);
+		m_addProfileButton->setEnabled(true);
+		m_removeProfileButton->setEnabled(m_profiles.size() > 1);
+		m_profileEnabledCheckBox->setEnabled(true);
+		m_formatCombo->setEnabled(true);
 		m_urlEdit->setEnabled(true);
 		m_testButton->setEnabled(true);
-		// Start button enabled when audio source is selected
-		m_startStopButton->setEnabled(!m_audioSourceCombo->currentText().isEmpty());
+		m_serverCheckBox->setEnabled(true);
+		m_serverPortSpin->setEnabled(true);
+		m_nativeWebSocketCheckBox->setEnabled(true);
+		m_sendLevelsCheckBox->setEnabled(true);
+		// Start button enabled when some enabled profile has an audio source
+		m_startStopButton->setEnabled(hasStreamableProfile());
 	}
 
+	updateCaptureControls();
+
 	// Update the status label to reflect streaming state
 	updateConnectionStatus(m_streamer->IsConnected());
 }
@@ -453,64 +903,173 @@ void SettingsDialog::onTestConnectionError(const QString &error)
 
 void SettingsDialog::updateStatus()
 {
-	// Update audio level and mute status
-	if (!m_audioSourceCombo->currentText().isEmpty()) {
-		std::string sourceNameStdString = m_audioSourceCombo->currentText().toStdString();
-		obs_source_t *source = obs_get_source_by_name(sourceNameStdString.c_str());
-		if (source) {
-			// Update volume meter attachment
-			cleanupVolumeMeter();
-
-			// Create and attach new volmeter
-			m_volmeter = obs_volmeter_create(OBS_FADER_LOG);
-			obs_volmeter_add_callback(m_volmeter, volumeCallback, this);
-			obs_volmeter_attach_source(m_volmeter, source);
-
-			// Show current peak level
-			float db = m_currentPeak;
-			if (db < -60.0f)
-				db = -60.0f;
-			if (db > 0.0f)
-				db = 0.0f;
-
-			// Convert to 0-100 range
-			int level = static_cast<int>((db + 60.0f) / 60.0f * 100.0f);
-			m_audioLevelBar->setValue(level);
-
-			// Check mute status
-			if (m_streamer->IsStreaming()) {
-				bool muted = obs_source_muted(source);
-				if (muted) {
-					m_muteStatusLabel->setText("⚠️ Audio source is MUTED");
-					m_muteStatusLabel->show();
-				} else {
-					m_muteStatusLabel->hide();
-				}
-			} else {
-				m_muteStatusLabel->hide();
-			}
+	// Update subscriber count for server mode
+	if (m_streamer->IsStreaming() && m_streamer->IsServerEnabled()) {
+		m_subscribersLabel->setText(QString("Subscribers: %1 (port %2)")
+						    .arg(m_streamer->GetSubscriberCount())
+						    .arg(m_streamer->GetServerPort()));
+		m_subscribersLabel->show();
+	} else {
+		m_subscribersLabel->hide();
+	}
 
-			obs_source_release(source);
-		} else {
-			m_audioLevelBar->setValue(0);
-			m_muteStatusLabel->hide();
+	updateLevels();
+	// Stats move slowly next to the level bar; every half second is plenty
+	if (++m_statusTicks % 5 == 0) {
+		updateStats();
+	}
+	// Consumers can start and stop recording with control messages too
+	if (m_recordTraceCheckBox->isChecked() != Tracer::IsEnabled()) {
+		QSignalBlocker blocker(m_recordTraceCheckBox);
+		m_recordTraceCheckBox->setChecked(Tracer::IsEnabled());
+	}
 
-			// Clean up volmeter if source not found
-			cleanupVolumeMeter();
-		}
+	// Check mute status
+	bool muted = false;
+	if (m_streamer->IsStreaming() && !m_audioSourceCombo->currentText().isEmpty()) {
+		OBSSourceWrapper source(m_audioSourceCombo->currentText().toStdString());
+		muted = source && obs_source_muted(source.get());
+	}
+	if (muted) {
+		m_muteStatusLabel->setText("⚠️ Audio source is MUTED");
+		m_muteStatusLabel->show();
 	} else {
-		m_audioLevelBar->setValue(0);
 		m_muteStatusLabel->hide();
+	}
+}
+
+std::vector<std::shared_ptr<StreamPipeline>> SettingsDialog::currentPipelines() const
+{
+	std::vector<std::shared_ptr<StreamPipeline>> matches;
+	auto pipelines = m_streamer->GetPipelines();
+	if (!pipelines || m_profiles.empty())
+		return matches;
+
+	// A mix track profile runs one pipeline per track, named "<profile> (Track N)"
+	const std::string &name = m_profiles[m_currentProfile].name;
+	for (const auto &pipeline : *pipelines) {
+		const std::string &pipelineName = pipeline->GetProfile().name;
+		if (pipelineName == name || pipelineName.rfind(name + " (Track ", 0) == 0) {
+			matches.push_back(pipeline);
+		}
+	}
+	return matches;
+}
+
+void SettingsDialog::updateLevels()
+{
+	// The current profile's pipelines meter every block anyway; show the loudest
+	AudioLevels levels;
+	for (const auto &pipeline : currentPipelines()) {
+		AudioLevels candidate = pipeline->GetLevels();
+		if (candidate.channels > 0 && (levels.channels == 0 || candidate.MaxPeak() > levels.MaxPeak())) {
+			levels = candidate;
+		}
+	}
 
-		// Clean up volmeter if no source selected
-		cleanupVolumeMeter();
+	if (levels.channels == 0) {
+		m_audioLevelBar->setValue(0);
+		m_audioLevelBar->setToolTip("Levels are shown while the profile is streaming");
+		return;
 	}
+
+	// Show current peak level, converted from -60..0 dBFS to 0-100
+	float db = std::clamp(AmplitudeToDb(levels.MaxPeak()), -60.0f, 0.0f);
+	m_audioLevelBar->setValue(static_cast<int>((db + 60.0f) / 60.0f * 100.0f));
+
+	QString tooltip = "Peak / RMS / true peak (dBFS)";
+	for (uint32_t ch = 0; ch < levels.channels; ++ch) {
+		tooltip += QString("\nCh %1: %2 / %3 / %4")
+				   .arg(ch + 1)
+				   .arg(AmplitudeToDb(levels.peak[ch]), 0, 'f', 1)
+				   .arg(AmplitudeToDb(levels.rms[ch]), 0, 'f', 1)
+				   .arg(AmplitudeToDb(levels.truePeak[ch]), 0, 'f', 1);
+	}
+	m_audioLevelBar->setToolTip(tooltip);
+}
+
+void SettingsDialog::updateStats()
+{
+	std::vector<std::shared_ptr<StreamPipeline>> pipelines = currentPipelines();
+	if (pipelines.empty()) {
+		m_statsLabel->setText("Not streaming");
+		return;
+	}
+
+	// Tracks of one profile are merged into a single set of figures
+	HistogramSnapshot callback, queueWait, encode, captureToSend, queueDepth, sinkBuffer, captureToConsumer,
+		syncRtt;
+	uint64_t packets = 0, bytes = 0, drops = 0, overruns = 0;
+	uint32_t shedStage = 0;
+	for (const auto &pipeline : pipelines) {
+		const PipelineStats &stats = pipeline->GetStats();
+		callback.Add(stats.callbackNs);
+		queueWait.Add(stats.queueWaitNs);
+		encode.Add(stats.encodeNs);
+		captureToSend.Add(stats.captureToSendNs);
+		queueDepth.Add(stats.encoderQueueDepth);
+		sinkBuffer.Add(stats.sinkQueueBytes);
+		captureToConsumer.Add(stats.captureToConsumerNs);
+		syncRtt.Add(stats.clockSyncRttNs);
+		packets += stats.packetsSent.load(std::memory_order_relaxed);
+		bytes += stats.bytesSent.load(std::memory_order_relaxed);
+		drops += stats.packetsDropped.load(std::memory_order_relaxed);
+		overruns += stats.budgetOverruns.load(std::memory_order_relaxed);
+		shedStage = std::max(shedStage, stats.shedStage.load(std::memory_order_relaxed));
+	}
+
+	auto duration = [](uint64_t ns) {
+		return ns < 1000000 ? QString("%1 us").arg(ns / 1000.0, 0, 'f', 0)
+				    : QString("%1 ms").arg(ns / 1000000.0, 0, 'f', 1);
+	};
+	auto kilobytes = [](uint64_t value) { return QString("%1 KB").arg(value / 1024.0, 0, 'f', 0); };
+	auto count = [](uint64_t value) { return QString::number(value); };
+	auto row = [](const char *label, const HistogramSnapshot &histogram, auto format) {
+		return QString("%1 p50 %2  p99 %3  max %4")
+			.arg(QString(label).leftJustified(13))
+			.arg(format(histogram.Percentile(0.50)), 7)
+			.arg(format(histogram.Percentile(0.99)), 7)
+			.arg(format(histogram.GetMax()), 7);
+	};
+
+	QStringList lines;
+	lines << row("Callback", callback, duration);
+	if (queueWait.GetCount() > 0) {
+		lines << row("Queue wait", queueWait, duration);
+	}
+	lines << row("Encode", encode, duration);
+	lines << row("Capture->send", captureToSend, duration);
+	if (queueDepth.GetCount() > 0) {
+		lines << row("Lane depth", queueDepth, count);
+	}
+	lines << row("Sink buffer", sinkBuffer, kilobytes);
+	// Only consumers that take part in clock sync and acknowledge packets fill these
+	if (captureToConsumer.GetCount() > 0) {
+		lines << row("Consumer", captureToConsumer, duration);
+	}
+	if (syncRtt.GetCount() > 0) {
+		lines << row("Sync RTT", syncRtt, duration);
+	}
+	if (overruns > 0) {
+		lines << QString("%1 %2 overruns, shedding %3")
+				 .arg(QString("CPU budget").leftJustified(13))
+				 .arg(overruns)
+				 .arg(ShedStageName(static_cast<ShedStage>(shedStage)));
+	}
+	lines << QString("Sent %1 packets (%2 MB), dropped %3")
+			 .arg(packets)
+			 .arg(bytes / (1024.0 * 1024.0), 0, 'f', 1)
+			 .arg(drops);
+	m_statsLabel->setText(lines.join("\n"));
 }
 
 void SettingsDialog::populateAudioSources()
 {
-	// Save current selection
-	QString currentSelection = m_audioSourceCombo->currentText();
+	// Save current selection; rebuilding the list must not rewrite the profile's source
+	QString currentSelection = m_profiles.empty()
+					   ? m_audioSourceCombo->currentText()
+					   : QString::fromStdString(m_profiles[m_currentProfile].audioSource);
+	m_loadingProfile = true;
 
 	m_audioSourceCombo->clear();
 
@@ -569,16 +1128,14 @@ void SettingsDialog::populateAudioSources()
 	}
 
 	// Restore previous selection if it still exists
-	if (!currentSelection.isEmpty()) {
-		int index = m_audioSourceCombo->findText(currentSelection);
-		if (index >= 0) {
-			m_audioSourceCombo->setCurrentIndex(index);
-		} else {
-			// Source no longer exists, show warning
-			m_statusLabel->setText("Previous source not found");
-			m_statusLabel->setStyleSheet("QLabel { font-weight: bold; color: orange; }");
-			QTimer::singleShot(3000, this, [this]() { updateConnectionStatus(m_streamer->IsConnected()); });
-		}
+	m_audioSourceCombo->setCurrentIndex(m_audioSourceCombo->findText(currentSelection));
+	m_loadingProfile = false;
+
+	if (!currentSelection.isEmpty() && m_audioSourceCombo->currentIndex() < 0) {
+		// Source no longer exists, show warning
+		m_statusLabel->setText("Previous source not found");
+		m_statusLabel->setStyleSheet("QLabel { font-weight: bold; color: orange; }");
+		QTimer::singleShot(3000, this, [this]() { updateConnectionStatus(m_streamer->IsConnected()); });
 	}
 }
 
@@ -594,49 +1151,4 @@ void SettingsDialog::selectDefaultMicrophoneSource()
 	}
 }
 
-void SettingsDialog::cleanupVolumeMeter()
-{
-	if (!m_volmeter) {
-		return;
-	}
-
-	try {
-		// Safely remove callback - this can fail if OBS is shutting down
-		obs_volmeter_remove_callback(m_volmeter, volumeCallback, this);
-	} catch (...) {
-		// Log error but continue with cleanup
-		blog(LOG_WARNING, "[Audio to WebSocket] Exception during volume meter callback removal");
-	}
-
-	try {
-		// Destroy the volume meter - this should not fail but be defensive
-		obs_volmeter_destroy(m_volmeter);
-	} catch (...) {
-		// Log error but continue
-		blog(LOG_ERROR, "[Audio to WebSocket] Exception during volume meter destruction");
-	}
-
-	// Always nullify the pointer regardless of cleanup success
-	m_volmeter = nullptr;
-}
-
-void SettingsDialog::volumeCallback(void *data, const float magnitude[MAX_AUDIO_CHANNELS],
-				    const float peak[MAX_AUDIO_CHANNELS], const float inputPeak[MAX_AUDIO_CHANNELS])
-{
-	UNUSED_PARAMETER(magnitude);
-	UNUSED_PARAMETER(inputPeak);
-
-	auto *dialog = static_cast<SettingsDialog *>(data);
-
-	// Use the highest peak from all channels
-	float maxPeak = -60.0f;
-	for (int i = 0; i < MAX_AUDIO_CHANNELS; i++) {
-		if (peak[i] > maxPeak) {
-			maxPeak = peak[i];
-		}
-	}
-
-	dialog->m_currentPeak = maxPeak;
-}
-
 } // namespace obs_audio_to_websocket
@@ -0,0 +1,130 @@
+#include "obs-audio-to-websocket/shm-ring-sink.hpp"
+#include "obs-audio-to-websocket/log.hpp"
+#include <cstdlib>
+#include <cstring>
+
+namespace obs_audio_to_websocket {
+
+namespace {
+
+constexpr const char *SHM_SCHEME = "shm://";
+
+bool ParseShmUri(const std::string &uri, std::string &name, size_t &capacity)
+{
+	if (uri.compare(0, strlen(SHM_SCHEME), SHM_SCHEME) != 0)
+		return false;
+
+	std::string rest = uri.substr(strlen(SHM_SCHEME));
+	size_t query = rest.find('?');
+	name = rest.substr(0, query);
+	capacity = SHM_RING_DEFAULT_CAPACITY;
+
+	if (query != std::string::npos) {
+		std::string params = rest.substr(query + 1);
+		const std::string sizeKey = "size=";
+		size_t sizePos = params.find(sizeKey);
+		if (sizePos != std::string::npos) {
+			const char *value = params.c_str() + sizePos + sizeKey.length();
+			char *end = nullptr;
+			unsigned long long size = strtoull(value, &end, 10);
+			if (end == value || (*end != '\0' && *end != '&') || size < SHM_RING_MIN_CAPACITY ||
+			    size > SHM_RING_MAX_CAPACITY)
+				return false;
+			capacity = static_cast<size_t>(size);
+		}
+	}
+
+	return !name.empty() && name.find('/') == std::string::npos;
+}
+
+} // namespace
+
+ShmRingSink::~ShmRingSink()
+{
+	Disconnect();
+}
+
+bool ShmRingSink::Connect(const std::string &uri)
+{
+	m_uri = uri;
+
+	std::string name;
+	size_t capacity = 0;
+	if (!ParseShmUri(uri, name, capacity)) {
+		blog(LOG_ERROR, "[Audio to WebSocket] Invalid shared-memory URL: %s", uri.c_str());
+		if (m_onError) {
+			m_onError("Invalid shared-memory URL (expected shm://name[?size=4096..268435456])");
+		}
+		return false;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_writeMutex);
+		if (!m_writer.Create(name, capacity)) {
+			std::string errorMessage = m_writer.GetError();
+			blog(LOG_ERROR, "[Audio to WebSocket] Could not create shared-memory ring '%s': %s",
+			     name.c_str(), errorMessage.c_str());
+			if (m_onError) {
+				m_onError("Shared-memory ring failed: " + errorMessage);
+			}
+			return false;
+		}
+	}
+
+	blog(LOG_INFO, "[Audio to WebSocket] Shared-memory ring '%s' ready (%zu KB)", name.c_str(), capacity / 1024);
+	m_open = true;
+
+	if (m_onConnected) {
+		m_onConnected();
+	}
+
+	SendControlMessage("start");
+	return true;
+}
+
+void ShmRingSink::Disconnect()
+{
+	if (!m_open.exchange(false))
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_writeMutex);
+		m_writer.Close();
+	}
+
+	if (m_onDisconnected) {
+		m_onDisconnected();
+	}
+}
+
+void ShmRingSink::SendAudioPacket(const AudioPacketPtr &packet)
+{
+	if (!m_open || !packet)
+		return;
+
+	std::lock_guard<std::mutex> lock(m_writeMutex);
+	// The ring never waits for readers; only an oversized packet can fail
+	if (!m_writer.Write(ShmRecordType::AudioPacket, packet->data.data(), packet->data.size())) {
+		m_droppedPackets++;
+		RecordDropped();
+		return;
+	}
+	RecordSent(packet->captureNs, packet->data.size());
+}
+
+void ShmRingSink::SendControlText(const std::string &payload)
+{
+	if (!m_open)
+		return;
+
+	std::lock_guard<std::mutex> lock(m_writeMutex);
+	m_writer.Write(ShmRecordType::Control, payload.data(), payload.size());
+}
+
+uint32_t ShmRingSink::GetReaderCount() const
+{
+	std::lock_guard<std::mutex> lock(m_writeMutex);
+	return m_writer.GetReaderCount();
+}
+
+} // namespace obs_audio_to_websocket
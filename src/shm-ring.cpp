@@ -0,0 +1,446 @@
+#include "obs-audio-to-websocket/shm-ring.hpp"
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+
+namespace obs_audio_to_websocket {
+
+namespace {
+
+constexpr uint32_t FLAG_WRITER_CLOSED = 1u << 0;
+
+size_t AlignRecord(size_t length)
+{
+	return (sizeof(ShmRecordHeader) + length + 7) & ~static_cast<size_t>(7);
+}
+
+bool IsPowerOfTwo(size_t value)
+{
+	return value != 0 && (value & (value - 1)) == 0;
+}
+
+uint64_t SteadyNowNs()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		       std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+#ifndef _WIN32
+std::string ShmPath(const std::string &name)
+{
+	return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+// An existing segment may be replaced once its writer closed it or exited. Anything else - a live writer,
+// a header still being initialized, a foreign segment - keeps the name.
+bool IsStaleSegment(const std::string &path)
+{
+	int fd = shm_open(path.c_str(), O_RDONLY, 0);
+	if (fd < 0)
+		return errno == ENOENT; // Removed meanwhile, the next create may succeed
+
+	struct stat st;
+	bool stale = false;
+	if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= SHM_RING_HEADER_SIZE) {
+		void *mem = mmap(nullptr, SHM_RING_HEADER_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+		if (mem != MAP_FAILED) {
+			const auto *header = static_cast<const ShmRingHeader *>(mem);
+			if (header->magic == SHM_RING_MAGIC) {
+				std::atomic_thread_fence(std::memory_order_acquire);
+				pid_t pid = static_cast<pid_t>(header->writerPid);
+				bool closed = header->flags & FLAG_WRITER_CLOSED;
+				// kill(pid, 0) fails with EPERM for a live process owned by another user
+				stale = closed || pid <= 0 || (kill(pid, 0) != 0 && errno == ESRCH);
+			}
+			munmap(mem, SHM_RING_HEADER_SIZE);
+		}
+	}
+	close(fd);
+	return stale;
+}
+#endif
+
+#ifdef __linux__
+// Shared (not FUTEX_PRIVATE) futex so it works across processes mapping the same segment
+void FutexWait(std::atomic<uint32_t> *word, uint32_t expected, int timeoutMs)
+{
+	struct timespec ts;
+	ts.tv_sec = timeoutMs / 1000;
+	ts.tv_nsec = (timeoutMs % 1000) * 1000000L;
+	syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+}
+
+void FutexWakeAll(std::atomic<uint32_t> *word)
+{
+	syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+#endif
+
+} // namespace
+
+ShmRingWriter::~ShmRingWriter()
+{
+	Close();
+}
+
+bool ShmRingWriter::Create(const std::string &name, size_t capacity)
+{
+	Close();
+
+#ifdef _WIN32
+	(void)name;
+	(void)capacity;
+	m_error = "Shared-memory transport is not supported on Windows";
+	return false;
+#else
+	if (!IsPowerOfTwo(capacity) || capacity < SHM_RING_MIN_CAPACITY || capacity > SHM_RING_MAX_CAPACITY) {
+		m_error = "Ring capacity must be a power of two between 4 KB and 256 MB";
+		return false;
+	}
+
+	std::string path = ShmPath(name);
+
+	int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	int openErrno = errno;
+	if (fd < 0 && openErrno == EEXIST && IsStaleSegment(path)) {
+		// Left behind by a writer that exited without closing it
+		shm_unlink(path.c_str());
+		fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+		openErrno = errno;
+	}
+	if (fd < 0) {
+		m_error = openErrno == EEXIST ? "Another writer is using this ring"
+					      : std::string("shm_open failed: ") + strerror(openErrno);
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		m_error = std::string("fstat failed: ") + strerror(errno);
+		close(fd);
+		shm_unlink(path.c_str());
+		return false;
+	}
+
+	size_t mappedSize = SHM_RING_HEADER_SIZE + capacity;
+	if (ftruncate(fd, static_cast<off_t>(mappedSize)) != 0) {
+		m_error = std::string("ftruncate failed: ") + strerror(errno);
+		close(fd);
+		shm_unlink(path.c_str());
+		return false;
+	}
+
+	void *mem = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mem == MAP_FAILED) {
+		m_error = std::string("mmap failed: ") + strerror(errno);
+		shm_unlink(path.c_str());
+		return false;
+	}
+
+	// The fresh segment is zero-filled; construct the header in place
+	auto *header = new (mem) ShmRingHeader();
+	header->version = SHM_RING_VERSION;
+	header->headerSize = static_cast<uint32_t>(SHM_RING_HEADER_SIZE);
+	header->flags = 0;
+	header->capacity = capacity;
+	header->createdNs = SteadyNowNs();
+	header->writerPid = static_cast<uint32_t>(getpid());
+	header->writePos.store(0, std::memory_order_relaxed);
+	header->writeClaim.store(0, std::memory_order_relaxed);
+	header->sequence.store(0, std::memory_order_relaxed);
+	header->notify.store(0, std::memory_order_relaxed);
+	header->readersWaiting.store(0, std::memory_order_relaxed);
+	header->readers.store(0, std::memory_order_relaxed);
+
+	// Magic goes last so readers never attach to a half-initialized header
+	std::atomic_thread_fence(std::memory_order_release);
+	header->magic = SHM_RING_MAGIC;
+
+	m_name = path;
+	m_header = header;
+	m_data = static_cast<uint8_t *>(mem) + SHM_RING_HEADER_SIZE;
+	m_mappedSize = mappedSize;
+	m_device = static_cast<uint64_t>(st.st_dev);
+	m_inode = static_cast<uint64_t>(st.st_ino);
+	m_error.clear();
+	return true;
+#endif
+}
+
+void ShmRingWriter::Close()
+{
+	if (!m_header)
+		return;
+
+#ifndef _WIN32
+	// Tell attached readers we're gone, then remove the name; their mappings stay valid
+	m_header->flags |= FLAG_WRITER_CLOSED;
+	m_header->notify.fetch_add(1, std::memory_order_release);
+#ifdef __linux__
+	FutexWakeAll(&m_header->notify);
+#endif
+	munmap(m_header, m_mappedSize);
+
+	// Another writer may have replaced the segment (e.g. after deciding this process was gone)
+	int fd = shm_open(m_name.c_str(), O_RDONLY, 0);
+	if (fd >= 0) {
+		struct stat st;
+		bool ours = fstat(fd, &st) == 0 && static_cast<uint64_t>(st.st_dev) == m_device &&
+			    static_cast<uint64_t>(st.st_ino) == m_inode;
+		close(fd);
+		if (ours) {
+			shm_unlink(m_name.c_str());
+		}
+	}
+#endif
+
+	m_header = nullptr;
+	m_data = nullptr;
+	m_mappedSize = 0;
+}
+
+bool ShmRingWriter::Write(ShmRecordType type, const void *data, size_t length)
+{
+	if (!m_header)
+		return false;
+
+	const uint64_t capacity = m_header->capacity;
+	const size_t recordSize = AlignRecord(length);
+
+	// Keep at least half the ring readable so readers have a chance to keep up
+	if (recordSize > capacity / 2)
+		return false;
+
+	uint64_t pos = m_header->writePos.load(std::memory_order_relaxed);
+	uint64_t offset = pos & (capacity - 1);
+	uint64_t remaining = capacity - offset;
+
+	uint64_t start = pos;
+	if (recordSize > remaining) {
+		// Doesn't fit before the end: pad (or skip a sub-header tail) and start over at offset 0
+		start = pos + remaining;
+	}
+	uint64_t end = start + recordSize;
+
+	// Announce the overwrite range before touching any bytes a reader may be copying
+	m_header->writeClaim.store(end, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	uint64_t sequence = m_header->sequence.load(std::memory_order_relaxed);
+
+	if (start != pos && remaining >= sizeof(ShmRecordHeader)) {
+		ShmRecordHeader padding;
+		padding.length = static_cast<uint32_t>(remaining - sizeof(ShmRecordHeader));
+		padding.type = static_cast<uint32_t>(ShmRecordType::Padding);
+		padding.sequence = 0;
+		memcpy(m_data + offset, &padding, sizeof(padding));
+	}
+
+	ShmRecordHeader record;
+	record.length = static_cast<uint32_t>(length);
+	record.type = static_cast<uint32_t>(type);
+	record.sequence = sequence + 1;
+
+	uint8_t *out = m_data + (start & (capacity - 1));
+	memcpy(out, &record, sizeof(record));
+	if (length > 0) {
+		memcpy(out + sizeof(record), data, length);
+	}
+
+	m_header->writePos.store(end, std::memory_order_release);
+	m_header->sequence.store(sequence + 1, std::memory_order_release);
+	m_header->notify.fetch_add(1, std::memory_order_release);
+
+#ifdef __linux__
+	if (m_header->readersWaiting.load(std::memory_order_acquire) > 0) {
+		FutexWakeAll(&m_header->notify);
+	}
+#endif
+	return true;
+}
+
+uint32_t ShmRingWriter::GetReaderCount() const
+{
+	return m_header ? m_header->readers.load(std::memory_order_relaxed) : 0;
+}
+
+ShmRingReader::~ShmRingReader()
+{
+	Close();
+}
+
+bool ShmRingReader::Open(const std::string &name)
+{
+	Close();
+
+#ifdef _WIN32
+	(void)name;
+	m_error = "Shared-memory transport is not supported on Windows";
+	return false;
+#else
+	std::string path = ShmPath(name);
+	int fd = shm_open(path.c_str(), O_RDWR, 0);
+	if (fd < 0) {
+		m_error = std::string("shm_open failed: ") + strerror(errno);
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < SHM_RING_HEADER_SIZE) {
+		m_error = "Segment is too small to hold a ring header";
+		close(fd);
+		return false;
+	}
+
+	size_t mappedSize = static_cast<size_t>(st.st_size);
+	// Readers only write the advisory counters in the header
+	void *mem = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mem == MAP_FAILED) {
+		m_error = std::string("mmap failed: ") + strerror(errno);
+		return false;
+	}
+
+	auto *header = static_cast<ShmRingHeader *>(mem);
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (header->magic != SHM_RING_MAGIC || header->version != SHM_RING_VERSION ||
+	    header->headerSize != SHM_RING_HEADER_SIZE || !IsPowerOfTwo(header->capacity) ||
+	    SHM_RING_HEADER_SIZE + header->capacity > mappedSize) {
+		m_error = "Segment is not a compatible audio ring";
+		munmap(mem, mappedSize);
+		return false;
+	}
+
+	m_header = header;
+	m_data = static_cast<const uint8_t *>(mem) + SHM_RING_HEADER_SIZE;
+	m_mappedSize = mappedSize;
+	m_readPos = header->writePos.load(std::memory_order_acquire);
+	m_lostBytes = 0;
+	m_overruns = 0;
+	m_header->readers.fetch_add(1, std::memory_order_relaxed);
+	m_error.clear();
+	return true;
+#endif
+}
+
+void ShmRingReader::Close()
+{
+	if (!m_header)
+		return;
+
+#ifndef _WIN32
+	m_header->readers.fetch_sub(1, std::memory_order_relaxed);
+	munmap(m_header, m_mappedSize);
+#endif
+
+	m_header = nullptr;
+	m_data = nullptr;
+	m_mappedSize = 0;
+}
+
+bool ShmRingReader::Wait(uint32_t observedNotify, int timeoutMs)
+{
+#ifdef __linux__
+	m_header->readersWaiting.fetch_add(1, std::memory_order_acq_rel);
+	// Re-check after registering so a publish between the check and the wait isn't missed
+	if (m_header->notify.load(std::memory_order_acquire) == observedNotify) {
+		FutexWait(&m_header->notify, observedNotify, timeoutMs);
+	}
+	m_header->readersWaiting.fetch_sub(1, std::memory_order_acq_rel);
+#else
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+	while (m_header->notify.load(std::memory_order_acquire) == observedNotify &&
+	       std::chrono::steady_clock::now() < deadline) {
+		std::this_thread::sleep_for(std::chrono::microseconds(500));
+	}
+#endif
+	return m_header->notify.load(std::memory_order_acquire) != observedNotify;
+}
+
+ShmRingReader::Result ShmRingReader::Read(std::vector<uint8_t> &payload, ShmRecordType &type, int timeoutMs)
+{
+	if (!m_header)
+		return Result::Closed;
+
+	const uint64_t capacity = m_header->capacity;
+
+	for (;;) {
+		uint32_t observedNotify = m_header->notify.load(std::memory_order_acquire);
+		uint64_t writePos = m_header->writePos.load(std::memory_order_acquire);
+
+		if (m_readPos == writePos) {
+			if (m_header->flags & FLAG_WRITER_CLOSED)
+				return Result::Closed;
+			if (timeoutMs <= 0 || !Wait(observedNotify, timeoutMs))
+				return Result::Timeout;
+			continue;
+		}
+
+		if (writePos - m_readPos > capacity) {
+			m_lostBytes += writePos - m_readPos;
+			m_overruns++;
+			m_readPos = writePos;
+			return Result::Overrun;
+		}
+
+		uint64_t offset = m_readPos & (capacity - 1);
+		uint64_t remaining = capacity - offset;
+		if (remaining < sizeof(ShmRecordHeader)) {
+			// Tail too short for a header: the writer skipped it
+			m_readPos += remaining;
+			continue;
+		}
+
+		ShmRecordHeader record;
+		memcpy(&record, m_data + offset, sizeof(record));
+
+		size_t recordSize = AlignRecord(record.length);
+		bool sane = recordSize <= remaining;
+		if (sane && record.type != static_cast<uint32_t>(ShmRecordType::Padding)) {
+			payload.resize(record.length);
+			if (record.length > 0) {
+				memcpy(payload.data(), m_data + offset + sizeof(record), record.length);
+			}
+		}
+
+		// Validate the copy: if the writer has claimed this region since, the bytes may be torn
+		std::atomic_thread_fence(std::memory_order_acquire);
+		uint64_t claim = m_header->writeClaim.load(std::memory_order_relaxed);
+		if (!sane || claim - m_readPos > capacity) {
+			uint64_t newest = m_header->writePos.load(std::memory_order_acquire);
+			m_lostBytes += newest - m_readPos;
+			m_overruns++;
+			m_readPos = newest;
+			return Result::Overrun;
+		}
+
+		m_readPos += recordSize;
+		if (record.type == static_cast<uint32_t>(ShmRecordType::Padding)) {
+			continue;
+		}
+
+		type = static_cast<ShmRecordType>(record.type);
+		return Result::Ok;
+	}
+}
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,1029 @@
+#include "obs-audio-to-websocket/stream-pipeline.hpp"
+#include "obs-audio-to-websocket/audio-packet.hpp"
+#include "obs-audio-to-websocket/constants.hpp"
+#include "obs-audio-to-websocket/encoder-pool.hpp"
+#include "obs-audio-to-websocket/rtp-sink.hpp"
+#include "obs-audio-to-websocket/trace.hpp"
+#include "obs-audio-to-websocket/websocketpp-server.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "obs-audio-to-websocket/log.hpp"
+#include <nlohmann/json.hpp>
+
+namespace obs_audio_to_websocket {
+
+namespace {
+
+// Feature streams shedding extraction skip every other stretch of this length
+constexpr uint64_t FEATURE_SHED_PERIOD_NS = 100000000;
+
+// First half of a clock sync exchange. wallNs is the system clock at t1, so consumers that never reply
+// can still place stream timestamps in wall time.
+std::string MakeClockSyncRequest()
+{
+	uint64_t t1 = SteadyNowNs();
+	auto wall = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::system_clock::now().time_since_epoch());
+	return MakeControlMessage("clock_sync", {{"t1", t1}, {"wallNs", wall.count()}});
+}
+
+} // namespace
+
+StreamPipeline::StreamPipeline(StreamProfile profile)
+	: m_profile(std::move(profile)),
+	  m_inputName(m_profile.InputName()),
+	  m_sourceId(m_profile.SourceId()),
+	  m_ladder(m_profile.FormatLadder()),
+	  m_stats(std::make_shared<PipelineStats>()),
+	  m_lastRateUpdate(std::chrono::steady_clock::now())
+{
+	if (m_ladder.size() > 1) {
+		m_bitrate = std::make_unique<BitrateController>(m_ladder.size());
+	}
+	SetCpuBudget(constants::DEFAULT_CPU_BUDGET_PERCENT / 100.0);
+
+	m_ring.resize(constants::ENCODER_RING_BLOCKS);
+	for (auto &slot : m_ring) {
+		slot.samples.reserve(constants::ENCODER_RING_SLOT_SAMPLES);
+	}
+}
+
+StreamPipeline::~StreamPipeline()
+{
+	Stop();
+	// A request can still arrive from a sink draining after Stop
+	JoinTraceDump();
+}
+
+bool StreamPipeline::Start(WebSocketPPServer *server, int dscp, std::unique_ptr<AudioInput> input)
+{
+	if (m_running)
+		return true;
+
+	ResetCaptureState();
+	m_server = server;
+	// Blocks left over from the last run were dropped with its lane
+	m_ringHead = 0;
+	m_ringTail = 0;
+	m_ringFullLogged = false;
+	m_encoder = EncoderPool::Instance().IsEnabled()
+			    ? EncoderPool::Instance().CreateStream([this]() { EncodeQueued(); })
+			    : nullptr;
+	m_inlineCpuNs = 0;
+	m_inlineBlocks = 0;
+	m_running = true;
+
+	if (input) {
+		std::lock_guard<std::mutex> lock(m_inputMutex);
+		std::string error;
+		if (!input->Attach(*this, error)) {
+			m_running = false;
+			m_server = nullptr;
+			ReportError(error);
+			return false;
+		}
+		m_input = std::move(input);
+	}
+
+	ConnectSinks(dscp);
+	return true;
+}
+
+void StreamPipeline::Stop()
+{
+	if (!m_running.exchange(false))
+		return;
+
+	DetachInput();
+	if (m_encoder) {
+		// Queued blocks are dropped; one being encoded finishes first
+		m_encoder->Close();
+	}
+	DisconnectSinks();
+	JoinTraceDump();
+	m_server = nullptr;
+	m_dataRate = 0.0;
+	m_levels.Publish(AudioLevels());
+
+	blog(LOG_INFO, "[Audio to WebSocket] Profile '%s': encoded %llu blocks using %.1f ms CPU%s",
+	     m_profile.name.c_str(), static_cast<unsigned long long>(GetEncodedBlocks()), GetEncodeCpuTimeNs() / 1e6,
+	     m_encoder ? " on the encoder pool" : "");
+}
+
+void StreamPipeline::SetCpuBudget(double fraction)
+{
+	if (fraction <= 0.0) {
+		m_watchdog.reset();
+		return;
+	}
+
+	// Only stages with something to shed in this pipeline
+	std::vector<ShedStage> stages = {ShedStage::Metering};
+	if (m_profile.IsFeatureStream()) {
+		stages.push_back(ShedStage::Features);
+	}
+	if (std::any_of(m_ladder.begin(), m_ladder.end(), [](const FormatRung &rung) { return rung.sampleRate != 0; })) {
+		stages.push_back(ShedStage::Resampling);
+	}
+	stages.push_back(ShedStage::Packets);
+
+	CpuBudgetSettings settings;
+	settings.budgetFraction = fraction;
+	m_watchdog = std::make_unique<CpuWatchdog>(std::move(stages), settings);
+}
+
+uint64_t StreamPipeline::GetEncodeCpuTimeNs() const
+{
+	return m_encoder ? m_encoder->GetCpuTimeNs() : m_inlineCpuNs.load(std::memory_order_relaxed);
+}
+
+uint64_t StreamPipeline::GetEncodedBlocks() const
+{
+	return m_encoder ? m_encoder->GetJobCount() : m_inlineBlocks.load(std::memory_order_relaxed);
+}
+
+bool StreamPipeline::IsConnected() const
+{
+	WebSocketPPServer *server = m_server.load();
+	if (server && server->GetSubscriberCount() > 0)
+		return true;
+
+	auto sinks = GetSinks();
+	if (!sinks)
+		return false;
+
+	return std::any_of(sinks->begin(), sinks->end(),
+			   [](const std::shared_ptr<AudioSink> &sink) { return sink->IsConnected(); });
+}
+
+void StreamPipeline::ResetCaptureState()
+{
+	// Capture-thread state starts fresh for every run
+	m_formatLogged = false;
+	m_formatErrorLogged = false;
+	m_silenceCounter = 0;
+	m_extractor.reset();
+	m_levelMeter.Reset();
+	m_bytesSinceLastUpdate = 0;
+	m_lastRateUpdate = std::chrono::steady_clock::now();
+	m_lastClockSyncNs = SteadyNowNs();
+	// Every run starts on the best rung; the sinks are new, so are their drop counters
+	if (m_bitrate) {
+		m_bitrate->Reset();
+	}
+	m_rung = 0;
+	m_stats->formatRung = 0;
+	m_lastAdaptNs = m_lastClockSyncNs;
+	m_lastDropCount = 0;
+	m_resampler.reset();
+	if (m_watchdog) {
+		m_watchdog->Reset();
+	}
+	m_stats->shedStage = 0;
+	m_shedParity = 0;
+}
+
+void StreamPipeline::DetachInput()
+{
+	std::lock_guard<std::mutex> lock(m_inputMutex);
+
+	if (m_input) {
+		m_input->Detach();
+		m_input.reset();
+	}
+}
+
+void StreamPipeline::ConnectSinks(int dscp)
+{
+	std::vector<std::string> urlList = ParseUrlList(m_profile.urls);
+
+	auto sinks = std::make_shared<SinkList>();
+	std::vector<std::string> sinkUrls;
+	std::weak_ptr<StreamPipeline> weakSelf = weak_from_this();
+	for (const auto &url : urlList) {
+		auto sink = CreateAudioSink(url, m_profile.GetSinkOptions());
+		if (!sink) {
+			// wss:// is only missing from builds configured with ENABLE_TLS=OFF
+			bool tls = url.compare(0, 6, "wss://") == 0;
+			blog(LOG_ERROR, "[Audio to WebSocket] %s: %s",
+			     tls ? "This build has no TLS support" : "Unsupported URL scheme", url.c_str());
+			ReportError((tls ? "wss:// is not supported by this build: " : "Unsupported URL: ") + url);
+			continue;
+		}
+
+		if (m_profile.IsFeatureStream() && std::dynamic_pointer_cast<RtpSink>(sink)) {
+			// RTP payload types describe audio samples, not feature frames
+			blog(LOG_ERROR, "[Audio to WebSocket] Profile '%s': RTP can't carry log-mel features, skipping %s",
+			     m_profile.name.c_str(), url.c_str());
+			ReportError("RTP can't carry log-mel features: " + url);
+			continue;
+		}
+
+		sink->SetDscp(dscp);
+		sink->SetStats(m_stats);
+
+		// Sinks can report in after the pipeline is gone, so they only hold it weakly
+		std::weak_ptr<AudioSink> weakSink = sink;
+		sink->SetOnConnected([weakSelf, weakSink]() {
+			if (auto self = weakSelf.lock())
+				self->OnSinkConnected(weakSink);
+		});
+		sink->SetOnDisconnected([weakSelf]() {
+			auto self = weakSelf.lock();
+			if (self && self->m_onConnectionChanged)
+				self->m_onConnectionChanged();
+		});
+		sink->SetOnMessage([weakSelf, weakSink](const std::string &msg) {
+			if (auto self = weakSelf.lock())
+				self->OnSinkMessage(weakSink, msg);
+		});
+		sink->SetOnError([weakSelf, url](const std::string &err) {
+			if (auto self = weakSelf.lock())
+				self->OnSinkError(url, err);
+		});
+
+		if (auto rtpSink = std::dynamic_pointer_cast<RtpSink>(sink)) {
+			rtpSink->SetOnDescription([weakSelf, url](const std::string &sdp) {
+				if (auto self = weakSelf.lock())
+					self->BroadcastDescription(url, sdp);
+			});
+		}
+
+		sinks->push_back(sink);
+		sinkUrls.push_back(url);
+	}
+
+	if (sinks->empty() && !m_server.load()) {
+		blog(LOG_WARNING, "[Audio to WebSocket] Profile '%s': no WebSocket URL specified", m_profile.name.c_str());
+	}
+
+	std::atomic_store(&m_sinks, std::shared_ptr<const SinkList>(sinks));
+
+	if (WebSocketPPServer *server = m_server.load()) {
+		// Sinks get theirs as they connect; current subscribers get it now
+		server->BroadcastControlText(DescribeFormat());
+	}
+
+	for (size_t i = 0; i < sinks->size(); ++i) {
+		(*sinks)[i]->Connect(sinkUrls[i]);
+	}
+}
+
+void StreamPipeline::DisconnectSinks()
+{
+	// Swap the list out first so the audio thread stops handing packets to these sinks
+	auto sinks = std::atomic_exchange(&m_sinks, std::shared_ptr<const SinkList>());
+	if (!sinks)
+		return;
+
+	for (const auto &sink : *sinks) {
+		sink->SendControlMessage("stop");
+		sink->Disconnect();
+	}
+}
+
+void StreamPipeline::PushAudio(const AudioFrame &frame)
+{
+	// Blocks go on to Encode even with nothing connected, so levels stay live while sinks reconnect
+	if (!m_running || !GetSinks()) {
+		return;
+	}
+
+	uint32_t channels = frame.channels;
+	bool layout_valid = channels > 0 && channels <= MAX_FRAME_CHANNELS &&
+			    (frame.interleaved || std::all_of(frame.planes.begin(), frame.planes.begin() + channels,
+							      [](const float *plane) { return plane != nullptr; }));
+	if (!layout_valid) {
+		if (!m_formatErrorLogged) {
+			m_formatErrorLogged = true;
+			blog(LOG_ERROR, "[Audio to WebSocket] Profile '%s': unusable audio layout (%u channels, max %zu)",
+			     m_profile.name.c_str(), channels, MAX_FRAME_CHANNELS);
+		}
+		return;
+	}
+
+	uint64_t received = SteadyNowNs();
+	auto encoder = m_encoder;
+	if (!encoder) {
+		AudioFrame stamped = frame;
+		stamped.receivedNs = received;
+		uint64_t start = ThreadCpuTimeNs();
+		Encode(stamped);
+		m_inlineCpuNs.fetch_add(ThreadCpuTimeNs() - start, std::memory_order_relaxed);
+		m_inlineBlocks.fetch_add(1, std::memory_order_relaxed);
+		uint64_t done = SteadyNowNs();
+		m_stats->callbackNs.Record(done - received);
+		Tracer::Complete("callback", received, done, received);
+		return;
+	}
+
+	size_t head = m_ringHead.load(std::memory_order_relaxed);
+	size_t queued = head - m_ringTail.load(std::memory_order_acquire);
+	m_stats->encoderQueueDepth.Record(queued);
+	if (queued == m_ring.size()) {
+		// The lane is a whole ring behind: drop this block rather than wait or allocate
+		m_stats->blocksShed.fetch_add(1, std::memory_order_relaxed);
+		if (!m_ringFullLogged) {
+			m_ringFullLogged = true;
+			blog(LOG_WARNING, "[Audio to WebSocket] Profile '%s': encoder %zu blocks behind, dropping audio",
+			     m_profile.name.c_str(), queued);
+		}
+		return;
+	}
+
+	// The frame points into OBS's buffers, which are only valid during this call
+	FrameSlot &slot = m_ring[head % m_ring.size()];
+	slot.frame = frame;
+	slot.frame.receivedNs = received;
+	if (frame.interleaved) {
+		size_t bytes = frame.frames * channels * (frame.bitDepth / 8);
+		slot.bytes.resize(bytes);
+		memcpy(slot.bytes.data(), frame.interleaved, bytes);
+		slot.frame.interleaved = slot.bytes.data();
+	} else {
+		slot.samples.resize(static_cast<size_t>(frame.frames) * channels);
+		for (uint32_t ch = 0; ch < channels; ++ch) {
+			float *plane = slot.samples.data() + static_cast<size_t>(ch) * frame.frames;
+			memcpy(plane, frame.planes[ch], frame.frames * sizeof(float));
+			slot.frame.planes[ch] = plane;
+		}
+	}
+	m_ringHead.store(head + 1, std::memory_order_release);
+	encoder->Post();
+	uint64_t done = SteadyNowNs();
+	m_stats->callbackNs.Record(done - received);
+	Tracer::Complete("callback", received, done, received);
+}
+
+void StreamPipeline::EncodeQueued()
+{
+	size_t tail = m_ringTail.load(std::memory_order_relaxed);
+	if (tail == m_ringHead.load(std::memory_order_acquire))
+		return;
+	Encode(m_ring[tail % m_ring.size()].frame);
+	m_ringTail.store(tail + 1, std::memory_order_release);
+}
+
+void StreamPipeline::Encode(const AudioFrame &frame)
+{
+	auto sinks = GetSinks();
+	if (!m_running || !sinks) {
+		return;
+	}
+	uint64_t started = SteadyNowNs();
+	if (m_encoder) {
+		m_stats->queueWaitNs.Record(started - frame.receivedNs);
+		Tracer::Complete("queue_wait", frame.receivedNs, started, frame.receivedNs);
+	}
+	if (m_watchdog && m_watchdog->Sheds(ShedStage::Packets) && (++m_shedParity & 1)) {
+		// Last resort: every other block goes unprocessed. Filters restart after the gap rather than
+		// bridge it.
+		m_stats->blocksShed.fetch_add(1, std::memory_order_relaxed);
+		m_resampler.reset();
+		if (m_extractor) {
+			m_extractor->Reset();
+		}
+		return;
+	}
+	WebSocketPPServer *server = m_server.load();
+	if (server && server->GetSubscriberCount() == 0) {
+		server = nullptr;
+	}
+
+	// Levels are measured here once, for the dialog, the wire and the silence warning below, unless the
+	// watchdog has shed them
+	bool metering = !m_watchdog || !m_watchdog->Sheds(ShedStage::Metering);
+	bool interval_done = false;
+	float peak_level = metering ? m_levelMeter.Measure(frame, interval_done) : 0.0f;
+	if (interval_done) {
+		m_levels.Publish(m_levelMeter.GetLevels());
+	}
+
+	// Skip the conversion entirely when no sink or subscriber could take the packet
+	bool any_connected = server || std::any_of(sinks->begin(), sinks->end(),
+						   [](const std::shared_ptr<AudioSink> &sink) { return sink->IsConnected(); });
+	if (!any_connected) {
+		CheckBudget(frame, started);
+		return;
+	}
+
+	if (interval_done && m_profile.sendLevels) {
+		SendLevels(m_levelMeter.GetLevels(), *sinks, server);
+	}
+	if (m_bitrate) {
+		AdaptFormat(frame, *sinks, server);
+	}
+
+	if (m_profile.IsFeatureStream()) {
+		EncodeFeatures(frame, *sinks, server);
+	} else {
+		EncodePcm(frame, *sinks, server);
+	}
+	uint64_t encoded = SteadyNowNs();
+	m_stats->encodeNs.Record(encoded - started);
+	Tracer::Complete("encode", started, encoded, frame.receivedNs);
+	CheckBudget(frame, started);
+
+	// Only warn about silence, don't log normal levels
+	if (!metering) {
+		m_silenceCounter = 0;
+	} else if (peak_level < 0.0001f) { // Essentially silence (-80 dB)
+		m_silenceCounter++;
+		if (m_silenceCounter == 500) { // After ~10 seconds at 48kHz
+			blog(LOG_WARNING, "[Audio to WebSocket] No audio detected from '%s' - check source",
+			     m_inputName.c_str());
+		}
+	} else {
+		m_silenceCounter = 0;
+	}
+}
+
+void StreamPipeline::EncodePcm(const AudioFrame &input, const SinkList &sinks, WebSocketPPServer *server)
+{
+	const FormatRung &rung = m_ladder[m_rung.load(std::memory_order_relaxed)];
+	bool to_float = rung.encoding == SampleEncoding::Float32;
+	uint32_t bit_depth = to_float ? 32 : 16;
+	const AudioFrame &frame = ApplyRung(input, rung, bit_depth);
+	if (frame.frames == 0) {
+		// The resampler is still filling its history
+		return;
+	}
+
+	uint32_t channels = frame.channels;
+	size_t frames = frame.frames;
+	size_t data_size = frames * channels * (bit_depth / 8);
+
+	// Encode once, straight into the shared packet that every sink will send
+	auto packet = CreateAudioPacket(frame.timestamp, AudioFormat(frame.sampleRate, channels, bit_depth),
+					m_sourceId, m_inputName, data_size);
+	packet->captureNs = frame.receivedNs;
+	uint8_t *out_ptr = packet->payload();
+
+	{
+		TraceSpan span("convert", frame.receivedNs);
+		if (frame.interleaved) {
+			CopyInterleaved(frame, out_ptr, data_size);
+		} else {
+			ConvertPlanar(frame, to_float, out_ptr);
+		}
+	}
+
+	// Log audio format info once per run
+	if (!m_formatLogged) {
+		m_formatLogged = true;
+		blog(LOG_INFO, "[Audio to WebSocket] Profile '%s': streaming %u Hz, %u ch, %s (LE)",
+		     m_profile.name.c_str(), frame.sampleRate, channels,
+		     to_float ? "32-bit float PCM" : "16-bit PCM");
+		blog(LOG_INFO, "[Audio to WebSocket] Source: %s, Format: %s", m_inputName.c_str(),
+		     frame.interleaved ? "converted by OBS" : "FLOAT_PLANAR");
+		blog(LOG_INFO, "[Audio to WebSocket] Frame size: %zu samples, Buffer: %.1fms", frames,
+		     (frames * 1000.0f) / frame.sampleRate);
+
+		// Log first few samples for debugging (only once)
+		if (frames >= 5 && !frame.interleaved) {
+			const float *first_channel = frame.planes[0];
+			blog(LOG_INFO, "[Audio to WebSocket] First 5 samples (ch0): %.4f %.4f %.4f %.4f %.4f",
+			     first_channel[0], first_channel[1], first_channel[2], first_channel[3], first_channel[4]);
+		}
+	}
+
+	SendPacket(std::move(packet), data_size, sinks, server);
+}
+
+const AudioFrame &StreamPipeline::ApplyRung(const AudioFrame &frame, const FormatRung &rung, uint32_t bitDepth)
+{
+	bool resample = rung.sampleRate && rung.sampleRate < frame.sampleRate;
+	bool downmix = rung.mono && frame.channels > 1;
+	bool reencode = frame.interleaved && frame.bitDepth != bitDepth;
+	if (!resample) {
+		m_resampler.reset();
+	}
+	if (!resample && !downmix && !reencode)
+		return frame;
+
+	TraceSpan span("apply_rung", frame.receivedNs);
+	if (downmix) {
+		DownmixMono(frame, m_planar);
+		m_converted = frame;
+		m_converted.interleaved = nullptr;
+		m_converted.channels = 1;
+		m_converted.planes[0] = m_planar.data();
+	} else if (frame.interleaved) {
+		DeinterleaveFrame(frame, m_planar, m_converted);
+	} else {
+		m_converted = frame;
+	}
+	if (!resample)
+		return m_converted;
+
+	auto quality = m_watchdog && m_watchdog->Sheds(ShedStage::Resampling) ? Resampler::Quality::Linear
+									      : Resampler::Quality::High;
+	if (!m_resampler || m_resampler->GetInputRate() != frame.sampleRate ||
+	    m_resampler->GetOutputRate() != rung.sampleRate || m_resampler->GetChannels() != m_converted.channels ||
+	    m_resampler->GetQuality() != quality) {
+		m_resampler = std::make_unique<Resampler>(frame.sampleRate, rung.sampleRate, m_converted.channels,
+							  quality);
+	}
+	int64_t offsetNs = 0;
+	m_converted.frames = static_cast<uint32_t>(m_resampler->Process(m_converted, m_resampled, offsetNs));
+	m_converted.sampleRate = rung.sampleRate;
+	m_converted.timestamp = static_cast<uint64_t>(static_cast<int64_t>(frame.timestamp) + offsetNs);
+	for (uint32_t ch = 0; ch < m_converted.channels; ++ch) {
+		m_converted.planes[ch] = m_resampled[ch].data();
+	}
+	return m_converted;
+}
+
+void StreamPipeline::EncodeFeatures(const AudioFrame &frame, const SinkList &sinks, WebSocketPPServer *server)
+{
+	if (m_watchdog && m_watchdog->Sheds(ShedStage::Features) && (frame.timestamp / FEATURE_SHED_PERIOD_NS) % 2) {
+		// Starting over after the gap keeps analysis windows from spanning it
+		if (m_extractor) {
+			m_extractor->Reset();
+		}
+		return;
+	}
+
+	DownmixMono(frame, m_mono);
+
+	if (!m_extractor || m_extractor->GetSampleRate() != frame.sampleRate) {
+		m_extractor = std::make_unique<LogMelExtractor>(frame.sampleRate, m_profile.features);
+		blog(LOG_INFO,
+		     "[Audio to WebSocket] Profile '%s': log-mel features at %u Hz, %u bins, window %zu / hop %zu "
+		     "samples (FFT %zu), %s (LE)",
+		     m_profile.name.c_str(), frame.sampleRate, m_extractor->GetMelBins(), m_extractor->GetWindowSize(),
+		     m_extractor->GetHopSize(), m_extractor->GetFftSize(),
+		     m_profile.features.float16 ? "16-bit float" : "32-bit float");
+	}
+
+	m_features.clear();
+	int64_t offset = 0;
+	size_t produced;
+	{
+		TraceSpan span("log_mel", frame.receivedNs);
+		produced = m_extractor->Process(m_mono.data(), m_mono.size(), m_features, offset);
+	}
+	if (produced == 0) {
+		// Not a full hop yet; the samples stay buffered in the extractor
+		return;
+	}
+
+	// Stamp the packet with the start of its first frame's window
+	int64_t offset_ns = offset * 1000000000LL / static_cast<int64_t>(frame.sampleRate);
+	uint64_t timestamp = frame.timestamp + static_cast<uint64_t>(offset_ns);
+
+	// Frame-major: melBins values per frame, frames in time order
+	bool half = m_profile.features.float16;
+	uint32_t bit_depth = m_profile.BitDepth();
+	size_t data_size = m_features.size() * (bit_depth / 8);
+	auto packet = CreateAudioPacket(timestamp, AudioFormat(frame.sampleRate, m_extractor->GetMelBins(), bit_depth),
+					m_sourceId, m_inputName, data_size);
+	packet->captureNs = frame.receivedNs;
+	uint8_t *out_ptr = packet->payload();
+	for (float value : m_features) {
+		if (half) {
+			uint16_t bits = FloatToHalf(value);
+			*out_ptr++ = bits & 0xFF;
+			*out_ptr++ = (bits >> 8) & 0xFF;
+		} else {
+			uint32_t bits;
+			memcpy(&bits, &value, sizeof(bits));
+			*out_ptr++ = bits & 0xFF;
+			*out_ptr++ = (bits >> 8) & 0xFF;
+			*out_ptr++ = (bits >> 16) & 0xFF;
+			*out_ptr++ = (bits >> 24) & 0xFF;
+		}
+	}
+
+	SendPacket(std::move(packet), data_size, sinks, server);
+}
+
+void StreamPipeline::SendPacket(AudioPacketPtr packet, size_t bytes, const SinkList &sinks, WebSocketPPServer *server)
+{
+	// One span for the whole fan-out: how long the encoder spends handing the packet to every sink
+	TraceSpan span("send", packet->captureNs);
+	for (const auto &sink : sinks) {
+		sink->SendAudioPacket(packet);
+	}
+	if (server) {
+		server->Broadcast(packet);
+	}
+	UpdateDataRate(bytes);
+	SyncClocks(sinks, server);
+}
+
+void StreamPipeline::SyncClocks(const SinkList &sinks, WebSocketPPServer *server)
+{
+	// Sinks start an exchange as they connect; after that, one every interval
+	uint64_t now = SteadyNowNs();
+	uint64_t intervalMs = m_bitrate ? constants::ADAPTIVE_CLOCK_SYNC_INTERVAL_MS : constants::CLOCK_SYNC_INTERVAL_MS;
+	if (now - m_lastClockSyncNs < intervalMs * 1000000ULL)
+		return;
+	m_lastClockSyncNs = now;
+
+	std::string request = MakeClockSyncRequest();
+	for (const auto &sink : sinks) {
+		if (sink->IsConnected() && !std::dynamic_pointer_cast<RtpSink>(sink)) {
+			sink->SendControlText(request);
+		}
+	}
+	if (server) {
+		// Subscribers can't reply, but still get the stream clock to wall time mapping
+		server->BroadcastControlText(request);
+	}
+}
+
+void StreamPipeline::CheckBudget(const AudioFrame &frame, uint64_t started)
+{
+	if (!m_watchdog || frame.sampleRate == 0)
+		return;
+
+	uint64_t now = SteadyNowNs();
+	uint64_t cost = now - started;
+	uint64_t blockNs = static_cast<uint64_t>(frame.frames) * 1000000000ULL / frame.sampleRate;
+	double budgetFraction = m_watchdog->GetSettings().budgetFraction;
+	if (static_cast<double>(cost) > static_cast<double>(blockNs) * budgetFraction) {
+		m_stats->budgetOverruns.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	ShedStage previous = m_watchdog->GetStage();
+	if (!m_watchdog->Record(cost, blockNs, now))
+		return;
+
+	ShedStage stage = m_watchdog->GetStage();
+	bool degraded = stage > previous;
+	m_stats->shedStage.store(static_cast<uint32_t>(stage), std::memory_order_relaxed);
+	if (degraded) {
+		blog(LOG_WARNING,
+		     "[Audio to WebSocket] Profile '%s': blocks keep overrunning their %.0f%% CPU budget, shedding %s",
+		     m_profile.name.c_str(), budgetFraction * 100.0, ShedStageName(stage));
+	} else {
+		blog(LOG_INFO, "[Audio to WebSocket] Profile '%s': back within CPU budget, restoring %s",
+		     m_profile.name.c_str(), ShedStageName(previous));
+	}
+
+	if (stage >= ShedStage::Metering && previous < ShedStage::Metering) {
+		// Rather than leave the last levels frozen on screen
+		m_levels.Publish(AudioLevels());
+	} else if (stage < ShedStage::Metering && previous >= ShedStage::Metering) {
+		// The interval in progress when metering stopped is stale
+		m_levelMeter.Reset();
+	}
+
+	if (m_onCpuLoad) {
+		m_onCpuLoad(stage, degraded);
+	}
+}
+
+void StreamPipeline::AdaptFormat(const AudioFrame &frame, const SinkList &sinks, WebSocketPPServer *server)
+{
+	uint64_t now = SteadyNowNs();
+	if (now - m_lastAdaptNs < constants::ADAPTIVE_EVALUATE_INTERVAL_MS * 1000000ULL)
+		return;
+	m_lastAdaptNs = now;
+
+	// RTP sinks are left out: UDP has no backlog, and they count packets they can't carry as drops
+	LinkSignals signals;
+	uint64_t drops = 0;
+	for (const auto &sink : sinks) {
+		if (std::dynamic_pointer_cast<RtpSink>(sink))
+			continue;
+		drops += sink->GetDroppedPackets();
+		if (!sink->IsConnected())
+			continue;
+		signals.queuedBytes = std::max<uint64_t>(signals.queuedBytes, sink->GetQueuedBytes());
+		const ClockSync &clock = sink->GetClockSync();
+		if (clock.GetMinRttNs() > 0) {
+			signals.rttGrowthNs = std::max(signals.rttGrowthNs, clock.GetLastRttNs() - clock.GetMinRttNs());
+		}
+	}
+	signals.newDrops = drops > m_lastDropCount ? drops - m_lastDropCount : 0;
+	m_lastDropCount = drops;
+
+	const FormatRung &current = m_ladder[m_bitrate->GetRung()];
+	uint64_t rate = current.sampleRate ? std::min(current.sampleRate, frame.sampleRate) : frame.sampleRate;
+	uint64_t channels = current.mono ? 1 : frame.channels;
+	signals.bytesPerSecond = rate * channels * (current.encoding == SampleEncoding::Float32 ? 4 : 2);
+
+	if (!m_bitrate->Update(signals, now))
+		return;
+
+	size_t index = m_bitrate->GetRung();
+	const char *reason = BitrateReasonName(m_bitrate->GetReason());
+	m_rung.store(index, std::memory_order_relaxed);
+	m_stats->formatRung.store(static_cast<uint32_t>(index), std::memory_order_relaxed);
+	m_stats->formatSwitches.fetch_add(1, std::memory_order_relaxed);
+	blog(LOG_INFO, "[Audio to WebSocket] Profile '%s': switching to %s (%s)", m_profile.name.c_str(),
+	     FormatRungName(m_ladder[index]).c_str(), reason);
+
+	// Queued ahead of the first packet in the new format, so consumers see it in order
+	std::string message = DescribeFormat(reason);
+	for (const auto &sink : sinks) {
+		if (!std::dynamic_pointer_cast<RtpSink>(sink)) {
+			sink->SendControlText(message);
+		}
+	}
+	if (server) {
+		server->BroadcastControlText(message);
+	}
+}
+
+void StreamPipeline::CopyInterleaved(const AudioFrame &frame, uint8_t *out_ptr, size_t size) const
+{
+	// OBS already produced the wire format in host byte order, which is little-endian on every platform
+	// OBS runs on
+	memcpy(out_ptr, frame.interleaved, size);
+}
+
+void StreamPipeline::OnSinkConnected(const std::weak_ptr<AudioSink> &sink)
+{
+	if (auto connected = sink.lock()) {
+		// A reconnect may have reached a different consumer, with a different clock
+		connected->GetClockSync().Reset();
+		if (!std::dynamic_pointer_cast<RtpSink>(connected)) {
+			connected->SendControlText(DescribeFormat());
+			connected->SendControlText(MakeClockSyncRequest());
+		}
+		SendDescriptions(connected);
+	}
+	if (m_onConnectionChanged) {
+		m_onConnectionChanged();
+	}
+}
+
+void StreamPipeline::OnSinkMessage(const std::weak_ptr<AudioSink> &sink, const std::string &message)
+{
+	// t4 of a clock sync exchange, taken before parsing adds to the round trip
+	const uint64_t receivedNs = SteadyNowNs();
+
+	// Handle status/control messages from server
+	try {
+		nlohmann::json msg = nlohmann::json::parse(message);
+		std::string type = msg.value("type", "");
+
+		if (type == "get_sdp") {
+			if (auto requester = sink.lock()) {
+				SendDescriptions(requester);
+			}
+		} else if (type == "get_format") {
+			if (auto requester = sink.lock()) {
+				requester->SendControlText(DescribeFormat());
+			}
+		} else if (type == "start_trace" || type == "stop_trace" || type == "get_trace") {
+			OnTraceRequest(sink, type);
+		} else if (type == "clock_sync_reply") {
+			if (auto responder = sink.lock()) {
+				OnClockSyncReply(*responder, msg, receivedNs);
+			}
+		} else if (type == "ack") {
+			if (auto consumer = sink.lock()) {
+				OnAck(*consumer, msg);
+			}
+		}
+	} catch (...) {
+		// Ignore parse errors
+	}
+}
+
+void StreamPipeline::OnTraceRequest(const std::weak_ptr<AudioSink> &sink, const std::string &type)
+{
+	if (!m_remoteTraceControl) {
+		if (!m_traceRefusalLogged.exchange(true)) {
+			blog(LOG_WARNING,
+			     "[Audio to WebSocket] Profile '%s': ignoring %s from an endpoint, "
+			     "remote trace control is off",
+			     m_profile.name.c_str(), type.c_str());
+		}
+		return;
+	}
+
+	if (type == "start_trace") {
+		Tracer::Instance().Clear();
+		Tracer::Instance().SetEnabled(true);
+		return;
+	}
+	if (type == "stop_trace") {
+		Tracer::Instance().SetEnabled(false);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_traceDumpMutex);
+	if (m_traceDumping) {
+		blog(LOG_WARNING, "[Audio to WebSocket] Profile '%s': a trace is already being sent, ignoring get_trace",
+		     m_profile.name.c_str());
+		return;
+	}
+	if (m_traceDump.joinable()) {
+		m_traceDump.join(); // Finished
+	}
+	m_traceDumping = true;
+	m_traceDump = std::thread([this, sink]() {
+		// ASCII-only, so the text can be split anywhere
+		std::string trace = Tracer::Instance()
+					    .Collect(constants::REMOTE_TRACE_EVENTS_PER_THREAD)
+					    .dump(-1, ' ', true);
+		if (auto requester = sink.lock()) {
+			// Concatenating the parts' data gives a trace file that loads as-is
+			const size_t partBytes = constants::REMOTE_TRACE_PART_BYTES;
+			const size_t parts = std::max<size_t>(1, (trace.size() + partBytes - 1) / partBytes);
+			for (size_t part = 0; part < parts; ++part) {
+				requester->SendControlText(MakeControlMessage(
+					"trace", {{"part", part},
+						  {"parts", parts},
+						  {"data", trace.substr(part * partBytes, partBytes)}}));
+			}
+		}
+		m_traceDumping = false;
+	});
+}
+
+void StreamPipeline::JoinTraceDump()
+{
+	std::lock_guard<std::mutex> lock(m_traceDumpMutex);
+	if (m_traceDump.joinable()) {
+		m_traceDump.join();
+	}
+}
+
+void StreamPipeline::OnClockSyncReply(AudioSink &sink, const nlohmann::json &msg, uint64_t receivedNs)
+{
+	int64_t t1 = msg.at("t1").get<int64_t>();
+	int64_t t2 = msg.at("t2").get<int64_t>();
+	int64_t t3 = msg.value("t3", t2);
+	int64_t t4 = static_cast<int64_t>(receivedNs);
+
+	ClockSync &clock = sink.GetClockSync();
+	if (!clock.AddSample(t1, t2, t3, t4))
+		return;
+	m_stats->clockSyncRttNs.Record(static_cast<uint64_t>((t4 - t1) - (t3 - t2)));
+
+	// The consumer gets the filtered result, so it can map packet timestamps onto its own clock
+	sink.SendControlText(MakeControlMessage("clock_offset", {{"sourceId", m_sourceId},
+								 {"offsetNs", clock.GetOffsetNs()},
+								 {"rttNs", clock.GetRttNs()}}));
+}
+
+void StreamPipeline::OnAck(const AudioSink &sink, const nlohmann::json &msg)
+{
+	// Consumer-side receipt of a packet, on the consumer's clock; meaningless until the clocks are synced
+	const ClockSync &clock = sink.GetClockSync();
+	if (!clock.HasEstimate())
+		return;
+
+	int64_t audioTimestamp = msg.at("audioTimestamp").get<int64_t>();
+	int64_t received = clock.ToStreamClock(msg.at("receivedNs").get<int64_t>());
+	if (received >= audioTimestamp) {
+		m_stats->captureToConsumerNs.Record(static_cast<uint64_t>(received - audioTimestamp));
+	}
+}
+
+void StreamPipeline::OnSinkError(const std::string &url, const std::string &error)
+{
+	auto sinks = GetSinks();
+	bool multipleSinks = sinks && sinks->size() > 1;
+	ReportError(multipleSinks ? url + ": " + error : error);
+
+	if (error.find("Max reconnection attempts exceeded") == std::string::npos)
+		return;
+
+	// Other sinks keep streaming on their own connections
+	bool othersAlive = sinks && std::any_of(sinks->begin(), sinks->end(),
+						[](const std::shared_ptr<AudioSink> &sink) {
+							return sink->IsConnected() || sink->IsReconnecting();
+						});
+	if (othersAlive) {
+		blog(LOG_ERROR, "[Audio to WebSocket] Connection to %s permanently failed", url.c_str());
+		return;
+	}
+
+	blog(LOG_ERROR, "[Audio to WebSocket] Profile '%s': connection permanently failed", m_profile.name.c_str());
+	if (m_onFailed) {
+		m_onFailed();
+	}
+}
+
+void StreamPipeline::SendLevels(const AudioLevels &levels, const SinkList &sinks, WebSocketPPServer *server)
+{
+	nlohmann::json peak = nlohmann::json::array();
+	nlohmann::json rms = nlohmann::json::array();
+	nlohmann::json truePeak = nlohmann::json::array();
+	auto toDb = [](float amplitude) { return std::round(AmplitudeToDb(amplitude) * 10.0f) / 10.0f; };
+	for (uint32_t ch = 0; ch < levels.channels; ++ch) {
+		peak.push_back(toDb(levels.peak[ch]));
+		rms.push_back(toDb(levels.rms[ch]));
+		truePeak.push_back(toDb(levels.truePeak[ch]));
+	}
+
+	std::string payload = MakeControlMessage("levels", {{"sourceId", m_sourceId},
+							    {"audioTimestamp", levels.timestamp},
+							    {"durationMs", levels.frames * 1000.0 / levels.sampleRate},
+							    {"peak", peak},
+							    {"rms", rms},
+							    {"truePeak", truePeak}});
+	for (const auto &sink : sinks) {
+		if (!std::dynamic_pointer_cast<RtpSink>(sink)) {
+			sink->SendControlText(payload);
+		}
+	}
+	if (server) {
+		server->BroadcastControlText(payload);
+	}
+}
+
+std::string StreamPipeline::DescribeFormat(const char *reason) const
+{
+	nlohmann::json fields = {{"sourceId", m_sourceId}, {"codec", m_profile.codec}};
+	if (m_profile.IsFeatureStream()) {
+		// The packet header's channel count is melBins; frames per packet = payload / (melBins * value size)
+		const FeatureSettings &features = m_profile.features;
+		fields["sampleFormat"] = features.float16 ? "f16" : "f32";
+		fields["melBins"] = features.melBins;
+		fields["windowMs"] = features.windowMs;
+		fields["hopMs"] = features.hopMs;
+		fields["window"] = "hann";
+		fields["melScale"] = "htk";
+		fields["log"] = "ln";
+		fields["logFloor"] = 1e-10;
+	} else {
+		size_t index = m_rung.load(std::memory_order_relaxed);
+		fields["sampleFormat"] = SampleEncodingName(m_ladder[index].encoding);
+		if (m_bitrate) {
+			// Rate and channel count change with the rung too; each packet header has them
+			nlohmann::json ladder = nlohmann::json::array();
+			for (const auto &rung : m_ladder) {
+				ladder.push_back(FormatRungName(rung));
+			}
+			fields["ladder"] = ladder;
+			fields["rung"] = index;
+			if (reason) {
+				fields["reason"] = reason;
+			}
+		}
+	}
+	return MakeControlMessage("format", fields);
+}
+
+void StreamPipeline::BroadcastDescription(const std::string &url, const std::string &sdp)
+{
+	std::string payload = MakeControlMessage("sdp", {{"uri", url}, {"sdp", sdp}});
+
+	if (auto sinks = GetSinks()) {
+		for (const auto &sink : *sinks) {
+			if (!std::dynamic_pointer_cast<RtpSink>(sink)) {
+				sink->SendControlText(payload);
+			}
+		}
+	}
+	if (WebSocketPPServer *server = m_server.load()) {
+		server->BroadcastControlText(payload);
+	}
+}
+
+void StreamPipeline::SendDescriptions(const std::shared_ptr<AudioSink> &target)
+{
+	auto sinks = GetSinks();
+	if (!sinks)
+		return;
+
+	for (const auto &sink : *sinks) {
+		auto rtpSink = std::dynamic_pointer_cast<RtpSink>(sink);
+		if (!rtpSink || rtpSink == target)
+			continue;
+
+		std::string sdp = rtpSink->GetSdp();
+		if (!sdp.empty()) {
+			target->SendControlText(MakeControlMessage("sdp", {{"uri", rtpSink->GetUri()}, {"sdp", sdp}}));
+		}
+	}
+}
+
+void StreamPipeline::ReportError(const std::string &error)
+{
+	if (m_onError) {
+		m_onError(error);
+	}
+}
+
+void StreamPipeline::UpdateDataRate(size_t bytes)
+{
+	// Only the capture thread touches these counters, so no lock is needed
+	m_bytesSinceLastUpdate += bytes;
+
+	auto now = std::chrono::steady_clock::now();
+	auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_lastRateUpdate);
+
+	if (elapsed.count() >= 1000) {                                          // Update every second
+		double kbps = (m_bytesSinceLastUpdate * 8.0) / elapsed.count(); // Convert to kilobits per second
+		m_dataRate = kbps;
+
+		m_bytesSinceLastUpdate = 0;
+		m_lastRateUpdate = now;
+
+		if (m_onDataRate) {
+			m_onDataRate();
+		}
+	}
+}
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,357 @@
+#include "obs-audio-to-websocket/stream-profile.hpp"
+#include "obs-audio-to-websocket/log.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <set>
+#include <sstream>
+
+namespace obs_audio_to_websocket {
+
+using json = nlohmann::json;
+
+SinkOptions StreamProfile::GetSinkOptions() const
+{
+	SinkOptions options;
+	options.nativeWebSocket = nativeWebSocket;
+	return options;
+}
+
+uint32_t StreamProfile::BitDepth() const
+{
+	if (IsFeatureStream())
+		return features.float16 ? 16 : 32;
+	return encoding == SampleEncoding::Float32 ? 32 : 16;
+}
+
+bool StreamProfile::HasInput() const
+{
+	if (capture == CaptureMode::MixTracks)
+		return (mixTracks & ((1u << MAX_MIX_TRACKS) - 1)) != 0;
+	return !audioSource.empty();
+}
+
+std::string StreamProfile::InputName() const
+{
+	if (capture == CaptureMode::Source)
+		return audioSource;
+
+	std::string tracks;
+	for (size_t i = 0; i < MAX_MIX_TRACKS; ++i) {
+		if (mixTracks & (1u << i)) {
+			tracks += (tracks.empty() ? "" : ",") + std::to_string(i + 1);
+		}
+	}
+	return "Track " + tracks;
+}
+
+std::vector<FormatRung> StreamProfile::FormatLadder() const
+{
+	if (!adaptive || IsFeatureStream())
+		return {FormatRung{encoding, 0, false}};
+	if (!ladder.empty())
+		return ladder;
+
+	// Each step roughly halves the rate or more: 48 kHz stereo goes 3072 -> 1536 -> 512 -> 256 -> 128 kbit/s
+	std::vector<FormatRung> rungs;
+	if (encoding == SampleEncoding::Float32) {
+		rungs.push_back({SampleEncoding::Float32, 0, false});
+	}
+	rungs.push_back({SampleEncoding::Int16, 0, false});
+	rungs.push_back({SampleEncoding::Int16, 16000, false});
+	rungs.push_back({SampleEncoding::Int16, 16000, true});
+	rungs.push_back({SampleEncoding::Int16, 8000, true});
+	return rungs;
+}
+
+std::vector<StreamProfile> ExpandMixTracks(const StreamProfile &profile)
+{
+	if (profile.capture != CaptureMode::MixTracks)
+		return {profile};
+
+	std::vector<StreamProfile> expanded;
+	for (size_t i = 0; i < MAX_MIX_TRACKS; ++i) {
+		if (!(profile.mixTracks & (1u << i)))
+			continue;
+
+		StreamProfile track = profile;
+		track.mixTracks = 1u << i;
+		track.name = profile.name + " (Track " + std::to_string(i + 1) + ")";
+		expanded.push_back(std::move(track));
+	}
+	return expanded;
+}
+
+namespace {
+
+// Channel counts that map onto an OBS speaker layout
+bool IsSupportedChannelCount(uint32_t channels)
+{
+	return channels == 0 || (channels >= 1 && channels <= 6) || channels == 8;
+}
+
+} // namespace
+
+const char *SampleEncodingName(SampleEncoding encoding)
+{
+	switch (encoding) {
+	case SampleEncoding::Float32:
+		return "f32";
+	case SampleEncoding::Int16:
+	default:
+		return "s16";
+	}
+}
+
+bool ParseSampleEncoding(const std::string &name, SampleEncoding &encoding)
+{
+	if (name == "s16") {
+		encoding = SampleEncoding::Int16;
+		return true;
+	}
+	if (name == "f32") {
+		encoding = SampleEncoding::Float32;
+		return true;
+	}
+	return false;
+}
+
+std::string FormatRungName(const FormatRung &rung)
+{
+	std::string name = SampleEncodingName(rung.encoding);
+	if (rung.sampleRate) {
+		name += "@" + std::to_string(rung.sampleRate);
+	}
+	if (rung.mono) {
+		name += "/mono";
+	}
+	return name;
+}
+
+bool ParseFormatRung(const std::string &name, FormatRung &rung)
+{
+	FormatRung parsed;
+	std::string rest = name;
+	const std::string monoSuffix = "/mono";
+	if (rest.size() > monoSuffix.size() && rest.compare(rest.size() - monoSuffix.size(), std::string::npos,
+							    monoSuffix) == 0) {
+		parsed.mono = true;
+		rest.erase(rest.size() - monoSuffix.size());
+	}
+
+	size_t at = rest.find('@');
+	if (at != std::string::npos) {
+		std::string rate = rest.substr(at + 1);
+		if (rate.empty() || rate.find_first_not_of("0123456789") != std::string::npos || rate.size() > 6)
+			return false;
+		parsed.sampleRate = static_cast<uint32_t>(std::stoul(rate));
+		if (parsed.sampleRate < 8000 || parsed.sampleRate > 192000)
+			return false;
+		rest.erase(at);
+	}
+
+	if (!ParseSampleEncoding(rest, parsed.encoding))
+		return false;
+	rung = parsed;
+	return true;
+}
+
+std::string OutputFormatName(const StreamProfile &profile)
+{
+	if (profile.IsFeatureStream())
+		return profile.features.float16 ? "logmel-f16" : "logmel-f32";
+	return SampleEncodingName(profile.encoding);
+}
+
+bool ApplyOutputFormat(const std::string &name, StreamProfile &profile)
+{
+	if (name == "logmel-f16" || name == "logmel-f32") {
+		profile.codec = "logmel";
+		profile.features.float16 = name == "logmel-f16";
+		return true;
+	}
+	if (ParseSampleEncoding(name, profile.encoding)) {
+		profile.codec = "pcm";
+		return true;
+	}
+	return false;
+}
+
+std::string SerializeProfiles(const std::vector<StreamProfile> &profiles)
+{
+	json array = json::array();
+	for (const auto &profile : profiles) {
+		json tracks = json::array();
+		for (size_t i = 0; i < MAX_MIX_TRACKS; ++i) {
+			if (profile.mixTracks & (1u << i)) {
+				tracks.push_back(i + 1);
+			}
+		}
+		json ladder = json::array();
+		for (const auto &rung : profile.ladder) {
+			ladder.push_back(FormatRungName(rung));
+		}
+
+		array.push_back({{"name", profile.name},
+				 {"enabled", profile.enabled},
+				 {"capture", profile.capture == CaptureMode::MixTracks ? "mix" : "source"},
+				 {"source", profile.audioSource},
+				 {"tracks", tracks},
+				 {"urls", profile.urls},
+				 {"format", SampleEncodingName(profile.encoding)},
+				 {"codec", profile.codec},
+				 {"features",
+				  {{"melBins", profile.features.melBins},
+				   {"windowMs", profile.features.windowMs},
+				   {"hopMs", profile.features.hopMs},
+				   {"format", profile.features.float16 ? "f16" : "f32"}}},
+				 {"nativeWebSocket", profile.nativeWebSocket},
+				 {"legacySourceId", profile.legacySourceId},
+				 {"levels", profile.sendLevels},
+				 {"adaptive", profile.adaptive},
+				 {"ladder", ladder},
+				 {"sampleRate", profile.sampleRate},
+				 {"channels", profile.channels}});
+	}
+	return array.dump();
+}
+
+std::vector<StreamProfile> ParseProfiles(const std::string &text)
+{
+	std::vector<StreamProfile> profiles;
+
+	json array;
+	try {
+		array = json::parse(text);
+	} catch (const json::exception &e) {
+		blog(LOG_WARNING, "[Audio to WebSocket] Ignoring malformed stream profiles: %s", e.what());
+		return profiles;
+	}
+	if (!array.is_array()) {
+		blog(LOG_WARNING, "[Audio to WebSocket] Ignoring stream profiles: expected a JSON array");
+		return profiles;
+	}
+
+	std::set<std::string> names;
+	for (const auto &entry : array) {
+		if (!entry.is_object()) {
+			continue;
+		}
+
+		StreamProfile profile;
+		try {
+			profile.name = entry.value("name", profile.name);
+			profile.enabled = entry.value("enabled", profile.enabled);
+			profile.audioSource = entry.value("source", profile.audioSource);
+			profile.urls = entry.value("urls", profile.urls);
+			profile.codec = entry.value("codec", profile.codec);
+			profile.nativeWebSocket = entry.value("nativeWebSocket", profile.nativeWebSocket);
+			profile.legacySourceId = entry.value("legacySourceId", profile.legacySourceId);
+			profile.sendLevels = entry.value("levels", profile.sendLevels);
+			profile.adaptive = entry.value("adaptive", profile.adaptive);
+			profile.sampleRate = entry.value("sampleRate", profile.sampleRate);
+			profile.channels = entry.value("channels", profile.channels);
+
+			if (entry.contains("features")) {
+				const json &features = entry.at("features");
+				profile.features.melBins = features.value("melBins", profile.features.melBins);
+				profile.features.windowMs = features.value("windowMs", profile.features.windowMs);
+				profile.features.hopMs = features.value("hopMs", profile.features.hopMs);
+				profile.features.float16 = features.value("format", std::string("f16")) != "f32";
+			}
+
+			if (entry.value("capture", std::string("source")) == "mix") {
+				profile.capture = CaptureMode::MixTracks;
+			}
+			if (entry.contains("tracks")) {
+				profile.mixTracks = 0;
+				for (uint32_t track : entry.at("tracks").get<std::vector<uint32_t>>()) {
+					if (track >= 1 && track <= MAX_MIX_TRACKS) {
+						profile.mixTracks |= 1u << (track - 1);
+					}
+				}
+			}
+
+			for (const auto &name : entry.value("ladder", std::vector<std::string>())) {
+				FormatRung rung;
+				if (!ParseFormatRung(name, rung)) {
+					blog(LOG_WARNING, "[Audio to WebSocket] Profile '%s': unknown ladder step '%s'",
+					     profile.name.c_str(), name.c_str());
+					continue;
+				}
+				profile.ladder.push_back(rung);
+			}
+
+			std::string format = entry.value("format", std::string(SampleEncodingName(profile.encoding)));
+			if (!ParseSampleEncoding(format, profile.encoding)) {
+				blog(LOG_WARNING, "[Audio to WebSocket] Profile '%s': unknown format '%s', using s16",
+				     profile.name.c_str(), format.c_str());
+			}
+		} catch (const json::exception &e) {
+			blog(LOG_WARNING, "[Audio to WebSocket] Skipping malformed stream profile: %s", e.what());
+			continue;
+		}
+
+		if (profile.sampleRate != 0 && (profile.sampleRate < 8000 || profile.sampleRate > 192000)) {
+			blog(LOG_WARNING, "[Audio to WebSocket] Profile '%s': unsupported sample rate %u, using OBS's",
+			     profile.name.c_str(), profile.sampleRate);
+			profile.sampleRate = 0;
+		}
+		if (!IsSupportedChannelCount(profile.channels)) {
+			blog(LOG_WARNING, "[Audio to WebSocket] Profile '%s': unsupported channel count %u, using OBS's",
+			     profile.name.c_str(), profile.channels);
+			profile.channels = 0;
+		}
+
+		FeatureSettings &features = profile.features;
+		if (features.melBins < 1 || features.melBins > 256) {
+			blog(LOG_WARNING, "[Audio to WebSocket] Profile '%s': unsupported mel bin count %u, using 80",
+			     profile.name.c_str(), features.melBins);
+			features.melBins = 80;
+		}
+		if (!(features.windowMs >= 5.0f && features.windowMs <= 100.0f)) {
+			features.windowMs = FeatureSettings().windowMs;
+		}
+		if (!(features.hopMs >= 1.0f && features.hopMs <= features.windowMs)) {
+			// Hops longer than the window would skip audio
+			features.hopMs = std::min(FeatureSettings().hopMs, features.windowMs);
+		}
+
+		if (profile.codec != "pcm" && profile.codec != "logmel") {
+			blog(LOG_WARNING, "[Audio to WebSocket] Profile '%s': unsupported codec '%s', using pcm",
+			     profile.name.c_str(), profile.codec.c_str());
+			profile.codec = "pcm";
+		}
+
+		// Names identify profiles in the dialog and on the wire (packet source ID)
+		if (profile.name.empty()) {
+			profile.name = "Profile";
+		}
+		std::string base = profile.name;
+		for (int suffix = 2; names.count(profile.name); ++suffix) {
+			profile.name = base + " " + std::to_string(suffix);
+		}
+		names.insert(profile.name);
+
+		profiles.push_back(std::move(profile));
+	}
+	return profiles;
+}
+
+std::vector<std::string> ParseUrlList(const std::string &urls)
+{
+	std::string normalized = urls;
+	std::replace(normalized.begin(), normalized.end(), ',', ' ');
+	std::replace(normalized.begin(), normalized.end(), ';', ' ');
+
+	std::vector<std::string> result;
+	std::istringstream stream(normalized);
+	std::string url;
+	while (stream >> url) {
+		if (std::find(result.begin(), result.end(), url) == result.end()) {
+			result.push_back(url);
+		}
+	}
+	return result;
+}
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,370 @@
+#include "obs-audio-to-websocket/stream-socket-sink.hpp"
+#include "obs-audio-to-websocket/constants.hpp"
+#include "obs-audio-to-websocket/log.hpp"
+#include "obs-audio-to-websocket/socket-options.hpp"
+#include <cstring>
+#include <type_traits>
+
+namespace obs_audio_to_websocket {
+
+namespace {
+
+constexpr const char *TCP_SCHEME = "tcp://";
+constexpr const char *UNIX_SCHEME = "unix://";
+
+// Control frames from the consumer are small JSON messages; anything larger is a protocol error
+constexpr size_t MAX_INCOMING_FRAME_BYTES = 64 * 1024;
+
+} // namespace
+
+template<typename Protocol>
+StreamSocketSink<Protocol>::StreamSocketSink()
+	: m_io(IoContextPool::Instance().Acquire()),
+	  m_socket(m_io),
+	  m_reconnect(m_io)
+{
+}
+
+template<typename Protocol> StreamSocketSink<Protocol>::~StreamSocketSink()
+{
+	Disconnect();
+}
+
+template<typename Protocol> bool StreamSocketSink<Protocol>::ParseUri(const std::string &uri)
+{
+	if (std::is_same<Protocol, asio::ip::tcp>::value) {
+		if (uri.compare(0, strlen(TCP_SCHEME), TCP_SCHEME) != 0)
+			return false;
+
+		std::string rest = uri.substr(strlen(TCP_SCHEME));
+		rest = rest.substr(0, rest.find('/'));
+		size_t colon = rest.rfind(':');
+		if (colon == std::string::npos || colon == 0 || colon + 1 >= rest.length())
+			return false;
+
+		m_host = rest.substr(0, colon);
+		m_port = rest.substr(colon + 1);
+		// Allow bracketed IPv6 literals: tcp://[::1]:9000
+		if (m_host.size() > 2 && m_host.front() == '[' && m_host.back() == ']') {
+			m_host = m_host.substr(1, m_host.size() - 2);
+		}
+		return true;
+	}
+
+	if (uri.compare(0, strlen(UNIX_SCHEME), UNIX_SCHEME) != 0)
+		return false;
+
+	m_path = uri.substr(strlen(UNIX_SCHEME));
+	return !m_path.empty();
+}
+
+template<typename Protocol> bool StreamSocketSink<Protocol>::Connect(const std::string &uri)
+{
+	if (m_connected) {
+		blog(LOG_WARNING, "[Audio to WebSocket] Already connected");
+		return false;
+	}
+
+	m_uri = uri;
+	if (!ParseUri(uri)) {
+		blog(LOG_ERROR, "[Audio to WebSocket] Invalid URL: %s", uri.c_str());
+		if (m_onError) {
+			m_onError("Invalid URL: " + uri);
+		}
+		return false;
+	}
+
+	m_running = true;
+	m_reconnect.Reset();
+	asio::post(m_io, WeakHandler(this, [this]() { StartConnect(); }));
+	return true;
+}
+
+template<typename Protocol> void StreamSocketSink<Protocol>::Disconnect()
+{
+	if (!m_running.exchange(false))
+		return;
+
+	// On the socket's own thread, so no handler is running while its state is torn down
+	RunOnContext(m_io, [this]() {
+		asio::error_code ec;
+		m_reconnect.Cancel();
+		m_socket.shutdown(asio::socket_base::shutdown_both, ec);
+		m_socket.close(ec);
+	});
+
+	bool wasConnected = m_connected.exchange(false);
+
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		DropQueueLocked();
+	}
+
+	if (wasConnected && m_onDisconnected) {
+		m_onDisconnected();
+	}
+}
+
+template<typename Protocol> void StreamSocketSink<Protocol>::StartConnect()
+{
+	if (!m_running)
+		return;
+
+	if constexpr (std::is_same<Protocol, asio::ip::tcp>::value) {
+		auto resolver = std::make_shared<asio::ip::tcp::resolver>(m_io);
+		resolver->async_resolve(
+			m_host, m_port,
+			WeakHandler(this, [this, resolver](const asio::error_code &ec,
+							   asio::ip::tcp::resolver::results_type results) {
+				if (ec) {
+					HandleError("Could not resolve host", ec);
+					return;
+				}
+				asio::async_connect(m_socket, results,
+						    WeakHandler(this, [this](const asio::error_code &connectEc,
+									     const asio::ip::tcp::endpoint &) {
+							    OnConnect(connectEc);
+						    }));
+			}));
+	} else {
+		m_socket.async_connect(typename Protocol::endpoint(m_path),
+				       WeakHandler(this, [this](const asio::error_code &ec) { OnConnect(ec); }));
+	}
+}
+
+template<typename Protocol> void StreamSocketSink<Protocol>::OnConnect(const asio::error_code &ec)
+{
+	if (ec) {
+		HandleError("Connection failed", ec);
+		return;
+	}
+
+	if constexpr (std::is_same<Protocol, asio::ip::tcp>::value) {
+		int dscp = m_dscp.load();
+		asio::error_code optionEc = TuneAudioSocket(m_socket, dscp);
+		if (optionEc) {
+			blog(LOG_WARNING, "[Audio to WebSocket] Could not apply socket options (DSCP %d): %s", dscp,
+			     optionEc.message().c_str());
+		}
+	}
+
+	blog(LOG_INFO, "[Audio to WebSocket] Connected to %s", m_uri.c_str());
+	m_connected = true;
+	m_reconnect.Reset();
+
+	if (m_onConnected) {
+		m_onConnected();
+	}
+
+	SendControlMessage("start");
+	StartReadHeader();
+}
+
+template<typename Protocol> void StreamSocketSink<Protocol>::StartReadHeader()
+{
+	auto onHeader = [this](const asio::error_code &ec, size_t) {
+		if (ec) {
+			HandleError("Connection closed", ec);
+			return;
+		}
+
+		uint32_t length = 0;
+		uint32_t type = 0;
+		for (int i = 0; i < 4; ++i) {
+			length |= static_cast<uint32_t>(m_readHeader[i]) << (i * 8);
+			type |= static_cast<uint32_t>(m_readHeader[4 + i]) << (i * 8);
+		}
+
+		if (length > MAX_INCOMING_FRAME_BYTES) {
+			HandleError("Oversized frame from peer", asio::error::message_size);
+			return;
+		}
+		StartReadPayload(length, type);
+	};
+	asio::async_read(m_socket, asio::buffer(m_readHeader), WeakHandler(this, onHeader));
+}
+
+template<typename Protocol> void StreamSocketSink<Protocol>::StartReadPayload(size_t length, uint32_t type)
+{
+	m_readPayload.resize(length);
+	auto onPayload = [this, type](const asio::error_code &ec, size_t) {
+		if (ec) {
+			HandleError("Connection closed", ec);
+			return;
+		}
+
+		if (type == static_cast<uint32_t>(StreamFrameType::Control) && m_onMessage) {
+			m_onMessage(std::string(m_readPayload.begin(), m_readPayload.end()));
+		}
+		StartReadHeader();
+	};
+	asio::async_read(m_socket, asio::buffer(m_readPayload), WeakHandler(this, onPayload));
+}
+
+template<typename Protocol>
+void StreamSocketSink<Protocol>::WriteHeader(Frame &frame, size_t length, StreamFrameType type)
+{
+	uint32_t len = static_cast<uint32_t>(length);
+	uint32_t typ = static_cast<uint32_t>(type);
+	for (int i = 0; i < 4; ++i) {
+		frame.header[i] = (len >> (i * 8)) & 0xFF;
+		frame.header[4 + i] = (typ >> (i * 8)) & 0xFF;
+	}
+}
+
+template<typename Protocol> void StreamSocketSink<Protocol>::SendAudioPacket(const AudioPacketPtr &packet)
+{
+	if (!m_connected || !packet)
+		return;
+
+	Frame frame;
+	WriteHeader(frame, packet->data.size(), StreamFrameType::AudioPacket);
+	frame.packet = packet;
+
+	if (!QueueFrame(std::move(frame), true)) {
+		m_droppedPackets++;
+		RecordDropped();
+	}
+}
+
+template<typename Protocol> void StreamSocketSink<Protocol>::SendControlText(const std::string &payload)
+{
+	if (!m_connected)
+		return;
+
+	Frame frame;
+	frame.text = payload;
+	WriteHeader(frame, frame.text.size(), StreamFrameType::Control);
+	QueueFrame(std::move(frame), false);
+}
+
+template<typename Protocol> bool StreamSocketSink<Protocol>::QueueFrame(Frame &&frame, bool droppable)
+{
+	bool startWrite = false;
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		if (droppable && m_queuedBytes + frame.size() > constants::MAX_SEND_BUFFERED_BYTES) {
+			return false;
+		}
+		if (frame.packet) {
+			RecordQueuedBytes(m_queuedBytes);
+		}
+
+		m_queuedBytes += frame.size();
+		m_queue.push_back(std::move(frame));
+		if (!m_writing) {
+			m_writing = true;
+			startWrite = true;
+		}
+	}
+
+	if (startWrite) {
+		asio::post(m_io, WeakHandler(this, [this]() { StartWrite(); }));
+	}
+	return true;
+}
+
+template<typename Protocol> void StreamSocketSink<Protocol>::StartWrite()
+{
+	// Gather everything queued so far into one vectored write; packet bytes are referenced, not copied
+	std::shared_ptr<WriteBatch> batch;
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		if (m_queue.empty() || !m_connected) {
+			m_writing = false;
+			return;
+		}
+
+		batch = m_spareBatch ? std::move(m_spareBatch) : std::make_shared<WriteBatch>();
+		batch->generation = m_writeGeneration;
+		while (!m_queue.empty()) {
+			batch->bytes += m_queue.front().size();
+			batch->frames.push_back(std::move(m_queue.front()));
+			m_queue.pop_front();
+		}
+		for (const Frame &frame : batch->frames) {
+			batch->buffers.push_back(asio::buffer(frame.header));
+			if (frame.packet) {
+				batch->buffers.push_back(asio::buffer(frame.packet->data));
+			} else {
+				batch->buffers.push_back(asio::buffer(frame.text));
+			}
+		}
+	}
+
+	auto onWritten = [this, batch](const asio::error_code &ec, size_t) {
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			bool current = batch->generation == m_writeGeneration;
+			if (!ec && current) {
+				for (const Frame &frame : batch->frames) {
+					if (frame.packet) {
+						RecordSent(frame.packet->captureNs, frame.packet->data.size());
+					}
+				}
+			}
+			if (current) {
+				m_queuedBytes -= batch->bytes;
+			}
+			batch->frames.clear();
+			batch->buffers.clear();
+			batch->bytes = 0;
+			m_spareBatch = batch;
+
+			// The queue was dropped while this write was in flight, and whatever writes now isn't ours
+			if (!current)
+				return;
+			if (ec) {
+				m_writing = false;
+			}
+		}
+
+		if (ec) {
+			HandleError("Failed to send audio data", ec);
+			return;
+		}
+		StartWrite();
+	};
+	asio::async_write(m_socket, batch->buffers, WeakHandler(this, onWritten));
+}
+
+template<typename Protocol> void StreamSocketSink<Protocol>::DropQueueLocked()
+{
+	m_queue.clear();
+	m_queuedBytes = 0;
+	m_writing = false;
+	m_writeGeneration++;
+}
+
+template<typename Protocol>
+void StreamSocketSink<Protocol>::HandleError(const std::string &what, const asio::error_code &ec)
+{
+	// Cancelled operations are expected while shutting down
+	if (!m_running || ec == asio::error::operation_aborted)
+		return;
+
+	asio::error_code closeEc;
+	m_socket.close(closeEc);
+
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		DropQueueLocked();
+	}
+
+	ReportConnectionLost(m_connected.exchange(false), m_reconnect.IsReconnecting(), what, ec.message());
+	ScheduleReconnect();
+}
+
+template<typename Protocol> void StreamSocketSink<Protocol>::ScheduleReconnect()
+{
+	if (!m_reconnect.Schedule(this, m_uri, [this]() { StartConnect(); }) && m_onError) {
+		m_onError(Reconnector::GAVE_UP_ERROR);
+	}
+}
+
+template class StreamSocketSink<asio::ip::tcp>;
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+template class StreamSocketSink<asio::local::stream_protocol>;
+#endif
+
+} // namespace obs_audio_to_websocket
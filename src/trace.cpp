@@ -0,0 +1,132 @@
+#include "obs-audio-to-websocket/trace.hpp"
+#include "obs-audio-to-websocket/log.hpp"
+#include <algorithm>
+
+namespace obs_audio_to_websocket {
+
+namespace {
+
+thread_local const char *t_threadName = nullptr;
+
+} // namespace
+
+Tracer &Tracer::Instance()
+{
+	static Tracer instance;
+	return instance;
+}
+
+void Tracer::SetEnabled(bool enabled)
+{
+#ifdef AUDIO_TO_WEBSOCKET_NO_TRACING
+	if (enabled) {
+		blog(LOG_WARNING, "[Audio to WebSocket] Tracing is not compiled into this build");
+	}
+#else
+	if (s_enabled.exchange(enabled) != enabled) {
+		blog(LOG_INFO, "[Audio to WebSocket] Trace recording %s", enabled ? "started" : "stopped");
+	}
+#endif
+}
+
+void Tracer::SetThreadName(const char *name)
+{
+	t_threadName = name;
+}
+
+Tracer::Ring &Tracer::ThreadRing()
+{
+	thread_local Ring *t_ring = nullptr;
+	if (!t_ring) {
+		auto ring = std::make_shared<Ring>();
+		std::lock_guard<std::mutex> lock(m_mutex);
+		ring->thread = static_cast<uint32_t>(m_rings.size() + 1);
+		m_rings.push_back(ring);
+		t_ring = ring.get();
+	}
+	// Picked up here rather than in SetThreadName, which may run before the thread's first event
+	if (t_threadName && t_ring->threadName.load(std::memory_order_relaxed) != t_threadName) {
+		t_ring->threadName.store(t_threadName, std::memory_order_relaxed);
+	}
+	return *t_ring;
+}
+
+void Tracer::Record(const char *name, uint64_t startNs, uint64_t duration, uint64_t id)
+{
+	Ring &ring = ThreadRing();
+	uint64_t index = ring.head.load(std::memory_order_relaxed);
+	Slot &slot = ring.slots[index % RING_SIZE];
+
+	// Same sequence-counter scheme as LevelSnapshot, per slot, so a dump can skip one being overwritten
+	slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.name.store(name, std::memory_order_relaxed);
+	slot.start.store(startNs, std::memory_order_relaxed);
+	slot.duration.store(duration, std::memory_order_relaxed);
+	slot.id.store(id, std::memory_order_relaxed);
+	slot.sequence.store(2 * index + 2, std::memory_order_release);
+
+	ring.head.store(index + 1, std::memory_order_release);
+}
+
+nlohmann::json Tracer::Collect(size_t maxEventsPerThread) const
+{
+	std::vector<std::shared_ptr<Ring>> rings;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		rings = m_rings;
+	}
+
+	nlohmann::json events = nlohmann::json::array();
+	for (const auto &ring : rings) {
+		const char *threadName = ring->threadName.load(std::memory_order_relaxed);
+		events.push_back({{"name", "thread_name"},
+				  {"ph", "M"},
+				  {"pid", 1},
+				  {"tid", ring->thread},
+				  {"args", {{"name", threadName ? threadName : "thread " + std::to_string(ring->thread)}}}});
+
+		uint64_t head = ring->head.load(std::memory_order_acquire);
+		uint64_t kept = std::min<uint64_t>(maxEventsPerThread, RING_SIZE);
+		uint64_t first = std::max(ring->cleared.load(std::memory_order_relaxed),
+					  head > kept ? head - kept : uint64_t(0));
+		for (uint64_t index = first; index < head; ++index) {
+			const Slot &slot = ring->slots[index % RING_SIZE];
+			uint64_t before = slot.sequence.load(std::memory_order_acquire);
+			if (before != 2 * index + 2)
+				continue;
+
+			const char *name = slot.name.load(std::memory_order_relaxed);
+			uint64_t start = slot.start.load(std::memory_order_relaxed);
+			uint64_t duration = slot.duration.load(std::memory_order_relaxed);
+			uint64_t id = slot.id.load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (slot.sequence.load(std::memory_order_relaxed) != before)
+				continue;
+
+			// Trace-event timestamps are microseconds; fractions keep the nanoseconds
+			nlohmann::json event = {{"name", name},    {"cat", "audio"},          {"pid", 1},
+						{"tid", ring->thread}, {"ts", start / 1000.0}, {"args", {{"block", id}}}};
+			if (duration == INSTANT) {
+				event["ph"] = "i";
+				event["s"] = "t";
+			} else {
+				event["ph"] = "X";
+				event["dur"] = duration / 1000.0;
+			}
+			events.push_back(std::move(event));
+		}
+	}
+
+	return {{"traceEvents", std::move(events)}, {"displayTimeUnit", "ns"}};
+}
+
+void Tracer::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (const auto &ring : m_rings) {
+		ring->cleared.store(ring->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+	}
+}
+
+} // namespace obs_audio_to_websocket
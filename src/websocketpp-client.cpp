@@ -1,7 +1,8 @@
 // CRITICAL: Ensure ASIO_STANDALONE is defined (should come from header)
 #include "obs-audio-to-websocket/websocketpp-client.hpp"
 #include "obs-audio-to-websocket/constants.hpp"
-#include <obs-module.h>
+#include "obs-audio-to-websocket/socket-options.hpp"
+#include "obs-audio-to-websocket/log.hpp"
 #include <nlohmann/json.hpp>
 #include <functional>
 #include <asio/error_code.hpp>
@@ -12,38 +13,161 @@
 #include <websocketpp/error.hpp>
 #include <chrono>
 #include <cstring>
-#include <thread>
+#include <type_traits>
 #include <websocketpp/common/functional.hpp>
+#include <utility>
 
 namespace obs_audio_to_websocket {
 
 using json = nlohmann::json;
 
-WebSocketPPClient::WebSocketPPClient()
+#ifndef AUDIO_TO_WEBSOCKET_NO_TLS
+namespace {
+
+template<typename Config>
+constexpr bool IsTlsConfig = std::is_same<typename Config::transport_config::socket_type,
+					  websocketpp::transport::asio::tls_socket::endpoint>::value;
+
+} // namespace
+#endif
+
+template<typename Config>
+BasicWebSocketPPClient<Config>::BasicWebSocketPPClient()
+	: m_io(IoContextPool::Instance().Acquire()),
+	  m_reconnect(m_io)
 {
 	// Clear all logs to avoid spam
 	m_client.clear_access_channels(websocketpp::log::alevel::all);
 	m_client.clear_error_channels(websocketpp::log::elevel::all);
 
-	// Initialize ASIO
-	m_client.init_asio();
-
-	// Set up handlers - MUST use websocketpp::lib::bind!
-	namespace lib = websocketpp::lib;
-	m_client.set_open_handler(lib::bind(&WebSocketPPClient::OnOpen, this, lib::placeholders::_1));
-	m_client.set_close_handler(lib::bind(&WebSocketPPClient::OnClose, this, lib::placeholders::_1));
-	m_client.set_message_handler(
-		lib::bind(&WebSocketPPClient::OnMessage, this, lib::placeholders::_1, lib::placeholders::_2));
-	m_client.set_fail_handler(lib::bind(&WebSocketPPClient::OnFail, this, lib::placeholders::_1));
-	// No TLS handler needed for ws_client
+	// Run on the shared network thread; the endpoint never owns or stops this io_context
+	m_client.init_asio(&m_io);
+}
+
+template<typename Config> void BasicWebSocketPPClient<Config>::InstallHandlers()
+{
+	if (m_handlersInstalled)
+		return;
+	m_handlersInstalled = true;
+
+	// Registered here rather than in the constructor because they hold a weak_ptr to this client:
+	// connections can outlive it on the shared io_context, and their callbacks must not touch it.
+	m_client.set_open_handler(WeakHandler(this, [this](websocketpp::connection_hdl hdl) { OnOpen(hdl); }));
+	m_client.set_close_handler(WeakHandler(this, [this](websocketpp::connection_hdl hdl) { OnClose(hdl); }));
+	m_client.set_message_handler(WeakHandler(
+		this, [this](websocketpp::connection_hdl hdl, message_ptr msg) { OnMessage(hdl, std::move(msg)); }));
+	m_client.set_fail_handler(WeakHandler(this, [this](websocketpp::connection_hdl hdl) { OnFail(hdl); }));
+	// Runs once TCP is connected, before the TLS and WebSocket handshakes
+	m_client.set_tcp_pre_init_handler(
+		WeakHandler(this, [this](websocketpp::connection_hdl hdl) { TuneSocket(hdl); }));
+
+#ifndef AUDIO_TO_WEBSOCKET_NO_TLS
+	if constexpr (IsTlsConfig<Config>) {
+		// Every connection of this client shares one context, which holds the cached session
+		m_client.set_tls_init_handler([ctx = m_tlsContext](websocketpp::connection_hdl) { return ctx; });
+		using tls_stream = asio::ssl::stream<asio::ip::tcp::socket>;
+		auto onSocketInit = [this](websocketpp::connection_hdl, tls_stream &stream) {
+			std::string host = websocketpp::uri(m_uri).get_host();
+			stream.set_verify_callback(asio::ssl::rfc2818_verification(host));
+
+			std::lock_guard<std::mutex> lock(m_tlsSessionMutex);
+			if (m_tlsSession) {
+				SSL_set_session(stream.native_handle(), m_tlsSession);
+			}
+		};
+		m_client.set_socket_init_handler(WeakHandler(this, onSocketInit));
+	}
+#endif
 }
 
-WebSocketPPClient::~WebSocketPPClient()
+template<typename Config> BasicWebSocketPPClient<Config>::~BasicWebSocketPPClient()
 {
 	Disconnect();
+
+#ifndef AUDIO_TO_WEBSOCKET_NO_TLS
+	if (m_tlsContext) {
+		// Connections still draining on the network thread share the context; stop them calling back here
+		RunOnContext(m_io, [this]() { SSL_CTX_set_app_data(m_tlsContext->native_handle(), nullptr); });
+	}
+
+	std::lock_guard<std::mutex> lock(m_tlsSessionMutex);
+	if (m_tlsSession) {
+		SSL_SESSION_free(m_tlsSession);
+		m_tlsSession = nullptr;
+	}
+#endif
 }
 
-bool WebSocketPPClient::Connect(const std::string &uri)
+template<typename Config> void BasicWebSocketPPClient<Config>::TuneSocket(websocketpp::connection_hdl hdl)
+{
+	websocketpp::lib::error_code ec;
+	typename client::connection_ptr con = m_client.get_con_from_hdl(hdl, ec);
+	if (ec || !con)
+		return;
+
+	int dscp = m_dscp.load();
+	asio::error_code optionEc = TuneAudioSocket(con->get_raw_socket(), dscp);
+	if (optionEc) {
+		blog(LOG_WARNING, "[Audio to WebSocket] Could not apply socket options (DSCP %d): %s", dscp,
+		     optionEc.message().c_str());
+	}
+}
+
+#ifndef AUDIO_TO_WEBSOCKET_NO_TLS
+template<typename Config> void BasicWebSocketPPClient<Config>::InitTls()
+{
+	if (m_tlsContext)
+		return;
+
+	auto ctx = std::make_shared<asio::ssl::context>(asio::ssl::context::sslv23_client);
+	ctx->set_options(asio::ssl::context::default_workarounds | asio::ssl::context::no_sslv2 |
+			 asio::ssl::context::no_sslv3 | asio::ssl::context::no_tlsv1 |
+			 asio::ssl::context::no_tlsv1_1);
+	ctx->set_verify_mode(asio::ssl::verify_peer);
+	if (m_tlsCaFile.empty()) {
+		ctx->set_default_verify_paths();
+	} else {
+		ctx->load_verify_file(m_tlsCaFile);
+	}
+
+	// Hand new sessions (TLS 1.2 session IDs and TLS 1.3 tickets alike) to StoreTlsSession
+	// rather than OpenSSL's internal cache, which clients never look up.
+	SSL_CTX *native = ctx->native_handle();
+	SSL_CTX_set_session_cache_mode(native, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+	SSL_CTX_set_app_data(native, this);
+	SSL_CTX_sess_set_new_cb(native, [](SSL *ssl, SSL_SESSION *session) -> int {
+		auto *self = static_cast<BasicWebSocketPPClient *>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+		if (!self)
+			return 0; // Client is gone; OpenSSL frees the session
+		self->StoreTlsSession(session);
+		return 1; // We keep the reference
+	});
+
+	m_tlsContext = ctx;
+}
+
+template<typename Config> void BasicWebSocketPPClient<Config>::StoreTlsSession(SSL_SESSION *session)
+{
+	std::lock_guard<std::mutex> lock(m_tlsSessionMutex);
+	if (m_tlsSession) {
+		SSL_SESSION_free(m_tlsSession);
+	}
+	m_tlsSession = session;
+}
+#endif
+
+template<typename Config>
+void BasicWebSocketPPClient<Config>::StartConnection(typename client::connection_ptr con)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_hdlMutex);
+		m_hdl = con->get_handle();
+	}
+	m_connectStart = std::chrono::steady_clock::now();
+	m_client.connect(con);
+}
+
+template<typename Config> bool BasicWebSocketPPClient<Config>::Connect(const std::string &uri)
 {
 	if (m_connected) {
 		blog(LOG_WARNING, "[Audio to WebSocket] Already connected");
@@ -53,23 +177,19 @@ bool WebSocketPPClient::Connect(const std::string &uri)
 	m_uri = uri;
 	m_shouldReconnect = true; // Enable auto-reconnect by default
 
-	// Start the event loop thread first
-	if (!m_threadRunning) {
-		m_threadRunning = true;
-		m_running = true;
-		m_thread = std::thread(&WebSocketPPClient::Run, this);
-		// Give the thread time to start
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
-	} else if (!m_running) {
-		// Thread exists but event loop stopped, need to restart
-		m_running = true;
-		m_client.reset();
-		// The thread should pick up that m_running is true again
-	}
+	m_running = true;
+	m_reconnect.Reset();
 
 	try {
+#ifndef AUDIO_TO_WEBSOCKET_NO_TLS
+		if constexpr (IsTlsConfig<Config>) {
+			InitTls();
+		}
+#endif
+		InstallHandlers();
+
 		websocketpp::lib::error_code ec;
-		client::connection_ptr con = m_client.get_connection(uri, ec);
+		typename client::connection_ptr con = m_client.get_connection(uri, ec);
 
 		if (ec) {
 			std::string errorMessage = ec.message();
@@ -80,11 +200,7 @@ bool WebSocketPPClient::Connect(const std::string &uri)
 			return false;
 		}
 
-		{
-			std::lock_guard<std::mutex> lock(m_hdlMutex);
-			m_hdl = con->get_handle();
-		}
-		m_client.connect(con);
+		StartConnection(con);
 
 		return true;
 	} catch (const websocketpp::exception &e) {
@@ -93,130 +209,62 @@ bool WebSocketPPClient::Connect(const std::string &uri)
 			m_onError(e.what());
 		}
 		return false;
+	} catch (const asio::system_error &e) {
+		// TLS context setup, e.g. an unreadable CA file
+		blog(LOG_ERROR, "[Audio to WebSocket] TLS setup failed: %s", e.what());
+		if (m_onError) {
+			m_onError(std::string("TLS setup failed: ") + e.what());
+		}
+		return false;
 	}
 }
 
-void WebSocketPPClient::Disconnect()
+template<typename Config> void BasicWebSocketPPClient<Config>::Disconnect()
 {
 	m_shouldReconnect = false;
-	m_reconnecting = false;
+	m_running = false;
 
-	// Wait for any reconnection thread to finish
-	if (m_reconnectThread.joinable()) {
-		m_reconnectThread.join();
-	}
+	// On the client's own network thread, so no handler is halfway through reconnecting
+	RunOnContext(m_io, [this]() {
+		m_reconnect.Cancel();
 
-	if (m_connected) {
 		websocketpp::lib::error_code ec;
 		websocketpp::connection_hdl hdl;
 		{
 			std::lock_guard<std::mutex> lock(m_hdlMutex);
 			hdl = m_hdl;
 		}
-		m_client.close(hdl, websocketpp::close::status::normal, "Closing connection", ec);
-		if (ec) {
-			std::string errorMessage = ec.message();
-			blog(LOG_ERROR, "[Audio to WebSocket] Error closing connection: %s", errorMessage.c_str());
-		}
-	}
-
-	// Stop the event loop
-	m_running = false;
-	m_client.stop();
-
-	// Wait for thread to finish
-	if (m_thread.joinable()) {
-		m_thread.join();
-		m_threadRunning = false;
-	}
-
-	m_connected = false;
-}
-
-void WebSocketPPClient::Run()
-{
-
-	int reset_count = 0;
-	while (m_running) {
-		try {
-
-			m_client.run();
-
-			// If we're still supposed to be running, the io_service ran out of work
-			// Reset it so it can be run again
-			if (m_running) {
-				reset_count++;
-				m_client.reset();
-				// Small delay to prevent busy loop
-				std::this_thread::sleep_for(std::chrono::milliseconds(100));
-			}
-		} catch (const websocketpp::exception &e) {
-			blog(LOG_ERROR, "[Audio to WebSocket] WebSocket++ exception: %s", e.what());
-			// Continue loop unless we're shutting down
-			if (m_running) {
-				std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-			}
-		} catch (const std::exception &e) {
-			blog(LOG_ERROR, "[Audio to WebSocket] Exception: %s", e.what());
-			if (m_running) {
-				std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-			}
-		} catch (...) {
-			blog(LOG_ERROR, "[Audio to WebSocket] Unknown exception in WebSocket event loop");
-			if (m_running) {
-				std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+		typename client::connection_ptr con = m_client.get_con_from_hdl(hdl, ec);
+		if (ec || !con)
+			return;
+
+		if (con->get_state() == websocketpp::session::state::open) {
+			con->close(websocketpp::close::status::normal, "Closing connection", ec);
+			if (ec) {
+				std::string errorMessage = ec.message();
+				blog(LOG_ERROR, "[Audio to WebSocket] Error closing connection: %s",
+				     errorMessage.c_str());
 			}
+		} else if (con->get_state() == websocketpp::session::state::connecting) {
+			// The shared io_context can't be stopped to abandon a pending connect; abort the socket instead
+			asio::error_code closeEc;
+			con->get_raw_socket().close(closeEc);
 		}
-	}
+	});
 
-	m_threadRunning = false;
+	// OnClose ignores a close after Disconnect(), so report it here like the other transports
+	if (m_connected.exchange(false) && m_onDisconnected) {
+		m_onDisconnected();
+	}
 }
 
 // ProcessSendQueue removed - we send messages directly now
 
-void WebSocketPPClient::SendAudioData(const AudioChunk &chunk)
+template<typename Config> void BasicWebSocketPPClient<Config>::SendAudioPacket(const AudioPacketPtr &packet)
 {
-	if (!m_connected)
+	if (!m_connected || !packet)
 		return;
 
-	// Convert to binary format (same as libwebsockets version)
-	std::vector<uint8_t> binaryData;
-
-	// Header: timestamp(8) + sampleRate(4) + channels(4) + bitDepth(4) + sourceIdLen(4) + sourceNameLen(4)
-	size_t headerSize = 8 + 4 + 4 + 4 + 4 + 4;
-	size_t sourceIdLen = chunk.sourceId.length();
-	size_t sourceNameLen = chunk.sourceName.length();
-	size_t totalSize = headerSize + sourceIdLen + sourceNameLen + chunk.data.size();
-
-	binaryData.reserve(totalSize);
-
-	// Write header (all multi-byte values in little-endian format)
-	auto writeUint64 = [&](uint64_t val) {
-		for (int i = 0; i < 8; ++i) {
-			binaryData.push_back((val >> (i * 8)) & 0xFF);
-		}
-	};
-
-	auto writeUint32 = [&](uint32_t val) {
-		for (int i = 0; i < 4; ++i) {
-			binaryData.push_back((val >> (i * 8)) & 0xFF);
-		}
-	};
-
-	writeUint64(chunk.timestamp);
-	writeUint32(chunk.format.sampleRate);
-	writeUint32(chunk.format.channels);
-	writeUint32(chunk.format.bitDepth);
-	writeUint32(static_cast<uint32_t>(sourceIdLen));
-	writeUint32(static_cast<uint32_t>(sourceNameLen));
-
-	// Write strings
-	binaryData.insert(binaryData.end(), chunk.sourceId.begin(), chunk.sourceId.end());
-	binaryData.insert(binaryData.end(), chunk.sourceName.begin(), chunk.sourceName.end());
-
-	// Write audio data (16-bit signed PCM samples in little-endian format)
-	binaryData.insert(binaryData.end(), chunk.data.begin(), chunk.data.end());
-
 	// Send as binary message directly
 	try {
 		websocketpp::lib::error_code ec;
@@ -225,7 +273,30 @@ void WebSocketPPClient::SendAudioData(const AudioChunk &chunk)
 			std::lock_guard<std::mutex> lock(m_hdlMutex);
 			hdl = m_hdl;
 		}
-		m_client.send(hdl, binaryData.data(), binaryData.size(), websocketpp::frame::opcode::binary, ec);
+
+		typename client::connection_ptr con = m_client.get_con_from_hdl(hdl, ec);
+		if (ec || !con) {
+			return;
+		}
+
+		// Each sink owns its own outgoing buffer; shed load here rather than let it grow without bound
+		size_t buffered = con->get_buffered_amount();
+		if (buffered > constants::MAX_SEND_BUFFERED_BYTES) {
+			m_droppedPackets++;
+			RecordDropped();
+			if (!m_backpressured.exchange(true)) {
+				blog(LOG_WARNING, "[Audio to WebSocket] Send buffer full for %s, dropping audio",
+				     m_uri.c_str());
+			}
+			return;
+		}
+		if (m_backpressured.exchange(false)) {
+			blog(LOG_INFO, "[Audio to WebSocket] Send buffer drained for %s (%llu packets dropped)",
+			     m_uri.c_str(), static_cast<unsigned long long>(m_droppedPackets.load()));
+		}
+
+		RecordQueuedBytes(buffered);
+		ec = con->send(packet->data.data(), packet->data.size(), websocketpp::frame::opcode::binary);
 
 		if (ec) {
 			std::string errorMessage = ec.message();
@@ -235,25 +306,20 @@ void WebSocketPPClient::SendAudioData(const AudioChunk &chunk)
 			if (m_onError) {
 				m_onError("Failed to send audio data: " + errorMessage);
 			}
+		} else {
+			// websocketpp owns the write from here and reports no completion, so this is hand-off time
+			RecordSent(packet->captureNs, packet->data.size());
 		}
 	} catch (const websocketpp::exception &e) {
 		blog(LOG_ERROR, "[Audio to WebSocket] Exception sending audio data: %s", e.what());
 	}
 }
 
-void WebSocketPPClient::SendControlMessage(const std::string &type)
+template<typename Config> void BasicWebSocketPPClient<Config>::SendControlText(const std::string &payload)
 {
 	if (!m_connected)
 		return;
 
-	json msg;
-	msg["type"] = type;
-	msg["timestamp"] = std::chrono::duration_cast<std::chrono::microseconds>(
-				   std::chrono::system_clock::now().time_since_epoch())
-				   .count();
-
-	std::string payload = msg.dump();
-
 	// Send control message directly
 	try {
 		websocketpp::lib::error_code ec;
@@ -274,15 +340,43 @@ void WebSocketPPClient::SendControlMessage(const std::string &type)
 	}
 }
 
-void WebSocketPPClient::OnOpen(websocketpp::connection_hdl hdl)
+template<typename Config> bool BasicWebSocketPPClient<Config>::IsCurrentConnection(websocketpp::connection_hdl hdl) const
+{
+	std::lock_guard<std::mutex> lock(m_hdlMutex);
+	return !m_hdl.owner_before(hdl) && !hdl.owner_before(m_hdl);
+}
+
+template<typename Config> void BasicWebSocketPPClient<Config>::OnOpen(websocketpp::connection_hdl hdl)
 {
-	blog(LOG_INFO, "[Audio to WebSocket] Connected");
+	if (!m_running || !IsCurrentConnection(hdl)) {
+		// Disconnected (or reconnected elsewhere) while the handshake was in flight
+		websocketpp::lib::error_code ec;
+		m_client.close(hdl, websocketpp::close::status::normal, "Closing connection", ec);
+		return;
+	}
+
+	double elapsedMs =
+		std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_connectStart).count();
+	m_lastConnectMs = elapsedMs;
+
+#ifndef AUDIO_TO_WEBSOCKET_NO_TLS
+	if constexpr (IsTlsConfig<Config>) {
+		websocketpp::lib::error_code ec;
+		typename client::connection_ptr con = m_client.get_con_from_hdl(hdl, ec);
+		m_tlsSessionResumed = !ec && con && SSL_session_reused(con->get_socket().native_handle());
+		blog(LOG_INFO, "[Audio to WebSocket] Connected in %.1f ms (%s)", elapsedMs,
+		     m_tlsSessionResumed ? "TLS session resumed" : "full TLS handshake");
+	} else
+#endif
+	{
+		blog(LOG_INFO, "[Audio to WebSocket] Connected in %.1f ms", elapsedMs);
+	}
 	{
 		std::lock_guard<std::mutex> lock(m_hdlMutex);
 		m_hdl = hdl; // Update the handle with the connected one
 	}
 	m_connected = true;
-	m_reconnectAttempts = 0; // Reset reconnection attempts on successful connection
+	m_reconnect.Reset();
 
 	if (m_onConnected) {
 		m_onConnected();
@@ -292,27 +386,28 @@ void WebSocketPPClient::OnOpen(websocketpp::connection_hdl hdl)
 	SendControlMessage("start");
 }
 
-void WebSocketPPClient::OnClose(websocketpp::connection_hdl hdl)
+template<typename Config> void BasicWebSocketPPClient<Config>::OnClose(websocketpp::connection_hdl hdl)
 {
-	(void)hdl; // Suppress unused parameter warning
-
-	if (m_connected) {
-		blog(LOG_INFO, "[Audio to WebSocket] Disconnected");
-	}
-
-	m_connected = false;
+	// The loop keeps running after Disconnect(), so a dropped connection can report in after a new Connect()
+	if (!m_running || !IsCurrentConnection(hdl))
+		return;
 
-	if (m_onDisconnected) {
-		m_onDisconnected();
+	websocketpp::lib::error_code ec;
+	typename client::connection_ptr con = m_client.get_con_from_hdl(hdl, ec);
+	std::string reason;
+	if (!ec && con) {
+		reason = con->get_remote_close_reason();
+		if (reason.empty())
+			reason = websocketpp::close::status::get_string(con->get_remote_close_code());
 	}
 
-	// Schedule reconnection if enabled
-	if (m_shouldReconnect && m_running) {
+	ReportConnectionLost(m_connected.exchange(false), m_reconnect.IsReconnecting(), "Connection closed", reason);
+	if (m_shouldReconnect) {
 		ScheduleReconnect();
 	}
 }
 
-void WebSocketPPClient::OnMessage(websocketpp::connection_hdl hdl, message_ptr msg)
+template<typename Config> void BasicWebSocketPPClient<Config>::OnMessage(websocketpp::connection_hdl hdl, message_ptr msg)
 {
 	(void)hdl; // Suppress unused parameter warning
 	if (m_onMessage) {
@@ -320,112 +415,65 @@ void WebSocketPPClient::OnMessage(websocketpp::connection_hdl hdl, message_ptr m
 	}
 }
 
-void WebSocketPPClient::OnFail(websocketpp::connection_hdl hdl)
+template<typename Config> void BasicWebSocketPPClient<Config>::OnFail(websocketpp::connection_hdl hdl)
 {
-	(void)hdl; // Suppress unused parameter warning
+	if (!m_running || !IsCurrentConnection(hdl))
+		return;
 
 	// Get detailed error information
-	client::connection_ptr con = m_client.get_con_from_hdl(hdl);
+	typename client::connection_ptr con = m_client.get_con_from_hdl(hdl);
 	websocketpp::lib::error_code ec;
 	if (con) {
 		ec = con->get_ec();
 	}
 
-	std::string errorMessage = ec.message();
-	blog(LOG_ERROR, "[Audio to WebSocket] Connection failed: %s (code: %d)", errorMessage.c_str(), ec.value());
-	m_connected = false;
-
-	// Only call error callback for initial connection attempts, not during automatic reconnection
-	if (!m_reconnecting && m_onError) {
-		m_onError("Connection failed: " + errorMessage);
-	}
-
-	// Schedule reconnection if enabled
-	if (m_shouldReconnect && m_running) {
+	bool wasConnected = m_connected.exchange(false);
+	ReportConnectionLost(wasConnected, m_reconnect.IsReconnecting(), "Connection failed", ec.message());
+	if (m_shouldReconnect) {
 		ScheduleReconnect();
 	}
 }
 
-// TLS handler removed - using non-TLS client for now
-
-void WebSocketPPClient::ScheduleReconnect()
+template<typename Config> void BasicWebSocketPPClient<Config>::ScheduleReconnect()
 {
-	if (m_reconnecting.exchange(true)) {
-		// Already reconnecting
-		return;
-	}
-
-	// Clean up any existing reconnect thread
-	if (m_reconnectThread.joinable()) {
-		m_reconnectThread.join();
+	// A timer on the shared io_context rather than a sleeping thread per client
+	if (!m_reconnect.Schedule(this, m_uri, [this]() { DoReconnect(); }) && m_onError) {
+		m_onError(Reconnector::GAVE_UP_ERROR);
 	}
-
-	// Start reconnection in a separate thread
-	m_reconnectThread = std::thread(&WebSocketPPClient::DoReconnect, this);
 }
 
-void WebSocketPPClient::DoReconnect()
+template<typename Config> void BasicWebSocketPPClient<Config>::DoReconnect()
 {
-	m_reconnectAttempts++;
-
-	// Calculate delay with exponential backoff
-	int delay = constants::INITIAL_RECONNECT_DELAY_MS;
-	for (int i = 1; i < m_reconnectAttempts && delay < constants::MAX_RECONNECT_DELAY_MS; i++) {
-		delay *= 2;
-	}
-	if (delay > constants::MAX_RECONNECT_DELAY_MS) {
-		delay = constants::MAX_RECONNECT_DELAY_MS;
-	}
-
-	blog(LOG_INFO, "[Audio to WebSocket] Reconnecting in %d ms (attempt %d/%d)", delay, m_reconnectAttempts.load(),
-	     constants::MAX_RECONNECT_ATTEMPTS);
-
-	// Wait for the delay
-	std::this_thread::sleep_for(std::chrono::milliseconds(delay));
-
 	// Check if we should still reconnect
 	if (!m_shouldReconnect || !m_running) {
-		m_reconnecting = false;
+		m_reconnect.Cancel();
 		return;
 	}
 
-	// Check if we've exceeded max attempts
-	if (m_reconnectAttempts > constants::MAX_RECONNECT_ATTEMPTS) {
-		blog(LOG_ERROR, "[Audio to WebSocket] Max reconnection attempts reached. Giving up.");
-		m_reconnecting = false;
-		// Notify that connection has permanently failed
-		if (m_onError) {
-			m_onError("Connection lost: Max reconnection attempts exceeded");
-		}
-		return;
-	}
-
-	// Attempt to reconnect
-	blog(LOG_INFO, "[Audio to WebSocket] Attempting to reconnect...");
+	blog(LOG_INFO, "[Audio to WebSocket] Attempting to reconnect to %s", m_uri.c_str());
 
-	// The Connect method will handle the actual connection
-	// We just need to reset the client and try again
+	// OnOpen resets the reconnector; OnFail or OnClose schedule the next attempt. If the connection can't even be
+	// created neither will run, so schedule it here.
 	try {
 		websocketpp::lib::error_code ec;
-		client::connection_ptr con = m_client.get_connection(m_uri, ec);
+		typename client::connection_ptr con = m_client.get_connection(m_uri, ec);
 
 		if (ec) {
 			std::string errorMessage = ec.message();
 			blog(LOG_ERROR, "[Audio to WebSocket] Reconnection failed: %s", errorMessage.c_str());
-			// Will retry via OnFail callback
+			ScheduleReconnect();
 		} else {
-			{
-				std::lock_guard<std::mutex> lock(m_hdlMutex);
-				m_hdl = con->get_handle();
-			}
-			m_client.connect(con);
+			StartConnection(con);
 		}
 	} catch (const websocketpp::exception &e) {
 		blog(LOG_ERROR, "[Audio to WebSocket] Reconnection exception: %s", e.what());
-		// Will retry via OnFail callback
+		ScheduleReconnect();
 	}
-
-	m_reconnecting = false;
 }
 
+template class BasicWebSocketPPClient<TunedAsioConfig>;
+#ifndef AUDIO_TO_WEBSOCKET_NO_TLS
+template class BasicWebSocketPPClient<TunedAsioTlsConfig>;
+#endif
+
 } // namespace obs_audio_to_websocket
@@ -0,0 +1,329 @@
+#include "obs-audio-to-websocket/websocketpp-server.hpp"
+#include "obs-audio-to-websocket/constants.hpp"
+#include "obs-audio-to-websocket/audio-sink.hpp"
+#include "obs-audio-to-websocket/log.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <websocketpp/close.hpp>
+#include <websocketpp/frame.hpp>
+#include <websocketpp/logger/levels.hpp>
+#include <websocketpp/error.hpp>
+#include <websocketpp/common/functional.hpp>
+
+namespace obs_audio_to_websocket {
+
+using json = nlohmann::json;
+
+namespace {
+
+int64_t SteadyNowMs()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+		       std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+} // namespace
+
+WebSocketPPServer::WebSocketPPServer()
+	: m_io(IoContextPool::Instance().Acquire()),
+	  m_subscribers(std::make_shared<SubscriberList>())
+{
+	// Clear all logs to avoid spam
+	m_server.clear_access_channels(websocketpp::log::alevel::all);
+	m_server.clear_error_channels(websocketpp::log::elevel::all);
+
+	// Accepts and serves subscribers on the shared network thread pool
+	m_server.init_asio(&m_io);
+	m_server.set_reuse_addr(true);
+
+	// Plain `this` binds: the destructor drains the handlers that could still call back, and the owner
+	// releases the server before the pool stops
+	namespace lib = websocketpp::lib;
+	m_server.set_open_handler(lib::bind(&WebSocketPPServer::OnOpen, this, lib::placeholders::_1));
+	m_server.set_close_handler(lib::bind(&WebSocketPPServer::OnClose, this, lib::placeholders::_1));
+	m_server.set_message_handler(
+		lib::bind(&WebSocketPPServer::OnMessage, this, lib::placeholders::_1, lib::placeholders::_2));
+}
+
+WebSocketPPServer::~WebSocketPPServer()
+{
+	Stop();
+	// Completions of the sockets Stop cut off are queued by now; let them call back into this first
+	RunOnContext(m_io, []() {});
+}
+
+bool WebSocketPPServer::Start(uint16_t port)
+{
+	if (m_running) {
+		blog(LOG_WARNING, "[Audio to WebSocket] Server already running on port %u", m_port);
+		return false;
+	}
+
+	websocketpp::lib::error_code ec;
+
+	// Prefer a dual-stack socket, fall back to IPv4 where IPv6 is disabled
+	m_server.listen(port, ec);
+	if (ec) {
+		ec.clear();
+		m_server.listen(websocketpp::lib::asio::ip::tcp::v4(), port, ec);
+	}
+	if (ec) {
+		std::string errorMessage = ec.message();
+		blog(LOG_ERROR, "[Audio to WebSocket] Could not listen on port %u: %s", port, errorMessage.c_str());
+		if (m_onError) {
+			m_onError("Server could not listen on port " + std::to_string(port) + ": " + errorMessage);
+		}
+		return false;
+	}
+
+	m_server.start_accept(ec);
+	if (ec) {
+		std::string errorMessage = ec.message();
+		blog(LOG_ERROR, "[Audio to WebSocket] Could not accept connections: %s", errorMessage.c_str());
+		m_server.stop_listening(ec);
+		return false;
+	}
+
+	// Port 0 listens on a free port
+	asio::error_code endpointEc;
+	m_port = port ? port : m_server.get_local_endpoint(endpointEc).port();
+	m_running = true;
+
+	blog(LOG_INFO, "[Audio to WebSocket] Server listening on port %u", m_port);
+	return true;
+}
+
+void WebSocketPPServer::Stop()
+{
+	if (!m_running.exchange(false)) {
+		return;
+	}
+
+	// The io_context is shared, so stop accepting and close subscribers instead of stopping the loop
+	RunOnContext(m_io, [this]() {
+		websocketpp::lib::error_code ec;
+		m_server.stop_listening(ec);
+
+		std::shared_ptr<const SubscriberList> subscribers = std::atomic_load(&m_subscribers);
+		for (const auto &subscriber : *subscribers) {
+			m_server.close(subscriber->hdl, websocketpp::close::status::going_away, "Server stopping", ec);
+		}
+	});
+
+	// OnClose drops each subscriber as its handshake completes. Not on the network thread itself, which
+	// has to run those handshakes.
+	if (!m_io.get_executor().running_in_this_thread()) {
+		std::unique_lock<std::mutex> lock(m_subscribersMutex);
+		m_subscriberClosed.wait_for(lock, std::chrono::milliseconds(constants::SERVER_CLOSE_TIMEOUT_MS),
+					    [this]() { return std::atomic_load(&m_subscribers)->empty(); });
+	}
+
+	// Subscribers that never answered are cut off
+	RunOnContext(m_io, [this]() {
+		std::shared_ptr<const SubscriberList> subscribers = std::atomic_load(&m_subscribers);
+		for (const auto &subscriber : *subscribers) {
+			websocketpp::lib::error_code ec;
+			server::connection_ptr con = m_server.get_con_from_hdl(subscriber->hdl, ec);
+			if (con) {
+				blog(LOG_WARNING, "[Audio to WebSocket] Subscriber %s did not close in time",
+				     subscriber->remote.c_str());
+				asio::error_code closeEc;
+				con->get_raw_socket().close(closeEc);
+			}
+		}
+	});
+
+	std::atomic_store(&m_subscribers, std::shared_ptr<const SubscriberList>(std::make_shared<SubscriberList>()));
+	blog(LOG_INFO, "[Audio to WebSocket] Server stopped");
+}
+
+size_t WebSocketPPServer::GetSubscriberCount() const
+{
+	return std::atomic_load(&m_subscribers)->size();
+}
+
+void WebSocketPPServer::Broadcast(const AudioPacketPtr &packet)
+{
+	if (!m_running || !packet)
+		return;
+
+	std::shared_ptr<const SubscriberList> subscribers = std::atomic_load(&m_subscribers);
+	if (subscribers->empty())
+		return;
+
+	int64_t now = SteadyNowMs();
+
+	for (const auto &subscriber : *subscribers) {
+		if (subscriber->evicting || !WantsSource(*subscriber, packet->sourceName)) {
+			continue;
+		}
+
+		websocketpp::lib::error_code ec;
+		server::connection_ptr con = m_server.get_con_from_hdl(subscriber->hdl, ec);
+		if (ec || !con) {
+			continue;
+		}
+
+		// The connection's outgoing buffer is this subscriber's send queue. When it backs up we
+		// drop for that subscriber only, and evict it if it never catches up.
+		size_t buffered = con->get_buffered_amount();
+		if (buffered > constants::SERVER_MAX_SUBSCRIBER_BUFFERED_BYTES) {
+			m_droppedPackets++;
+
+			int64_t since = subscriber->laggingSinceMs.load();
+			if (since == 0) {
+				subscriber->laggingSinceMs = now;
+			} else if (now - since > constants::SERVER_SLOW_CONSUMER_EVICT_MS) {
+				Evict(subscriber, "Slow consumer");
+			}
+			continue;
+		}
+		subscriber->laggingSinceMs = 0;
+
+		ec = con->send(packet->data.data(), packet->data.size(), websocketpp::frame::opcode::binary);
+		if (ec) {
+			Evict(subscriber, "Send failed");
+		}
+	}
+}
+
+void WebSocketPPServer::BroadcastControlText(const std::string &payload)
+{
+	std::shared_ptr<const SubscriberList> subscribers = std::atomic_load(&m_subscribers);
+	for (const auto &subscriber : *subscribers) {
+		SendControlText(subscriber->hdl, payload);
+	}
+}
+
+void WebSocketPPServer::SendControlText(websocketpp::connection_hdl hdl, const std::string &payload)
+{
+	websocketpp::lib::error_code ec;
+	m_server.send(hdl, payload, websocketpp::frame::opcode::text, ec);
+}
+
+void WebSocketPPServer::Evict(const std::shared_ptr<Subscriber> &subscriber, const char *reason)
+{
+	if (subscriber->evicting.exchange(true)) {
+		return;
+	}
+
+	m_evicted++;
+	blog(LOG_WARNING, "[Audio to WebSocket] Evicting subscriber %s: %s", subscriber->remote.c_str(), reason);
+
+	// Closing is asynchronous; OnClose removes the subscriber from the list
+	websocketpp::lib::error_code ec;
+	m_server.close(subscriber->hdl, websocketpp::close::status::try_again_later, reason, ec);
+}
+
+std::shared_ptr<WebSocketPPServer::Subscriber> WebSocketPPServer::FindSubscriber(websocketpp::connection_hdl hdl) const
+{
+	std::shared_ptr<const SubscriberList> subscribers = std::atomic_load(&m_subscribers);
+	for (const auto &subscriber : *subscribers) {
+		if (!subscriber->hdl.owner_before(hdl) && !hdl.owner_before(subscriber->hdl)) {
+			return subscriber;
+		}
+	}
+	return nullptr;
+}
+
+bool WebSocketPPServer::WantsSource(const Subscriber &subscriber, const std::string &sourceName) const
+{
+	std::shared_ptr<const std::set<std::string>> sources = std::atomic_load(&subscriber.sources);
+	return !sources || sources->empty() || sources->count(sourceName) > 0;
+}
+
+void WebSocketPPServer::OnOpen(websocketpp::connection_hdl hdl)
+{
+	auto subscriber = std::make_shared<Subscriber>();
+	subscriber->hdl = hdl;
+
+	websocketpp::lib::error_code ec;
+	server::connection_ptr con = m_server.get_con_from_hdl(hdl, ec);
+	if (con) {
+		subscriber->remote = con->get_remote_endpoint();
+	}
+
+	size_t count;
+	{
+		std::lock_guard<std::mutex> lock(m_subscribersMutex);
+		auto updated = std::make_shared<SubscriberList>(*std::atomic_load(&m_subscribers));
+		updated->push_back(subscriber);
+		count = updated->size();
+		std::atomic_store(&m_subscribers, std::shared_ptr<const SubscriberList>(updated));
+	}
+
+	blog(LOG_INFO, "[Audio to WebSocket] Subscriber connected: %s (%zu total)", subscriber->remote.c_str(), count);
+	SendControlText(hdl, MakeControlMessage("start"));
+
+	if (m_onSubscribersChanged) {
+		m_onSubscribersChanged(count);
+	}
+}
+
+void WebSocketPPServer::OnClose(websocketpp::connection_hdl hdl)
+{
+	std::shared_ptr<Subscriber> removed;
+	size_t count;
+	{
+		std::lock_guard<std::mutex> lock(m_subscribersMutex);
+		auto updated = std::make_shared<SubscriberList>(*std::atomic_load(&m_subscribers));
+		auto it = std::find_if(updated->begin(), updated->end(), [&hdl](const std::shared_ptr<Subscriber> &s) {
+			return !s->hdl.owner_before(hdl) && !hdl.owner_before(s->hdl);
+		});
+		if (it != updated->end()) {
+			removed = *it;
+			updated->erase(it);
+		}
+		count = updated->size();
+		std::atomic_store(&m_subscribers, std::shared_ptr<const SubscriberList>(updated));
+	}
+	m_subscriberClosed.notify_all();
+
+	if (removed) {
+		blog(LOG_INFO, "[Audio to WebSocket] Subscriber disconnected: %s (%zu remaining)",
+		     removed->remote.c_str(), count);
+	}
+
+	if (m_onSubscribersChanged) {
+		m_onSubscribersChanged(count);
+	}
+}
+
+void WebSocketPPServer::OnMessage(websocketpp::connection_hdl hdl, server::message_ptr msg)
+{
+	if (msg->get_opcode() != websocketpp::frame::opcode::text) {
+		return;
+	}
+
+	auto subscriber = FindSubscriber(hdl);
+	if (!subscriber) {
+		return;
+	}
+
+	// {"type": "subscribe", "sources": ["Mic/Aux", ...]} - an empty or missing list means all sources
+	try {
+		json request = json::parse(msg->get_payload());
+		if (request.value("type", "") != "subscribe") {
+			return;
+		}
+
+		auto sources = std::make_shared<std::set<std::string>>();
+		if (request.contains("sources") && request["sources"].is_array()) {
+			for (const auto &source : request["sources"]) {
+				if (source.is_string()) {
+					sources->insert(source.get<std::string>());
+				}
+			}
+		}
+		std::atomic_store(&subscriber->sources, std::shared_ptr<const std::set<std::string>>(sources));
+
+		blog(LOG_INFO, "[Audio to WebSocket] Subscriber %s subscribed to %s", subscriber->remote.c_str(),
+		     sources->empty() ? "all sources" : (std::to_string(sources->size()) + " source(s)").c_str());
+	} catch (const json::exception &e) {
+		blog(LOG_WARNING, "[Audio to WebSocket] Ignoring malformed message from %s: %s",
+		     subscriber->remote.c_str(), e.what());
+	}
+}
+
+} // namespace obs_audio_to_websocket
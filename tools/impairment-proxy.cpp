@@ -0,0 +1,248 @@
+#include "impairment-proxy.hpp"
+#include <algorithm>
+
+namespace obs_audio_to_websocket {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+Clock::duration ExponentialMs(std::mt19937 &rng, uint32_t meanMs)
+{
+	std::exponential_distribution<double> distribution(1.0 / meanMs);
+	std::chrono::duration<double, std::milli> interval(distribution(rng));
+	return std::chrono::duration_cast<Clock::duration>(interval);
+}
+
+} // namespace
+
+ImpairmentProxy::ImpairmentProxy(const asio::ip::tcp::endpoint &target, const ImpairmentSettings &settings)
+	: m_target(target),
+	  m_settings(settings),
+	  m_acceptor(m_io, asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0))
+{
+	m_port = m_acceptor.local_endpoint().port();
+	StartAccept();
+	m_thread = std::thread([this]() { m_io.run(); });
+}
+
+ImpairmentProxy::~ImpairmentProxy()
+{
+	asio::post(m_io, [this]() {
+		asio::error_code ec;
+		m_acceptor.close(ec);
+		auto links = m_links;
+		for (const auto &link : links) {
+			Close(link, false);
+		}
+		m_io.stop();
+	});
+	m_thread.join();
+}
+
+void ImpairmentProxy::StartAccept()
+{
+	auto link = std::make_shared<Link>(m_io, m_settings.seed + m_accepted);
+	m_acceptor.async_accept(link->client, [this, link](const asio::error_code &ec) {
+		if (ec == asio::error::operation_aborted)
+			return;
+		if (!ec) {
+			++m_accepted;
+			Open(link);
+		}
+		StartAccept();
+	});
+}
+
+void ImpairmentProxy::Open(const std::shared_ptr<Link> &link)
+{
+	m_links.insert(link);
+	m_stats.connections.fetch_add(1, std::memory_order_relaxed);
+
+	asio::error_code ec;
+	link->client.set_option(asio::ip::tcp::no_delay(true), ec);
+	link->server.async_connect(m_target, [this, link](const asio::error_code &connectEc) {
+		if (link->closed)
+			return;
+		if (connectEc) {
+			Close(link, true);
+			return;
+		}
+		asio::error_code optionEc;
+		link->server.set_option(asio::ip::tcp::no_delay(true), optionEc);
+
+		auto now = Clock::now();
+		link->lastDue = now;
+		link->linkFree = now;
+		ScheduleStall(*link, now);
+		ScheduleReset(link);
+		ReadClient(link);
+		ReadServer(link);
+	});
+}
+
+void ImpairmentProxy::ReadClient(const std::shared_ptr<Link> &link)
+{
+	link->client.async_read_some(asio::buffer(link->upBuffer), [this, link](const asio::error_code &ec, size_t n) {
+		if (link->closed)
+			return;
+		if (ec) {
+			Close(link, false);
+			return;
+		}
+
+		Chunk chunk;
+		chunk.data.assign(link->upBuffer.begin(), link->upBuffer.begin() + n);
+		chunk.due = Schedule(*link, n);
+		link->queue.push_back(std::move(chunk));
+		link->queuedBytes += n;
+
+		uint64_t max = m_stats.maxQueuedBytes.load(std::memory_order_relaxed);
+		if (link->queuedBytes > max)
+			m_stats.maxQueuedBytes.store(link->queuedBytes, std::memory_order_relaxed);
+
+		if (!link->writing)
+			WriteServer(link);
+
+		// Past the limit the client's own socket buffer fills, as it would behind a real bottleneck
+		if (link->queuedBytes >= m_settings.maxQueuedBytes) {
+			link->readPaused = true;
+		} else {
+			ReadClient(link);
+		}
+	});
+}
+
+void ImpairmentProxy::ReadServer(const std::shared_ptr<Link> &link)
+{
+	auto buffer = asio::buffer(link->downBuffer);
+	link->server.async_read_some(buffer, [this, link](const asio::error_code &ec, size_t n) {
+		if (link->closed)
+			return;
+		if (ec) {
+			Close(link, false);
+			return;
+		}
+		asio::async_write(link->client, asio::buffer(link->downBuffer, n),
+				  [this, link](const asio::error_code &writeEc, size_t) {
+					  if (link->closed)
+						  return;
+					  if (writeEc) {
+						  Close(link, false);
+						  return;
+					  }
+					  ReadServer(link);
+				  });
+	});
+}
+
+void ImpairmentProxy::WriteServer(const std::shared_ptr<Link> &link)
+{
+	if (link->queue.empty()) {
+		link->writing = false;
+		return;
+	}
+
+	link->writing = true;
+	link->sendTimer.expires_at(link->queue.front().due);
+	link->sendTimer.async_wait([this, link](const asio::error_code &ec) {
+		if (ec || link->closed)
+			return;
+		asio::async_write(link->server, asio::buffer(link->queue.front().data),
+				  [this, link](const asio::error_code &writeEc, size_t n) {
+					  if (link->closed)
+						  return;
+					  if (writeEc) {
+						  Close(link, false);
+						  return;
+					  }
+					  m_stats.bytes.fetch_add(n, std::memory_order_relaxed);
+					  link->queuedBytes -= n;
+					  link->queue.pop_front();
+					  if (link->readPaused && link->queuedBytes < m_settings.maxQueuedBytes / 2) {
+						  link->readPaused = false;
+						  ReadClient(link);
+					  }
+					  WriteServer(link);
+				  });
+	});
+}
+
+Clock::time_point ImpairmentProxy::Schedule(Link &link, size_t bytes)
+{
+	Clock::time_point due = Clock::now() + std::chrono::milliseconds(m_settings.delayMs);
+	if (m_settings.jitterMs) {
+		std::uniform_int_distribution<uint32_t> jitter(0, m_settings.jitterMs * 1000);
+		due += std::chrono::microseconds(jitter(link.jitterRng));
+	}
+	// Bytes on a stream can't overtake each other
+	due = std::max(due, link.lastDue);
+
+	if (m_settings.bandwidthBps) {
+		// Fully arrived once the capped link has carried it, after whatever is ahead of it
+		auto transfer = std::chrono::nanoseconds(bytes * 1000000000ULL / m_settings.bandwidthBps);
+		link.linkFree = std::max(due, link.linkFree) + transfer;
+		due = link.linkFree;
+	}
+
+	if (m_settings.stallEveryMs && m_settings.stallMs) {
+		while (due >= link.stallStart) {
+			if (due < link.stallEnd) {
+				if (!link.stallCounted) {
+					link.stallCounted = true;
+					m_stats.stalls.fetch_add(1, std::memory_order_relaxed);
+				}
+				due = link.stallEnd;
+				link.linkFree = std::max(link.linkFree, due);
+			}
+			ScheduleStall(link, link.stallEnd);
+		}
+	}
+
+	link.lastDue = due;
+	return due;
+}
+
+void ImpairmentProxy::ScheduleStall(Link &link, Clock::time_point after)
+{
+	if (!m_settings.stallEveryMs || !m_settings.stallMs)
+		return;
+	link.stallStart = after + ExponentialMs(link.stallRng, m_settings.stallEveryMs);
+	link.stallEnd = link.stallStart + std::chrono::milliseconds(m_settings.stallMs);
+	link.stallCounted = false;
+}
+
+void ImpairmentProxy::ScheduleReset(const std::shared_ptr<Link> &link)
+{
+	if (!m_settings.closeEveryMs)
+		return;
+	link->resetTimer.expires_after(ExponentialMs(link->resetRng, m_settings.closeEveryMs));
+	link->resetTimer.async_wait([this, link](const asio::error_code &ec) {
+		if (ec || link->closed)
+			return;
+		m_stats.resets.fetch_add(1, std::memory_order_relaxed);
+		Close(link, true);
+	});
+}
+
+void ImpairmentProxy::Close(const std::shared_ptr<Link> &link, bool reset)
+{
+	if (link->closed)
+		return;
+	link->closed = true;
+
+	asio::error_code ec;
+	if (reset) {
+		// Zero linger turns the close into a RST, like a dropped NAT mapping or a crashed peer
+		link->client.set_option(asio::socket_base::linger(true, 0), ec);
+		link->server.set_option(asio::socket_base::linger(true, 0), ec);
+	}
+	link->client.close(ec);
+	link->server.close(ec);
+	link->sendTimer.cancel();
+	link->resetTimer.cancel();
+	link->queue.clear();
+	m_links.erase(link);
+}
+
+} // namespace obs_audio_to_websocket
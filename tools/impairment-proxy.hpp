@@ -0,0 +1,125 @@
+#pragma once
+
+#include <asio.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace obs_audio_to_websocket {
+
+// What ImpairmentProxy does to the client -> server direction. Zero disables each impairment.
+struct ImpairmentSettings {
+	uint32_t delayMs = 0;       // Added one-way latency
+	uint32_t jitterMs = 0;      // Uniform extra delay in [0, jitterMs]; TCP keeps bytes in order regardless
+	uint64_t bandwidthBps = 0;  // Bytes per second the link drains at
+	uint32_t stallEveryMs = 0;  // Mean time between stalls (exponentially distributed)
+	uint32_t stallMs = 0;       // How long nothing gets through during a stall
+	uint32_t closeEveryMs = 0;  // Mean connection lifetime before an abrupt reset (exponentially distributed)
+	uint32_t seed = 1;          // Each connection's model is seeded with seed + its accept index
+	size_t maxQueuedBytes = 4 * 1024 * 1024; // In the proxy before it stops reading from the client
+
+	bool IsActive() const
+	{
+		return delayMs || jitterMs || bandwidthBps || (stallEveryMs && stallMs) || closeEveryMs;
+	}
+};
+
+// In-process TCP relay on the loopback interface that impairs a link reproducibly, for the load test and
+// the benchmarks. A sink connects to the proxy's port instead of the server's; WebSocket, raw TCP and RTP
+// over TCP all work unchanged since only timing and connection lifetime are touched, never bytes.
+//
+// The random draws (jitter, stall times, reset times) come from a seeded generator per connection, so a
+// run with the same settings meets the same impairments at the same offsets. Server -> client traffic is
+// relayed as is.
+class ImpairmentProxy {
+public:
+	struct Stats {
+		std::atomic<uint64_t> connections{0};
+		std::atomic<uint64_t> bytes{0};  // Client -> server, delivered
+		std::atomic<uint64_t> stalls{0}; // Stall windows that held back data
+		std::atomic<uint64_t> resets{0};
+		std::atomic<uint64_t> maxQueuedBytes{0};
+	};
+
+	ImpairmentProxy(const asio::ip::tcp::endpoint &target, const ImpairmentSettings &settings);
+	~ImpairmentProxy();
+	ImpairmentProxy(const ImpairmentProxy &) = delete;
+	ImpairmentProxy &operator=(const ImpairmentProxy &) = delete;
+
+	uint16_t GetPort() const { return m_port; }
+	const Stats &GetStats() const { return m_stats; }
+
+private:
+	struct Chunk {
+		std::vector<uint8_t> data;
+		std::chrono::steady_clock::time_point due;
+	};
+
+	struct Link {
+		Link(asio::io_context &io, uint32_t seed)
+			: client(io),
+			  server(io),
+			  sendTimer(io),
+			  resetTimer(io),
+			  jitterRng(seed),
+			  stallRng(seed ^ 0x5354414cu),
+			  resetRng(seed ^ 0x52535421u)
+		{
+		}
+
+		asio::ip::tcp::socket client;
+		asio::ip::tcp::socket server;
+		asio::steady_timer sendTimer;
+		asio::steady_timer resetTimer;
+		// One stream per impairment, so how reads happen to be chunked can't shift the stall or reset times
+		std::mt19937 jitterRng;
+		std::mt19937 stallRng;
+		std::mt19937 resetRng;
+
+		std::array<uint8_t, 16384> upBuffer;
+		std::array<uint8_t, 16384> downBuffer;
+		std::deque<Chunk> queue;
+		size_t queuedBytes = 0;
+		bool writing = false;
+		bool readPaused = false;
+		bool closed = false;
+
+		// Link model state
+		std::chrono::steady_clock::time_point lastDue;
+		std::chrono::steady_clock::time_point linkFree; // When the bandwidth cap has drained what's queued
+		std::chrono::steady_clock::time_point stallStart;
+		std::chrono::steady_clock::time_point stallEnd;
+		bool stallCounted = false;
+	};
+
+	void StartAccept();
+	void Open(const std::shared_ptr<Link> &link);
+	void ReadClient(const std::shared_ptr<Link> &link);
+	void ReadServer(const std::shared_ptr<Link> &link);
+	void WriteServer(const std::shared_ptr<Link> &link);
+	// Due time of a chunk of the given size arriving now, advancing the link model
+	std::chrono::steady_clock::time_point Schedule(Link &link, size_t bytes);
+	void ScheduleStall(Link &link, std::chrono::steady_clock::time_point after);
+	void ScheduleReset(const std::shared_ptr<Link> &link);
+	void Close(const std::shared_ptr<Link> &link, bool reset);
+
+	const asio::ip::tcp::endpoint m_target;
+	const ImpairmentSettings m_settings;
+	asio::io_context m_io;
+	asio::ip::tcp::acceptor m_acceptor;
+	uint16_t m_port = 0;
+	uint32_t m_accepted = 0;
+	std::set<std::shared_ptr<Link>> m_links; // Proxy thread only
+	Stats m_stats;
+	std::thread m_thread;
+};
+
+} // namespace obs_audio_to_websocket
@@ -0,0 +1,675 @@
+// Load-test harness: many WebSocketPPClients streaming synthetic audio into a local sink server that can
+// read slowly and drop connections, to see how the client copes before a rollout.
+//
+//   obs-audio-to-websocket-load-test --clients 50 --seconds 30 --read-rate 96000 --disconnect-every 5000
+//
+// Every client sends one block per tick, as the pipeline's fan-out does. The packet timestamp carries the
+// send time, so the server measures end-to-end latency on the same clock.
+//
+// With --subscribers N it tests the other direction instead: the embedded WebSocketPPServer broadcasting
+// to N local subscribers, measuring its CPU time and broadcast-to-receive latency.
+//
+//   obs-audio-to-websocket-load-test --subscribers 100 --seconds 30
+
+#include "obs-audio-to-websocket/audio-packet.hpp"
+#include "obs-audio-to-websocket/encoder-pool.hpp"
+#include "obs-audio-to-websocket/io-context-pool.hpp"
+#include "obs-audio-to-websocket/log.hpp"
+#include "obs-audio-to-websocket/pipeline-stats.hpp"
+#include "obs-audio-to-websocket/websocketpp-client.hpp"
+#include "obs-audio-to-websocket/websocketpp-server.hpp"
+#include "impairment-proxy.hpp"
+#include <websocketpp/client.hpp>
+#include <websocketpp/config/asio_no_tls.hpp>
+#include <websocketpp/config/asio_no_tls_client.hpp>
+#include <websocketpp/server.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace obs_audio_to_websocket;
+
+namespace {
+
+struct Options {
+	size_t clients = 50;
+	int seconds = 30;
+	uint32_t sampleRate = 48000;
+	uint32_t channels = 2;
+	uint32_t blockFrames = 1024;
+	uint32_t bitDepth = 16;
+	uint64_t readRate = 0;     // Bytes/s each server connection reads; 0 = as fast as possible
+	int disconnectEveryMs = 0; // 0 = never
+	double disconnectFraction = 1.0;
+	bool abrupt = false; // Drop the TCP connection instead of a close handshake
+	uint32_t seed = 1;
+	ImpairmentSettings impairment; // Between the clients and the server, when any is set
+	size_t subscribers = 0;        // > 0: embedded server fan-out to this many subscribers instead
+};
+
+void PrintUsage()
+{
+	fprintf(stderr,
+		"usage: obs-audio-to-websocket-load-test [options]\n"
+		"  --clients N             simulated streamers (default 50)\n"
+		"  --seconds N             test duration (default 30)\n"
+		"  --rate HZ               sample rate (default 48000)\n"
+		"  --channels N            channels (default 2)\n"
+		"  --block FRAMES          frames per block (default 1024)\n"
+		"  --f32                   32-bit float samples instead of 16-bit\n"
+		"  --read-rate BYTES       bytes/s the server reads per connection (default unlimited)\n"
+		"  --disconnect-every MS   force-close connections periodically (default never)\n"
+		"  --disconnect-fraction F share of connections closed each time (default 1, a reconnection storm)\n"
+		"  --abrupt                reset the TCP connection instead of sending a close frame\n"
+		"  --seed N                picks which connections are closed, seeds the impairments (default 1)\n"
+		"  --impair-delay MS       added one-way latency on the way to the server\n"
+		"  --impair-jitter MS      plus up to this much random delay\n"
+		"  --impair-bandwidth BYTES  link capacity per connection in bytes/s\n"
+		"  --impair-stall-every MS mean time between stalls\n"
+		"  --impair-stall MS       how long each stall holds back data\n"
+		"  --impair-reset-every MS mean connection lifetime before the link resets it\n"
+		"  --subscribers N         broadcast from the embedded server to N subscribers instead; only\n"
+		"                          --seconds, --rate, --channels, --block and --f32 apply\n"
+		"  --verbose               client log output at info level\n");
+}
+
+bool ParseOptions(int argc, char **argv, Options &options)
+{
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		auto value = [&]() -> const char * { return i + 1 < argc ? argv[++i] : nullptr; };
+		const char *v = nullptr;
+
+		if (arg == "--f32") {
+			options.bitDepth = 32;
+		} else if (arg == "--abrupt") {
+			options.abrupt = true;
+		} else if (arg == "--verbose") {
+			SetHeadlessLogLevel(LOG_INFO);
+		} else if (arg == "--subscribers" && (v = value())) {
+			options.subscribers = strtoul(v, nullptr, 10);
+		} else if (arg == "--clients" && (v = value())) {
+			options.clients = strtoul(v, nullptr, 10);
+		} else if (arg == "--seconds" && (v = value())) {
+			options.seconds = atoi(v);
+		} else if (arg == "--rate" && (v = value())) {
+			options.sampleRate = static_cast<uint32_t>(strtoul(v, nullptr, 10));
+		} else if (arg == "--channels" && (v = value())) {
+			options.channels = static_cast<uint32_t>(strtoul(v, nullptr, 10));
+		} else if (arg == "--block" && (v = value())) {
+			options.blockFrames = static_cast<uint32_t>(strtoul(v, nullptr, 10));
+		} else if (arg == "--read-rate" && (v = value())) {
+			options.readRate = strtoull(v, nullptr, 10);
+		} else if (arg == "--disconnect-every" && (v = value())) {
+			options.disconnectEveryMs = atoi(v);
+		} else if (arg == "--disconnect-fraction" && (v = value())) {
+			options.disconnectFraction = std::clamp(atof(v), 0.0, 1.0);
+		} else if (arg == "--seed" && (v = value())) {
+			options.seed = static_cast<uint32_t>(strtoul(v, nullptr, 10));
+		} else if (arg == "--impair-delay" && (v = value())) {
+			options.impairment.delayMs = static_cast<uint32_t>(strtoul(v, nullptr, 10));
+		} else if (arg == "--impair-jitter" && (v = value())) {
+			options.impairment.jitterMs = static_cast<uint32_t>(strtoul(v, nullptr, 10));
+		} else if (arg == "--impair-bandwidth" && (v = value())) {
+			options.impairment.bandwidthBps = strtoull(v, nullptr, 10);
+		} else if (arg == "--impair-stall-every" && (v = value())) {
+			options.impairment.stallEveryMs = static_cast<uint32_t>(strtoul(v, nullptr, 10));
+		} else if (arg == "--impair-stall" && (v = value())) {
+			options.impairment.stallMs = static_cast<uint32_t>(strtoul(v, nullptr, 10));
+		} else if (arg == "--impair-reset-every" && (v = value())) {
+			options.impairment.closeEveryMs = static_cast<uint32_t>(strtoul(v, nullptr, 10));
+		} else {
+			return false;
+		}
+	}
+	options.impairment.seed = options.seed;
+	return options.clients > 0 && options.seconds > 0 && options.sampleRate > 0 && options.channels > 0 &&
+	       options.blockFrames > 0;
+}
+
+// websocketpp sink on the loopback interface. Clients connect to /load/<index>, which is how received
+// packets and reconnects are attributed to them. All connection state lives on the server's own thread.
+class SinkServer {
+public:
+	struct ClientStats {
+		std::atomic<uint64_t> packets{0};
+		std::atomic<uint64_t> bytes{0};
+		std::atomic<uint64_t> connects{0};
+		uint64_t forcedCloseNs = 0; // Pending reconnect measurement; server thread only
+	};
+
+	SinkServer(size_t clients, uint64_t readRate) : m_clients(clients), m_readRate(readRate)
+	{
+		m_server.clear_access_channels(websocketpp::log::alevel::all);
+		m_server.clear_error_channels(websocketpp::log::elevel::all);
+		m_server.init_asio(&m_io);
+		m_server.set_reuse_addr(true);
+		m_server.set_open_handler([this](websocketpp::connection_hdl hdl) { OnOpen(hdl); });
+		m_server.set_close_handler([this](websocketpp::connection_hdl hdl) { m_connections.erase(hdl); });
+		m_server.set_fail_handler([this](websocketpp::connection_hdl hdl) { m_connections.erase(hdl); });
+		m_server.set_message_handler(
+			[this](websocketpp::connection_hdl hdl, server_type::message_ptr msg) { OnMessage(hdl, msg); });
+		m_server.listen(asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+		m_server.start_accept();
+		asio::error_code ec;
+		port = m_server.get_local_endpoint(ec).port();
+		m_thread = std::thread([this]() { m_io.run(); });
+	}
+
+	~SinkServer()
+	{
+		asio::post(m_io, [this]() {
+			websocketpp::lib::error_code ec;
+			m_server.stop_listening(ec);
+			for (auto &entry : m_connections) {
+				asio::error_code closeEc;
+				entry.second.con->get_raw_socket().close(closeEc);
+			}
+			m_connections.clear();
+			m_io.stop();
+		});
+		m_thread.join();
+	}
+
+	// Closes each live connection with the given probability, cleanly or by resetting the socket
+	void ForceDisconnect(double fraction, bool abrupt, std::mt19937 &rng)
+	{
+		std::bernoulli_distribution pick(fraction);
+		std::vector<bool> picks(m_clients.size());
+		for (size_t i = 0; i < picks.size(); ++i) {
+			picks[i] = pick(rng);
+		}
+
+		asio::post(m_io, [this, picks, abrupt]() {
+			uint64_t now = SteadyNowNs();
+			for (auto it = m_connections.begin(); it != m_connections.end();) {
+				Connection &connection = it->second;
+				if (!picks[connection.client]) {
+					++it;
+					continue;
+				}
+				m_clients[connection.client].forcedCloseNs = now;
+				forcedCloses.fetch_add(1, std::memory_order_relaxed);
+				if (abrupt) {
+					// Not every websocketpp version runs the close handler for a reset socket, so
+					// forget the connection here
+					asio::error_code ec;
+					connection.con->get_raw_socket().close(ec);
+					it = m_connections.erase(it);
+				} else {
+					websocketpp::lib::error_code ec;
+					connection.con->close(websocketpp::close::status::going_away, "load test", ec);
+					++it;
+				}
+			}
+		});
+	}
+
+	const ClientStats &GetClient(size_t index) const { return m_clients[index]; }
+
+	uint16_t port = 0;
+	Histogram latencyNs;   // Packet timestamp (send time) -> received
+	Histogram reconnectNs; // Forced close -> the same client's next open
+	std::atomic<uint64_t> forcedCloses{0};
+
+private:
+	using server_type = websocketpp::server<websocketpp::config::asio>;
+
+	struct Connection {
+		server_type::connection_ptr con;
+		size_t client = 0;
+		// Token bucket for --read-rate
+		double tokens = 0;
+		uint64_t refillNs = 0;
+		std::shared_ptr<asio::steady_timer> resume;
+	};
+
+	void OnOpen(websocketpp::connection_hdl hdl)
+	{
+		websocketpp::lib::error_code ec;
+		auto con = m_server.get_con_from_hdl(hdl, ec);
+		if (ec)
+			return;
+
+		const std::string &resource = con->get_resource();
+		size_t index = ~size_t(0);
+		if (resource.rfind("/load/", 0) == 0)
+			index = strtoul(resource.c_str() + 6, nullptr, 10);
+		if (index >= m_clients.size()) {
+			con->close(websocketpp::close::status::policy_violation, "unknown client", ec);
+			return;
+		}
+
+		ClientStats &client = m_clients[index];
+		client.connects.fetch_add(1, std::memory_order_relaxed);
+		if (client.forcedCloseNs) {
+			reconnectNs.Record(SteadyNowNs() - client.forcedCloseNs);
+			client.forcedCloseNs = 0;
+		}
+
+		Connection connection;
+		connection.con = con;
+		connection.client = index;
+		connection.tokens = static_cast<double>(m_readRate) / 10; // 100 ms burst
+		connection.refillNs = SteadyNowNs();
+		connection.resume = std::make_shared<asio::steady_timer>(m_io);
+		m_connections[hdl] = std::move(connection);
+	}
+
+	void OnMessage(websocketpp::connection_hdl hdl, server_type::message_ptr msg)
+	{
+		auto it = m_connections.find(hdl);
+		if (it == m_connections.end() || msg->get_opcode() != websocketpp::frame::opcode::binary)
+			return;
+
+		const std::string &payload = msg->get_payload();
+		uint64_t now = SteadyNowNs();
+		if (payload.size() >= AUDIO_PACKET_HEADER_SIZE) {
+			uint64_t timestamp = 0;
+			for (int i = 7; i >= 0; --i) {
+				timestamp = (timestamp << 8) | static_cast<uint8_t>(payload[i]);
+			}
+			latencyNs.Record(now > timestamp ? now - timestamp : 0);
+		}
+
+		Connection &connection = it->second;
+		ClientStats &client = m_clients[connection.client];
+		client.packets.fetch_add(1, std::memory_order_relaxed);
+		client.bytes.fetch_add(payload.size(), std::memory_order_relaxed);
+
+		if (m_readRate)
+			Throttle(hdl, connection, payload.size(), now);
+	}
+
+	// Stops reading once the connection is over its byte budget, until the bucket has refilled. The
+	// kernel buffers fill up behind it and the client sees the backpressure of a slow consumer.
+	void Throttle(websocketpp::connection_hdl hdl, Connection &connection, size_t bytes, uint64_t now)
+	{
+		double rate = static_cast<double>(m_readRate);
+		connection.tokens = std::min(rate / 10, connection.tokens + (now - connection.refillNs) * rate / 1e9);
+		connection.refillNs = now;
+		connection.tokens -= static_cast<double>(bytes);
+		if (connection.tokens >= 0)
+			return;
+
+		connection.con->pause_reading();
+		auto wait = std::chrono::nanoseconds(static_cast<uint64_t>(-connection.tokens / rate * 1e9));
+		connection.resume->expires_after(wait);
+		connection.resume->async_wait([this, hdl](const asio::error_code &ec) {
+			auto it = m_connections.find(hdl);
+			if (!ec && it != m_connections.end())
+				it->second.con->resume_reading();
+		});
+	}
+
+	asio::io_context m_io;
+	server_type m_server;
+	std::vector<ClientStats> m_clients;
+	const uint64_t m_readRate;
+	std::map<websocketpp::connection_hdl, Connection, std::owner_less<websocketpp::connection_hdl>> m_connections;
+	std::thread m_thread;
+};
+
+double Ms(uint64_t ns)
+{
+	return ns / 1e6;
+}
+
+// websocketpp clients subscribed to the embedded server, all on one thread of their own so their CPU time
+// isn't counted as the server's
+class SubscriberPool {
+public:
+	explicit SubscriberPool(size_t count) : m_stats(count)
+	{
+		m_client.clear_access_channels(websocketpp::log::alevel::all);
+		m_client.clear_error_channels(websocketpp::log::elevel::all);
+		m_client.init_asio(&m_io);
+		m_work = std::make_unique<asio::executor_work_guard<asio::io_context::executor_type>>(
+			m_io.get_executor());
+		m_thread = std::thread([this]() { m_io.run(); });
+	}
+
+	~SubscriberPool()
+	{
+		m_work.reset();
+		asio::post(m_io, [this]() {
+			for (auto &connection : m_connections) {
+				asio::error_code ec;
+				connection->get_raw_socket().close(ec);
+			}
+			m_io.stop();
+		});
+		m_thread.join();
+	}
+
+	void Connect(const std::string &uri)
+	{
+		asio::post(m_io, [this, uri]() {
+			for (size_t i = 0; i < m_stats.size(); ++i) {
+				websocketpp::lib::error_code ec;
+				client_type::connection_ptr con = m_client.get_connection(uri, ec);
+				if (ec)
+					continue;
+				con->set_open_handler([this](websocketpp::connection_hdl) { opened.fetch_add(1); });
+				con->set_message_handler(
+					[this, i](websocketpp::connection_hdl, client_type::message_ptr msg) {
+						OnMessage(i, msg);
+					});
+				con->set_close_handler([this](websocketpp::connection_hdl hdl) { OnClose(hdl); });
+				m_client.connect(con);
+				m_connections.push_back(con);
+			}
+		});
+	}
+
+	uint64_t GetPackets(size_t index) const { return m_stats[index].load(); }
+
+	std::atomic<size_t> opened{0};
+	std::atomic<size_t> closedByServer{0}; // Close frames received with "going away"
+	std::atomic<size_t> closedOtherwise{0};
+	Histogram latencyNs; // Broadcast -> received
+
+private:
+	using client_type = websocketpp::client<websocketpp::config::asio_client>;
+
+	void OnMessage(size_t index, client_type::message_ptr msg)
+	{
+		if (msg->get_opcode() != websocketpp::frame::opcode::binary)
+			return;
+		const std::string &payload = msg->get_payload();
+		if (payload.size() >= AUDIO_PACKET_HEADER_SIZE) {
+			uint64_t timestamp = 0;
+			for (int i = 7; i >= 0; --i) {
+				timestamp = (timestamp << 8) | static_cast<uint8_t>(payload[i]);
+			}
+			uint64_t now = SteadyNowNs();
+			latencyNs.Record(now > timestamp ? now - timestamp : 0);
+		}
+		m_stats[index].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void OnClose(websocketpp::connection_hdl hdl)
+	{
+		websocketpp::lib::error_code ec;
+		client_type::connection_ptr con = m_client.get_con_from_hdl(hdl, ec);
+		bool goingAway = con && con->get_remote_close_code() == websocketpp::close::status::going_away;
+		(goingAway ? closedByServer : closedOtherwise).fetch_add(1);
+	}
+
+	asio::io_context m_io;
+	client_type m_client;
+	std::unique_ptr<asio::executor_work_guard<asio::io_context::executor_type>> m_work;
+	std::vector<client_type::connection_ptr> m_connections;
+	std::vector<std::atomic<uint64_t>> m_stats;
+	std::thread m_thread;
+};
+
+// CPU time the given context's thread has used so far
+uint64_t ContextCpuTimeNs(asio::io_context &io)
+{
+	std::promise<uint64_t> cpu;
+	std::future<uint64_t> result = cpu.get_future();
+	asio::post(io, [&cpu]() { cpu.set_value(ThreadCpuTimeNs()); });
+	return result.get();
+}
+
+// --subscribers: one packet per block broadcast by the embedded server, as a pipeline in server mode does
+int RunFanout(const Options &options)
+{
+	// One network thread, so the server's share of CPU can be read off it
+	IoContextPool::Instance().Configure(1, false);
+	asio::io_context &network = IoContextPool::Instance().Acquire();
+
+	auto server = std::make_unique<WebSocketPPServer>();
+	if (!server->Start(0)) {
+		fprintf(stderr, "Embedded server could not start\n");
+		IoContextPool::Instance().Stop();
+		return 1;
+	}
+
+	auto subscribers = std::make_unique<SubscriberPool>(options.subscribers);
+	subscribers->Connect("ws://127.0.0.1:" + std::to_string(server->GetPort()) + "/");
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	while ((subscribers->opened < options.subscribers || server->GetSubscriberCount() < options.subscribers) &&
+	       std::chrono::steady_clock::now() < deadline) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	fprintf(stderr, "%zu/%zu subscribers connected to 127.0.0.1:%u\n", server->GetSubscriberCount(),
+		options.subscribers, server->GetPort());
+
+	const AudioFormat format(options.sampleRate, options.channels, options.bitDepth);
+	const size_t payloadBytes = static_cast<size_t>(options.blockFrames) * options.channels * options.bitDepth / 8;
+	const auto blockDuration =
+		std::chrono::nanoseconds(uint64_t(options.blockFrames) * 1000000000ULL / options.sampleRate);
+	const size_t packetBytes = CreateAudioPacket(0, format, "load", "load", payloadBytes)->data.size();
+
+	const uint64_t networkCpuStart = ContextCpuTimeNs(network);
+	uint64_t broadcastCpuNs = 0;
+	uint64_t blocks = 0;
+	const auto start = std::chrono::steady_clock::now();
+	const auto end = start + std::chrono::seconds(options.seconds);
+	auto nextBlock = start;
+	auto nextReport = start + std::chrono::seconds(1);
+	while (std::chrono::steady_clock::now() < end) {
+		std::this_thread::sleep_until(nextBlock);
+		nextBlock += blockDuration;
+
+		auto packet = CreateAudioPacket(SteadyNowNs(), format, "load", "load", payloadBytes);
+		memset(packet->payload(), 0, payloadBytes);
+		uint64_t cpuStart = ThreadCpuTimeNs();
+		server->Broadcast(packet);
+		broadcastCpuNs += ThreadCpuTimeNs() - cpuStart;
+		++blocks;
+
+		auto now = std::chrono::steady_clock::now();
+		if (now >= nextReport) {
+			HistogramSnapshot latency;
+			latency.Add(subscribers->latencyNs);
+			auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - start).count();
+			fprintf(stderr, "%3llds  %zu subscribers, latency p99 %.1f ms\n",
+				static_cast<long long>(elapsed), server->GetSubscriberCount(),
+				Ms(latency.Percentile(0.99)));
+			nextReport += std::chrono::seconds(1);
+		}
+	}
+
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	const uint64_t networkCpuNs = ContextCpuTimeNs(network) - networkCpuStart;
+
+	uint64_t received = 0;
+	for (size_t i = 0; i < options.subscribers; ++i) {
+		received += subscribers->GetPackets(i);
+	}
+	const uint64_t expected = blocks * options.subscribers;
+	HistogramSnapshot latency;
+	latency.Add(subscribers->latencyNs);
+
+	// Subscribers should get their close frames before the server lets go
+	auto stopStart = std::chrono::steady_clock::now();
+	server->Stop();
+	double stopMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - stopStart).count();
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	printf("subscribers        %zu (%llu evicted)\n", options.subscribers,
+	       static_cast<unsigned long long>(server->GetEvictedCount()));
+	printf("blocks             %llu, %zu bytes each\n", static_cast<unsigned long long>(blocks), packetBytes);
+	printf("packets            %llu of %llu received, %llu dropped for slow subscribers\n",
+	       static_cast<unsigned long long>(received), static_cast<unsigned long long>(expected),
+	       static_cast<unsigned long long>(server->GetDroppedPackets()));
+	printf("server cpu         %.2f%% of a core broadcasting, %.2f%% on the network thread (%.1f us per block)\n",
+	       100.0 * broadcastCpuNs / (seconds * 1e9), 100.0 * networkCpuNs / (seconds * 1e9),
+	       blocks ? (broadcastCpuNs + networkCpuNs) / 1e3 / blocks : 0.0);
+	printf("latency            p50 %.2f ms, p90 %.2f ms, p99 %.2f ms, p99.9 %.2f ms, max %.2f ms\n",
+	       Ms(latency.Percentile(0.5)), Ms(latency.Percentile(0.9)), Ms(latency.Percentile(0.99)),
+	       Ms(latency.Percentile(0.999)), Ms(latency.GetMax()));
+	printf("stop               %.0f ms, %zu close frames received, %zu closed otherwise\n", stopMs,
+	       subscribers->closedByServer.load(), subscribers->closedOtherwise.load());
+
+	bool ok = subscribers->closedByServer.load() == options.subscribers;
+	subscribers.reset();
+	server.reset();
+	IoContextPool::Instance().Stop();
+	// Every subscriber must have connected and been closed cleanly
+	return ok ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options)) {
+		PrintUsage();
+		return 2;
+	}
+	if (options.subscribers > 0)
+		return RunFanout(options);
+
+	SinkServer server(options.clients, options.readRate);
+	std::unique_ptr<ImpairmentProxy> proxy;
+	uint16_t port = server.port;
+	if (options.impairment.IsActive()) {
+		asio::ip::tcp::endpoint target(asio::ip::address_v4::loopback(), server.port);
+		proxy = std::make_unique<ImpairmentProxy>(target, options.impairment);
+		port = proxy->GetPort();
+	}
+
+	std::vector<std::shared_ptr<WebSocketPPClient>> clients;
+	for (size_t i = 0; i < options.clients; ++i) {
+		auto client = std::make_shared<WebSocketPPClient>();
+		client->Connect("ws://127.0.0.1:" + std::to_string(port) + "/load/" + std::to_string(i));
+		clients.push_back(std::move(client));
+	}
+
+	auto connectedCount = [&clients]() {
+		return std::count_if(clients.begin(), clients.end(), [](const auto &c) { return c->IsConnected(); });
+	};
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	while (static_cast<size_t>(connectedCount()) < clients.size() && std::chrono::steady_clock::now() < deadline) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	fprintf(stderr, "%zu/%zu clients connected to 127.0.0.1:%u%s\n", static_cast<size_t>(connectedCount()),
+		clients.size(), server.port, proxy ? " through the impairment proxy" : "");
+
+	// Per client: packets handed to a connected client, and blocks skipped while it was reconnecting
+	std::vector<uint64_t> attempted(clients.size()), offline(clients.size());
+	const AudioFormat format(options.sampleRate, options.channels, options.bitDepth);
+	const size_t payloadBytes = static_cast<size_t>(options.blockFrames) * options.channels * options.bitDepth / 8;
+	const auto blockDuration =
+		std::chrono::nanoseconds(uint64_t(options.blockFrames) * 1000000000ULL / options.sampleRate);
+
+	std::mt19937 rng(options.seed);
+	const auto start = std::chrono::steady_clock::now();
+	const auto end = start + std::chrono::seconds(options.seconds);
+	auto nextBlock = start;
+	auto nextDisconnect = start + std::chrono::milliseconds(options.disconnectEveryMs);
+	auto nextReport = start + std::chrono::seconds(1);
+	uint64_t blocks = 0;
+
+	std::vector<uint8_t> silence(payloadBytes);
+	const size_t packetBytes = CreateAudioPacket(0, format, "load", "load", payloadBytes)->data.size();
+	while (std::chrono::steady_clock::now() < end) {
+		std::this_thread::sleep_until(nextBlock);
+		nextBlock += blockDuration;
+
+		// One packet shared by every client, like the pipeline's fan-out
+		auto packet = CreateAudioPacket(SteadyNowNs(), format, "load", "load", payloadBytes);
+		memcpy(packet->payload(), silence.data(), payloadBytes);
+		AudioPacketPtr shared = packet;
+		for (size_t i = 0; i < clients.size(); ++i) {
+			if (clients[i]->IsConnected()) {
+				++attempted[i];
+				clients[i]->SendAudioPacket(shared);
+			} else {
+				++offline[i];
+			}
+		}
+		++blocks;
+
+		auto now = std::chrono::steady_clock::now();
+		if (options.disconnectEveryMs > 0 && now >= nextDisconnect) {
+			server.ForceDisconnect(options.disconnectFraction, options.abrupt, rng);
+			nextDisconnect += std::chrono::milliseconds(options.disconnectEveryMs);
+		}
+		if (now >= nextReport) {
+			HistogramSnapshot latency;
+			latency.Add(server.latencyNs);
+			auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - start).count();
+			fprintf(stderr, "%3llds  %zu/%zu connected, latency p99 %.1f ms\n",
+				static_cast<long long>(elapsed), static_cast<size_t>(connectedCount()), clients.size(),
+				Ms(latency.Percentile(0.99)));
+			nextReport += std::chrono::seconds(1);
+		}
+	}
+
+	// Let queued packets arrive before counting the rest as lost
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	uint64_t sent = 0, skipped = 0, dropped = 0, received = 0, bytes = 0, lost = 0;
+	size_t failed = 0;
+	for (size_t i = 0; i < clients.size(); ++i) {
+		const auto &stats = server.GetClient(i);
+		uint64_t clientDropped = clients[i]->GetDroppedPackets();
+		uint64_t clientReceived = stats.packets.load();
+		sent += attempted[i];
+		skipped += offline[i];
+		dropped += clientDropped;
+		received += clientReceived;
+		bytes += stats.bytes.load();
+		// Accepted by the client but never read: in flight when a connection went away
+		if (attempted[i] > clientDropped + clientReceived)
+			lost += attempted[i] - clientDropped - clientReceived;
+		if (!clients[i]->IsConnected() && !clients[i]->IsReconnecting())
+			++failed;
+	}
+
+	HistogramSnapshot latency, reconnect;
+	latency.Add(server.latencyNs);
+	reconnect.Add(server.reconnectNs);
+
+	printf("clients            %zu (%zu gave up reconnecting)\n", clients.size(), failed);
+	printf("blocks             %llu per client, %zu bytes each\n", static_cast<unsigned long long>(blocks),
+	       packetBytes);
+	printf("throughput         %.0f packets/s, %.2f MB/s\n", received / seconds, bytes / seconds / 1e6);
+	printf("packets            %llu sent, %llu received, %llu dropped by backpressure, %llu lost, "
+	       "%llu skipped while disconnected\n",
+	       static_cast<unsigned long long>(sent), static_cast<unsigned long long>(received),
+	       static_cast<unsigned long long>(dropped), static_cast<unsigned long long>(lost),
+	       static_cast<unsigned long long>(skipped));
+	printf("latency            p50 %.2f ms, p90 %.2f ms, p99 %.2f ms, p99.9 %.2f ms, max %.2f ms\n",
+	       Ms(latency.Percentile(0.5)), Ms(latency.Percentile(0.9)), Ms(latency.Percentile(0.99)),
+	       Ms(latency.Percentile(0.999)), Ms(latency.GetMax()));
+	printf("reconnects         %llu of %llu forced closes, p50 %.0f ms, p99 %.0f ms, max %.0f ms\n",
+	       static_cast<unsigned long long>(reconnect.GetCount()),
+	       static_cast<unsigned long long>(server.forcedCloses.load()), Ms(reconnect.Percentile(0.5)),
+	       Ms(reconnect.Percentile(0.99)), Ms(reconnect.GetMax()));
+	if (proxy) {
+		const auto &impaired = proxy->GetStats();
+		printf("impairment         %llu connections, %llu stalls, %llu resets, up to %llu bytes held back\n",
+		       static_cast<unsigned long long>(impaired.connections.load()),
+		       static_cast<unsigned long long>(impaired.stalls.load()),
+		       static_cast<unsigned long long>(impaired.resets.load()),
+		       static_cast<unsigned long long>(impaired.maxQueuedBytes.load()));
+	}
+
+	for (auto &client : clients) {
+		client->Disconnect();
+	}
+	clients.clear();
+	proxy.reset();
+	IoContextPool::Instance().Stop();
+	// Losses are expected when connections are closed on purpose; a client giving up is not
+	return failed == 0 ? 0 : 1;
+}
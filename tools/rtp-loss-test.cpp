@@ -0,0 +1,405 @@
+// RTP loss test: an RtpSink streaming synthetic 16-bit audio to a local UDP receiver that drops a seeded
+// random share of the datagrams it reads, as a lossy network would.
+//
+//   obs-audio-to-websocket-rtp-loss-test --seconds 10 --loss 0.05 --fec 5
+//
+// The receiver finds losses from sequence gaps only, like a real one, then rebuilds what it can from the
+// XOR parity packets (see the README's RTP section). Since it did the dropping itself, it can check every
+// gap against a drop and every rebuilt packet against the original bit for bit.
+
+#include "obs-audio-to-websocket/audio-packet.hpp"
+#include "obs-audio-to-websocket/io-context-pool.hpp"
+#include "obs-audio-to-websocket/log.hpp"
+#include "obs-audio-to-websocket/pipeline-stats.hpp"
+#include "obs-audio-to-websocket/rtp-sink.hpp"
+#include <asio.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace obs_audio_to_websocket;
+
+namespace {
+
+constexpr size_t RTP_HEADER_SIZE = 12;
+constexpr size_t FEC_HEADER_SIZE = 12;
+constexpr uint8_t PAYLOAD_TYPE = 96;
+
+struct Options {
+	int seconds = 10;
+	double loss = 0.05;
+	int fec = 5;
+	size_t mtu = 1200;
+	uint32_t sampleRate = 48000;
+	uint32_t channels = 2;
+	uint32_t blockFrames = 1024;
+	uint32_t seed = 1;
+};
+
+void PrintUsage()
+{
+	fprintf(stderr, "usage: obs-audio-to-websocket-rtp-loss-test [options]\n"
+			"  --seconds N     test duration (default 10)\n"
+			"  --loss F        share of datagrams the receiver drops (default 0.05)\n"
+			"  --fec N         media packets per parity packet, 0 = no FEC (default 5)\n"
+			"  --mtu BYTES     RTP datagram size limit (default 1200)\n"
+			"  --rate HZ       sample rate (default 48000)\n"
+			"  --channels N    channels (default 2)\n"
+			"  --block FRAMES  frames per block (default 1024)\n"
+			"  --seed N        seeds the losses (default 1)\n"
+			"  --verbose       sink log output at info level\n");
+}
+
+bool ParseOptions(int argc, char **argv, Options &options)
+{
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		auto value = [&]() -> const char * { return i + 1 < argc ? argv[++i] : nullptr; };
+		const char *v = nullptr;
+
+		if (arg == "--verbose") {
+			SetHeadlessLogLevel(LOG_INFO);
+		} else if (arg == "--seconds" && (v = value())) {
+			options.seconds = atoi(v);
+		} else if (arg == "--loss" && (v = value())) {
+			options.loss = atof(v);
+		} else if (arg == "--fec" && (v = value())) {
+			options.fec = atoi(v);
+		} else if (arg == "--mtu" && (v = value())) {
+			options.mtu = strtoul(v, nullptr, 10);
+		} else if (arg == "--rate" && (v = value())) {
+			options.sampleRate = static_cast<uint32_t>(strtoul(v, nullptr, 10));
+		} else if (arg == "--channels" && (v = value())) {
+			options.channels = static_cast<uint32_t>(strtoul(v, nullptr, 10));
+		} else if (arg == "--block" && (v = value())) {
+			options.blockFrames = static_cast<uint32_t>(strtoul(v, nullptr, 10));
+		} else if (arg == "--seed" && (v = value())) {
+			options.seed = static_cast<uint32_t>(strtoul(v, nullptr, 10));
+		} else {
+			return false;
+		}
+	}
+	return options.seconds > 0 && options.loss >= 0.0 && options.loss < 1.0 && options.fec >= 0 &&
+	       options.fec <= 48 && options.sampleRate > 0 && options.channels > 0 && options.blockFrames > 0;
+}
+
+uint16_t ReadUint16BE(const uint8_t *in)
+{
+	return static_cast<uint16_t>((in[0] << 8) | in[1]);
+}
+
+uint32_t ReadUint32BE(const uint8_t *in)
+{
+	return (static_cast<uint32_t>(in[0]) << 24) | (static_cast<uint32_t>(in[1]) << 16) |
+	       (static_cast<uint32_t>(in[2]) << 8) | in[3];
+}
+
+// One media packet as the receiver keeps it for FEC
+struct Media {
+	uint8_t markerAndType = 0;
+	uint32_t timestamp = 0;
+	std::vector<uint8_t> payload;
+};
+
+// UDP receiver on the loopback interface. Everything below runs on its own thread until Stop().
+class LossyReceiver {
+public:
+	LossyReceiver(double loss, uint32_t seed, size_t mtu, uint32_t channels)
+		: m_socket(m_io),
+		  m_rng(seed),
+		  m_drop(loss),
+		  m_mtu(mtu),
+		  m_bytesPerFrame(channels * sizeof(int16_t))
+	{
+		m_socket.open(asio::ip::udp::v4());
+		// Bursts of a whole block arrive at once; keep the kernel from adding losses of its own
+		asio::error_code ec;
+		m_socket.set_option(asio::socket_base::receive_buffer_size(4 << 20), ec);
+		m_socket.bind(asio::ip::udp::endpoint(asio::ip::address_v4::loopback(), 0));
+		port = m_socket.local_endpoint().port();
+		StartReceive();
+		m_thread = std::thread([this]() { m_io.run(); });
+	}
+
+	~LossyReceiver() { Stop(); }
+
+	void Stop()
+	{
+		if (!m_thread.joinable())
+			return;
+		asio::post(m_io, [this]() {
+			asio::error_code ec;
+			m_socket.close(ec);
+		});
+		m_thread.join();
+	}
+
+	uint16_t port = 0;
+
+	// Read after Stop()
+	uint64_t datagrams = 0;
+	uint64_t mediaReceived = 0;
+	uint64_t mediaDropped = 0;    // By this receiver
+	uint64_t trailingDrops = 0;   // Dropped after the last media packet that arrived, so no gap shows them
+	uint64_t parityReceived = 0;
+	uint64_t parityDropped = 0;
+	uint64_t gapPackets = 0;      // Missing sequence numbers the receiver detected
+	uint64_t recovered = 0;       // Rebuilt from parity and identical to the dropped original
+	uint64_t mismatched = 0;      // Rebuilt from parity but different from the original
+	uint64_t unrecoverable = 0;   // Lost packets whose group lost more than one, or its parity packet
+	uint64_t unexplained = 0;     // Missing in a group but not dropped here: lost inside the kernel
+	uint64_t malformed = 0;
+	uint64_t oversized = 0;       // Datagrams larger than the MTU
+	uint64_t timestampJumps = 0;  // Consecutive media packets whose timestamps differ by more than the frames sent
+
+private:
+	void StartReceive()
+	{
+		m_socket.async_receive(asio::buffer(m_buffer), [this](const asio::error_code &ec, size_t length) {
+			if (ec == asio::error::operation_aborted)
+				return;
+			if (!ec)
+				OnDatagram(m_buffer.data(), length);
+			StartReceive();
+		});
+	}
+
+	void OnDatagram(const uint8_t *data, size_t length)
+	{
+		++datagrams;
+		if (length < RTP_HEADER_SIZE || (data[0] >> 6) != 2) {
+			++malformed;
+			return;
+		}
+
+		const uint8_t markerAndType = data[1];
+		const uint8_t payloadType = markerAndType & 0x7F;
+		const uint16_t seq = ReadUint16BE(data + 2);
+		const uint32_t timestamp = ReadUint32BE(data + 4);
+		const uint8_t *payload = data + RTP_HEADER_SIZE;
+		const size_t payloadLength = length - RTP_HEADER_SIZE;
+		const bool drop = m_drop(m_rng);
+		if (length > m_mtu)
+			++oversized;
+
+		if (payloadType == PAYLOAD_TYPE) {
+			// Checked before dropping: the sink only skips ahead when the sender's audio had a gap
+			if (m_haveLast && seq == static_cast<uint16_t>(m_lastSeq + 1) &&
+			    timestamp != m_lastTimestamp + m_lastFrames)
+				++timestampJumps;
+			m_lastSeq = seq;
+			m_lastTimestamp = timestamp;
+			m_lastFrames = static_cast<uint32_t>(payloadLength / m_bytesPerFrame);
+			m_haveLast = true;
+
+			Media media{markerAndType, timestamp, std::vector<uint8_t>(payload, payload + payloadLength)};
+			if (drop) {
+				++mediaDropped;
+				++trailingDrops;
+				m_dropped[seq] = std::move(media);
+				return;
+			}
+			++mediaReceived;
+			trailingDrops = 0;
+			if (m_haveExpected && seq != m_expected) {
+				uint16_t gap = static_cast<uint16_t>(seq - m_expected);
+				if (gap < 0x8000)
+					gapPackets += gap;
+			}
+			m_expected = static_cast<uint16_t>(seq + 1);
+			m_haveExpected = true;
+			m_received[seq] = std::move(media);
+			return;
+		}
+
+		if (payloadType != PAYLOAD_TYPE + 1 || payloadLength < FEC_HEADER_SIZE) {
+			++malformed;
+			return;
+		}
+		(drop ? parityDropped : parityReceived)++;
+		OnParity(payload, payloadLength, !drop);
+	}
+
+	// Parity follows its group, so every media packet of the group has arrived or been lost by now
+	void OnParity(const uint8_t *fec, size_t length, bool usable)
+	{
+		const uint16_t base = ReadUint16BE(fec);
+		const uint8_t count = fec[2];
+
+		std::vector<uint16_t> missing;
+		for (uint8_t i = 0; i < count; ++i) {
+			uint16_t seq = static_cast<uint16_t>(base + i);
+			if (!m_received.count(seq))
+				missing.push_back(seq);
+		}
+
+		for (uint16_t seq : missing) {
+			if (!m_dropped.count(seq))
+				++unexplained;
+		}
+		if (missing.size() == 1 && usable && m_dropped.count(missing[0])) {
+			Media rebuilt = Rebuild(fec, length, base, count);
+			const Media &original = m_dropped[missing[0]];
+			bool same = rebuilt.markerAndType == original.markerAndType &&
+				    rebuilt.timestamp == original.timestamp && rebuilt.payload == original.payload;
+			(same ? recovered : mismatched)++;
+		} else {
+			unrecoverable += missing.size();
+		}
+
+		// Forget the group, so sequence numbers can wrap
+		for (uint8_t i = 0; i < count; ++i) {
+			uint16_t seq = static_cast<uint16_t>(base + i);
+			m_received.erase(seq);
+			m_dropped.erase(seq);
+		}
+	}
+
+	// XOR of the parity packet with every packet of the group that arrived leaves the missing one
+	Media Rebuild(const uint8_t *fec, size_t length, uint16_t base, uint8_t count)
+	{
+		Media media;
+		media.markerAndType = fec[3];
+		media.timestamp = ReadUint32BE(fec + 4);
+		uint16_t payloadLength = ReadUint16BE(fec + 8);
+		media.payload.assign(fec + FEC_HEADER_SIZE, fec + length);
+
+		for (uint8_t i = 0; i < count; ++i) {
+			auto it = m_received.find(static_cast<uint16_t>(base + i));
+			if (it == m_received.end())
+				continue;
+			const Media &other = it->second;
+			media.markerAndType ^= other.markerAndType;
+			media.timestamp ^= other.timestamp;
+			payloadLength ^= static_cast<uint16_t>(other.payload.size());
+			for (size_t j = 0; j < other.payload.size() && j < media.payload.size(); ++j) {
+				media.payload[j] ^= other.payload[j];
+			}
+		}
+		media.payload.resize(std::min<size_t>(payloadLength, media.payload.size()));
+		return media;
+	}
+
+	asio::io_context m_io;
+	asio::ip::udp::socket m_socket;
+	std::vector<uint8_t> m_buffer = std::vector<uint8_t>(65536);
+	std::mt19937 m_rng;
+	std::bernoulli_distribution m_drop;
+	size_t m_mtu;
+	size_t m_bytesPerFrame;
+	uint16_t m_lastSeq = 0;
+	uint32_t m_lastTimestamp = 0;
+	uint32_t m_lastFrames = 0;
+	bool m_haveLast = false;
+	std::map<uint16_t, Media> m_received;
+	std::map<uint16_t, Media> m_dropped;
+	uint16_t m_expected = 0;
+	bool m_haveExpected = false;
+	std::thread m_thread;
+};
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options)) {
+		PrintUsage();
+		return 2;
+	}
+
+	LossyReceiver receiver(options.loss, options.seed, options.mtu, options.channels);
+
+	auto sink = std::make_shared<RtpSink>();
+	std::string uri = "rtp://127.0.0.1:" + std::to_string(receiver.port) + "?mtu=" + std::to_string(options.mtu);
+	if (options.fec > 0)
+		uri += "&fec=" + std::to_string(options.fec);
+	sink->Connect(uri);
+
+	// The sink resolves the host on a network thread
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+	while (!sink->IsConnected() && std::chrono::steady_clock::now() < deadline) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+	if (!sink->IsConnected()) {
+		fprintf(stderr, "RTP sink did not connect to %s\n", uri.c_str());
+		IoContextPool::Instance().Stop();
+		return 1;
+	}
+
+	const AudioFormat format(options.sampleRate, options.channels, 16);
+	const size_t payloadBytes = static_cast<size_t>(options.blockFrames) * options.channels * sizeof(int16_t);
+	const auto blockDuration =
+		std::chrono::nanoseconds(uint64_t(options.blockFrames) * 1000000000ULL / options.sampleRate);
+
+	// A 440 Hz tone, so the payload bytes differ from packet to packet
+	const double step = 2.0 * 3.14159265358979323846 * 440.0 / options.sampleRate;
+	uint64_t frame = 0;
+	uint64_t blocks = 0;
+	const auto start = std::chrono::steady_clock::now();
+	const auto end = start + std::chrono::seconds(options.seconds);
+	auto nextBlock = start;
+	while (std::chrono::steady_clock::now() < end) {
+		std::this_thread::sleep_until(nextBlock);
+		nextBlock += blockDuration;
+
+		auto packet = CreateAudioPacket(SteadyNowNs(), format, "rtp-loss", "rtp-loss", payloadBytes);
+		uint8_t *out = packet->payload();
+		for (uint32_t i = 0; i < options.blockFrames; ++i, ++frame) {
+			auto sample = static_cast<int16_t>(std::lround(std::sin(step * frame) * 16000.0));
+			for (uint32_t ch = 0; ch < options.channels; ++ch) {
+				*out++ = static_cast<uint8_t>(sample);
+				*out++ = static_cast<uint8_t>(static_cast<uint16_t>(sample) >> 8);
+			}
+		}
+		sink->SendAudioPacket(packet);
+		++blocks;
+	}
+
+	// Let the last datagrams arrive
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	const uint64_t sendDrops = sink->GetDroppedPackets();
+	sink->Disconnect();
+	sink.reset();
+	receiver.Stop();
+	IoContextPool::Instance().Stop();
+
+	const uint64_t media = receiver.mediaReceived + receiver.mediaDropped;
+	const uint64_t detectable = receiver.mediaDropped - receiver.trailingDrops;
+	const uint64_t lostAfterFec = receiver.mediaDropped - receiver.recovered;
+	printf("blocks             %llu of %u frames\n", static_cast<unsigned long long>(blocks), options.blockFrames);
+	printf("datagrams          %llu received, %llu media, %llu parity, %llu not sent (socket busy)\n",
+	       static_cast<unsigned long long>(receiver.datagrams), static_cast<unsigned long long>(media),
+	       static_cast<unsigned long long>(receiver.parityReceived + receiver.parityDropped),
+	       static_cast<unsigned long long>(sendDrops));
+	printf("dropped            %llu media (%.2f%%), %llu parity\n",
+	       static_cast<unsigned long long>(receiver.mediaDropped),
+	       media ? 100.0 * receiver.mediaDropped / media : 0.0,
+	       static_cast<unsigned long long>(receiver.parityDropped));
+	printf("sequence gaps      %llu packets, %llu drops before the last packet received\n",
+	       static_cast<unsigned long long>(receiver.gapPackets), static_cast<unsigned long long>(detectable));
+	printf("timestamps         %llu jumps (sender stalls), %llu datagrams over the MTU\n",
+	       static_cast<unsigned long long>(receiver.timestampJumps),
+	       static_cast<unsigned long long>(receiver.oversized));
+	if (options.fec > 0) {
+		printf("fec                %llu recovered, %llu mismatched, %llu unrecoverable, %llu lost in the kernel\n",
+		       static_cast<unsigned long long>(receiver.recovered),
+		       static_cast<unsigned long long>(receiver.mismatched),
+		       static_cast<unsigned long long>(receiver.unrecoverable),
+		       static_cast<unsigned long long>(receiver.unexplained));
+		printf("residual loss      %.2f%% after FEC\n", media ? 100.0 * lostAfterFec / media : 0.0);
+	}
+
+	// Every drop must show up as a gap, every rebuilt packet must match and every datagram must fit the MTU;
+	// losses beyond the simulated ones (kernel buffers, a busy socket) are reported but don't fail the run
+	bool ok = media > 0 && receiver.gapPackets >= detectable && receiver.mismatched == 0 &&
+		  receiver.malformed == 0 && receiver.oversized == 0;
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+#include "wav-reader.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+constexpr uint16_t WAVE_FORMAT_PCM = 1;
+constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 3;
+constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+uint16_t ReadLe16(const uint8_t *p)
+{
+	return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t ReadLe32(const uint8_t *p)
+{
+	return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+	       (static_cast<uint32_t>(p[3]) << 24);
+}
+
+float DecodeSample(const uint8_t *p, uint16_t format, uint16_t bits)
+{
+	if (format == WAVE_FORMAT_IEEE_FLOAT) {
+		uint32_t raw = ReadLe32(p);
+		float value;
+		memcpy(&value, &raw, sizeof(value));
+		return value;
+	}
+	switch (bits) {
+	case 16:
+		return static_cast<int16_t>(ReadLe16(p)) / 32768.0f;
+	case 24: {
+		int32_t value = static_cast<int32_t>(p[0] << 8 | p[1] << 16 | static_cast<uint32_t>(p[2]) << 24) >> 8;
+		return value / 8388608.0f;
+	}
+	default:
+		return static_cast<int32_t>(ReadLe32(p)) / 2147483648.0f;
+	}
+}
+
+} // namespace
+
+bool ReadWavFile(const std::string &path, WavFile &wav, std::string &error)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		error = "cannot open " + path;
+		return false;
+	}
+	std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (bytes.size() < 12 || memcmp(bytes.data(), "RIFF", 4) != 0 || memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+		error = path + " is not a RIFF/WAVE file";
+		return false;
+	}
+
+	uint16_t format = 0, channels = 0, bits = 0, blockAlign = 0;
+	uint32_t sampleRate = 0;
+	const uint8_t *data = nullptr;
+	size_t dataSize = 0;
+
+	// Chunks are word-aligned; a truncated data chunk (common from crashed recorders) is read up to the end
+	size_t pos = 12;
+	while (pos + 8 <= bytes.size()) {
+		const uint8_t *chunk = bytes.data() + pos;
+		size_t size = ReadLe32(chunk + 4);
+		size_t available = std::min(size, bytes.size() - pos - 8);
+		if (memcmp(chunk, "fmt ", 4) == 0 && available >= 16) {
+			format = ReadLe16(chunk + 8);
+			channels = ReadLe16(chunk + 10);
+			sampleRate = ReadLe32(chunk + 12);
+			blockAlign = ReadLe16(chunk + 20);
+			bits = ReadLe16(chunk + 22);
+			if (format == WAVE_FORMAT_EXTENSIBLE && available >= 26) {
+				// The sub-format GUID starts with the actual format tag
+				format = ReadLe16(chunk + 32);
+			}
+		} else if (memcmp(chunk, "data", 4) == 0) {
+			data = chunk + 8;
+			dataSize = available;
+		}
+		pos += 8 + size + (size & 1);
+	}
+
+	if (!data || channels == 0 || sampleRate == 0) {
+		error = path + " has no fmt or data chunk";
+		return false;
+	}
+	bool supported = (format == WAVE_FORMAT_PCM && (bits == 16 || bits == 24 || bits == 32)) ||
+			  (format == WAVE_FORMAT_IEEE_FLOAT && bits == 32);
+	if (!supported || blockAlign != channels * (bits / 8)) {
+		error = path + ": unsupported sample format (tag " + std::to_string(format) + ", " +
+			std::to_string(bits) + " bits)";
+		return false;
+	}
+
+	wav.sampleRate = sampleRate;
+	wav.channels = channels;
+	wav.frames = static_cast<uint32_t>(dataSize / blockAlign);
+	wav.planes.assign(channels, std::vector<float>(wav.frames));
+	const size_t sampleBytes = bits / 8;
+	for (uint32_t i = 0; i < wav.frames; ++i) {
+		const uint8_t *frame = data + static_cast<size_t>(i) * blockAlign;
+		for (uint16_t ch = 0; ch < channels; ++ch) {
+			wav.planes[ch][i] = DecodeSample(frame + ch * sampleBytes, format, bits);
+		}
+	}
+	return true;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Whole-file WAV loader for the offline tools: PCM 16/24/32-bit or 32-bit float, including
+// WAVE_FORMAT_EXTENSIBLE, converted to planar float
+struct WavFile {
+	uint32_t sampleRate = 0;
+	uint32_t channels = 0;
+	uint32_t frames = 0;
+	std::vector<std::vector<float>> planes; // One per channel
+};
+
+// Returns false with a reason in error for anything it can't read
+bool ReadWavFile(const std::string &path, WavFile &wav, std::string &error);
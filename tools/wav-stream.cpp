@@ -0,0 +1,347 @@
+// Streams a WAV file through a StreamPipeline without OBS, for reproducing issues, profiling the encode path
+// and exercising consumers offline:
+//
+//   obs-audio-to-websocket-wav-stream [options] input.wav
+//
+// The file is cut into blocks the size OBS delivers and pushed either at real-time pace or as fast as the
+// pipeline takes them. Timestamps are on the stream clock, advancing with the position in the file from
+// when streaming began, so clock sync and consumer acks work as they do in OBS.
+
+#include "obs-audio-to-websocket/constants.hpp"
+#include "obs-audio-to-websocket/encoder-pool.hpp"
+#include "obs-audio-to-websocket/io-context-pool.hpp"
+#include "obs-audio-to-websocket/log.hpp"
+#include "obs-audio-to-websocket/stream-pipeline.hpp"
+#include "obs-audio-to-websocket/stream-profile.hpp"
+#include "wav-reader.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+using namespace obs_audio_to_websocket;
+
+namespace {
+
+struct Options {
+	std::string path;
+	StreamProfile profile;
+	bool realtime = true;
+	uint32_t blockFrames = 1024; // OBS's audio block size
+	uint32_t loops = 1;
+	bool inlineEncode = false;
+	int connectTimeoutMs = 5000;
+	int dscp = 0;
+	int cpuBudgetPercent = constants::DEFAULT_CPU_BUDGET_PERCENT;
+};
+
+void PrintUsage()
+{
+	fprintf(stderr,
+		"usage: obs-audio-to-websocket-wav-stream [options] input.wav\n"
+		"  --url LIST          destinations, as in the plugin's URL field (default %s)\n"
+		"  --format NAME       output format as in the settings dialog (default s16)\n"
+		"  --adaptive          step down the format ladder when the link congests\n"
+		"  --ladder LIST       comma-separated ladder steps, e.g. f32,s16,s16@16000/mono (implies --adaptive)\n"
+		"  --name NAME         stream/source name sent with each packet (default: file name)\n"
+		"  --block FRAMES      frames per block (default 1024)\n"
+		"  --realtime | --max  pace blocks at the file's sample rate, or push as fast as possible\n"
+		"  --loop N            play the file N times (default 1)\n"
+		"  --inline            encode on the push thread instead of the encoder pool\n"
+		"  --connect-timeout MS  wait this long for a sink to connect before pushing (default 5000)\n"
+		"  --dscp N            DSCP value for outgoing packets\n"
+		"  --cpu-budget PCT    CPU budget per block in percent of its duration, 0 for none (default %d)\n"
+		"  --verbose           plugin log output at info level\n",
+		StreamProfile().urls.c_str(), constants::DEFAULT_CPU_BUDGET_PERCENT);
+}
+
+bool ParseOptions(int argc, char **argv, Options &options)
+{
+	options.profile.name.clear();
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		auto value = [&]() -> const char * { return i + 1 < argc ? argv[++i] : nullptr; };
+		const char *v = nullptr;
+
+		if (arg == "--realtime") {
+			options.realtime = true;
+		} else if (arg == "--max") {
+			options.realtime = false;
+		} else if (arg == "--inline") {
+			options.inlineEncode = true;
+		} else if (arg == "--verbose") {
+			SetHeadlessLogLevel(LOG_INFO);
+		} else if (arg == "--url" && (v = value())) {
+			options.profile.urls = v;
+		} else if (arg == "--format" && (v = value())) {
+			if (!ApplyOutputFormat(v, options.profile)) {
+				fprintf(stderr, "unknown format '%s'\n", v);
+				return false;
+			}
+		} else if (arg == "--adaptive") {
+			options.profile.adaptive = true;
+		} else if (arg == "--ladder" && (v = value())) {
+			options.profile.adaptive = true;
+			options.profile.ladder.clear();
+			for (const auto &name : ParseUrlList(v)) {
+				FormatRung rung;
+				if (!ParseFormatRung(name, rung)) {
+					fprintf(stderr, "unknown ladder step '%s'\n", name.c_str());
+					return false;
+				}
+				options.profile.ladder.push_back(rung);
+			}
+		} else if (arg == "--name" && (v = value())) {
+			options.profile.name = v;
+		} else if (arg == "--block" && (v = value())) {
+			options.blockFrames = static_cast<uint32_t>(strtoul(v, nullptr, 10));
+		} else if (arg == "--loop" && (v = value())) {
+			options.loops = static_cast<uint32_t>(strtoul(v, nullptr, 10));
+		} else if (arg == "--connect-timeout" && (v = value())) {
+			options.connectTimeoutMs = atoi(v);
+		} else if (arg == "--dscp" && (v = value())) {
+			options.dscp = atoi(v);
+		} else if (arg == "--cpu-budget" && (v = value())) {
+			options.cpuBudgetPercent = atoi(v);
+		} else if (!arg.empty() && arg[0] != '-' && options.path.empty()) {
+			options.path = arg;
+		} else {
+			return false;
+		}
+	}
+
+	if (options.path.empty() || options.blockFrames == 0 || options.loops == 0)
+		return false;
+
+	if (options.profile.name.empty()) {
+		size_t slash = options.path.find_last_of("/\\");
+		options.profile.name = slash == std::string::npos ? options.path : options.path.substr(slash + 1);
+	}
+	// Pushed by the driver, not tapped from OBS
+	options.profile.audioSource = options.profile.name;
+	options.profile.sampleRate = 0;
+	options.profile.channels = 0;
+	return true;
+}
+
+// Pushes a decoded file into the pipeline from its own thread once Begin() is called, so a run can wait
+// for its sinks to connect first
+class WavInput : public AudioInput {
+public:
+	WavInput(const WavFile &wav, uint32_t blockFrames, uint32_t loops, bool realtime)
+		: m_wav(wav),
+		  m_blockFrames(blockFrames),
+		  m_loops(loops),
+		  m_realtime(realtime)
+	{
+	}
+	~WavInput() override { Detach(); }
+
+	bool Attach(StreamPipeline &pipeline, std::string &error) override
+	{
+		if (m_wav.channels > MAX_FRAME_CHANNELS) {
+			error = "WAV files with more than " + std::to_string(MAX_FRAME_CHANNELS) +
+				" channels are not supported";
+			return false;
+		}
+		m_pipeline = &pipeline;
+		m_thread = std::thread([this]() { Run(); });
+		return true;
+	}
+
+	void Detach() override
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_wake.notify_all();
+		if (m_thread.joinable())
+			m_thread.join();
+	}
+
+	void Begin()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_started = true;
+		}
+		m_wake.notify_all();
+	}
+
+	// Blocks until the whole file has been pushed (or Detach)
+	void WaitFinished()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_wake.wait(lock, [this]() { return m_finished || m_stop.load(); });
+	}
+
+	uint64_t GetPushedBlocks() const { return m_pushed.load(); }
+
+private:
+	void Run()
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [this]() { return m_started || m_stop.load(); });
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		const uint64_t startNs = SteadyNowNs();
+		uint64_t framesPushed = 0;
+		AudioFrame frame;
+		frame.channels = m_wav.channels;
+		frame.sampleRate = m_wav.sampleRate;
+
+		for (uint32_t loop = 0; loop < m_loops; ++loop) {
+			for (uint32_t offset = 0; offset < m_wav.frames; offset += m_blockFrames) {
+				if (m_realtime) {
+					auto due = start + std::chrono::nanoseconds(framesPushed * 1000000000ULL /
+										    m_wav.sampleRate);
+					std::unique_lock<std::mutex> lock(m_mutex);
+					if (m_wake.wait_until(lock, due, [this]() { return m_stop.load(); }))
+						return;
+				} else if (m_stop.load(std::memory_order_relaxed)) {
+					return;
+				}
+
+				frame.frames = std::min(m_blockFrames, m_wav.frames - offset);
+				for (uint32_t ch = 0; ch < m_wav.channels; ++ch) {
+					frame.planes[ch] = m_wav.planes[ch].data() + offset;
+				}
+				frame.timestamp = startNs + framesPushed * 1000000000ULL / m_wav.sampleRate;
+				m_pipeline->PushAudio(frame);
+				framesPushed += frame.frames;
+				m_pushed.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_finished = true;
+		}
+		m_wake.notify_all();
+	}
+
+	const WavFile &m_wav;
+	const uint32_t m_blockFrames;
+	const uint32_t m_loops;
+	const bool m_realtime;
+	StreamPipeline *m_pipeline = nullptr;
+
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	bool m_started = false;
+	bool m_finished = false;
+	std::atomic<bool> m_stop{false};
+	std::atomic<uint64_t> m_pushed{0};
+};
+
+double Ms(uint64_t ns)
+{
+	return ns / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options)) {
+		PrintUsage();
+		return 2;
+	}
+
+	WavFile wav;
+	std::string error;
+	if (!ReadWavFile(options.path, wav, error)) {
+		fprintf(stderr, "%s\n", error.c_str());
+		return 1;
+	}
+	fprintf(stderr, "%s: %u Hz, %u channels, %.2f s\n", options.path.c_str(), wav.sampleRate, wav.channels,
+		static_cast<double>(wav.frames) / wav.sampleRate);
+
+	if (options.inlineEncode) {
+		EncoderPool::Instance().Configure(0, false);
+	}
+
+	auto pipeline = std::make_shared<StreamPipeline>(options.profile);
+	pipeline->SetOnError([](const std::string &message) { fprintf(stderr, "error: %s\n", message.c_str()); });
+	pipeline->SetCpuBudget(options.cpuBudgetPercent / 100.0);
+
+	auto owned = std::make_unique<WavInput>(wav, options.blockFrames, options.loops, options.realtime);
+	WavInput *input = owned.get(); // Owned by the pipeline until Stop
+	if (!pipeline->Start(nullptr, options.dscp, std::move(owned)))
+		return 1;
+
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.connectTimeoutMs);
+	while (!pipeline->IsConnected() && std::chrono::steady_clock::now() < deadline) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	if (!pipeline->IsConnected()) {
+		fprintf(stderr, "no sink connected after %d ms, streaming anyway\n", options.connectTimeoutMs);
+	}
+
+	const uint64_t startNs = SteadyNowNs();
+	input->Begin();
+	input->WaitFinished();
+	const uint64_t pushedNs = SteadyNowNs();
+
+	// Stop drops blocks still queued for the encoder, so let the lane and the sinks catch up first
+	const PipelineStats &stats = pipeline->GetStats();
+	deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+	uint64_t settled = 0, last = ~uint64_t(0);
+	while (std::chrono::steady_clock::now() < deadline) {
+		uint64_t done = stats.packetsSent.load() + stats.packetsDropped.load();
+		if (pipeline->GetEncodedBlocks() >= input->GetPushedBlocks() && done == last && ++settled >= 5)
+			break;
+		if (done != last)
+			settled = 0;
+		last = done;
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+
+	const uint64_t blocks = input->GetPushedBlocks();
+	const uint64_t encoded = pipeline->GetEncodedBlocks();
+	const uint64_t encodeCpuNs = pipeline->GetEncodeCpuTimeNs();
+	pipeline->Stop();
+
+	HistogramSnapshot encode, captureToSend;
+	encode.Add(stats.encodeNs);
+	captureToSend.Add(stats.captureToSendNs);
+
+	const double audioSeconds = static_cast<double>(wav.frames) * options.loops / wav.sampleRate;
+	const double wallSeconds = (pushedNs - startNs) / 1e9;
+	printf("blocks pushed      %llu (%llu encoded, %.1f ms CPU)\n", static_cast<unsigned long long>(blocks),
+	       static_cast<unsigned long long>(encoded), Ms(encodeCpuNs));
+	printf("packets sent       %llu\n", static_cast<unsigned long long>(stats.packetsSent.load()));
+	printf("bytes sent         %llu\n", static_cast<unsigned long long>(stats.bytesSent.load()));
+	printf("packets dropped    %llu\n", static_cast<unsigned long long>(stats.packetsDropped.load()));
+	if (stats.budgetOverruns.load() > 0) {
+		printf("budget overruns    %llu (%llu blocks shed, ended shedding %s)\n",
+		       static_cast<unsigned long long>(stats.budgetOverruns.load()),
+		       static_cast<unsigned long long>(stats.blocksShed.load()),
+		       ShedStageName(static_cast<ShedStage>(stats.shedStage.load())));
+	}
+	if (options.profile.adaptive) {
+		printf("format switches    %llu (ended on %s)\n",
+		       static_cast<unsigned long long>(stats.formatSwitches.load()),
+		       FormatRungName(options.profile.FormatLadder()[stats.formatRung.load()]).c_str());
+	}
+	printf("wall time          %.3f s for %.3f s of audio (%.1fx real time)\n", wallSeconds, audioSeconds,
+	       wallSeconds > 0 ? audioSeconds / wallSeconds : 0.0);
+	printf("encode             p50 %.3f ms, p99 %.3f ms, max %.3f ms\n", Ms(encode.Percentile(0.5)),
+	       Ms(encode.Percentile(0.99)), Ms(encode.GetMax()));
+	printf("capture to send    p50 %.3f ms, p99 %.3f ms, max %.3f ms\n", Ms(captureToSend.Percentile(0.5)),
+	       Ms(captureToSend.Percentile(0.99)), Ms(captureToSend.GetMax()));
+
+	pipeline.reset();
+	EncoderPool::Instance().Stop();
+	IoContextPool::Instance().Stop();
+	return 0;
+}